@@ -17,6 +17,7 @@
 //   SCA 06.09.2022  v1.7 MPLABX 5.45/xc32 2.50/Harmony 2.06
 //                   Enlev bug dans GetCharFromFifo qui
 //                   empchait un buffer > 256 lments
+//   v1.8            ajout PeekCharFromFifo (lecture sans retrait)
 //
 /*--------------------------------------------------------*/
 
@@ -153,3 +154,31 @@ uint8_t GetCharFromFifo ( S_fifo *pDescrFifo, int8_t *carLu )
 } // GetCharFromFifo 
 
 
+/*------------------*/
+/* PeekCharFromFifo */
+/*==================*/
+
+// Lit le caractre situ  la position offset (0 = prochain  lire)
+// sans modifier le pointeur de lecture
+// retourne 0 si OK, 1 si offset au-del des caractres disponibles
+
+uint8_t PeekCharFromFifo ( S_fifo *pDescrFifo, int32_t offset, int8_t *carLu )
+{
+   int8_t *pPeek;
+
+   // test si le caractre demand est disponible
+   if ((offset < 0) || (offset >= GetReadSize(pDescrFifo))) {
+      *carLu = 0;
+      return (1); // pas disponible
+   }
+
+   // position du caractre, avec gestion du rebouclement
+   pPeek = pDescrFifo->pRead + offset;
+   if (pPeek > pDescrFifo->pFinFifo) {
+      pPeek = pPeek - pDescrFifo->fifoSize;
+   }
+   *carLu = *pPeek;
+   return (0); // OK
+} // PeekCharFromFifo
+
+
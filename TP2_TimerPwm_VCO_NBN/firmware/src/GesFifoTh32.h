@@ -17,6 +17,7 @@
 //   SCA 06.09.2022  v1.7 MPLABX 5.45/xc32 2.50/Harmony 2.06
 //                   Enlev bug dans GetCharFromFifo qui
 //                   empchait un buffer > 256 lments
+//   v1.8            ajout PeekCharFromFifo (lecture sans retrait)
 //
 /*--------------------------------------------------------*/
 
@@ -81,4 +82,14 @@ uint8_t PutCharInFifo ( S_fifo *pDescrFifo, int8_t charToPut );
 
 uint8_t GetCharFromFifo ( S_fifo *pDescrFifo, int8_t *carLu );
 
+/*------------------*/
+/* PeekCharFromFifo */
+/*==================*/
+
+// Lit le caractre situ  la position offset (0 = prochain  lire)
+// sans le retirer du fifo
+// retourne 0 si OK, 1 si offset au-del des caractres disponibles
+
+uint8_t PeekCharFromFifo ( S_fifo *pDescrFifo, int32_t offset, int8_t *carLu );
+
 #endif
@@ -17,12 +17,19 @@
 #include "Mc32gest_RS232.h"
 #include "gestPWM.h"
 #include "Mc32CalCrc16.h"
+#include "gestParam.h"
+#include "gestTraj.h"
+#include "gestPlayout.h"
+#include "gestBoot.h"
+#include "gestFrame.h"
+#include "gestCal.h"
+#include "gestDiag.h"
 
 
-// Struct pour mission des messages
-StruMess TxMess;
 // Struct pour rception des messages
 StruMess RxMess;  
+// Struct pour rception des trames de commande
+StruCmdMess RxCmdMess;
 /*                  Descripteurs de FIFO (RX et TX)                          */
 
 S_fifo descrFifoRX; /**< Descripteur du FIFO de rception (RX).            */
@@ -32,6 +39,74 @@ S_fifo descrFifoTX; /**< Descripteur du FIFO d'
 static int8_t fifoRX[FIFO_RX_SIZE];
 static int8_t fifoTX[FIFO_TX_SIZE];
 
+/* Instant d'arrive (core timer) de chaque octet du FIFO RX, mme index que fifoRX */
+static uint32_t fifoRXStamp[FIFO_RX_SIZE];
+static uint32_t rxIsrStamp;       // Instant d'entre dans l'ISR de rception en cours
+static uint32_t rxFrameStamp;     // Instant d'arrive du dbut de la dernire trame de commande
+
+/* Ping en attente de l'application des consignes */
+static uint8_t pingPending = 0;   // 1 = rponse au ping en attente
+static uint8_t pingSeq;           // Numro de squence reu
+static uint32_t pingRxStamp;      // Arrive dans l'ISR
+static uint32_t pingParseStamp;   // Fin du dcodage
+
+/* Compteurs du contrle de flux (RTS mis  jour depuis l'ISR et le consommateur) */
+static volatile S_rs232FlowStats flowStats;
+static volatile uint32_t rtsAssertStamp; // Instant (core timer) de la dernire activation de RTS
+static uint32_t ctsHoldStamp;            // Instant du dernier constat de blocage CTS
+#if !RS232_MULTIDROP
+static uint8_t ctsHold = 0;              // 1 = mission en attente bloque par CTS
+#endif
+
+/* Compteurs d'erreurs de la liaison (champs d'erreur UART mis  jour par l'ISR,
+   champs du parseur par le consommateur : aucun champ n'est partag) */
+static volatile S_rs232LinkStats linkStats;
+static uint8_t rxHunting = 0;            // 1 = recherche du code de dbut en cours
+static uint32_t huntStamp;               // Arrive du premier octet rejet de la recherche en cours
+static uint32_t realignTicksTotal = 0;   // Dure cumule des recherches (perte -> trame valide)
+static uint32_t realignTicksMax = 0;     // Plus longue recherche
+
+#if RS232_MULTIDROP
+/* Filtre d'adresse de l'ISR RX : suit la longueur des trames pour carter
+   entirement celles destines aux autres noeuds */
+typedef enum {
+    MD_HUNT,   // Recherche d'un code de dbut
+    MD_ADDR,   // Attente de l'octet d'adresse
+    MD_CMD,    // Attente du code de commande
+    MD_LEN,    // Attente de la longueur des donnes
+    MD_BODY    // Reste de la trame (donnes + CRC)
+} E_mdState;
+
+static E_mdState mdState = MD_HUNT;
+static int8_t mdStart;          // Code de dbut retenu en attendant l'adresse
+static uint8_t mdAccept;        // 1 = trame pour ce noeud ou diffusion
+static uint8_t mdRemain;        // Octets restants de la trame en cours
+static uint32_t mdNoiseBytes;   // Octets hors trame carts par l'ISR (ajouts  BytesDiscarded)
+static uint8_t pollPending = 0; // 1 = consigne adresse reue, rponse d'tat attendue
+
+// Pas de CTS sur le bus : l'mission est toujours autorise
+#define RS232_TX_READY()    (1)
+#else
+#define RS232_TX_READY()    (RS232_CTS == 0)
+#endif
+
+// Canal fiable : trame reue en avance, en attente d'excution
+typedef struct {
+    uint8_t Valid;                          // 1 = trame mmorise
+    uint8_t Len;                            // Octets utiles (Cmd + donnes)
+    uint8_t Data[CMD_PAYLOAD_MAX - 1];      // Cmd interne puis ses donnes
+} S_relRxSlot;
+
+// Canal fiable : rponse mmorise pour les rptitions
+typedef struct {
+    uint8_t Len;                                        // 0 = pas de rponse
+    uint8_t Data[CMD_PAYLOAD_MAX - RS232_REL_ACK_SIZE]; // Rponse (tat en premier)
+} S_relResp;
+
+static S_relRxSlot relRxSlots[RS232_REL_WINDOW]; // Seq dans [relExpected, relExpected + fentre[
+static S_relResp relResp[RS232_REL_WINDOW];      // Seq dans [relExpected - fentre, relExpected[
+static uint8_t relExpected = 0;                  // Prochain Seq  excuter
+
 
 /*                          Initialisation FIFO et RTS                        */
 /**
@@ -47,8 +122,656 @@ void InitFifoComm(void)
     // Initialisation du fifo d'mission
     InitFifo(&descrFifoTX, FIFO_TX_SIZE, fifoTX, 0);
 
+#if RS232_MULTIDROP
+    RS485_DE = 0;    // Transceiver en rception, bus libre
+#else
     // Init RTS 
     RS232_RTS = 1;   // interdit mission par l'autre
+    rtsAssertStamp = _CP0_GET_COUNT(); // Dbut de la priode bloque
+#endif
+}
+
+
+/*                 Dmarrage de l'mission                                    */
+/**
+ * @brief Autorise l'interruption d'mission si le distant est prt.
+ *
+ * En mode multipoint, l'metteur RS485 est valid avant le premier octet ;
+ * il est relch par l'ISR lorsque le dernier bit est sorti.
+ */
+static void RS232_TxStart(void)
+{
+#if RS232_MULTIDROP
+    RS485_DE = 1;
+#endif
+    if (RS232_TX_READY()) {
+        PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT);
+    }
+}
+
+
+/*                 Relchement RTS ct consommateur                          */
+/**
+ * @brief Relche RTS ds que la place libre du FIFO RX dpasse le seuil bas.
+ *
+ * Appele par le consommateur aprs chaque message retir du FIFO, afin que
+ * l'metteur distant ne reste pas bloqu jusqu'au cycle de service suivant.
+ * La dure de blocage est cumule avant de remettre RTS  0 : l'ISR ne peut
+ * donc pas ractiver RTS (et craser rtsAssertStamp) pendant la mise  jour.
+ */
+static void RS232_RxFlowRelease(void)
+{
+#if !RS232_MULTIDROP
+    uint32_t elapsed;
+
+    if ((RS232_RTS == 1) && (GetWriteSpace(&descrFifoRX) >= RX_FIFO_START_THRESHOLD)) {
+        elapsed = _CP0_GET_COUNT() - rtsAssertStamp;
+        flowStats.RtsThrottledTicks += elapsed;
+        if (elapsed > flowStats.RtsMaxTicks) {
+            flowStats.RtsMaxTicks = elapsed;
+        }
+        RS232_RTS = 0; // Autorise l'mission depuis le priphrique distant
+    }
+#endif
+}
+
+
+/**
+ * @brief crit une valeur 32 bits dans un buffer, MSB en premier.
+ *
+ * @param[out] pDest Emplacement des 4 octets.
+ * @param[in]  value Valeur  crire.
+ */
+static void RS232_PutU32(uint8_t *pDest, uint32_t value)
+{
+    pDest[0] = (uint8_t)(value >> 24);
+    pDest[1] = (uint8_t)(value >> 16);
+    pDest[2] = (uint8_t)(value >> 8);
+    pDest[3] = (uint8_t)value;
+}
+
+
+/**
+ * @brief Retourne l'instant d'arrive du prochain octet  lire du FIFO RX.
+ *
+ * @return Valeur du core timer releve par l'ISR lors du dpt de l'octet.
+ */
+static uint32_t RS232_RxHeadStamp(void)
+{
+    return fifoRXStamp[descrFifoRX.pRead - descrFifoRX.pDebFifo];
+}
+
+/*                 Comptage des octets rejets par le parseur                 */
+/**
+ * @brief Retire un octet rejet du FIFO RX et le comptabilise.
+ *
+ * Le premier rejet ouvre une resynchronisation, date par l'arrive de l'octet.
+ */
+static void RS232_DiscardByte(void)
+{
+    int8_t c;
+
+    if (rxHunting == 0) {
+        rxHunting = 1;
+        huntStamp = RS232_RxHeadStamp();
+        linkStats.Resyncs++;
+    }
+    GetCharFromFifo(&descrFifoRX, &c);
+    linkStats.BytesDiscarded++;
+}
+
+/**
+ * @brief Comptabilise une trame valide et clt la resynchronisation en cours.
+ *
+ * @param[in] stamp Arrive du code de dbut de la trame.
+ */
+static void RS232_FrameOk(uint32_t stamp)
+{
+    uint32_t elapsed;
+
+    linkStats.FramesOk++;
+    if (rxHunting) {
+        rxHunting = 0;
+        elapsed = stamp - huntStamp;
+        realignTicksTotal += elapsed;
+        if (elapsed > realignTicksMax) {
+            realignTicksMax = elapsed;
+        }
+    }
+}
+
+
+/*                 Excution des trames de commande                           */
+/**
+ * @brief Excute une commande et construit sa rponse.
+ *
+ * @param[in]  pMess    Trame de commande dont le CRC a t vrifi.
+ * @param[out] response Rponse (CMD_PAYLOAD_MAX - RS232_REL_ACK_SIZE octets au plus).
+ * @return Longueur de la rponse, 0 si aucune rponse immdiate (ping).
+ */
+static uint8_t RS232_BuildResponse(const StruCmdMess *pMess, uint8_t *response)
+{
+    uint8_t respLen = 1;
+    U_manip16 value;
+    S_rs232LinkStats link;
+    S_rs232FlowStats flow;
+    S_trajStatus traj;
+    S_playStatus play;
+    uint32_t size;
+    uint16_t crc;
+    uint8_t reportLen;
+    uint8_t i;
+
+    switch (pMess->Cmd)
+    {
+        case CMD_PARAM_WRITE:
+        case CMD_PARAM_READ:
+        {
+            if (((pMess->Cmd == CMD_PARAM_READ) && (pMess->Len != 1)) ||
+                ((pMess->Cmd == CMD_PARAM_WRITE) && (pMess->Len != 3))) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[0] = PARAM_OK;
+            if (pMess->Cmd == CMD_PARAM_WRITE) {
+                value.shl.msb = pMess->Data[1];
+                value.shl.lsb = pMess->Data[2];
+                response[0] = GPARAM_Set(pMess->Data[0], (int16_t)value.val);
+            } else if (pMess->Data[0] >= PARAM_NB) {
+                response[0] = PARAM_ERR_ID;
+            }
+            // Rponse : tat, identifiant et valeur effective du paramtre
+            value.val = 0;
+            if (pMess->Data[0] < PARAM_NB) {
+                value.val = (uint16_t)GPARAM_Get((E_paramId)pMess->Data[0]);
+            }
+            response[1] = pMess->Data[0];
+            response[2] = value.shl.msb;
+            response[3] = value.shl.lsb;
+            respLen = 4;
+            break;
+        }
+
+        case CMD_GET_LINK_STATS:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            GetLinkStats(&link);
+            response[0] = PARAM_OK;
+            RS232_PutU32(&response[1],  link.FramesOk);
+            RS232_PutU32(&response[5],  link.FramesBadCrc);
+            RS232_PutU32(&response[9],  link.BytesDiscarded);
+            RS232_PutU32(&response[13], link.Resyncs);
+            RS232_PutU32(&response[17], link.OverrunErrors);
+            RS232_PutU32(&response[21], link.FramingErrors);
+            RS232_PutU32(&response[25], link.ParityErrors);
+            RS232_PutU32(&response[29], link.ErrorBytesDropped);
+            RS232_PutU32(&response[33], link.RxFifoFullDrops);
+            RS232_PutU32(&response[37], link.RtsAssertions);
+            RS232_PutU32(&response[41], link.AddrFiltered);
+            respLen = 45;
+            break;
+        }
+
+        case CMD_GET_FLOW_STATS:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            GetFlowStats(&flow);
+            response[0] = PARAM_OK;
+            RS232_PutU32(&response[1],  flow.RtsAssertCount);
+            RS232_PutU32(&response[5],  flow.RtsThrottledTicks);
+            RS232_PutU32(&response[9],  flow.RtsMaxTicks);
+            RS232_PutU32(&response[13], flow.CtsHoldCount);
+            RS232_PutU32(&response[17], flow.CtsThrottledTicks);
+            respLen = 21;
+            break;
+        }
+
+        case CMD_PING:
+        {
+            if (pMess->Len != 1) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+#if RS232_MULTIDROP
+            // Ping de diffusion : pas de rponse
+            if (pMess->Addr == RS232_ADDR_BROADCAST) {
+                return 0;
+            }
+#endif
+            // Rponse diffre jusqu' l'application des consignes (SendPingReply)
+            pingSeq = pMess->Data[0];
+            pingRxStamp = rxFrameStamp;
+            pingParseStamp = _CP0_GET_COUNT();
+            pingPending = 1;
+            return 0;
+        }
+
+        case CMD_TRAJ_LOAD:
+        {
+            if ((pMess->Len % GTRAJ_POINT_SIZE) != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[1] = GTRAJ_Load(pMess->Data, pMess->Len / GTRAJ_POINT_SIZE);
+            response[0] = (response[1] == (pMess->Len / GTRAJ_POINT_SIZE)) ? PARAM_OK : CMD_ERR_OVERRUN;
+            GTRAJ_GetStatus(&traj);
+            response[2] = (GTRAJ_BUFFER_SIZE - 1) - traj.Count;
+            respLen = 3;
+            break;
+        }
+
+        case CMD_TRAJ_CTRL:
+        {
+            if (pMess->Len != 1) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[0] = PARAM_OK;
+            if (pMess->Data[0] == 0) {
+                GTRAJ_Stop();
+            } else if (pMess->Data[0] == 1) {
+                GTRAJ_Start();
+            } else if (pMess->Data[0] == 2) {
+                GTRAJ_End();
+            } else {
+                response[0] = CMD_ERR_VALUE;
+            }
+            break;
+        }
+
+        case CMD_TRAJ_STATUS:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            GTRAJ_GetStatus(&traj);
+            response[0] = PARAM_OK;
+            response[1] = traj.State;
+            response[2] = traj.Count;
+            response[3] = (uint8_t)(traj.Time >> 8);
+            response[4] = (uint8_t)traj.Time;
+            RS232_PutU32(&response[5], traj.UnderrunCount);
+            RS232_PutU32(&response[9], traj.OverrunCount);
+            respLen = 13;
+            break;
+        }
+
+        case CMD_PLAYOUT_STATUS:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            GPLAY_GetStatus(&play);
+            response[0] = PARAM_OK;
+            response[1] = play.Count;
+            RS232_PutU32(&response[2], play.LateTicks);
+            RS232_PutU32(&response[6], play.OverrunCount);
+            respLen = 10;
+            break;
+        }
+
+        case CMD_BOOT_START:
+        {
+            if (pMess->Len != 6) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            size = ((uint32_t)pMess->Data[0] << 24) | ((uint32_t)pMess->Data[1] << 16) |
+                   ((uint32_t)pMess->Data[2] << 8) | pMess->Data[3];
+            crc = ((uint16_t)pMess->Data[4] << 8) | pMess->Data[5];
+            response[0] = GBOOT_Start(size, crc);
+            response[1] = GBOOT_WINDOW;
+            response[2] = GBOOT_BLOCK_SIZE;
+            respLen = 3;
+            break;
+        }
+
+        case CMD_BOOT_DATA:
+        {
+            if (pMess->Len < 3) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[0] = GBOOT_PutBlock(((uint16_t)pMess->Data[0] << 8) | pMess->Data[1],
+                                         &pMess->Data[2], pMess->Len - 2);
+            response[1] = (uint8_t)(GBOOT_GetNextBlock() >> 8);
+            response[2] = (uint8_t)GBOOT_GetNextBlock();
+            response[3] = GBOOT_GetFreeSlots();
+            respLen = 4;
+            break;
+        }
+
+        case CMD_BOOT_END:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[0] = GBOOT_End(&crc);
+            response[1] = (uint8_t)(crc >> 8);
+            response[2] = (uint8_t)crc;
+            respLen = 3;
+            break;
+        }
+
+        case CMD_GET_SYNC_STATS:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            GetLinkStats(&link);
+            response[0] = PARAM_OK;
+            RS232_PutU32(&response[1], link.Resyncs);
+            RS232_PutU32(&response[5], realignTicksTotal);
+            RS232_PutU32(&response[9], realignTicksMax);
+            respLen = 13;
+            break;
+        }
+
+        case CMD_STATS_RESET:
+        {
+            if (pMess->Len != 0) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            ResetLinkStats();
+            response[0] = PARAM_OK;
+            break;
+        }
+
+        case CMD_CALIBRATE:
+        {
+            if (pMess->Len != 1) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            response[0] = GCAL_Command(pMess->Data[0], &response[1]);
+            respLen = 1 + GCAL_REPORT_SIZE;
+            break;
+        }
+
+        case CMD_DIAG:
+        {
+            response[0] = GDIAG_Command(pMess->Data, pMess->Len, &response[1], &reportLen);
+            respLen = 1 + reportLen;
+            break;
+        }
+
+        case CMD_REL_RESET:
+        {
+            if (pMess->Len != 1) {
+                response[0] = CMD_ERR_LENGTH;
+                break;
+            }
+            // Nouvelle session : trames en attente et rponses mmorises abandonnes
+            relExpected = pMess->Data[0];
+            for (i = 0; i < RS232_REL_WINDOW; i++) {
+                relRxSlots[i].Valid = 0;
+                relResp[i].Len = 0;
+            }
+            response[0] = PARAM_OK;
+            break;
+        }
+
+        default:
+        {
+            response[0] = CMD_ERR_UNKNOWN;
+            break;
+        }
+    }
+
+    return respLen;
+}
+
+/*                 Canal fiable (fentre glissante)                           */
+/**
+ * @brief Envoie l'acquittement d'une trame fiable, suivi de sa rponse.
+ *
+ * @param[in] seq   Numro de la trame acquitte.
+ * @param[in] pResp Rponse mmorise, NULL si la trame n'est pas encore excute.
+ */
+static void RS232_RelReply(uint8_t seq, const S_relResp *pResp)
+{
+    uint8_t reply[CMD_PAYLOAD_MAX];
+    uint8_t len = RS232_REL_ACK_SIZE;
+    uint8_t i;
+
+    reply[0] = seq;
+    reply[1] = relExpected;
+    reply[2] = 0;
+    for (i = 1; i < RS232_REL_WINDOW; i++) {
+        if (relRxSlots[(uint8_t)(relExpected + i) % RS232_REL_WINDOW].Valid) {
+            reply[2] |= (1 << (i - 1));
+        }
+    }
+    if (pResp != NULL) {
+        for (i = 0; i < pResp->Len; i++) {
+            reply[len++] = pResp->Data[i];
+        }
+    }
+    // FIFO TX plein : rponse perdue, l'hte rmet et obtient la rponse mmorise
+    SendCommand(CMD_REL_DATA | CMD_RESPONSE_FLAG, reply, len);
+}
+
+/**
+ * @brief Excute dans l'ordre les trames fiables disponibles  partir de relExpected.
+ *
+ * @param[in] pMess Trame reue (adresse reprise pour les commandes internes).
+ */
+static void RS232_RelDeliver(const StruCmdMess *pMess)
+{
+    StruCmdMess inner;
+    S_relRxSlot *pSlot;
+    S_relResp *pResp;
+    uint8_t seq;
+    uint8_t i;
+
+    pSlot = &relRxSlots[relExpected % RS232_REL_WINDOW];
+    while (pSlot->Valid)
+    {
+        pResp = &relResp[relExpected % RS232_REL_WINDOW];
+#if RS232_MULTIDROP
+        inner.Addr = pMess->Addr;
+#endif
+        inner.Cmd = pSlot->Data[0];
+        inner.Len = pSlot->Len - 1;
+        for (i = 0; i < inner.Len; i++) {
+            inner.Data[i] = pSlot->Data[i + 1];
+        }
+        if ((inner.Cmd == CMD_PING) || (inner.Cmd == CMD_REL_DATA) ||
+            (inner.Cmd == CMD_REL_RESET) || (inner.Cmd & CMD_RESPONSE_FLAG)) {
+            pResp->Data[0] = CMD_ERR_VALUE;
+            pResp->Len = 1;
+        } else {
+            pResp->Len = RS232_BuildResponse(&inner, pResp->Data);
+        }
+        pSlot->Valid = 0;
+
+        seq = relExpected++;
+        RS232_RelReply(seq, pResp);
+        pSlot = &relRxSlots[relExpected % RS232_REL_WINDOW];
+    }
+}
+
+/**
+ * @brief Traite une trame CMD_REL_DATA : mmorisation, excution dans l'ordre, acquittement.
+ *
+ * @param[in] pMess Trame fiable (Len >= 2).
+ */
+static void RS232_RelReceive(const StruCmdMess *pMess)
+{
+    uint8_t seq = pMess->Data[0];
+    uint8_t ahead = (uint8_t)(seq - relExpected);
+    S_relRxSlot *pSlot;
+    uint8_t i;
+
+    if (ahead < RS232_REL_WINDOW) {
+        pSlot = &relRxSlots[seq % RS232_REL_WINDOW];
+        if (!pSlot->Valid) {
+            pSlot->Len = pMess->Len - 1;
+            for (i = 0; i < pSlot->Len; i++) {
+                pSlot->Data[i] = pMess->Data[i + 1];
+            }
+            pSlot->Valid = 1;
+        }
+        if (ahead == 0) {
+            RS232_RelDeliver(pMess);
+        } else {
+            // En avance : acquittement slectif seul, excution aprs comblement du trou
+            RS232_RelReply(seq, NULL);
+        }
+    } else if ((uint8_t)(relExpected - seq) <= RS232_REL_WINDOW) {
+        // Rptition d'une trame excute (rponse perdue) : pas de nouvelle excution
+        RS232_RelReply(seq, &relResp[seq % RS232_REL_WINDOW]);
+    } else {
+        // Hors fentre : CumAck indique  l'hte o reprendre
+        RS232_RelReply(seq, NULL);
+    }
+}
+
+/**
+ * @brief Excute une commande reue et envoie la rponse correspondante.
+ *
+ * @param[in] pMess Trame de commande dont le CRC a t vrifi.
+ */
+static void RS232_ExecCommand(const StruCmdMess *pMess)
+{
+    uint8_t response[CMD_PAYLOAD_MAX];
+    uint8_t respLen;
+
+    // Une rponse (d'un autre noeud ou renvoye en cho) n'est jamais excute
+    if (pMess->Cmd & CMD_RESPONSE_FLAG) {
+        return;
+    }
+
+    if (pMess->Cmd == CMD_REL_DATA) {
+#if RS232_MULTIDROP
+        // Pas d'acquittement possible en diffusion
+        if (pMess->Addr == RS232_ADDR_BROADCAST) {
+            return;
+        }
+#endif
+        if (pMess->Len < 2) {
+            response[0] = CMD_ERR_LENGTH;
+            SendCommand(pMess->Cmd | CMD_RESPONSE_FLAG, response, 1);
+        } else {
+            RS232_RelReceive(pMess);
+        }
+        return;
+    }
+
+    respLen = RS232_BuildResponse(pMess, response);
+
+#if RS232_MULTIDROP
+    // Trame de diffusion : excute sans rponse pour viter les collisions
+    if (pMess->Addr == RS232_ADDR_BROADCAST) {
+        return;
+    }
+#endif
+    if (respLen > 0) {
+        SendCommand(pMess->Cmd | CMD_RESPONSE_FLAG, response, respLen);
+    }
+}
+
+/**
+ * @brief Vrifie le CRC de la trame en tte du FIFO RX sans la retirer.
+ *
+ * @param[in] size Taille de la trame, CRC compris.
+ * @return 1 si le CRC est correct, 0 sinon.
+ *
+ * @pre size octets sont disponibles dans le FIFO RX.
+ */
+static uint8_t RS232_PeekFrameValid(uint8_t size)
+{
+    uint16_t Crc = 0xFFFF;
+    U_manip16 receivedCRC;
+    int8_t c;
+    uint8_t i;
+
+    for (i = 0; i < (size - CMD_CRC_SIZE); i++) {
+        PeekCharFromFifo(&descrFifoRX, i, &c);
+        Crc = updateCRC16(Crc, (uint8_t)c);
+    }
+    PeekCharFromFifo(&descrFifoRX, size - 2, &c);
+    receivedCRC.shl.msb = (uint8_t)c;
+    PeekCharFromFifo(&descrFifoRX, size - 1, &c);
+    receivedCRC.shl.lsb = (uint8_t)c;
+    return (Crc == receivedCRC.val);
+}
+
+/**
+ * @brief Rejette le code de dbut d'une trame dont le CRC est invalide.
+ *
+ * Seul le premier octet est retir : si le code de dbut tait une fausse
+ * dtection (octet de donnes ou trame tronque), une trame valide commenant
+ * dans les octets suivants est retrouve au passage suivant.
+ */
+static void RS232_RejectFrame(void)
+{
+    // CRC invalide => Indicateur d'erreur (clignotement de la LED6)
+    linkStats.FramesBadCrc++;
+    BSP_LEDToggle(BSP_LED_6);
+    RS232_DiscardByte();
+}
+
+/**
+ * @brief Retire une trame de commande complte du FIFO RX et l'excute si le CRC est valide.
+ *
+ * @param[in] len Longueur des donnes annonce dans l'en-tte (<= CMD_PAYLOAD_MAX).
+ *
+ * @pre La trame complte (CMD_MESS_SIZE(len) octets) est disponible dans le FIFO RX.
+ */
+static void RS232_ReadCommand(uint8_t len)
+{
+    uint8_t i;
+
+    if (!RS232_PeekFrameValid(CMD_MESS_SIZE(len))) {
+        RS232_RejectFrame();
+        return;
+    }
+
+    rxFrameStamp = RS232_RxHeadStamp();
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.Start);
+#if RS232_MULTIDROP
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.Addr);
+#endif
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.Cmd);
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.Len);
+    for (i = 0; i < len; i++) {
+        GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.Data[i]);
+    }
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.MsbCrc);
+    GetCharFromFifo(&descrFifoRX, (int8_t*)&RxCmdMess.LsbCrc);
+
+    RS232_FrameOk(rxFrameStamp);
+    RS232_ExecCommand(&RxCmdMess);
+}
+
+/**
+ * @brief Borne une consigne reue  la plage de S_pwmSettings.
+ *
+ * @param[in] value Valeur reue.
+ * @param[in] limit Borne symtrique (-limit..+limit).
+ * @return Valeur borne.
+ */
+static int8_t RS232_ClampSetting(int8_t value, int8_t limit)
+{
+    if (value > limit) {
+        return limit;
+    }
+    if (value < -limit) {
+        return -limit;
+    }
+    return value;
 }
 
 
@@ -66,6 +789,13 @@ void InitFifoComm(void)
  * Si le message est valide (CRC correct), les paramtres PWM sont mis  jour
  * et le mode de communication passe en "remote". Sinon, le mode reste en "local".
  *
+ * Tous les messages complets prsents dans le FIFO sont consomms (le dernier
+ * valide l'emporte) et RTS est relch ds que la place libre franchit le
+ * seuil bas, sans attendre le cycle de service suivant.
+ *
+ * Les trames de commande (STX_CMD_code) sont excutes au passage ; leur
+ * rponse est dpose dans le FIFO TX.
+ *
  * param[in,out] pData Pointeur vers la structure S_pwmSettings,
  *                      contenant les valeurs de vitesse et d'angle.
  *
@@ -76,69 +806,125 @@ void InitFifoComm(void)
 int GetMessage(S_pwmSettings* pData) {
     static uint8_t iter = 0; // Compteur d'itrations sans rception de message
     static uint8_t commStatus = 0; // tat de communication : 0 = local, 1 = remote
-    uint8_t NbCharToRead = GetReadSize(&descrFifoRX); // Nombre d'octets disponibles dans le buffer RX
+    int32_t NbCharToRead = GetReadSize(&descrFifoRX); // Nombre d'octets disponibles dans le buffer RX
     int8_t RxChar; // Octet reu via la communication srie
-    uint16_t Crc = 0xFFFF; // Valeur initiale du CRC
-    U_manip16 receivedCRC; // Union pour assembler le CRC reu (MSB + LSB)
+    int8_t CmdLen; // Longueur annonce d'une trame de commande
+    uint8_t setpointReceived = 0; // 1 = au moins une consigne valide dans cet appel
+
+    // Consignes inchanges tant qu'aucune trame ne les modifie
+    // (en mode local, GPWM_GetSettings repositionne l'indicateur)
+    pData->Changed = 0;
 
-    // Vrifie si suffisamment d'octets sont disponibles pour un message complet
-    if (NbCharToRead >= MESS_SIZE)
+    // Traite toutes les trames compltes disponibles
+    while (NbCharToRead > 0)
     {
-        // Lecture du premier octet et vrification du code de dbut (STX_code)
-        GetCharFromFifo(&descrFifoRX, &RxChar);
-        if (RxChar == STX_code) {
-            // Extraction des valeurs du message reu
-            RxMess.Start = RxChar;
-            GetCharFromFifo(&descrFifoRX, &RxMess.Speed); // Vitesse
-            GetCharFromFifo(&descrFifoRX, &RxMess.Angle); // Angle
-            GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.MsbCrc); // Octet de poids fort du CRC
-            GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.LsbCrc); // Octet de poids faible du CRC
-
-            // Calcul du CRC sur les donnes reues (hors CRC)
-            Crc = updateCRC16(Crc, RxMess.Start);
-            Crc = updateCRC16(Crc, RxMess.Speed);
-            Crc = updateCRC16(Crc, RxMess.Angle);
-
-            // Reconstruction du CRC reu (conversion des 2 octets en une valeur 16 bits)
-            receivedCRC.shl.msb = RxMess.MsbCrc;
-            receivedCRC.shl.lsb = RxMess.LsbCrc;
-
-            // Vrification du CRC : comparaison entre le CRC calcul et celui reu
-            if (Crc == receivedCRC.val)
+        // Examen du code de dbut sans le retirer du FIFO
+        PeekCharFromFifo(&descrFifoRX, 0, &RxChar);
+
+        if (RxChar == STX_code)
+        {
+            // Message de consigne incomplet => attente de la suite
+            if (NbCharToRead < MESS_SIZE) {
+                break;
+            }
+
+            // Vrification du CRC avant retrait (fausse dtection => un seul octet perdu)
+            if (RS232_PeekFrameValid(MESS_SIZE))
             {
-                // CRC valide => mise  jour des paramtres PWM
+                RS232_FrameOk(RS232_RxHeadStamp());
+
+                // Extraction des valeurs du message reu
+                GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.Start);
+#if RS232_MULTIDROP
+                GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.Addr); // Adresse (dj filtre par l'ISR)
+#endif
+                GetCharFromFifo(&descrFifoRX, &RxMess.Speed); // Vitesse
+                GetCharFromFifo(&descrFifoRX, &RxMess.Angle); // Angle
+                GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.MsbCrc); // Octet de poids fort du CRC
+                GetCharFromFifo(&descrFifoRX, (int8_t*)&RxMess.LsbCrc); // Octet de poids faible du CRC
+
+                // CRC valide => mise  jour des paramtres PWM, borns  la plage de S_pwmSettings
+                RxMess.Speed = RS232_ClampSetting(RxMess.Speed, ADC1_VALUE_MAX / 2);
+                RxMess.Angle = RS232_ClampSetting(RxMess.Angle, ADC2_ANGLE_OFFSET);
+                if ((pData->SpeedSetting != RxMess.Speed) || (pData->AngleSetting != RxMess.Angle) ||
+                    (pData->AngleFrac != 0)) {
+                    pData->Changed = 1;
+                }
                 pData->SpeedSetting = RxMess.Speed;
                 pData->absSpeed = abs(RxMess.Speed); // Valeur absolue de la vitesse
 
                 pData->AngleSetting = RxMess.Angle;
-                pData->absAngle = abs(RxMess.Angle-90); // Valeur absolue de l'angle
+                pData->absAngle = GPWM_RemoteAbsAngle(RxMess.Angle); // Valeur absolue de l'angle
+                pData->AngleFrac = 0;
+
+                // Horodatage pour la restitution retarde (sans effet si retard nul)
+                GPLAY_Push(pData);
 
-                // Rinitialisation du compteur d'absence de messages et passage en mode remote
-                iter = 0;
-                commStatus = 1;
+                setpointReceived = 1;
+#if RS232_MULTIDROP
+                // Interrogation individuelle => l'tat sera renvoy par SendMessage
+                if (RxMess.Addr != RS232_ADDR_BROADCAST) {
+                    pollPending = 1;
+                }
+#endif
             }
             else
             {
-                // CRC invalide => Indicateur d'erreur (clignotement de la LED6)
-                BSP_LEDToggle(BSP_LED_6);
+                RS232_RejectFrame();
             }
         }
+        else if (RxChar == STX_CMD_code)
+        {
+            // En-tte incomplet => attente de la suite
+            if (NbCharToRead < CMD_HEADER_SIZE) {
+                break;
+            }
+            PeekCharFromFifo(&descrFifoRX, CMD_LEN_OFFSET, &CmdLen);
+            if ((uint8_t)CmdLen > CMD_PAYLOAD_MAX)
+            {
+                // Longueur impossible => faux dpart, resynchronisation sur l'octet suivant
+                RS232_DiscardByte();
+            }
+            else if (NbCharToRead < CMD_MESS_SIZE((uint8_t)CmdLen))
+            {
+                // Trame de commande incomplte => attente de la suite
+                break;
+            }
+            else
+            {
+                RS232_ReadCommand((uint8_t)CmdLen);
+            }
+        }
+        else
+        {
+            // Octet hors trame => rejet (recherche du code de dbut)
+            RS232_DiscardByte();
+        }
+
+        // Place libre dans le FIFO RX => relche RTS si le seuil bas est franchi
+        RS232_RxFlowRelease();
+        NbCharToRead = GetReadSize(&descrFifoRX);
+    }
+
+    if (setpointReceived)
+    {
+        // Rinitialisation du compteur d'absence de messages et passage en mode remote
+        iter = 0;
+        commStatus = 1;
     }
     else
     {
-        // Pas assez d'octets dans le buffer => incrmentation du compteur d'absence de message
+        // Pas de consigne reue => incrmentation du compteur d'absence de message
         iter++;
-        if (iter >= COMM_TIMEOUT_ITERATION) {
+        if (iter >= GPARAM_Get(PARAM_ID_COMM_TIMEOUT)) {
             // Si aucune rception pendant un certain temps => retour au mode local
             commStatus = 0;
-            iter = COMM_TIMEOUT_ITERATION; // vite tout dpassement du compteur
+            iter = GPARAM_Get(PARAM_ID_COMM_TIMEOUT); // vite tout dpassement du compteur
         }
     }
 
-    // Gestion du contrle de flux : si l'espace disponible dans le FIFO RX est suffisant, on permet la transmission
-    if (GetWriteSpace(&descrFifoRX) >= RX_FIFO_START_THRESHOLD) {
-        RS232_RTS = 0; // Active la transmission depuis le priphrique distant
-    }
+    // Gestion du contrle de flux (aussi au dmarrage, lorsque RTS = 1 sans rception)
+    RS232_RxFlowRelease();
 
     return commStatus; // Retourne l'tat de la communication (local ou remote)
 }
@@ -162,40 +948,333 @@ int GetMessage(S_pwmSettings* pData) {
  *                  de vitesse et d'angle  envoyer.
  */
 void SendMessage(S_pwmSettings* pData) {
-    int8_t spaceLeft;
-    uint16_t Crc = 0xFFFF;
+    int32_t spaceLeft;
+    static uint8_t frame[MESS_SIZE];                 // Dernire trame construite
+    static uint8_t size = 0;                         // Sa taille (0 = aucune)
+    static int8_t lastSpeed = 0;                     // Consignes et adresse qu'elle contient
+    static int8_t lastAngle = 0;
+    static uint8_t lastAddr = 0;
+    uint8_t addr = (uint8_t)GPARAM_Get(PARAM_ID_NODE_ADDRESS);
+    uint8_t i;
+
+#if RS232_MULTIDROP
+    // Bus multipoint : l'tat n'est mis qu'en rponse  une interrogation
+    if (pollPending == 0) {
+        return;
+    }
+#endif
 
     // Vrification de l'espace disponible dans le FIFO TX avant d'envoyer un message
     spaceLeft = GetWriteSpace(&descrFifoTX);
     if (spaceLeft >= MESS_SIZE) {
-        // Calcul du CRC sur les donnes du message (Start, Speed, Angle)
-        Crc = updateCRC16(Crc, (int8_t)STX_code);
-        Crc = updateCRC16(Crc, pData->SpeedSetting);
-        Crc = updateCRC16(Crc, pData->AngleSetting);
+#if RS232_MULTIDROP
+        // Interrogation servie ; FIFO TX presque plein => nouvel essai au cycle suivant
+        pollPending = 0;
+#endif
+        // Construction du message (Start, [Addr], Speed, Angle, CRC) et mise en FIFO.
+        // Consignes inchanges => la trame prcdente est renvoye sans recalcul du CRC
+        // (l'envoi priodique est conserv : il maintient le partenaire en mode remote).
+        // Comparaison des valeurs et non de pData->Changed, qui ne couvre que le dernier
+        // cycle alors que l'envoi n'a lieu que toutes les SEND_DIVIDER itrations.
+        if ((size == 0) || (pData->SpeedSetting != lastSpeed) ||
+            (pData->AngleSetting != lastAngle) || (addr != lastAddr)) {
+            size = GFRAME_EncodeSetpoint(frame, addr, pData->SpeedSetting, pData->AngleSetting);
+            lastSpeed = pData->SpeedSetting;
+            lastAngle = pData->AngleSetting;
+            lastAddr = addr;
+        }
+        for (i = 0; i < size; i++) {
+            PutCharInFifo(&descrFifoTX, (int8_t)frame[i]);
+        }
+    }
 
-        // Extraction des octets de poids fort et faible du CRC 16 bits
-        TxMess.MsbCrc = (uint8_t)((Crc & 0xFF00) >> 8); // Octet de poids fort
-        TxMess.LsbCrc = (uint8_t)(Crc & 0x00FF);        // Octet de poids faible
+    // Vrification du signal CTS et activation de l'interruption TX si ncessaire
+    if (GetReadSize(&descrFifoTX) > 0) {
+        RS232_TxStart();
+    }
 
-        // Construction du message avec les donnes fournies
-        TxMess.Start = (uint8_t)STX_code;
-        TxMess.Speed = pData->SpeedSetting;
-        TxMess.Angle = pData->AngleSetting;
+#if !RS232_MULTIDROP
+    // Mesure ( la rsolution du cycle d'appel) du temps d'mission bloque par CTS
+    if ((RS232_CTS == 1) && (GetReadSize(&descrFifoTX) > 0)) {
+        if (ctsHold == 0) {
+            ctsHold = 1;
+            ctsHoldStamp = _CP0_GET_COUNT();
+            flowStats.CtsHoldCount++;
+        }
+    } else if (ctsHold == 1) {
+        ctsHold = 0;
+        flowStats.CtsThrottledTicks += _CP0_GET_COUNT() - ctsHoldStamp;
+    }
+#endif
+}
 
-        // Ajout du message dans le FIFO d'mission
-        PutCharInFifo(&descrFifoTX, (int8_t)TxMess.Start);
-        PutCharInFifo(&descrFifoTX, TxMess.Speed);
-        PutCharInFifo(&descrFifoTX, TxMess.Angle);
-        PutCharInFifo(&descrFifoTX, (int8_t)TxMess.MsbCrc);
-        PutCharInFifo(&descrFifoTX, (int8_t)TxMess.LsbCrc);
+/*           Construction et mise en FIFO trame de commande                   */
+/**
+ * @brief Construit une trame de commande et la dpose dans le FIFO TX.
+ *
+ * La trame n'est dpose que si elle tient entirement dans le FIFO TX, afin
+ * de ne jamais mettre de trame tronque.
+ *
+ * @param[in] cmd      Code de commande (ou de rponse).
+ * @param[in] pPayload Donnes de la trame.
+ * @param[in] len      Nombre d'octets de donnes.
+ * @return 0 si dpose, 1 sinon.
+ */
+uint8_t SendCommand(uint8_t cmd, const uint8_t *pPayload, uint8_t len)
+{
+    uint8_t frame[CMD_MESS_SIZE(CMD_PAYLOAD_MAX)];
+    uint8_t size;
+    uint8_t i;
+
+    if ((len > CMD_PAYLOAD_MAX) || (GetWriteSpace(&descrFifoTX) < CMD_MESS_SIZE(len))) {
+        return 1;
     }
 
-    // Vrification du signal CTS et activation de l'interruption TX si ncessaire
-    if ((RS232_CTS == 0) && (GetReadSize(&descrFifoTX) > 0)) {
-        PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT);
+    // Construction de la trame et ajout dans le FIFO d'mission
+    size = GFRAME_EncodeCommand(frame, (uint8_t)GPARAM_Get(PARAM_ID_NODE_ADDRESS),
+                                cmd, pPayload, len);
+    for (i = 0; i < size; i++) {
+        PutCharInFifo(&descrFifoTX, (int8_t)frame[i]);
+    }
+
+    // Autorise l'interruption d'mission si le distant est prt
+    RS232_TxStart();
+    return 0;
+}
+
+/*                 Lecture des compteurs de contrle de flux                  */
+/**
+ * @brief Copie les compteurs du contrle de flux.
+ *
+ * L'interruption RX est masque pendant la copie pour obtenir un jeu de
+ * compteurs cohrent.
+ *
+ * @param[out] pStats Structure recevant la copie des compteurs.
+ */
+void GetFlowStats(S_rs232FlowStats *pStats)
+{
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+    *pStats = flowStats;
+    // Inclut la priode de blocage en cours
+    if (RS232_RTS == 1) {
+        pStats->RtsThrottledTicks += _CP0_GET_COUNT() - rtsAssertStamp;
+    }
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+}
+
+/*                 Rponse au ping                                            */
+/**
+ * @brief Envoie la rponse au ping en attente avec les instants relevs.
+ *
+ * La rponse n'est mise qu'une fois GPWM_ExecPWM excut aprs le dcodage
+ * du ping, afin que tApply mesure bien la prise en compte des consignes.
+ */
+void SendPingReply(void)
+{
+    uint8_t response[18];
+    uint32_t applyStamp = GPWM_GetApplyStamp();
+
+    // Comparaison signe : robuste au dbordement du core timer
+    if ((pingPending == 0) || ((int32_t)(applyStamp - pingParseStamp) < 0)) {
+        return;
+    }
+
+    response[0] = PARAM_OK;
+    response[1] = pingSeq;
+    RS232_PutU32(&response[2],  pingRxStamp);
+    RS232_PutU32(&response[6],  pingParseStamp);
+    RS232_PutU32(&response[10], applyStamp);
+    RS232_PutU32(&response[14], _CP0_GET_COUNT());
+    // Nouvel essai au cycle suivant si le FIFO TX est plein
+    if (SendCommand(CMD_PING | CMD_RESPONSE_FLAG, response, sizeof(response)) == 0) {
+        pingPending = 0;
     }
 }
 
+/*                 Lecture des compteurs d'erreurs de la liaison              */
+/**
+ * @brief Copie les compteurs d'erreurs de la liaison.
+ *
+ * Les interruptions RX et erreur sont masques pendant la copie pour obtenir
+ * un jeu de compteurs cohrent.
+ *
+ * @param[out] pStats Structure recevant la copie des compteurs.
+ */
+void GetLinkStats(S_rs232LinkStats *pStats)
+{
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    *pStats = linkStats;
+    pStats->RtsAssertions = flowStats.RtsAssertCount;
+#if RS232_MULTIDROP
+    pStats->BytesDiscarded += mdNoiseBytes;
+#endif
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+}
+
+/*                 Remise  zro des compteurs                                */
+/**
+ * @brief Remet  zro les compteurs de liaison, de contrle de flux et de resynchronisation.
+ *
+ * Les priodes de blocage RTS/CTS en cours sont comptes  partir de la remise
+ *  zro ; une recherche de code de dbut en cours est abandonne.
+ */
+void ResetLinkStats(void)
+{
+    S_rs232LinkStats zeroLink = { 0 };
+    S_rs232FlowStats zeroFlow = { 0 };
+
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    linkStats = zeroLink;
+    flowStats = zeroFlow;
+#if RS232_MULTIDROP
+    mdNoiseBytes = 0;
+#endif
+    rtsAssertStamp = _CP0_GET_COUNT();
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+
+    ctsHoldStamp = _CP0_GET_COUNT();
+    rxHunting = 0;
+    realignTicksTotal = 0;
+    realignTicksMax = 0;
+}
+
+/*                 Dpt d'un octet reu (contexte ISR)                       */
+/**
+ * @brief Place un octet reu dans le FIFO RX logiciel et compte les pertes.
+ *
+ * @param[in] byte Octet reu.
+ */
+static void RS232_RxStore(int8_t byte)
+{
+    fifoRXStamp[descrFifoRX.pWrite - descrFifoRX.pDebFifo] = rxIsrStamp;
+    if (PutCharInFifo(&descrFifoRX, byte) != 0) {
+        linkStats.RxFifoFullDrops++; // FIFO plein : octet perdu
+    }
+}
+
+#if RS232_MULTIDROP
+/*                 Filtre d'adresse (contexte ISR)                            */
+/**
+ * @brief Transmet ou carte un octet de la trame en cours selon son adresse.
+ *
+ * @param[in] byte Octet reu.
+ */
+static void RS232_RxFilterPass(int8_t byte)
+{
+    if (mdAccept) {
+        RS232_RxStore(byte);
+    } else {
+        linkStats.AddrFiltered++;
+    }
+}
+
+/**
+ * @brief Ne transmet au FIFO RX que les trames adresses  ce noeud.
+ *
+ * Le code de dbut est retenu jusqu' l'octet d'adresse. La longueur de la
+ * trame (fixe pour une consigne, Len pour une commande) est suivie afin
+ * d'carter entirement une trame trangre, mme si ses donnes contiennent
+ * un code de dbut. Une longueur invalide ramne  la recherche du code de dbut.
+ *
+ * @param[in] byte Octet reu.
+ */
+static void RS232_RxFilterByte(int8_t byte)
+{
+    uint8_t nodeAddr;
+
+    switch (mdState)
+    {
+        case MD_HUNT:
+            if ((byte == STX_code) || (byte == STX_CMD_code)) {
+                mdStart = byte;
+                mdState = MD_ADDR;
+            } else {
+                mdNoiseBytes++; // Bruit hors trame, pas une trame trangre
+            }
+            break;
+
+        case MD_ADDR:
+            nodeAddr = (uint8_t)GPARAM_Get(PARAM_ID_NODE_ADDRESS);
+            mdAccept = (((uint8_t)byte == nodeAddr) || ((uint8_t)byte == RS232_ADDR_BROADCAST));
+            if (mdAccept) {
+                RS232_RxStore(mdStart);
+                RS232_RxStore(byte);
+            } else {
+                linkStats.AddrFiltered += 2;
+            }
+            if (mdStart == STX_code) {
+                mdRemain = MESS_SIZE - 2;
+                mdState = MD_BODY;
+            } else {
+                mdState = MD_CMD;
+            }
+            break;
+
+        case MD_CMD:
+            RS232_RxFilterPass(byte);
+            mdState = MD_LEN;
+            break;
+
+        case MD_LEN:
+            RS232_RxFilterPass(byte);
+            if ((uint8_t)byte > CMD_PAYLOAD_MAX) {
+                mdState = MD_HUNT; // Longueur impossible => resynchronisation
+            } else {
+                mdRemain = (uint8_t)byte + CMD_CRC_SIZE;
+                mdState = MD_BODY;
+            }
+            break;
+
+        case MD_BODY:
+        default:
+            RS232_RxFilterPass(byte);
+            mdRemain--;
+            if (mdRemain == 0) {
+                mdState = MD_HUNT;
+            }
+            break;
+    }
+}
+#endif
+
+/*                 Interface octet (ISR ou mulation)                         */
+/**
+ * @brief Traite un octet reu sur la ligne.
+ *
+ * Filtre d'adresse (mode multipoint), horodatage et dpt dans le FIFO RX.
+ * Appele par l'ISR pour chaque octet du FIFO matriel ; rxIsrStamp doit
+ * tre mis  jour par l'appelant.
+ *
+ * @param[in] byte Octet reu.
+ */
+void RS232_RxByte(int8_t byte)
+{
+#if RS232_MULTIDROP
+    RS232_RxFilterByte(byte); // Trames des autres noeuds cartes ici
+#else
+    RS232_RxStore(byte);
+#endif
+}
+
+/**
+ * @brief Retire du FIFO TX le prochain octet  mettre.
+ *
+ * @param[out] pByte Octet  mettre.
+ * @return 1 si un octet est fourni, 0 si FIFO TX vide ou CTS inactif.
+ */
+uint8_t RS232_TxByte(int8_t *pByte)
+{
+    if (!RS232_TX_READY() || (GetReadSize(&descrFifoTX) == 0)) {
+        return 0;
+    }
+    GetCharFromFifo(&descrFifoTX, pByte);
+    return 1;
+}
+
 /*          interruption UART                                                 */
 /**
  * @brief Gre les interruptions de l'UART1 (erreurs, rception et mission).
@@ -205,6 +1284,7 @@ void SendMessage(S_pwmSettings* pData) {
  */
 void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
     int8_t receivedByte; // Variable pour stocker temporairement un octet reu.
+    USART_ERROR errors;  // Drapeaux d'erreur de l'UART1
 
     // Indicateur de dbut d'interruption : teindre LED3 pour signaler l'entre dans l'interruption
     LED3_W = 1;
@@ -216,9 +1296,19 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
         // Efface le flag d'erreur pour indiquer qu'il a t trait
         PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_1_ERROR);
         
+        // Comptage des erreurs de trame et de parit (tat de l'octet en tte du FIFO matriel)
+        errors = PLIB_USART_ErrorsGet(USART_ID_1);
+        if (errors & USART_ERROR_FRAMING) {
+            linkStats.FramingErrors++;
+        }
+        if (errors & USART_ERROR_PARITY) {
+            linkStats.ParityErrors++;
+        }
+
         // Vrifie s'il y a une erreur d'overflow (dpassement de buffer RX)
-        if (PLIB_USART_ErrorsGet(USART_ID_1) & USART_ERROR_RECEIVER_OVERRUN) {
+        if (errors & USART_ERROR_RECEIVER_OVERRUN) {
             
+            linkStats.OverrunErrors++;
             // Efface l'erreur d'overflow pour permettre la rception de nouveaux octets
             PLIB_USART_ReceiverOverrunErrorClear(USART_ID_1);    
         }
@@ -227,6 +1317,7 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
         while (PLIB_USART_ReceiverDataIsAvailable(USART_ID_1)) {
              // Lire et ignorer les donnes dans le buffer pour le vider
             (void)PLIB_USART_ReceiverByteReceive(USART_ID_1);
+            linkStats.ErrorBytesDropped++;
             
         }
     }
@@ -235,6 +1326,8 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
     // Vrifie si un drapeau d'interruption de rception est lev
     if (PLIB_INT_SourceFlagGet(INT_ID_0, INT_SOURCE_USART_1_RECEIVE)) {
         
+        rxIsrStamp = _CP0_GET_COUNT(); // Horodatage des octets reus dans cette interruption
+        
         // Tant qu'il y a des donnes  lire dans le buffer RX de l'UART1
         while (PLIB_USART_ReceiverDataIsAvailable(USART_ID_1)) {
             
@@ -242,19 +1335,23 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
             receivedByte = (int8_t)PLIB_USART_ReceiverByteReceive(USART_ID_1);
             
             // Placer l'octet reu dans le FIFO RX logiciel
-            PutCharInFifo(&descrFifoRX, receivedByte);
+            RS232_RxByte(receivedByte);
             
         }
         // Inverse l'tat de LED4 pour indiquer qu'une rception de donnes a eu lieu
         LED4_W = !LED4_R;
         
+#if !RS232_MULTIDROP
         // Vrifie si l'espace disponible dans le FIFO RX est infrieur au seuil critique
-        if (GetWriteSpace(&descrFifoRX) <= RX_FIFO_STOP_THRESHOLD) {
+        if ((RS232_RTS == 0) && (GetWriteSpace(&descrFifoRX) <= RX_FIFO_STOP_THRESHOLD)) {
             
             // Active RTS (Request To Send) pour signaler  l'metteur distant d'arrter l'envoi
             RS232_RTS = 1;
+            rtsAssertStamp = _CP0_GET_COUNT();
+            flowStats.RtsAssertCount++;
             
         }
+#endif
         // Efface le flag d'interruption de rception pour indiquer qu'il a t trait
         PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
         
@@ -264,14 +1361,11 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
     // Vrifie si un drapeau d'interruption de transmission est lev
     if (PLIB_INT_SourceFlagGet(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT)) {
         
-        // Tant que CTS (Clear To Send) est bas, qu'il y a des donnes  envoyer
-        // dans le FIFO TX et que le buffer matriel TX de l'UART1 n'est pas plein
-        while ((RS232_CTS == 0) && GetReadSize(&descrFifoTX) > 0 &&
-            !PLIB_USART_TransmitterBufferIsFull(USART_ID_1)) {
+        // Tant que le buffer matriel TX de l'UART1 n'est pas plein, que CTS
+        // (Clear To Send) est bas et qu'il y a des donnes dans le FIFO TX
+        while (!PLIB_USART_TransmitterBufferIsFull(USART_ID_1) &&
+               RS232_TxByte(&receivedByte)) {
 
-            // Rcupre un octet du FIFO TX logiciel
-            GetCharFromFifo(&descrFifoTX, &receivedByte);
-            
             // Envoie l'octet via l'UART1
             PLIB_USART_TransmitterByteSend(USART_ID_1, (uint8_t)receivedByte);
             
@@ -282,8 +1376,20 @@ void __ISR(_UART_1_VECTOR, ipl5AUTO) UART1_InterruptHandler(void) {
         // Vrifie s'il n'y a plus de donnes  envoyer dans le FIFO TX
         if (GetReadSize(&descrFifoTX) == 0) {
             
+#if RS232_MULTIDROP
+            if (PLIB_USART_TransmitterIsEmpty(USART_ID_1)) {
+                // Dernier bit sorti => libre le bus et revient au mode d'interruption normal
+                RS485_DE = 0;
+                PLIB_USART_TransmitterInterruptModeSelect(USART_ID_1, USART_TRANSMIT_FIFO_EMPTY);
+                PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT);
+            } else {
+                // Attente de la fin du registre  dcalage avant de relcher DE
+                PLIB_USART_TransmitterInterruptModeSelect(USART_ID_1, USART_TRANSMIT_FIFO_IDLE);
+            }
+#else
             // Dsactive l'interruption de transmission pour conomiser les ressources
             PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT);
+#endif
             
         }
         // Efface le flag d'interruption de transmission pour indiquer qu'il a t trait
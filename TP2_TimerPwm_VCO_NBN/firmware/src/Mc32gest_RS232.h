@@ -13,39 +13,57 @@
 
 #include <stdint.h>
 #include "GesFifoTh32.h"
+#include "gestFrame.h"
 #include "gestPWM.h"
 
-//--------------------------  Constantes et macros  --------------------------//
+#if RS232_MULTIDROP
+#define RS485_DE              RS232_RTS // Validation de l'metteur RS485 (1 = prise du bus).
+#endif
 
-#define MESS_SIZE    5       // Taille d'un message complet en octets.
-#define STX_code    (-86)    // Code de synchronisation (STX), -86 correspond  0xAA en hexadcimal.
+//--------------------------  Tailles des FIFOs  -----------------------------//
+// RX : 4 messages de consigne + 2 trames de commande maximales + 1 octet de scurit.
+// GetMessage ne vide le FIFO qu'une fois par cycle de Timer 1 : avec une seule
+// trame maximale, RTS bloquait l'metteur aprs une trame CMD_BOOT_DATA par cycle.
+#define FIFO_RX_SIZE ((4 * MESS_SIZE) + (2 * CMD_MESS_SIZE(CMD_PAYLOAD_MAX)) + 1)
+// TX : 4 messages de consigne + 2 rponses maximales + 1 octet de scurit.
+#define FIFO_TX_SIZE ((4 * MESS_SIZE) + (2 * CMD_MESS_SIZE(CMD_PAYLOAD_MAX)) + 1)
 
-#define FIFO_RX_SIZE ((4 * MESS_SIZE) + 1)   // Taille du buffer FIFO RX (capacit de 4 messages + 1 octet de scurit).
-#define FIFO_TX_SIZE ((4 * MESS_SIZE) + 1)   // Taille du buffer FIFO TX (capacit de 4 messages + 1 octet de scurit).
+// Tailles et places libres des FIFOs : int32_t (GesFifoTh32) uniquement, elles
+// dpassent 127 (FIFO_TX_SIZE = 133 en mode multipoint). Seules les longueurs
+// de trame sont manipules sur 8 bits.
+#if (CMD_MESS_SIZE(CMD_PAYLOAD_MAX) > 255)
+#error "Longueur de trame sur 8 bits : CMD_PAYLOAD_MAX trop grand"
+#endif
 
 #define COMM_TIMEOUT_ITERATION    10       // Nombre de d'iteration avant expiration du timeout de communication.
 
-#define RX_FIFO_START_THRESHOLD   (2 * MESS_SIZE)  // Seuil de remplissage du FIFO RX pour dbuter le traitement des messages.
-#define RX_FIFO_STOP_THRESHOLD    6               // Seuil de remplissage du FIFO RX pour stopper temporairement la rception.
+//--------------------------  Contrle de flux RTS/CTS  ----------------------//
 
-//--------------------------  Structures de donnes  --------------------------//
-/**
- * @brief Structure reprsentant le format d'un message transmis via RS232.
- *
- * - Start  : Octet de synchronisation (STX_code).
- * - Speed  : Valeur de consigne de vitesse.
- * - Angle  : Valeur de consigne d'angle.
- * - MsbCrc : Octet de poids fort du code de contrle CRC.
- * - LsbCrc : Octet de poids faible du code de contrle CRC.
- */
-typedef struct {
-    uint8_t Start;  // Code de dpart pour synchroniser la rception.
-    int8_t  Speed;  // Valeur de consigne de la vitesse.
-    int8_t  Angle;  // Valeur de consigne de l'angle.
-    uint8_t MsbCrc; // Octet de poids fort du CRC pour vrifier l'intgrit des donnes.
-    uint8_t LsbCrc; // Octet de poids faible du CRC.
-} StruMess;
+#define RS232_BAUDRATE        57600   // Vitesse de la liaison (doit correspondre  DRV_USART0_Initialize).
+#define RS232_BYTES_PER_SEC   (RS232_BAUDRATE / 10) // Format 8N1 : 10 bits par octet.
+#define RS232_UART_HW_FIFO    4       // Profondeur du FIFO matriel RX de l'UART1 (PIC32MX).
+#define RS232_RTS_LATENCY_US  500     // Temps de raction max. de l'metteur distant  RTS [us].
+
+// Nombre d'octets pouvant encore arriver aprs l'activation de RTS :
+// octets mis pendant le temps de raction + contenu du FIFO matriel.
+#define RS232_RTS_INFLIGHT    ((((RS232_BYTES_PER_SEC * RS232_RTS_LATENCY_US) + 999999) / 1000000) \
+                               + RS232_UART_HW_FIFO)
 
+// Seuil haut (ISR) : RTS est activ lorsque la place libre ne couvre plus que les octets en vol.
+#define RX_FIFO_STOP_THRESHOLD    RS232_RTS_INFLIGHT
+// Seuil bas (consommateur) : RTS est relch lorsque la place libre dpasse ce seuil.
+// L'hystrse vaut la moiti de la place restante au-dessus du seuil haut.
+#define RX_FIFO_START_THRESHOLD   (RX_FIFO_STOP_THRESHOLD + \
+                                   (((FIFO_RX_SIZE - 1) - RX_FIFO_STOP_THRESHOLD) / 2))
+
+#if (RX_FIFO_START_THRESHOLD <= RX_FIFO_STOP_THRESHOLD)
+#error "FIFO_RX_SIZE trop petit pour le controle de flux a la vitesse RS232_BAUDRATE"
+#endif
+
+// Base de temps pour les compteurs : core timer = SYS_CLK / 2
+#define RS232_CORE_TICKS_PER_US   (SYS_CLK_FREQ / 2 / 1000000)
+
+//--------------------------  Structures de donnes  --------------------------//
 /**
  * @brief Union permettant d'accder  une valeur 16 bits (uint16_t)
  *        soit globalement, soit sparment via ses octets de poids faible et fort.
@@ -58,6 +76,39 @@ typedef union {
     } shl;
 } U_manip16;
 
+/**
+ * @brief Compteurs du contrle de flux (cot du throttling sur le dbit).
+ *
+ * Les dures sont exprimes en ticks du core timer (RS232_CORE_TICKS_PER_US par us).
+ */
+typedef struct {
+    uint32_t RtsAssertCount;    // Nombre d'activations de RTS (rception bloque).
+    uint32_t RtsThrottledTicks; // Dure cumule pendant laquelle RTS tait actif.
+    uint32_t RtsMaxTicks;       // Plus longue priode continue avec RTS actif.
+    uint32_t CtsHoldCount;      // Nombre de fois o l'mission a t bloque par CTS.
+    uint32_t CtsThrottledTicks; // Dure cumule (approx.) d'mission bloque par CTS.
+} S_rs232FlowStats;
+
+/**
+ * @brief Compteurs d'erreurs et de qualit de la liaison.
+ *
+ * Permet de distinguer une perte de dbit due au bruit (CRC, trame, parit),
+ * au contrle de flux (RTS) ou au parseur (octets rejets, resynchronisations).
+ */
+typedef struct {
+    uint32_t FramesOk;          // Trames (consigne ou commande) avec CRC valide.
+    uint32_t FramesBadCrc;      // Trames rejetes pour CRC invalide.
+    uint32_t BytesDiscarded;    // Octets rejets lors de la recherche du code de dbut (en multipoint, y compris par le filtre d'adresse).
+    uint32_t Resyncs;           // Pertes de synchronisation (dbut d'une recherche de STX).
+    uint32_t OverrunErrors;     // Dbordements du FIFO matriel RX de l'UART.
+    uint32_t FramingErrors;     // Erreurs de trame (bit de stop invalide).
+    uint32_t ParityErrors;      // Erreurs de parit.
+    uint32_t ErrorBytesDropped; // Octets vids du FIFO matriel suite  une erreur.
+    uint32_t RxFifoFullDrops;   // Octets perdus, FIFO RX logiciel plein.
+    uint32_t RtsAssertions;     // Nombre d'activations de RTS (copie de S_rs232FlowStats).
+    uint32_t AddrFiltered;      // Octets des trames adresses aux autres noeuds (mode multipoint).
+} S_rs232LinkStats;
+
 //--------------------------  Prototypes des fonctions  --------------------------//
 /**
  * @brief Initialise les files FIFO pour la communication RS232.
@@ -79,6 +130,60 @@ int GetMessage(S_pwmSettings *pData);
  */
 void SendMessage(S_pwmSettings *pData);
 
+/**
+ * @brief Construit une trame de commande et la dpose dans le FIFO TX.
+ *
+ * @param[in] cmd      Code de commande (avec CMD_RESPONSE_FLAG pour une rponse).
+ * @param[in] pPayload Donnes  transmettre (peut tre NULL si len = 0).
+ * @param[in] len      Nombre d'octets de donnes (<= CMD_PAYLOAD_MAX).
+ * @return 0 si la trame a t dpose, 1 si FIFO TX plein ou longueur invalide.
+ */
+uint8_t SendCommand(uint8_t cmd, const uint8_t *pPayload, uint8_t len);
+
+/**
+ * @brief Copie les compteurs du contrle de flux.
+ *
+ * @param[out] pStats Structure recevant une copie cohrente des compteurs.
+ */
+void GetFlowStats(S_rs232FlowStats *pStats);
+
+/**
+ * @brief Copie les compteurs d'erreurs de la liaison.
+ *
+ * @param[out] pStats Structure recevant une copie cohrente des compteurs.
+ */
+void GetLinkStats(S_rs232LinkStats *pStats);
+
+/**
+ * @brief Remet  zro tous les compteurs de la liaison (dbut d'une mesure).
+ */
+void ResetLinkStats(void);
+
+/**
+ * @brief Envoie la rponse au ping en attente si les consignes ont t appliques depuis.
+ *
+ * A appeler aprs GPWM_ExecPWM.
+ */
+void SendPingReply(void);
+
+/**
+ * @brief Traite un octet reu (filtre d'adresse, horodatage, FIFO RX).
+ *
+ * Point d'entre de l'ISR UART1 ; permet aussi d'alimenter la pile de
+ * protocole sans UART (mulation, rejeu d'une capture).
+ *
+ * @param[in] byte Octet reu.
+ */
+void RS232_RxByte(int8_t byte);
+
+/**
+ * @brief Fournit le prochain octet  mettre (FIFO TX, CTS respect).
+ *
+ * @param[out] pByte Octet  mettre.
+ * @return 1 si un octet est fourni, 0 sinon.
+ */
+uint8_t RS232_TxByte(int8_t *pByte);
+
 //--------------------------  Descripteurs externes  --------------------------//
 extern S_fifo descrFifoRX; // Descripteur du buffer FIFO de rception.
 extern S_fifo descrFifoTX; // Descripteur du buffer FIFO de transmission.
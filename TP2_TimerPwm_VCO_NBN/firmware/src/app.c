@@ -64,10 +64,16 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 // --------------- Inclusions supplmentaires ---------------
 // (cran LCD, ADC, etc.)
 #include "Mc32DriverLcd.h"       // Pilote pour cran LCD
-#include "Mc32DriverAdc.h"       // Pilote pour ADC
 #include "peripheral/ports/plib_ports.h" //Gestion des ports
 #include "gestPWM.h"            // gestion des pwm
 #include "Mc32gest_RS232.h"
+#include "gestParam.h"          // paramtres rglables  l'excution
+#include "gestTraj.h"           // trajectoires joues par le Timer 4
+#include "gestPlayout.h"        // restitution retarde des consignes remote
+#include "gestTelem.h"          // tlmtrie compresse
+#include "gestBoot.h"           // tlchargement firmware
+#include "gestAdc.h"            // acquisition ADC sous interruption
+#include "gestCal.h"            // calibration des potentiomtres
 // *****************************************************************************
 // *****************************************************************************
 // Section: Global Data Definitions
@@ -122,11 +128,41 @@ void App_Timer1Callback()
         // Aprs les 3 premires secondes, excute les tches de service
         APP_UpdateState(APP_STATE_SERVICE_TASKS);
         
-        // Clear le LCD
-        ClearLcd();
+        // Clear le LCD une seule fois : GPWM_DispSettings ne rcrit
+        // l'cran que lorsque les consignes ou le mode changent
+        if (threeSecondCounter == 149)
+        {
+            ClearLcd();
+            threeSecondCounter++;
+        }
     }
 }
 
+/**
+ * @brief Callback pour le Timer 2. Dclenchement de l'ADC synchronis sur la PWM.
+ *
+ * @details Appele  chaque priode du Timer 2 (40 kHz, interruption ipl6),
+ *          active uniquement en mode synchronis (PARAM_ID_ADC_SYNC) ; transmet
+ *          la priode  GADC_PwmPeriodCallback qui lance les balayages.
+ */
+void App_Timer2Callback()
+{
+    GADC_PwmPeriodCallback();
+}
+
+/**
+ * @brief Callback pour le Timer 4. Lecture  cadence fixe de la trajectoire.
+ *
+ * @details Appele  chaque interruption du Timer 4 (GTRAJ_TICK_HZ). Joue la
+ *          trajectoire en cours ou, en mode remote, restitue les consignes
+ *          retardes et interpoles.
+ */
+void App_Timer4Callback()
+{
+    GTRAJ_Tick();
+    GPLAY_Tick();
+}
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Application Local Functions
@@ -216,6 +252,9 @@ void APP_Initialize ( void )
 
 void APP_Tasks ( void )
 {
+    // Programmation flash des blocs firmware reus (tche de fond, sans effet hors session)
+    GBOOT_Tasks();
+
     /* Vrifie l'tat actuel de l'application. */
     switch ( appData.state )
     {
@@ -239,11 +278,20 @@ void APP_Tasks ( void )
                 lcd_gotoxy(1, 4); 
                 printf_lcd("Vitor Coelho"); // Nom du second auteur           
 
+                // Chargement des valeurs par dfaut des paramtres rglables
+                GPARAM_Initialize();
+
+                // Chargement de la calibration des potentiomtres (flash)
+                GCAL_Initialize();
+
                 // Initialisation des paramtres PWM
                 GPWM_Initialize(&pData); 
 
-                // Initialisation du module ADC
-                BSP_InitADC10(); 
+                // Initialisation du lecteur de trajectoire (Timer 4)
+                GTRAJ_Initialize();
+
+                // Initialisation du module ADC (acquisition continue sous interruption)
+                GADC_Initialize();
 
                 // Initialisation du module UART pour la communication srie
                 DRV_USART0_Initialize();
@@ -283,10 +331,22 @@ void APP_Tasks ( void )
             // Affichage des paramtres sur l'cran LCD
             GPWM_DispSettings(&pData, CommStatus);
 
+            // Restitution retarde des consignes remote (si un retard est configur)
+            GPLAY_Enable((CommStatus == 1) && !GTRAJ_IsRunning());
+
             // Excution du contrle PWM et du moteur en fonction des paramtres rcuprs
-            GPWM_ExecPWM(&pData);
+            // (sauf pendant une trajectoire ou une restitution retarde : la PWM est
+            // alors pilote par le Timer 4)
+            if (!GTRAJ_IsRunning() && !GPLAY_IsActive())
+            {
+                GPWM_ExecPWM(&pData);
+            }
+            SendPingReply(); // Rponse au ping ventuel, consignes appliques
+
+            // Tlmtrie (si active dans le registre de paramtres)
+            GTELEM_Sample(&pData);
 
-            if (inter == 5) // Envoie des donnes toutes les 5 itrations
+            if (inter >= GPARAM_Get(PARAM_ID_SEND_DIVIDER)) // Envoie des donnes toutes les SEND_DIVIDER itrations
             {
                 // Transmission des donnes via RS232
                 if (CommStatus == 0) 
@@ -51,7 +51,6 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 // Section: Included Files
 // *****************************************************************************
 // *****************************************************************************
-#include "Mc32DriverAdc.h"       // Pilote pour ADC
 
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus  // Provide C++ Compatibility
@@ -67,6 +66,7 @@ extern "C" {
 // *****************************************************************************
 
 #define TEMP_ITERATION 5
+#define SEND_DIVIDER 5   // Nb d'itrations entre deux envois RS232 (dfaut du registre de paramtres)
 
 // Masques pour les LEDs
 #define LEDS_PORTA_MASK  0b1000011111110011 // RA0-RA7 et RA15
@@ -89,7 +89,6 @@ typedef enum
 typedef struct
 {
     APP_STATES state;        //tat courant de l'application
-    S_ADCResults AdcRes;     // Rsultats ADC (structure personnalise)
 } APP_DATA;
 
 // *****************************************************************************
@@ -105,10 +104,19 @@ typedef struct
  */
 void App_Timer1Callback(void);
 
+/**
+ * @brief Fonction callback pour le Timer 2.
+ *
+ * Appele  chaque priode de la PWM (40 kHz) lorsque l'ADC est synchronis
+ * sur la PWM (PARAM_ID_ADC_SYNC) ; l'interruption est dsactive sinon.
+ */
+void App_Timer2Callback(void);
+
 /**
  * @brief Fonction callback pour le Timer 4.
  *
- * Appele lors de chaque interruption du Timer 4. Gre l'excution de la PWM logicielle.
+ * Appele lors de chaque interruption du Timer 4 (100 Hz). Joue les points de la
+ * trajectoire tlcharge par RS232.
  */
 void App_Timer4Callback(void);
 
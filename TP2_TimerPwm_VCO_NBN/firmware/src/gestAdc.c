@@ -0,0 +1,455 @@
+/*--------------------------------------------------------*/
+// GestAdc.c
+/*--------------------------------------------------------*/
+//	Description :	Acquisition ADC10 sous interruption
+//			        (balayage AN0/AN1  cadence fixe, buffer par canal)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <xc.h>
+#include <sys/attribs.h>
+#include <stdint.h>
+
+#include "system_config.h"
+#include "system_definitions.h"
+#include "gestAdc.h"
+
+#define GADC_RING_MASK      (GADC_RING_SIZE - 1)
+#define GADC_BUF_STRIDE     4        // ADC1BUFx espacs de 16 octets (4 mots)
+
+// Buffers circulaires : crits par l'ISR (head), lus par l'application (tail)
+static volatile uint16_t adcRing[GADC_NB_CHANNELS][GADC_RING_SIZE];
+static volatile uint8_t adcHead[GADC_NB_CHANNELS];
+static uint8_t adcTail[GADC_NB_CHANNELS];
+static volatile uint16_t adcLatest[GADC_NB_CHANNELS];  // Dernire conversion
+static volatile uint32_t adcSeq = 0;                   // Balayages termins
+static uint16_t adcMean[GADC_NB_CHANNELS];             // Dernire moyenne calcule
+// Surchantillonnage : accumulation sur plusieurs appels si 4^n dpasse un cycle
+static uint32_t adcOsSum[GADC_NB_CHANNELS];
+static uint16_t adcOsCount[GADC_NB_CHANNELS];
+static uint8_t adcOsBits[GADC_NB_CHANNELS];
+static uint16_t adcOsValue[GADC_NB_CHANNELS];
+static volatile uint32_t adcOverruns = 0;
+// Mdiane glissante applique en sortie de buffer (avant moyenne ou dcimation)
+static S_median adcMedian[GADC_NB_CHANNELS];
+static uint8_t adcMedianTaps = 0;
+// Dclenchement synchronis sur la PWM
+static volatile uint8_t adcMode = GADC_MODE_FREE;
+static uint8_t adcSyncDelay = GADC_SYNC_SAMC;     // SAMC en mode synchronis [TAD]
+static volatile uint8_t adcSyncCount = GADC_SYNC_DECIM;
+static volatile uint16_t adcSyncStamp = 0;        // Timer 2 au dclenchement
+static volatile uint8_t adcSyncPhase = 0;         // Phase du dernier balayage
+static GADC_SyncHandler adcSyncHandler = 0;
+// Capture de diagnostic : chantillons bruts d'un canal
+static uint16_t *adcCapPtr = 0;
+static volatile uint16_t adcCapLeft = 0;        // chantillons restant  copier
+static uint8_t adcCapChan = 0;
+
+/**
+ * @brief Programme les registres de l'ADC10 pour un mode de dclenchement.
+ *
+ * @param mode  GADC_MODE_FREE ou GADC_MODE_PWM_SYNC.
+ * @param delay Retard d'chantillonnage en mode synchronis [TAD].
+ *
+ * @details Mode libre : balayage de AN0 et AN1 (CSCNA), chantillonnage et
+ *          conversion automatiques (ASAM, SSRC = 7), rsultats en alternance
+ *          dans les deux moitis du buffer (BUFM) : l'ISR lit la moiti
+ *          complte pendant que l'ADC remplit l'autre.
+ *          Mode synchronis : ASAM est mis  1 par l'ISR du Timer 2 et remis
+ *           0 par le matriel (CLRASAM)  la fin du balayage ; un seul
+ *          balayage par interruption, dans le premier buffer.
+ */
+static void GADC_Configure(uint8_t mode, uint8_t delay)
+{
+    AD1CON1 = 0;                       // ADC arrt pendant la configuration
+    AD1PCFG &= ~GADC_SCAN_MASK;        // Broches balayes en mode analogique
+    AD1CHS = 0;                        // Entre ngative = VR-
+    AD1CSSL = GADC_SCAN_MASK;
+
+    AD1CON2 = 0;                       // VR+ = AVDD, VR- = AVSS
+    AD1CON2bits.CSCNA = 1;
+    AD1CON3 = 0;                       // Horloge drive de PBCLK
+    AD1CON1bits.FORM = 0;              // Entier 16 bits
+    AD1CON1bits.SSRC = 7;              // Fin d'acquisition par le compteur interne
+
+    if (mode == GADC_MODE_PWM_SYNC)
+    {
+        AD1CON2bits.SMPI = GADC_NB_CHANNELS - 1;
+        AD1CON3bits.SAMC = delay;
+        AD1CON3bits.ADCS = GADC_SYNC_ADCS;
+        AD1CON1bits.CLRASAM = 1;       // Arrt aprs un balayage
+        AD1CON1bits.ASAM = 0;          // Dpart par GADC_PwmPeriodCallback
+    }
+    else
+    {
+        AD1CON2bits.SMPI = (GADC_SCANS_PER_INT * GADC_NB_CHANNELS) - 1;
+        AD1CON2bits.BUFM = 1;
+        AD1CON3bits.SAMC = GADC_SAMC;
+        AD1CON3bits.ADCS = GADC_ADCS;
+        AD1CON1bits.ASAM = 1;          // Acquisition relance aprs chaque conversion
+    }
+}
+
+/**
+ * @brief Configure l'ADC10 et dmarre l'acquisition continue.
+ */
+void GADC_Initialize(void)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        adcHead[ch] = 0;
+        adcTail[ch] = 0;
+        adcLatest[ch] = 0;
+        adcMean[ch] = 0;
+        adcOsSum[ch] = 0;
+        adcOsCount[ch] = 0;
+        adcOsBits[ch] = 0;
+        adcOsValue[ch] = 0;
+        GFILT_MedianInit(&adcMedian[ch], 0, 0);
+    }
+
+    adcMode = GADC_MODE_FREE;
+    adcSyncDelay = GADC_SYNC_SAMC;
+    GADC_Configure(adcMode, adcSyncDelay);
+
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_AD1, INT_PRIORITY_LEVEL2);
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_AD1, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_ADC_1);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_ADC_1);
+
+    AD1CON1bits.ON = 1;
+}
+
+/**
+ * @brief Choisit le dclenchement des conversions.
+ *
+ * @param mode  GADC_MODE_FREE ou GADC_MODE_PWM_SYNC.
+ * @param delay Retard d'chantillonnage en mode synchronis, born 
+ *              GADC_SYNC_SAMC_MIN..GADC_SYNC_SAMC_MAX.
+ *
+ * @details Sans effet si rien ne change. Sinon l'ADC est arrt, reprogramm
+ *          et relanc ; l'interruption du Timer 2 n'est active qu'en mode
+ *          synchronis (ISR de quelques instructions  40 kHz).
+ */
+void GADC_SetTrigger(uint8_t mode, uint8_t delay)
+{
+    if (delay < GADC_SYNC_SAMC_MIN) {
+        delay = GADC_SYNC_SAMC_MIN;
+    } else if (delay > GADC_SYNC_SAMC_MAX) {
+        delay = GADC_SYNC_SAMC_MAX;
+    }
+    if (mode != GADC_MODE_PWM_SYNC) {
+        mode = GADC_MODE_FREE;
+    }
+    if ((mode == adcMode) && ((mode == GADC_MODE_FREE) || (delay == adcSyncDelay))) {
+        return;
+    }
+
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_TIMER_2);
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_ADC_1);
+    adcMode = mode;
+    adcSyncDelay = delay;
+    adcSyncCount = GADC_SYNC_DECIM;
+    GADC_Configure(mode, delay);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_ADC_1);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_ADC_1);
+    AD1CON1bits.ON = 1;
+
+    if (mode == GADC_MODE_PWM_SYNC) {
+        PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_T2, INT_PRIORITY_LEVEL6);
+        PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_2);
+        PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_TIMER_2);
+    }
+}
+
+/**
+ * @brief Enregistre le traitement appel  chaque balayage synchronis.
+ *
+ * @param handler Fonction appele sous interruption ADC (brve), 0 = aucune.
+ */
+void GADC_SetSyncHandler(GADC_SyncHandler handler)
+{
+    adcSyncHandler = handler;
+}
+
+/**
+ * @brief Retourne la phase PWM du dernier balayage synchronis.
+ */
+uint8_t GADC_GetSyncPhase(void)
+{
+    return adcSyncPhase;
+}
+
+/**
+ * @brief Interruption de priode du Timer 2 : lance un balayage toutes les
+ *        GADC_SYNC_DECIM priodes PWM.
+ *
+ * @details Appele par l'ISR du Timer 2 (system_interrupt.c), priorit 6 pour
+ *          une latence de dclenchement faible et constante. Le compteur du
+ *          Timer 2 relu ici date le dclenchement (latence comprise).
+ */
+void GADC_PwmPeriodCallback(void)
+{
+    if (--adcSyncCount == 0)
+    {
+        adcSyncCount = GADC_SYNC_DECIM;
+        adcSyncStamp = PLIB_TMR_Counter16BitGet(TMR_ID_2);
+        AD1CON1bits.ASAM = 1; // Dbut de l'acquisition, conversion aprs SAMC TAD
+    }
+}
+
+/**
+ * @brief Retire le plus ancien chantillon non lu d'un canal.
+ *
+ * @param chan    Canal.
+ * @param pSample chantillon lu.
+ * @return 1 si un chantillon a t lu, 0 sinon.
+ */
+uint8_t GADC_ReadSample(uint8_t chan, uint16_t *pSample)
+{
+    uint8_t tail = adcTail[chan];
+
+    if (tail == adcHead[chan]) {
+        return 0;
+    }
+    *pSample = adcRing[chan][tail];
+    adcTail[chan] = (tail + 1) & GADC_RING_MASK;
+    return 1;
+}
+
+/**
+ * @brief Choisit la mdiane glissante applique aux chantillons.
+ *
+ * @param taps 0 ou 1 = sans mdiane, 3 ou 5 points.
+ *
+ * @details Un changement redmarre les fentres sur le dernier chantillon.
+ */
+void GADC_SetMedian(uint8_t taps)
+{
+    uint8_t ch;
+
+    if (taps == adcMedianTaps) {
+        return;
+    }
+    adcMedianTaps = taps;
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        GFILT_MedianInit(&adcMedian[ch], taps, adcLatest[ch]);
+    }
+}
+
+/**
+ * @brief Retire un chantillon et lui applique la mdiane glissante.
+ *
+ * @param chan    Canal.
+ * @param pSample chantillon filtr.
+ * @return 1 si un chantillon a t lu, 0 si le buffer est vide.
+ */
+static uint8_t GADC_ReadFiltered(uint8_t chan, uint16_t *pSample)
+{
+    if (!GADC_ReadSample(chan, pSample)) {
+        return 0;
+    }
+    *pSample = GFILT_MedianProcess(&adcMedian[chan], *pSample);
+    return 1;
+}
+
+/**
+ * @brief Vide le buffer d'un canal et retourne la moyenne des chantillons lus.
+ *
+ * @param chan Canal.
+ * @return Moyenne des nouveaux chantillons, moyenne prcdente si aucun.
+ *
+ * @details Appele  chaque cycle de service (50 Hz), la moyenne porte sur
+ *          environ GADC_SCAN_HZ / 50 chantillons rgulirement espacs.
+ */
+uint16_t GADC_GetMean(uint8_t chan)
+{
+    uint32_t sum = 0;
+    uint16_t count = 0;
+    uint16_t sample;
+
+    while (GADC_ReadFiltered(chan, &sample)) {
+        sum += sample;
+        count++;
+    }
+    if (count > 0) {
+        adcMean[chan] = (uint16_t)(sum / count);
+    }
+    return adcMean[chan];
+}
+
+/**
+ * @brief Surchantillonnage et dcimation d'un canal.
+ *
+ * @param chan Canal.
+ * @param bits Bits supplmentaires, born  GADC_OVERSAMPLE_MAX.
+ * @return Rsultat sur 10 + bits bits.
+ *
+ * @details Vide le buffer du canal dans un accumulateur ; chaque bloc de
+ *          4^bits chantillons produit un rsultat (somme >> bits). Le bloc
+ *          en cours est conserv d'un appel  l'autre. Un changement de bits
+ *          redmarre l'accumulation, le dernier chantillon mis  l'chelle
+ *          servant de valeur d'attente.
+ */
+uint16_t GADC_GetOversampled(uint8_t chan, uint8_t bits)
+{
+    uint16_t blockSize;
+    uint16_t sample;
+
+    if (bits > GADC_OVERSAMPLE_MAX) {
+        bits = GADC_OVERSAMPLE_MAX;
+    }
+    if (bits != adcOsBits[chan]) {
+        adcOsBits[chan] = bits;
+        adcOsSum[chan] = 0;
+        adcOsCount[chan] = 0;
+        adcOsValue[chan] = adcLatest[chan] << bits;
+    }
+
+    blockSize = 1 << (2 * bits);
+    while (GADC_ReadFiltered(chan, &sample)) {
+        adcOsSum[chan] += sample;
+        adcOsCount[chan]++;
+        if (adcOsCount[chan] >= blockSize) {
+            adcOsValue[chan] = (uint16_t)(adcOsSum[chan] >> bits);
+            adcOsSum[chan] = 0;
+            adcOsCount[chan] = 0;
+        }
+    }
+    return adcOsValue[chan];
+}
+
+/**
+ * @brief Retourne le dernier chantillon converti d'un canal.
+ */
+uint16_t GADC_GetLatest(uint8_t chan)
+{
+    return adcLatest[chan];
+}
+
+/**
+ * @brief Copie le dernier balayage complet et son numro.
+ *
+ * @param pSnap chantillons et numro du balayage.
+ * @return Numro du balayage.
+ *
+ * @details L'interruption ADC est suspendue pendant la copie : les canaux
+ *          proviennent tous du mme balayage.
+ */
+uint32_t GADC_GetLatestSeq(S_adcSnapshot *pSnap)
+{
+    uint8_t ch;
+
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_ADC_1);
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        pSnap->Sample[ch] = adcLatest[ch];
+    }
+    pSnap->Seq = adcSeq;
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_ADC_1);
+    return pSnap->Seq;
+}
+
+/**
+ * @brief Retourne le nombre d'chantillons perdus (buffer plein).
+ */
+uint32_t GADC_GetOverrunCount(void)
+{
+    return adcOverruns;
+}
+
+/**
+ * @brief Dmarre la copie des prochains chantillons bruts d'un canal.
+ *
+ * @param chan  Canal.
+ * @param pBuf  Destination de count chantillons.
+ * @param count Nombre d'chantillons, 0 = arrt d'une capture en cours.
+ */
+void GADC_StartCapture(uint8_t chan, uint16_t *pBuf, uint16_t count)
+{
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_ADC_1);
+    adcCapChan = chan;
+    adcCapPtr = pBuf;
+    adcCapLeft = count;
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_ADC_1);
+}
+
+/**
+ * @brief Indique si la capture demande est complte.
+ *
+ * @return 1 si tous les chantillons ont t copis, 0 sinon.
+ */
+uint8_t GADC_IsCaptureDone(void)
+{
+    return (adcCapLeft == 0);
+}
+
+/**
+ * @brief Mmorise un chantillon dans le buffer de son canal.
+ *
+ * @details Un chantillon est perdu (et compt) si le buffer est plein.
+ *          Il est aussi copi vers la capture de diagnostic en cours.
+ */
+static void GADC_Store(uint8_t ch, uint16_t sample)
+{
+    uint8_t head = adcHead[ch];
+    uint8_t next = (head + 1) & GADC_RING_MASK;
+
+    if ((adcCapLeft != 0) && (ch == adcCapChan)) {
+        *adcCapPtr++ = sample;
+        adcCapLeft--;
+    }
+    adcLatest[ch] = sample;
+    if (next == adcTail[ch]) {
+        adcOverruns++;
+    } else {
+        adcRing[ch][head] = sample;
+        adcHead[ch] = next;
+    }
+}
+
+/**
+ * @brief Interruption de fin de balayage : copie les rsultats du buffer ADC.
+ *
+ * @details Mode libre : avec BUFM = 1, BUFS indique la moiti en cours de
+ *          remplissage ; l'autre contient GADC_SCANS_PER_INT balayages complets.
+ *          Mode synchronis : un balayage dans ADC1BUF0.., dat par la phase
+ *          PWM du premier chantillonnage et transmis au traitement enregistr.
+ */
+void __ISR(_ADC_VECTOR, ipl2AUTO) GADC_InterruptHandler(void)
+{
+    volatile uint32_t *pBuf;
+    uint16_t samples[GADC_NB_CHANNELS];
+    uint16_t phase;
+    uint8_t scan;
+    uint8_t ch;
+
+    if (adcMode == GADC_MODE_PWM_SYNC)
+    {
+        pBuf = &ADC1BUF0;
+        for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+            samples[ch] = (uint16_t)pBuf[ch * GADC_BUF_STRIDE];
+            GADC_Store(ch, samples[ch]);
+        }
+        phase = (adcSyncStamp + (adcSyncDelay * GADC_SYNC_TICKS_PER_TAD)) % GADC_PWM_PERIOD_TICKS;
+        adcSyncPhase = (uint8_t)phase;
+        adcSeq++;
+        if (adcSyncHandler != 0) {
+            adcSyncHandler(samples, adcSyncPhase);
+        }
+    }
+    else
+    {
+        pBuf = AD1CON2bits.BUFS ? &ADC1BUF0 : &ADC1BUF8;
+        for (scan = 0; scan < GADC_SCANS_PER_INT; scan++) {
+            for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+                GADC_Store(ch, (uint16_t)pBuf[((scan * GADC_NB_CHANNELS) + ch) * GADC_BUF_STRIDE]);
+            }
+        }
+        adcSeq += GADC_SCANS_PER_INT;
+    }
+
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_ADC_1);
+}
@@ -0,0 +1,176 @@
+#ifndef GestAdc_H
+#define GestAdc_H
+
+/*--------------------------------------------------------*/
+// GestAdc.h
+/*--------------------------------------------------------*/
+// Description : Acquisition ADC10  cadence fixe (balayage automatique,
+//               dclenchement par le compteur interne de l'ADC) et
+//               mmorisation sous interruption dans un buffer par canal
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "system_config.h"
+#include "gestFilter.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GADC_NB_CHANNELS    2        // Canaux balays
+#define GADC_CHAN_SPEED     0        // AN0 : potentiomtre de vitesse
+#define GADC_CHAN_ANGLE     1        // AN1 : potentiomtre d'angle
+#define GADC_SCAN_MASK      0x0003   // AD1CSSL : AN0 et AN1
+
+// Cadence : TAD = 2 * (ADCS + 1) * Tpb, une conversion = (SAMC + 12) * TAD.
+// Le Timer 3 (seul timer pouvant dclencher l'ADC) sert  la PWM servo et
+// tourne trop lentement : l'chantillonnage est cadenc par le compteur
+// interne de l'ADC (SSRC = 7), driv de PBCLK.
+#define GADC_ADCS           199      // TAD = 5 us  PBCLK 80 MHz
+#define GADC_SAMC           28       // Acquisition 28 TAD => 200 us par conversion
+#define GADC_SCAN_HZ        (SYS_CLK_BUS_PERIPHERAL_1 / (2 * (GADC_ADCS + 1)) \
+                             / (GADC_SAMC + 12) / GADC_NB_CHANNELS) // 2500 balayages/s
+
+#define GADC_SCANS_PER_INT  4        // Balayages par interruption (SMPI = 8 conversions)
+#define GADC_RING_SIZE      128      // chantillons mmoriss par canal (puissance de 2)
+
+// Surchantillonnage : 4^n chantillons somms puis dcals de n => 10 + n bits.
+// Le bruit de l'entre (>= 1 LSB) sert de dithering ;  2500 balayages/s,
+// n = 3 (64 chantillons) donne un nouveau rsultat toutes les 25.6 ms.
+#define GADC_OVERSAMPLE_MAX 3        // 13 bits
+
+// Mode synchronis sur la PWM (Timer 2 : PBCLK / 16 / 125 = 40 kHz, OC2) :
+// toutes les GADC_SYNC_DECIM priodes, l'ISR du Timer 2 (dbut de la priode,
+// front montant de OC2) lance un balayage ; le premier canal est chantillonn
+// SAMC * TAD plus tard,  une phase fixe de la PWM. Une entre de mesure de
+// courant doit tre le plus petit ANx balay pour tre convertie en premier.
+#define GADC_MODE_FREE      0        // Balayage continu  GADC_SCAN_HZ
+#define GADC_MODE_PWM_SYNC  1        // Balayage dclench par la priode PWM
+#define GADC_PWM_PERIOD_TICKS 125    // Priode du Timer 2 [ticks de 200 ns]
+#define GADC_SYNC_DECIM     16       // Priodes PWM par balayage : 2500 balayages/s
+#define GADC_SYNC_ADCS      15       // TAD = 400 ns = 2 priodes du Timer 2
+#define GADC_SYNC_TICKS_PER_TAD 2    // Ticks Timer 2 (200 ns) par TAD
+#define GADC_SYNC_SAMC_MIN  1        // Retard d'chantillonnage min. [TAD]
+#define GADC_SYNC_SAMC_MAX  31       // Retard max. (12.4 us, milieu de la priode PWM)
+#define GADC_SYNC_SAMC      4        // 1.6 us aprs le front : commutation du pont termine
+
+/**
+ * @brief Traitement immdiat d'un balayage synchronis (ex. limiteur de courant),
+ *        appel sous interruption ADC.
+ * @param pSamples Un chantillon par canal.
+ * @param phase    Phase PWM de l'chantillonnage du premier canal [ticks Timer 2].
+ */
+typedef void (*GADC_SyncHandler)(const uint16_t *pSamples, uint8_t phase);
+
+/**
+ * @brief Dernier balayage complet et son numro.
+ */
+typedef struct {
+    uint16_t Sample[GADC_NB_CHANNELS];  // Valeurs brutes (10 bits)
+    uint32_t Seq;                       // Nombre de balayages depuis l'initialisation
+} S_adcSnapshot;
+
+#if ((GADC_SCANS_PER_INT * GADC_NB_CHANNELS) > 8)
+#error "Une interruption ADC doit lire au plus une moitie du buffer (8 mots)"
+#endif
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Configure l'ADC10 (balayage automatique, deux buffers de 8 mots) et son interruption.
+ */
+void GADC_Initialize(void);
+
+/**
+ * @brief Choisit le dclenchement des conversions.
+ * @param mode  GADC_MODE_FREE ou GADC_MODE_PWM_SYNC.
+ * @param delay Mode synchronis : retard d'chantillonnage aprs le dbut de la priode [TAD].
+ */
+void GADC_SetTrigger(uint8_t mode, uint8_t delay);
+
+/**
+ * @brief Enregistre le traitement appel  chaque balayage synchronis (0 = aucun).
+ */
+void GADC_SetSyncHandler(GADC_SyncHandler handler);
+
+/**
+ * @brief Retourne la phase PWM du dernier balayage synchronis [ticks Timer 2, 0  124].
+ */
+uint8_t GADC_GetSyncPhase(void);
+
+/**
+ * @brief Interruption de priode du Timer 2 (PWM) : dclenchement synchronis.
+ */
+void GADC_PwmPeriodCallback(void);
+
+/**
+ * @brief Retire le plus ancien chantillon non lu d'un canal.
+ * @param chan    Canal (0  GADC_NB_CHANNELS - 1).
+ * @param pSample chantillon lu.
+ * @return 1 si un chantillon a t lu, 0 si le buffer est vide.
+ */
+uint8_t GADC_ReadSample(uint8_t chan, uint16_t *pSample);
+
+/**
+ * @brief Choisit la mdiane glissante applique aux chantillons avant moyenne.
+ * @param taps 0 ou 1 = sans mdiane, 3 ou 5 points.
+ */
+void GADC_SetMedian(uint8_t taps);
+
+/**
+ * @brief Retourne la moyenne des chantillons acquis depuis l'appel prcdent.
+ * @param chan Canal.
+ * @return Moyenne (10 bits) ; valeur prcdente si aucun nouvel chantillon.
+ */
+uint16_t GADC_GetMean(uint8_t chan);
+
+/**
+ * @brief Surchantillonnage et dcimation : retourne la somme des 4^bits
+ *        derniers chantillons dcale de bits (rsolution 10 + bits).
+ * @param chan Canal.
+ * @param bits Bits supplmentaires (0  GADC_OVERSAMPLE_MAX).
+ * @return Dernier rsultat complet ; dernier chantillon mis  l'chelle au dpart.
+ */
+uint16_t GADC_GetOversampled(uint8_t chan, uint8_t bits);
+
+/**
+ * @brief Retourne le dernier chantillon converti d'un canal.
+ * @param chan Canal.
+ * @return Valeur brute (10 bits).
+ */
+uint16_t GADC_GetLatest(uint8_t chan);
+
+/**
+ * @brief Copie le dernier balayage complet, sans attente du convertisseur.
+ * @param pSnap chantillons de tous les canaux, issus du mme balayage.
+ * @return Numro du balayage (Seq) : inchang si aucune conversion depuis
+ *         l'appel prcdent, cart = balayages couls (1 / GADC_SCAN_HZ chacun).
+ */
+uint32_t GADC_GetLatestSeq(S_adcSnapshot *pSnap);
+
+/**
+ * @brief Retourne le nombre d'chantillons perdus (buffer plein).
+ */
+uint32_t GADC_GetOverrunCount(void);
+
+/**
+ * @brief Copie sous interruption les prochains chantillons bruts d'un canal
+ *        (cadence GADC_SCAN_HZ, sans mdiane ni filtre).
+ * @param chan  Canal.
+ * @param pBuf  Destination (count chantillons), inutilise par l'application
+ *              jusqu' la fin de la capture.
+ * @param count Nombre d'chantillons, 0 = arrt.
+ */
+void GADC_StartCapture(uint8_t chan, uint16_t *pBuf, uint16_t count);
+
+/**
+ * @brief Retourne 1 lorsque la capture demande est complte.
+ */
+uint8_t GADC_IsCaptureDone(void);
+
+#endif // GestAdc_H
@@ -0,0 +1,228 @@
+/*--------------------------------------------------------*/
+// GestBoot.c
+/*--------------------------------------------------------*/
+//	Description :	Rception d'une image firmware en zone flash de transit
+//			        (blocs fentrs, programmation en tche de fond)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <xc.h>
+#include <stdint.h>
+
+#include "gestBoot.h"
+#include "gestNvm.h"
+#include "Mc32CalCrc16.h"
+
+/**
+ * @brief Bloc reu en attente de programmation.
+ */
+typedef struct {
+    uint16_t Block;                   // Numro du bloc
+    uint8_t Len;                      // Nombre d'octets utiles
+    uint8_t Data[GBOOT_BLOCK_SIZE];   // Donnes
+} S_bootSlot;
+
+// Zones effaces  l'excution, retires de la mmoire programme de l'application
+GNVM_RESERVE(gbootStagingArea, GBOOT_STAGING_ADDR, GBOOT_STAGING_SIZE);
+GNVM_RESERVE(gbootDescrPage, GBOOT_DESCR_ADDR, GNVM_PAGE_SIZE);
+
+// Fentre de rception : remplie par GBOOT_PutBlock, vide par GBOOT_Tasks
+static S_bootSlot bootSlots[GBOOT_WINDOW];
+static uint8_t bootHead = 0;        // Bloc en cours de programmation
+static uint8_t bootCount = 0;       // Blocs en attente
+static uint8_t bootWord = 0;        // Prochain mot  programmer dans le bloc courant
+
+static uint8_t bootActive = 0;      // 1 = session ouverte
+static uint8_t bootFlashError = 0;  // 1 = erreur de programmation depuis l'ouverture
+static uint32_t bootSize;           // Taille annonce de l'image
+static uint16_t bootCrc;            // CRC16 annonc de l'image
+static uint16_t bootNext;           // Prochain bloc attendu
+
+/**
+ * @brief Ouvre une session de tlchargement.
+ *
+ * @param size Taille de l'image.
+ * @param crc  CRC16 attendu.
+ * @return GBOOT_OK, GBOOT_ERR_SIZE ou GBOOT_ERR_FLASH.
+ *
+ * @details Seules les pages couvrant l'image sont effaces, ainsi que le
+ *          descripteur (l'image prcdente n'est donc plus valide).
+ *          L'effacement bloque le CPU (~20 ms par page) : l'hte attend la
+ *          rponse avant d'envoyer les blocs.
+ */
+uint8_t GBOOT_Start(uint32_t size, uint16_t crc)
+{
+    uint32_t addr;
+
+    bootActive = 0;
+    bootHead = 0;
+    bootCount = 0;
+    bootWord = 0;
+    bootFlashError = 0;
+    bootNext = 0;
+
+    if ((size == 0) || (size > GBOOT_STAGING_SIZE)) {
+        return GBOOT_ERR_SIZE;
+    }
+
+    if (GNVM_ErasePage(GBOOT_DESCR_ADDR) != 0) {
+        return GBOOT_ERR_FLASH;
+    }
+    for (addr = GBOOT_STAGING_ADDR; addr < (GBOOT_STAGING_ADDR + size); addr += GNVM_PAGE_SIZE)
+    {
+        if (GNVM_ErasePage(addr) != 0) {
+            return GBOOT_ERR_FLASH;
+        }
+    }
+
+    bootSize = size;
+    bootCrc = crc;
+    bootActive = 1;
+    return GBOOT_OK;
+}
+
+/**
+ * @brief Place un bloc dans la fentre de programmation.
+ *
+ * @param block Numro du bloc.
+ * @param pData Donnes.
+ * @param len   Longueur (multiple de 4 ; GBOOT_BLOCK_SIZE sauf pour le dernier bloc).
+ * @return GBOOT_OK si accept ou dj reu, GBOOT_ERR_xxx sinon.
+ */
+uint8_t GBOOT_PutBlock(uint16_t block, const uint8_t *pData, uint8_t len)
+{
+    uint32_t offset = (uint32_t)block * GBOOT_BLOCK_SIZE;
+    S_bootSlot *pSlot;
+    uint8_t i;
+
+    if (!bootActive) {
+        return GBOOT_ERR_STATE;
+    }
+    if (block < bootNext) {
+        return GBOOT_OK; // Rptition d'un bloc dj acquitt
+    }
+    if (block != bootNext) {
+        return GBOOT_ERR_SEQUENCE;
+    }
+    if ((len == 0) || (len > GBOOT_BLOCK_SIZE) || ((len % GNVM_WORD_SIZE) != 0) ||
+        (offset >= bootSize) ||
+        ((len < GBOOT_BLOCK_SIZE) && ((offset + len) < bootSize))) {
+        return GBOOT_ERR_SIZE;
+    }
+    if (bootCount >= GBOOT_WINDOW) {
+        return GBOOT_ERR_BUSY;
+    }
+
+    pSlot = &bootSlots[(bootHead + bootCount) % GBOOT_WINDOW];
+    pSlot->Block = block;
+    pSlot->Len = len;
+    for (i = 0; i < len; i++) {
+        pSlot->Data[i] = pData[i];
+    }
+    bootCount++;
+    bootNext++;
+    return GBOOT_OK;
+}
+
+/**
+ * @brief Retourne le prochain bloc attendu.
+ */
+uint16_t GBOOT_GetNextBlock(void)
+{
+    return bootNext;
+}
+
+/**
+ * @brief Retourne le nombre de places libres dans la fentre.
+ */
+uint8_t GBOOT_GetFreeSlots(void)
+{
+    return GBOOT_WINDOW - bootCount;
+}
+
+/**
+ * @brief Programme quelques mots du bloc en tte de fentre.
+ *
+ * @details Appele  chaque passage dans APP_Tasks. Chaque mot bloque le CPU
+ *          environ 20 us, soit bien moins que la dure d'un caractre 
+ *          57600 bauds : la rception des blocs suivants continue pendant la
+ *          programmation.
+ */
+void GBOOT_Tasks(void)
+{
+    S_bootSlot *pSlot;
+    uint32_t word;
+    uint8_t n;
+
+    for (n = 0; (n < GBOOT_WORDS_PER_CALL) && (bootCount > 0); n++)
+    {
+        pSlot = &bootSlots[bootHead];
+        // Ordre petit-boutiste : les octets de l'image restent dans l'ordre reu
+        word = (uint32_t)pSlot->Data[bootWord] |
+               ((uint32_t)pSlot->Data[bootWord + 1] << 8) |
+               ((uint32_t)pSlot->Data[bootWord + 2] << 16) |
+               ((uint32_t)pSlot->Data[bootWord + 3] << 24);
+        if (GNVM_WriteWord(GBOOT_STAGING_ADDR + ((uint32_t)pSlot->Block * GBOOT_BLOCK_SIZE) + bootWord,
+                           word) != 0) {
+            bootFlashError = 1;
+        }
+        bootWord += GNVM_WORD_SIZE;
+        if (bootWord >= pSlot->Len) {
+            bootWord = 0;
+            bootHead = (bootHead + 1) % GBOOT_WINDOW;
+            bootCount--;
+        }
+    }
+}
+
+/**
+ * @brief Termine la session et valide l'image.
+ *
+ * @param pCrc CRC16 de l'image relue en flash.
+ * @return GBOOT_OK si l'image est complte et correcte, GBOOT_ERR_xxx sinon.
+ *
+ * @details Le descripteur n'est crit qu'aprs vrification ; le mot magique
+ *          est programm en dernier pour qu'une coupure ne valide jamais une
+ *          image partielle.
+ */
+uint8_t GBOOT_End(uint16_t *pCrc)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    const volatile uint8_t *pImage = (const volatile uint8_t *)PA_TO_KVA1(GBOOT_STAGING_ADDR);
+
+    *pCrc = 0;
+    if (!bootActive) {
+        return GBOOT_ERR_STATE;
+    }
+
+    // Fin de programmation des blocs encore en fentre
+    while (bootCount > 0) {
+        GBOOT_Tasks();
+    }
+    bootActive = 0;
+
+    if (bootFlashError) {
+        return GBOOT_ERR_FLASH;
+    }
+    if (((uint32_t)bootNext * GBOOT_BLOCK_SIZE) < bootSize) {
+        return GBOOT_ERR_SIZE; // Image incomplte
+    }
+
+    for (i = 0; i < bootSize; i++) {
+        crc = updateCRC16(crc, pImage[i]);
+    }
+    *pCrc = crc;
+    if (crc != bootCrc) {
+        return GBOOT_ERR_CRC;
+    }
+
+    if ((GNVM_WriteWord(GBOOT_DESCR_ADDR + 4, bootSize) != 0) ||
+        (GNVM_WriteWord(GBOOT_DESCR_ADDR + 8, crc) != 0) ||
+        (GNVM_WriteWord(GBOOT_DESCR_ADDR, GBOOT_DESCR_MAGIC) != 0)) {
+        return GBOOT_ERR_FLASH;
+    }
+    return GBOOT_OK;
+}
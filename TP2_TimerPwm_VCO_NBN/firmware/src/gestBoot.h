@@ -0,0 +1,105 @@
+#ifndef GestBoot_H
+#define GestBoot_H
+
+/*--------------------------------------------------------*/
+// GestBoot.h
+/*--------------------------------------------------------*/
+// Description : Rception d'une image firmware par RS232 dans une zone
+//               flash de transit (blocs fentrs avec CRC, programmation
+//               en tche de fond, CRC final de l'image)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestNvm.h"
+
+/*--------------------------------------------------------*/
+// Organisation de la flash
+/*--------------------------------------------------------*/
+// La moiti haute de la flash programme reoit l'image ; l'application ne
+// doit pas dpasser la moiti basse. La dernire page contient le descripteur
+// lu au reset par le bootloader (boot flash) qui recopie l'image valide,
+// l'avant-dernire la calibration ADC (gestCal), jamais efface par un
+// tlchargement. Ces zones sont rserves par GNVM_RESERVE (gestBoot.c,
+// gestCal.c) : l'application est limite par l'diteur de liens  la moiti
+// basse. Le bootloader de recopie n'est pas fourni par ce projet : sans lui,
+// une image valide reste en zone de transit.
+
+#define GBOOT_STAGING_ADDR   (GNVM_FLASH_BASE + (GNVM_FLASH_SIZE / 2))
+#define GBOOT_DESCR_ADDR     (GNVM_FLASH_BASE + GNVM_FLASH_SIZE - GNVM_PAGE_SIZE)
+#define GBOOT_CAL_ADDR       (GBOOT_DESCR_ADDR - GNVM_PAGE_SIZE)
+#define GBOOT_STAGING_SIZE   (GBOOT_CAL_ADDR - GBOOT_STAGING_ADDR)
+#define GBOOT_DESCR_MAGIC    0x424F4F54   // "BOOT" : image complte et vrifie
+
+/*--------------------------------------------------------*/
+// Protocole
+/*--------------------------------------------------------*/
+// 1. CMD_BOOT_START [Taille(32 bits), CrcMsb, CrcLsb] : efface la zone
+//    -> [Etat, Fentre, Taille de bloc]
+// 2. CMD_BOOT_DATA [BlocMsb, BlocLsb, Donnes] : jusqu' GBOOT_WINDOW blocs
+//    sans attendre les acquittements ; le CRC16 de la trame protge le bloc.
+//    -> [Etat, ProchainMsb, ProchainLsb, Places libres]
+//    Un bloc hors squence ou sans place libre est refus : l'hte reprend
+//    au numro "Prochain".
+// 3. CMD_BOOT_END [] : termine la programmation, vrifie le CRC16 de l'image
+//    relue en flash et crit le descripteur -> [Etat, CrcMsb, CrcLsb]
+
+#define GBOOT_BLOCK_SIZE     32   // Octets de donnes par bloc (multiple de 4)
+#define GBOOT_WINDOW         4    // Blocs en attente de programmation (double buffering)
+#define GBOOT_WORDS_PER_CALL 8    // Mots programms par appel de GBOOT_Tasks
+
+// Codes d'tat spcifiques (en plus de PARAM_OK / CMD_ERR_xxx)
+#define GBOOT_OK             0
+#define GBOOT_ERR_STATE      0x90 // Commande hors session
+#define GBOOT_ERR_SIZE       0x91 // Image trop grande ou bloc de taille invalide
+#define GBOOT_ERR_FLASH      0x92 // Erreur d'effacement ou de programmation
+#define GBOOT_ERR_SEQUENCE   0x93 // Bloc hors squence
+#define GBOOT_ERR_BUSY       0x94 // Plus de place dans la fentre
+#define GBOOT_ERR_CRC        0x95 // CRC de l'image incorrect
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Ouvre une session : efface la zone de transit et le descripteur.
+ * @param size Taille de l'image en octets.
+ * @param crc  CRC16 attendu de l'image.
+ * @return GBOOT_OK ou GBOOT_ERR_xxx.
+ */
+uint8_t GBOOT_Start(uint32_t size, uint16_t crc);
+
+/**
+ * @brief Mmorise un bloc reu pour programmation.
+ * @param block Numro du bloc.
+ * @param pData Donnes du bloc.
+ * @param len   Nombre d'octets (GBOOT_BLOCK_SIZE, sauf dernier bloc).
+ * @return GBOOT_OK ou GBOOT_ERR_xxx.
+ */
+uint8_t GBOOT_PutBlock(uint16_t block, const uint8_t *pData, uint8_t len);
+
+/**
+ * @brief Retourne le numro du prochain bloc attendu.
+ */
+uint16_t GBOOT_GetNextBlock(void);
+
+/**
+ * @brief Retourne le nombre de places libres dans la fentre.
+ */
+uint8_t GBOOT_GetFreeSlots(void);
+
+/**
+ * @brief Termine la session : vrifie l'image et crit le descripteur.
+ * @param pCrc CRC16 calcul sur l'image relue en flash.
+ * @return GBOOT_OK ou GBOOT_ERR_xxx.
+ */
+uint8_t GBOOT_End(uint16_t *pCrc);
+
+/**
+ * @brief Programme en tche de fond les blocs reus (quelques mots par appel).
+ */
+void GBOOT_Tasks(void);
+
+#endif // GestBoot_H
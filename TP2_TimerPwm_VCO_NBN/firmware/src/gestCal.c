@@ -0,0 +1,302 @@
+/*--------------------------------------------------------*/
+// GestCal.c
+/*--------------------------------------------------------*/
+//	Description :	Calibration des potentiomtres
+//			        (capture des butes, mmorisation en flash avec CRC16)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestCal.h"
+#include "gestNvm.h"
+#include "gestFrame.h"
+#include "Mc32CalCrc16.h"
+
+// Page rserve : retire de la mmoire programme de l'application
+GNVM_RESERVE(gcalPage, GCAL_PAGE_ADDR, GNVM_PAGE_SIZE);
+
+// Enregistrement en flash : [Magic][Donnes][CRC16 des donnes]
+#define GCAL_DATA_WORDS     (((sizeof(S_calChan) * GADC_NB_CHANNELS) + 3) / 4)
+#define GCAL_DATA_ADDR      (GCAL_PAGE_ADDR + 4)
+#define GCAL_CRC_ADDR       (GCAL_DATA_ADDR + (GCAL_DATA_WORDS * 4))
+
+/**
+ * @brief Image de l'enregistrement, accessible par mots pour la flash.
+ */
+typedef union {
+    S_calChan Chan[GADC_NB_CHANNELS];
+    uint32_t Words[GCAL_DATA_WORDS];
+} U_calRecord;
+
+static U_calRecord calActive;          // Calibration en vigueur
+static uint8_t calValid = 0;           // 1 = calActive provient de la flash
+static U_calRecord calCapture;         // Valeurs en cours de capture
+static uint16_t calLatest[GADC_NB_CHANNELS];
+static uint8_t calCapturing = 0;
+static uint8_t calCentered = 0;        // 1 = GCAL_OP_CENTER reu depuis GCAL_OP_START
+static uint8_t calRevision = 0;
+
+/**
+ * @brief CRC16 d'un enregistrement.
+ */
+static uint16_t GCAL_Crc(const U_calRecord *pRec)
+{
+    const uint8_t *pByte = (const uint8_t *)pRec->Words;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(pRec->Words); i++) {
+        crc = updateCRC16(crc, pByte[i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Vrifie la cohrence d'un enregistrement (ordre et course minimale).
+ *
+ * @return 1 si chaque canal a min + GCAL_MIN_SPAN <= milieu <= max - GCAL_MIN_SPAN.
+ */
+static uint8_t GCAL_Check(const U_calRecord *pRec)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        if ((pRec->Chan[ch].Max > GCAL_ADC_MAX) ||
+            ((pRec->Chan[ch].Min + GCAL_MIN_SPAN) > pRec->Chan[ch].Center) ||
+            ((pRec->Chan[ch].Center + GCAL_MIN_SPAN) > pRec->Chan[ch].Max)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Valeurs par dfaut : pleine chelle.
+ */
+static void GCAL_SetFullScale(U_calRecord *pRec)
+{
+    uint8_t ch;
+
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        pRec->Chan[ch].Min = 0;
+        pRec->Chan[ch].Center = GCAL_ADC_MAX / 2;
+        pRec->Chan[ch].Max = GCAL_ADC_MAX;
+    }
+}
+
+/**
+ * @brief Charge la calibration mmorise.
+ *
+ * @details Quelques mots lus directement dans la flash et un CRC16 sur
+ *          GCAL_DATA_WORDS mots : sans effet mesurable sur le dmarrage.
+ *          Page vierge, incomplte ou corrompue => pleine chelle.
+ */
+void GCAL_Initialize(void)
+{
+    uint8_t i;
+
+    calCapturing = 0;
+    calValid = 0;
+    GCAL_SetFullScale(&calActive);
+
+    if (GNVM_ReadWord(GCAL_PAGE_ADDR) == GCAL_MAGIC)
+    {
+        for (i = 0; i < GCAL_DATA_WORDS; i++) {
+            calCapture.Words[i] = GNVM_ReadWord(GCAL_DATA_ADDR + (i * 4));
+        }
+        if ((GNVM_ReadWord(GCAL_CRC_ADDR) == GCAL_Crc(&calCapture)) && GCAL_Check(&calCapture)) {
+            calActive = calCapture;
+            calValid = 1;
+        }
+    }
+    calRevision++;
+}
+
+/**
+ * @brief Transmet la mesure courante d'un canal.
+ *
+ * @param chan  Canal ADC.
+ * @param value Mesure 10 bits.
+ *
+ * @details Pendant une capture, les extrmes atteints sont mmoriss.
+ */
+void GCAL_Capture(uint8_t chan, uint16_t value)
+{
+    if (chan >= GADC_NB_CHANNELS) {
+        return;
+    }
+    calLatest[chan] = value;
+    if (calCapturing) {
+        if (value < calCapture.Chan[chan].Min) {
+            calCapture.Chan[chan].Min = value;
+        }
+        if (value > calCapture.Chan[chan].Max) {
+            calCapture.Chan[chan].Max = value;
+        }
+    }
+}
+
+/**
+ * @brief crit un enregistrement dans la page de calibration.
+ *
+ * @return 0 si OK, 1 si erreur.
+ *
+ * @details Comme le descripteur de gestBoot, le mot magique est programm
+ *          en dernier : une coupure ne valide jamais un enregistrement partiel.
+ *          L'effacement bloque le CPU environ 20 ms.
+ */
+static uint8_t GCAL_Write(const U_calRecord *pRec)
+{
+    uint8_t i;
+
+    if (GNVM_ErasePage(GCAL_PAGE_ADDR) != 0) {
+        return 1;
+    }
+    for (i = 0; i < GCAL_DATA_WORDS; i++) {
+        if (GNVM_WriteWord(GCAL_DATA_ADDR + (i * 4), pRec->Words[i]) != 0) {
+            return 1;
+        }
+    }
+    if ((GNVM_WriteWord(GCAL_CRC_ADDR, GCAL_Crc(pRec)) != 0) ||
+        (GNVM_WriteWord(GCAL_PAGE_ADDR, GCAL_MAGIC) != 0)) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Excute une opration de calibration.
+ *
+ * @param op      GCAL_OP_xxx.
+ * @param pReport Valeurs (min, milieu, max) par canal, octet de poids fort en premier.
+ * @return GCAL_OK ou code d'erreur.
+ */
+uint8_t GCAL_Command(uint8_t op, uint8_t *pReport)
+{
+    const U_calRecord *pShown;
+    uint8_t status = GCAL_OK;
+    uint8_t ch;
+
+    switch (op)
+    {
+        case GCAL_OP_START:
+        {
+            for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+                calCapture.Chan[ch].Min = calLatest[ch];
+                calCapture.Chan[ch].Center = calLatest[ch];
+                calCapture.Chan[ch].Max = calLatest[ch];
+            }
+            calCapturing = 1;
+            calCentered = 0;
+            break;
+        }
+
+        case GCAL_OP_CENTER:
+        {
+            if (!calCapturing) {
+                status = GCAL_ERR_STATE;
+                break;
+            }
+            for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+                calCapture.Chan[ch].Center = calLatest[ch];
+            }
+            calCentered = 1;
+            break;
+        }
+
+        case GCAL_OP_SAVE:
+        {
+            if (!calCapturing || !calCentered) {
+                status = GCAL_ERR_STATE;
+                break;
+            }
+            if (!GCAL_Check(&calCapture)) {
+                status = GCAL_ERR_RANGE; // Capture conserve : l'oprateur peut complter la course
+                break;
+            }
+            calCapturing = 0;
+            if (GCAL_Write(&calCapture) != 0) {
+                status = GCAL_ERR_FLASH;
+            }
+            calActive = calCapture; // En vigueur jusqu'au prochain reset mme si l'criture a chou
+            calValid = 1;
+            calRevision++;
+            break;
+        }
+
+        case GCAL_OP_ABORT:
+        {
+            calCapturing = 0;
+            break;
+        }
+
+        case GCAL_OP_CLEAR:
+        {
+            calCapturing = 0;
+            if (GNVM_ErasePage(GCAL_PAGE_ADDR) != 0) {
+                status = GCAL_ERR_FLASH;
+            }
+            GCAL_SetFullScale(&calActive);
+            calValid = 0;
+            calRevision++;
+            break;
+        }
+
+        case GCAL_OP_READ:
+        {
+            break;
+        }
+
+        default:
+        {
+            status = CMD_ERR_VALUE;
+            break;
+        }
+    }
+
+    pShown = calCapturing ? &calCapture : &calActive;
+    for (ch = 0; ch < GADC_NB_CHANNELS; ch++) {
+        pReport[(ch * 6) + 0] = (uint8_t)(pShown->Chan[ch].Min >> 8);
+        pReport[(ch * 6) + 1] = (uint8_t)pShown->Chan[ch].Min;
+        pReport[(ch * 6) + 2] = (uint8_t)(pShown->Chan[ch].Center >> 8);
+        pReport[(ch * 6) + 3] = (uint8_t)pShown->Chan[ch].Center;
+        pReport[(ch * 6) + 4] = (uint8_t)(pShown->Chan[ch].Max >> 8);
+        pReport[(ch * 6) + 5] = (uint8_t)pShown->Chan[ch].Max;
+    }
+    return status;
+}
+
+/**
+ * @brief Lit la calibration en vigueur d'un canal.
+ *
+ * @param chan Canal ADC.
+ * @param pCal Calibration (pleine chelle si le canal n'est pas calibr).
+ * @return 1 si calibr.
+ */
+uint8_t GCAL_Get(uint8_t chan, S_calChan *pCal)
+{
+    if (chan >= GADC_NB_CHANNELS) {
+        return 0;
+    }
+    *pCal = calActive.Chan[chan];
+    return calValid;
+}
+
+/**
+ * @brief Retourne 1 pendant une capture.
+ */
+uint8_t GCAL_IsCapturing(void)
+{
+    return calCapturing;
+}
+
+/**
+ * @brief Retourne le compteur de changements de calibration.
+ */
+uint8_t GCAL_GetRevision(void)
+{
+    return calRevision;
+}
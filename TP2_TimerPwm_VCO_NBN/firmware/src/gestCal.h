@@ -0,0 +1,108 @@
+#ifndef GestCal_H
+#define GestCal_H
+
+/*--------------------------------------------------------*/
+// GestCal.h
+/*--------------------------------------------------------*/
+// Description : Calibration des potentiomtres (butes et point milieu
+//               par canal ADC), mmorise en flash avec CRC16
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestAdc.h"
+#include "gestBoot.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GCAL_PAGE_ADDR      GBOOT_CAL_ADDR   // Page rserve (organisation : gestBoot.h)
+#define GCAL_MAGIC          0x43414C31       // "CAL1" : enregistrement complet
+#define GCAL_ADC_MAX        1023             // Pleine chelle des valeurs calibres (10 bits)
+#define GCAL_MIN_SPAN       64               // cart minimal bute - milieu [pas ADC]
+
+/*--------------------------------------------------------*/
+// Protocole
+/*--------------------------------------------------------*/
+// CMD_CALIBRATE [Op] -> [Etat, n x (MinMsb, MinLsb, MilMsb, MilLsb, MaxMsb, MaxLsb)]
+// (valeurs en cours de capture, sinon calibration en vigueur ; n = GADC_NB_CHANNELS)
+// 1. GCAL_OP_START  : dbut de capture, amener chaque potentiomtre  ses butes
+//                     (vitesse force  0 pendant la capture)
+// 2. GCAL_OP_CENTER : position actuelle = point milieu (vitesse nulle, angle 90)
+// 3. GCAL_OP_SAVE   : vrification et criture en flash, tables recalcules
+//                     (refus tant que GCAL_OP_CENTER n'a pas t reu)
+
+#define GCAL_OP_START       0
+#define GCAL_OP_CENTER      1
+#define GCAL_OP_SAVE        2
+#define GCAL_OP_ABORT       3   // Abandon de la capture, calibration inchange
+#define GCAL_OP_CLEAR       4   // Effacement : retour  la pleine chelle 0..1023
+#define GCAL_OP_READ        5   // Lecture seule
+
+#define GCAL_REPORT_SIZE    (6 * GADC_NB_CHANNELS)
+
+// Codes d'tat spcifiques (en plus de PARAM_OK / CMD_ERR_xxx)
+#define GCAL_OK             0
+#define GCAL_ERR_STATE      0xA0 // Opration hors capture, ou SAVE sans CENTER
+#define GCAL_ERR_RANGE      0xA1 // Course trop faible ou milieu hors course
+#define GCAL_ERR_FLASH      0xA2 // Erreur d'effacement ou de programmation
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Calibration d'un canal (valeurs ADC 10 bits).
+ */
+typedef struct {
+    uint16_t Min;      // Bute basse
+    uint16_t Center;   // Point milieu
+    uint16_t Max;      // Bute haute
+} S_calChan;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Charge la calibration mmorise (quelques lectures directes de la flash).
+ */
+void GCAL_Initialize(void);
+
+/**
+ * @brief Transmet la mesure courante d'un canal (appele  chaque cycle).
+ * @param chan  Canal ADC.
+ * @param value Mesure 10 bits.
+ */
+void GCAL_Capture(uint8_t chan, uint16_t value);
+
+/**
+ * @brief Excute une opration de calibration.
+ * @param op      GCAL_OP_xxx.
+ * @param pReport Valeurs par canal (GCAL_REPORT_SIZE octets).
+ * @return GCAL_OK ou GCAL_ERR_xxx (CMD_ERR_VALUE si op inconnue).
+ */
+uint8_t GCAL_Command(uint8_t op, uint8_t *pReport);
+
+/**
+ * @brief Lit la calibration en vigueur d'un canal.
+ * @param chan Canal ADC.
+ * @param pCal Calibration.
+ * @return 1 si le canal est calibr, 0 sinon (pleine chelle).
+ */
+uint8_t GCAL_Get(uint8_t chan, S_calChan *pCal);
+
+/**
+ * @brief Retourne 1 pendant une capture.
+ */
+uint8_t GCAL_IsCapturing(void);
+
+/**
+ * @brief Retourne un compteur incrment  chaque changement de calibration.
+ */
+uint8_t GCAL_GetRevision(void);
+
+#endif // GestCal_H
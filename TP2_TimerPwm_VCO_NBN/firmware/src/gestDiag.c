@@ -0,0 +1,237 @@
+/*--------------------------------------------------------*/
+// GestDiag.c
+/*--------------------------------------------------------*/
+//	Description :	Diagnostic du bruit ADC
+//			        (bloc d'chantillons bruts, raies calcules par Goertzel)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestDiag.h"
+#include "gestFrame.h"
+
+#if (GDIAG_BLOCK_SIZE != 250)
+#error "Table diagCos calculee pour GDIAG_BLOCK_SIZE = 250"
+#endif
+
+#if ((2 * GDIAG_BINS_MAX) + 1) > (CMD_PAYLOAD_MAX - RS232_REL_ACK_SIZE)
+#error "GDIAG_BINS_MAX trop grand pour une reponse"
+#endif
+
+// cos(2 pi k / GDIAG_BLOCK_SIZE) en Q30, k = 0  GDIAG_BIN_MAX : la prcision
+// du coefficient fixe celle de la frquence de rsonance des raies basses
+#define GDIAG_COS_FRAC      30
+static const int32_t diagCos[GDIAG_BIN_MAX + 1] = {
+     1073741824,  1073402725,  1072385641,  1070691216,  1068320520,  1065275049,
+     1061556728,  1057167904,  1052111351,  1046390262,  1040008250,  1032969347,
+     1025277998,  1016939062,  1007957805,   998339900,   988091422,   977218845,
+      965729035,   953629251,   940927133,   927630706,   913748367,   899288885,
+      884261394,   868675383,   852540699,   835867532,   818666412,   800948206,
+      782724104,   764005616,   744804566,   725133081,   705003587,   684428797,
+      663421708,   641995587,   620163968,   597940640,   575339640,   552375243,
+      529061954,   505414499,   481447812,   457177033,   432617491,   407784699,
+      382694341,   357362265,   331804471,   306037103,   280076435,   253938864,
+      227640901,   201199155,   174630326,   147951198,   121178621,    94329504,
+       67420807,    40469525,    13492683,   -13492683,   -40469525,   -67420807,
+      -94329504,  -121178621,  -147951198,  -174630326,  -201199155,  -227640901,
+     -253938864,  -280076435,  -306037103,  -331804471,  -357362265,  -382694341,
+     -407784699,  -432617491,  -457177033,  -481447812,  -505414499,  -529061954,
+     -552375243,  -575339640,  -597940640,  -620163968,  -641995587,  -663421708,
+     -684428797,  -705003587,  -725133081,  -744804566,  -764005616,  -782724104,
+     -800948206,  -818666412,  -835867532,  -852540699,  -868675383,  -884261394,
+     -899288885,  -913748367,  -927630706,  -940927133,  -953629251,  -965729035,
+     -977218845,  -988091422,  -998339900, -1007957805, -1016939062, -1025277998,
+    -1032969347, -1040008250, -1046390262, -1052111351, -1057167904, -1061556728,
+    -1065275049, -1068320520, -1070691216, -1072385641, -1073402725, -1073741824
+};
+
+static uint16_t diagBlock[GDIAG_BLOCK_SIZE];   // chantillons bruts (10 bits)
+static uint8_t diagState = GDIAG_STATE_IDLE;
+static uint8_t diagChan = 0;
+static uint16_t diagMean = 0;                  // Moyenne du bloc [1/16 pas ADC]
+
+/**
+ * @brief Termine la capture en cours : calcule la moyenne du bloc.
+ */
+static void GDIAG_Update(void)
+{
+    uint32_t sum = 0;
+    uint16_t i;
+
+    if ((diagState != GDIAG_STATE_BUSY) || !GADC_IsCaptureDone()) {
+        return;
+    }
+    for (i = 0; i < GDIAG_BLOCK_SIZE; i++) {
+        sum += diagBlock[i];
+    }
+    diagMean = (uint16_t)(((sum * GDIAG_AMP_FRAC) + (GDIAG_BLOCK_SIZE / 2)) / GDIAG_BLOCK_SIZE);
+    diagState = GDIAG_STATE_READY;
+}
+
+/**
+ * @brief Racine carre entire (bit par bit).
+ *
+ * @param value Valeur 64 bits.
+ * @return Partie entire de la racine.
+ */
+static uint32_t GDIAG_Sqrt(uint64_t value)
+{
+    uint64_t bit = (uint64_t)1 << 62;
+    uint64_t root = 0;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= (root + bit)) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Amplitude crte d'une raie du bloc captur.
+ *
+ * @param k Raie (0  GDIAG_BIN_MAX).
+ * @return Amplitude en 1/GDIAG_AMP_FRAC de pas ADC ; moyenne du bloc pour k = 0.
+ *
+ * @details Goertzel sur le bloc centr (moyenne retire), entres en
+ *          1/16 de pas : s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2], puis
+ *          |X| = s1 + s2 - 2 cos(w) s1 s2. Les tats restent sous
+ *          N x 16368 / sin(2 pi / N) < 2^28, les produits (2^58 au plus)
+ *          sont sur 64 bits.
+ *          Amplitude crte = 2 |X| / N (|X| / N pour la raie de Nyquist).
+ */
+static uint16_t GDIAG_Goertzel(uint8_t k)
+{
+    int32_t cosK = diagCos[k];
+    int32_t s0;
+    int32_t s1 = 0;
+    int32_t s2 = 0;
+    int64_t power;
+    uint32_t divisor;
+    uint16_t i;
+
+    if (k == 0) {
+        return diagMean;
+    }
+
+    for (i = 0; i < GDIAG_BLOCK_SIZE; i++)
+    {
+        s0 = (((int32_t)diagBlock[i] * GDIAG_AMP_FRAC) - diagMean)
+           + (int32_t)(((int64_t)cosK * s1) >> (GDIAG_COS_FRAC - 1))
+           - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    power = ((int64_t)s1 * s1) + ((int64_t)s2 * s2)
+          - ((((int64_t)cosK * s1) >> (GDIAG_COS_FRAC - 1)) * s2);
+    if (power < 0) {
+        power = 0; // Arrondis sur une raie quasi nulle
+    }
+
+    divisor = (k == GDIAG_BIN_MAX) ? GDIAG_BLOCK_SIZE : (GDIAG_BLOCK_SIZE / 2);
+    return (uint16_t)((GDIAG_Sqrt((uint64_t)power) + (divisor / 2)) / divisor);
+}
+
+/**
+ * @brief Excute une opration de diagnostic (protocole : gestDiag.h).
+ *
+ * @param pArgs      Donnes de la commande (Op en premier).
+ * @param len        Nombre d'octets de donnes.
+ * @param pReport    Rsultat.
+ * @param pReportLen Nombre d'octets du rsultat.
+ * @return GDIAG_OK, GDIAG_ERR_xxx, CMD_ERR_LENGTH ou CMD_ERR_VALUE.
+ *
+ * @details Les raies sont calcules  la demande, dans le contexte de
+ *          APP_Tasks : environ 250 itrations par raie.
+ */
+uint8_t GDIAG_Command(const uint8_t *pArgs, uint8_t len, uint8_t *pReport, uint8_t *pReportLen)
+{
+    uint8_t status = GDIAG_OK;
+    uint16_t last;
+    uint16_t amp;
+    uint8_t i;
+
+    *pReportLen = 0;
+    if (len == 0) {
+        return CMD_ERR_LENGTH;
+    }
+    GDIAG_Update();
+
+    switch (pArgs[0])
+    {
+        case GDIAG_OP_CAPTURE:
+        {
+            if (len != 2) {
+                status = CMD_ERR_LENGTH;
+                break;
+            }
+            if (pArgs[1] >= GADC_NB_CHANNELS) {
+                status = GDIAG_ERR_RANGE;
+                break;
+            }
+            diagChan = pArgs[1];
+            diagState = GDIAG_STATE_BUSY;
+            GADC_StartCapture(diagChan, diagBlock, GDIAG_BLOCK_SIZE);
+            break;
+        }
+
+        case GDIAG_OP_STATUS:
+        {
+            if (len != 1) {
+                status = CMD_ERR_LENGTH;
+                break;
+            }
+            pReport[0] = diagState;
+            pReport[1] = diagChan;
+            pReport[2] = (uint8_t)(diagMean >> 8);
+            pReport[3] = (uint8_t)diagMean;
+            *pReportLen = 4;
+            break;
+        }
+
+        case GDIAG_OP_BINS:
+        {
+            if (len != 4) {
+                status = CMD_ERR_LENGTH;
+                break;
+            }
+            if (diagState != GDIAG_STATE_READY) {
+                status = GDIAG_ERR_STATE;
+                break;
+            }
+            last = pArgs[1] + ((uint16_t)(pArgs[2] - 1) * pArgs[3]);
+            if ((pArgs[2] == 0) || (pArgs[2] > GDIAG_BINS_MAX) || (last > GDIAG_BIN_MAX)) {
+                status = GDIAG_ERR_RANGE;
+                break;
+            }
+            for (i = 0; i < pArgs[2]; i++)
+            {
+                amp = GDIAG_Goertzel(pArgs[1] + (i * pArgs[3]));
+                pReport[2 * i] = (uint8_t)(amp >> 8);
+                pReport[(2 * i) + 1] = (uint8_t)amp;
+            }
+            *pReportLen = 2 * pArgs[2];
+            break;
+        }
+
+        default:
+        {
+            status = CMD_ERR_VALUE;
+            break;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,73 @@
+#ifndef GestDiag_H
+#define GestDiag_H
+
+/*--------------------------------------------------------*/
+// GestDiag.h
+/*--------------------------------------------------------*/
+// Description : Diagnostic du bruit ADC : capture d'un bloc d'chantillons
+//               bruts et amplitude des raies choisies (Goertzel en virgule fixe)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestAdc.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+// Bloc de 250 chantillons  GADC_SCAN_HZ (2500 Hz) : 100 ms, raies espaces
+// de 10 Hz. Le secteur (50 Hz) et ses harmoniques tombent exactement sur une
+// raie (k = 5, 10, 15...) ; la raie k = 125 correspond  Nyquist (1250 Hz).
+// La PWM (40 kHz = 16 x 2500 Hz) est replie sur la raie 0 : son ondulation se
+// mesure en comparant la moyenne du bloc  plusieurs PARAM_ID_ADC_SYNC_DELAY.
+#define GDIAG_BLOCK_SIZE    250
+#define GDIAG_BIN_MAX       (GDIAG_BLOCK_SIZE / 2)
+#define GDIAG_BIN_HZ        (GADC_SCAN_HZ / GDIAG_BLOCK_SIZE)   // Espacement des raies
+#define GDIAG_AMP_FRAC      16      // Amplitudes en 1/16 de pas ADC
+#define GDIAG_BINS_MAX      22      // Raies par rponse (CMD_PAYLOAD_MAX - RS232_REL_ACK_SIZE - 1) / 2
+
+/*--------------------------------------------------------*/
+// Protocole
+/*--------------------------------------------------------*/
+// CMD_DIAG [Op, Arguments] -> [Etat, Rsultat]
+// 1. GDIAG_OP_CAPTURE [Op, Canal] -> [Etat] : dmarre la capture (100 ms)
+// 2. GDIAG_OP_STATUS  [Op] -> [Etat, Etape, Canal, MoyMsb, MoyLsb]
+//    (moyenne du bloc en 1/16 de pas ADC, valide  l'tape GDIAG_STATE_READY)
+// 3. GDIAG_OP_BINS    [Op, Premire, Nombre, Pas]
+//    -> [Etat, Nombre x (AmpMsb, AmpLsb)]
+//    Amplitude crte des raies Premire + i x Pas (i < Nombre), frquence
+//    k x GDIAG_BIN_HZ, en 1/16 de pas ADC ; la raie 0 est la moyenne du bloc.
+//    Un spectre complet s'obtient en plusieurs requtes.
+
+#define GDIAG_OP_CAPTURE    0
+#define GDIAG_OP_STATUS     1
+#define GDIAG_OP_BINS       2
+
+// tapes
+#define GDIAG_STATE_IDLE    0   // Aucun bloc
+#define GDIAG_STATE_BUSY    1   // Capture en cours
+#define GDIAG_STATE_READY   2   // Bloc disponible
+
+// Codes d'tat spcifiques (en plus de PARAM_OK / CMD_ERR_xxx)
+#define GDIAG_OK            0
+#define GDIAG_ERR_STATE     0xB0 // Aucun bloc captur ou capture en cours
+#define GDIAG_ERR_RANGE     0xB1 // Canal, raie ou nombre de raies invalide
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Excute une opration de diagnostic.
+ * @param pArgs       Donnes de la commande (Op en premier).
+ * @param len         Nombre d'octets de donnes.
+ * @param pReport     Rsultat (2 x GDIAG_BINS_MAX octets au plus).
+ * @param pReportLen  Nombre d'octets du rsultat.
+ * @return GDIAG_OK, GDIAG_ERR_xxx, CMD_ERR_LENGTH ou CMD_ERR_VALUE (op inconnue).
+ */
+uint8_t GDIAG_Command(const uint8_t *pArgs, uint8_t len, uint8_t *pReport, uint8_t *pReportLen);
+
+#endif // GestDiag_H
@@ -0,0 +1,223 @@
+/*--------------------------------------------------------*/
+// GestFilter.c
+/*--------------------------------------------------------*/
+//	Description :	Filtres passe-bas en virgule fixe
+//			        (moyenne glissante, EMA, biquad, mdiane)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestFilter.h"
+
+// change conditionnel (a <= b en sortie) : conditions compiles en MOVN/MOVZ, sans saut
+#define GFILT_CSWAP(a, b)  { uint16_t lo = ((a) < (b)) ? (a) : (b); \
+                             (b) = ((a) < (b)) ? (b) : (a); (a) = lo; }
+
+/**
+ * @brief Fixe le nombre de canaux d'un banc.
+ *
+ * @param pB     Banc de filtres.
+ * @param nbChan Nombre de canaux, born  GFILT_BANK_MAX.
+ *
+ * @details Chaque canal doit ensuite tre configur par GFILT_BankConfig.
+ */
+void GFILT_BankInit(S_filterBank *pB, uint8_t nbChan)
+{
+    if (nbChan > GFILT_BANK_MAX) {
+        nbChan = GFILT_BANK_MAX;
+    }
+    pB->NbChan = nbChan;
+}
+
+/**
+ * @brief Configure un canal et initialise son tat.
+ *
+ * @param pB      Banc de filtres.
+ * @param chan    Canal.
+ * @param pCfg    Configuration ; Param est born  la plage admise.
+ * @param initial Valeur de dpart.
+ *
+ * @details L'tat est rempli comme si l'entre valait initial depuis
+ *          toujours : un changement de type ne provoque pas de saut.
+ */
+void GFILT_BankConfig(S_filterBank *pB, uint8_t chan, const S_filterChanCfg *pCfg, uint16_t initial)
+{
+    uint8_t param = pCfg->Param;
+    uint8_t i;
+
+    if (chan >= pB->NbChan) {
+        return;
+    }
+
+    if (pCfg->Type == GFILT_TYPE_BOXCAR) {
+        if ((param == 0) || (param > GFILT_BOXCAR_MAX)) {
+            param = GFILT_BOXCAR_MAX;
+        }
+    } else if (pCfg->Type == GFILT_TYPE_EMA) {
+        if (param < GFILT_EMA_SHIFT_MIN) {
+            param = GFILT_EMA_SHIFT_MIN;
+        } else if (param > GFILT_EMA_SHIFT_MAX) {
+            param = GFILT_EMA_SHIFT_MAX;
+        }
+    }
+
+    pB->Type[chan] = pCfg->Type;
+    pB->Param[chan] = param;
+    pB->pMap[chan] = pCfg->pMap;
+
+    pB->Index[chan] = 0;
+    for (i = 0; i < GFILT_BOXCAR_MAX; i++) {
+        pB->Buf[i][chan] = initial;
+    }
+    pB->Sum[chan] = (uint32_t)initial * param;
+    pB->Ema[chan] = (int32_t)initial << GFILT_EMA_FRAC;
+    pB->X1[chan] = (int32_t)initial << GFILT_BIQ_FRAC;
+    pB->X2[chan] = pB->X1[chan];
+    pB->Y1[chan] = pB->X1[chan];
+    pB->Y2[chan] = pB->X1[chan];
+    pB->Err[chan] = 0;
+}
+
+/**
+ * @brief Filtre un chantillon par canal et le met  l'chelle.
+ *
+ * @param pB   Banc de filtres.
+ * @param pIn  chantillons (10  13 bits).
+ * @param pOut Sorties : table du canal applique  la mesure filtre.
+ *
+ * @details Biquad en forme directe I ; l'tat garde GFILT_BIQ_FRAC bits
+ *          fractionnaires pour viter les cycles limites dus  l'arrondi,
+ *          et le reste de la division est rinject au pas suivant (retour
+ *          d'erreur) : sans lui, une zone morte de +/- 0.75 pas fausse le
+ *          gain statique.
+ *          Avec une entre de 13 bits les produits restent sur 32 bits.
+ */
+void GFILT_BankProcess(S_filterBank *pB, const uint16_t *pIn, int32_t *pOut)
+{
+    uint8_t ch;
+    uint8_t index;
+    int32_t xq;
+    int32_t y;
+
+    for (ch = 0; ch < pB->NbChan; ch++)
+    {
+        switch (pB->Type[ch])
+        {
+            case GFILT_TYPE_EMA:
+            {
+                pB->Ema[ch] += (((int32_t)pIn[ch] << GFILT_EMA_FRAC) - pB->Ema[ch]) >> pB->Param[ch];
+                y = (pB->Ema[ch] + (1 << (GFILT_EMA_FRAC - 1))) >> GFILT_EMA_FRAC;
+                break;
+            }
+
+            case GFILT_TYPE_BIQUAD:
+            {
+                xq = (int32_t)pIn[ch] << GFILT_BIQ_FRAC;
+                y = (GFILT_BIQ_B0 * xq) + (GFILT_BIQ_B1 * pB->X1[ch]) + (GFILT_BIQ_B2 * pB->X2[ch])
+                  - (GFILT_BIQ_A1 * pB->Y1[ch]) - (GFILT_BIQ_A2 * pB->Y2[ch]) + pB->Err[ch];
+                pB->Err[ch] = y & ((1 << GFILT_BIQ_SHIFT) - 1);
+                y >>= GFILT_BIQ_SHIFT;
+                pB->X2[ch] = pB->X1[ch];
+                pB->X1[ch] = xq;
+                pB->Y2[ch] = pB->Y1[ch];
+                pB->Y1[ch] = y;
+                if (y < 0) {
+                    y = 0;
+                }
+                y = (y + (1 << (GFILT_BIQ_FRAC - 1))) >> GFILT_BIQ_FRAC;
+                break;
+            }
+
+            case GFILT_TYPE_BOXCAR:
+            default:
+            {
+                index = pB->Index[ch];
+                pB->Sum[ch] = pB->Sum[ch] - pB->Buf[index][ch] + pIn[ch];
+                pB->Buf[index][ch] = pIn[ch];
+                pB->Index[ch] = (index + 1) % pB->Param[ch];
+                y = pB->Sum[ch] / pB->Param[ch];
+                break;
+            }
+        }
+
+        if (pB->pMap[ch] != 0) {
+            pOut[ch] = GLUT_Eval(pB->pMap[ch], (uint16_t)y);
+        } else {
+            pOut[ch] = y;
+        }
+    }
+}
+
+/**
+ * @brief Initialise une mdiane glissante.
+ *
+ * @param pM      Mdiane.
+ * @param taps    Longueur demande (ramene  1, 3 ou 5).
+ * @param initial Valeur de dpart de la fentre.
+ */
+void GFILT_MedianInit(S_median *pM, uint8_t taps, uint16_t initial)
+{
+    uint8_t i;
+
+    if (taps >= 5) {
+        pM->Taps = 5;
+    } else if (taps >= 3) {
+        pM->Taps = 3;
+    } else {
+        pM->Taps = 1;
+    }
+    pM->Index = 0;
+    for (i = 0; i < GFILT_MEDIAN_MAX; i++) {
+        pM->Win[i] = initial;
+    }
+}
+
+/**
+ * @brief Ajoute un chantillon et retourne la mdiane de la fentre.
+ *
+ * @param pM Mdiane.
+ * @param x  chantillon.
+ * @return Mdiane (x si Taps = 1).
+ *
+ * @details Rseaux de tri partiels sur une copie de la fentre : 3 changes
+ *          pour 3 points, 7 pour 5 points. Un chantillon isol (ou deux
+ *          avec 5 points) ne parvient pas au filtre de moyenne.
+ */
+uint16_t GFILT_MedianProcess(S_median *pM, uint16_t x)
+{
+    uint16_t a, b, c, d, e;
+
+    if (pM->Taps < 3) {
+        return x;
+    }
+
+    pM->Win[pM->Index] = x;
+    pM->Index++;
+    if (pM->Index >= pM->Taps) {
+        pM->Index = 0;
+    }
+
+    a = pM->Win[0];
+    b = pM->Win[1];
+    c = pM->Win[2];
+    if (pM->Taps == 3) {
+        GFILT_CSWAP(a, b);
+        GFILT_CSWAP(b, c);
+        GFILT_CSWAP(a, b);
+        return b;
+    }
+
+    d = pM->Win[3];
+    e = pM->Win[4];
+    GFILT_CSWAP(a, b);
+    GFILT_CSWAP(d, e);
+    GFILT_CSWAP(a, d);
+    GFILT_CSWAP(b, e);
+    GFILT_CSWAP(b, c);
+    GFILT_CSWAP(c, d);
+    GFILT_CSWAP(b, c);
+    return c;
+}
@@ -0,0 +1,145 @@
+#ifndef GestFilter_H
+#define GestFilter_H
+
+/*--------------------------------------------------------*/
+// GestFilter.h
+/*--------------------------------------------------------*/
+// Description : Filtres passe-bas en virgule fixe pour les mesures ADC
+//               (moyenne glissante, EMA  coefficient 2^-k, biquad, mdiane)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestLut.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GFILT_BANK_MAX       4    // Canaux max. d'un banc de filtres
+#define GFILT_BOXCAR_MAX     10   // Longueur max. de la moyenne glissante (= ADC_SAMPLING_SIZE)
+
+#define GFILT_EMA_SHIFT_MIN  1    // alpha = 1/2
+#define GFILT_EMA_SHIFT_MAX  8    // alpha = 1/256
+#define GFILT_EMA_SHIFT      3    // alpha = 1/8 par dfaut (~ moyenne de 15 chantillons)
+#define GFILT_EMA_FRAC       16   // Bits fractionnaires de l'tat EMA
+
+// Biquad : Butterworth passe-bas d'ordre 2, fc = 2.5 Hz  fs = 50 Hz (cycle de service).
+// Coefficients Q14 ; a0 = 1, gain statique b0 + b1 + b2 = 1 + a1 + a2 (1316).
+#define GFILT_BIQ_SHIFT      14
+#define GFILT_BIQ_B0         329
+#define GFILT_BIQ_B1         658
+#define GFILT_BIQ_B2         329
+#define GFILT_BIQ_A1         (-25576)
+#define GFILT_BIQ_A2         10508
+#define GFILT_BIQ_FRAC       3    // Bits fractionnaires de l'tat du biquad (entre 13 bits max.)
+
+#define GFILT_MEDIAN_MAX     5    // Mdiane glissante : 3 ou 5 points (1 = sans effet)
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Type de filtre (valeur du paramtre PARAM_ID_ADC_FILTER).
+ */
+typedef enum {
+    GFILT_TYPE_BOXCAR = 0,  // Moyenne glissante sur N chantillons (division par N)
+    GFILT_TYPE_EMA,         // y += (x - y) / 2^k : un mot d'tat, sans division
+    GFILT_TYPE_BIQUAD,      // Passe-bas d'ordre 2 (meilleure rjection du bruit)
+    GFILT_TYPE_NB
+} E_filterType;
+
+/**
+ * @brief Configuration d'un canal du banc : filtre et mise  l'chelle.
+ *
+ * Sortie = pMap(filtre(x)), ou filtre(x) si pMap est nul.
+ */
+typedef struct {
+    E_filterType Type;
+    uint8_t Param;                       // Longueur (boxcar) ou k (EMA)
+    const S_lut *pMap;                   // Table mesure -> units de sortie
+} S_filterChanCfg;
+
+/**
+ * @brief Banc de filtres : tat rang par tableaux, un indice par canal.
+ *
+ * Les canaux sont traits en une seule boucle ; les tats d'un mme type
+ * sont contigus en mmoire.
+ */
+typedef struct {
+    uint8_t NbChan;
+    // Configuration
+    uint8_t Type[GFILT_BANK_MAX];
+    uint8_t Param[GFILT_BANK_MAX];
+    const S_lut *pMap[GFILT_BANK_MAX];
+    // Boxcar : derniers chantillons, position et somme
+    uint16_t Buf[GFILT_BOXCAR_MAX][GFILT_BANK_MAX];
+    uint8_t Index[GFILT_BANK_MAX];
+    uint32_t Sum[GFILT_BANK_MAX];
+    // EMA : sortie en Q(GFILT_EMA_FRAC)
+    int32_t Ema[GFILT_BANK_MAX];
+    // Biquad : entres et sorties prcdentes en Q(GFILT_BIQ_FRAC)
+    int32_t X1[GFILT_BANK_MAX];
+    int32_t X2[GFILT_BANK_MAX];
+    int32_t Y1[GFILT_BANK_MAX];
+    int32_t Y2[GFILT_BANK_MAX];
+    int32_t Err[GFILT_BANK_MAX];         // Reste de la division par 2^GFILT_BIQ_SHIFT
+} S_filterBank;
+
+/**
+ * @brief tat d'une mdiane glissante (rejet des chantillons aberrants).
+ */
+typedef struct {
+    uint16_t Win[GFILT_MEDIAN_MAX];      // Derniers chantillons (ordre d'arrive)
+    uint8_t Index;                       // Position du prochain chantillon
+    uint8_t Taps;                        // Longueur : 1, 3 ou 5
+} S_median;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Fixe le nombre de canaux d'un banc.
+ * @param pB     Banc de filtres.
+ * @param nbChan Nombre de canaux (1  GFILT_BANK_MAX).
+ */
+void GFILT_BankInit(S_filterBank *pB, uint8_t nbChan);
+
+/**
+ * @brief Configure un canal et initialise son tat sur une valeur de dpart.
+ * @param pB      Banc de filtres.
+ * @param chan    Canal.
+ * @param pCfg    Configuration (Param : 1..GFILT_BOXCAR_MAX ou k ; ignor pour le biquad).
+ * @param initial Valeur de dpart (la sortie dmarre sans transitoire).
+ */
+void GFILT_BankConfig(S_filterBank *pB, uint8_t chan, const S_filterChanCfg *pCfg, uint16_t initial);
+
+/**
+ * @brief Filtre un chantillon par canal et le met  l'chelle.
+ * @param pB   Banc de filtres.
+ * @param pIn  chantillons (NbChan valeurs).
+ * @param pOut Sorties mises  l'chelle par la table du canal (NbChan valeurs).
+ */
+void GFILT_BankProcess(S_filterBank *pB, const uint16_t *pIn, int32_t *pOut);
+
+/**
+ * @brief Initialise une mdiane glissante.
+ * @param pM      Mdiane.
+ * @param taps    Longueur : >= 5 => 5, >= 3 => 3, sinon 1 (sans effet).
+ * @param initial Valeur de dpart de la fentre.
+ */
+void GFILT_MedianInit(S_median *pM, uint8_t taps, uint16_t initial);
+
+/**
+ * @brief Ajoute un chantillon et retourne la mdiane de la fentre.
+ * @param pM Mdiane.
+ * @param x  chantillon.
+ * @return Mdiane des Taps derniers chantillons.
+ */
+uint16_t GFILT_MedianProcess(S_median *pM, uint16_t x);
+
+#endif // GestFilter_H
@@ -0,0 +1,127 @@
+/*--------------------------------------------------------*/
+// GestFrame.c
+/*--------------------------------------------------------*/
+//	Description :	Codage et vrification des trames RS232
+//			        (sans dpendance matrielle, partageable avec l'hte)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestFrame.h"
+#include "Mc32CalCrc16.h"
+
+/**
+ * @brief Calcule le CRC16 d'une suite d'octets.
+ *
+ * @param pData Octets.
+ * @param size  Nombre d'octets.
+ * @return CRC16-CCITT (valeur initiale 0xFFFF).
+ */
+static uint16_t GFRAME_Crc(const uint8_t *pData, uint8_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for (i = 0; i < size; i++) {
+        crc = updateCRC16(crc, pData[i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Place le code de dbut et l'adresse (mode multipoint).
+ *
+ * @return Nombre d'octets crits.
+ */
+static uint8_t GFRAME_PutHeader(uint8_t *pFrame, uint8_t start, uint8_t addr)
+{
+    pFrame[0] = start;
+#if RS232_MULTIDROP
+    pFrame[1] = addr;
+#else
+    (void)addr;
+#endif
+    return 1 + RS232_ADDR_SIZE;
+}
+
+/**
+ * @brief Ajoute le CRC16 des octets dj placs.
+ *
+ * @return Taille totale de la trame.
+ */
+static uint8_t GFRAME_PutCrc(uint8_t *pFrame, uint8_t size)
+{
+    uint16_t crc = GFRAME_Crc(pFrame, size);
+
+    pFrame[size] = (uint8_t)((crc & 0xFF00) >> 8);
+    pFrame[size + 1] = (uint8_t)(crc & 0x00FF);
+    return size + CMD_CRC_SIZE;
+}
+
+/**
+ * @brief Construit une trame de consigne.
+ *
+ * @param pFrame Buffer de MESS_SIZE octets.
+ * @param addr   Adresse du noeud (mode multipoint).
+ * @param speed  Consigne de vitesse.
+ * @param angle  Consigne d'angle.
+ * @return MESS_SIZE.
+ */
+uint8_t GFRAME_EncodeSetpoint(uint8_t *pFrame, uint8_t addr, int8_t speed, int8_t angle)
+{
+    uint8_t n = GFRAME_PutHeader(pFrame, (uint8_t)STX_code, addr);
+
+    pFrame[n++] = (uint8_t)speed;
+    pFrame[n++] = (uint8_t)angle;
+    return GFRAME_PutCrc(pFrame, n);
+}
+
+/**
+ * @brief Construit une trame de commande.
+ *
+ * @param pFrame   Buffer de CMD_MESS_SIZE(len) octets.
+ * @param addr     Adresse du noeud (mode multipoint).
+ * @param cmd      Code de commande.
+ * @param pPayload Donnes.
+ * @param len      Nombre d'octets de donnes.
+ * @return Taille de la trame, 0 si len > CMD_PAYLOAD_MAX.
+ */
+uint8_t GFRAME_EncodeCommand(uint8_t *pFrame, uint8_t addr, uint8_t cmd,
+                             const uint8_t *pPayload, uint8_t len)
+{
+    uint8_t n;
+    uint8_t i;
+
+    if (len > CMD_PAYLOAD_MAX) {
+        return 0;
+    }
+    n = GFRAME_PutHeader(pFrame, (uint8_t)STX_CMD_code, addr);
+    pFrame[n++] = cmd;
+    pFrame[n++] = len;
+    for (i = 0; i < len; i++) {
+        pFrame[n++] = pPayload[i];
+    }
+    return GFRAME_PutCrc(pFrame, n);
+}
+
+/**
+ * @brief Vrifie le CRC16 d'une trame complte.
+ *
+ * @param pFrame Trame, code de dbut compris.
+ * @param size   Taille totale, CRC compris.
+ * @return 1 si le CRC est correct, 0 sinon.
+ */
+uint8_t GFRAME_CheckCrc(const uint8_t *pFrame, uint8_t size)
+{
+    uint16_t crc;
+
+    if (size <= CMD_CRC_SIZE) {
+        return 0;
+    }
+    crc = GFRAME_Crc(pFrame, size - CMD_CRC_SIZE);
+    return (pFrame[size - 2] == (uint8_t)(crc >> 8)) &&
+           (pFrame[size - 1] == (uint8_t)crc);
+}
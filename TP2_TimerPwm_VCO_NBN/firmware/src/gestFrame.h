@@ -0,0 +1,189 @@
+#ifndef GestFrame_H
+#define GestFrame_H
+
+/*--------------------------------------------------------*/
+// GestFrame.h
+/*--------------------------------------------------------*/
+// Description : Format des trames RS232 (consignes et commandes) et
+//               codage/vrification indpendants du matriel
+//
+//               Ce module ne dpend que de <stdint.h> et de Mc32CalCrc16 :
+//               un outil hte peut le compiler tel quel pour construire et
+//               vrifier les trames avec la mme table CRC16 que la carte.
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+//--------------------------  Bus multipoint RS485  -------------------------//
+// RS232_MULTIDROP = 1 : plusieurs cartes partagent un bus RS485 half-duplex.
+// - Un octet d'adresse suit le code de dbut de chaque trame (couvert par le CRC).
+// - L'ISR RX carte les trames destines aux autres noeuds avant le FIFO RX.
+// - La sortie RTS commande la validation de l'metteur du transceiver (DE) ;
+//   le contrle de flux RTS/CTS est alors dsactiv. /RE doit tre reli  DE
+//   (le rcepteur est coup pendant l'mission, pas d'cho).
+// - Le noeud ne rpond qu'aux trames qui lui sont adresses (pas  la diffusion).
+#ifndef RS232_MULTIDROP
+#define RS232_MULTIDROP       0
+#endif
+
+#define RS232_ADDR_BROADCAST  0xFF    // Adresse de diffusion (tous les noeuds, sans rponse).
+#define RS232_NODE_ADDRESS    1       // Adresse par dfaut du noeud (registre de paramtres).
+
+#if RS232_MULTIDROP
+#define RS232_ADDR_SIZE       1       // Octet d'adresse aprs le code de dbut.
+#else
+#define RS232_ADDR_SIZE       0
+#endif
+
+//--------------------------  Constantes et macros  --------------------------//
+
+#define MESS_SIZE    (5 + RS232_ADDR_SIZE) // Taille d'un message complet en octets.
+#define STX_code    (-86)    // Code de synchronisation (STX), -86 correspond  0xAA en hexadcimal.
+
+//--------------------------  Trames de commande  ----------------------------//
+// Format : STX_CMD | [Addr] | Cmd | Len | Data[Len] | MsbCrc | LsbCrc
+// Le CRC16 couvre STX_CMD, l'adresse (mode multipoint), Cmd, Len et les donnes.
+// La rponse reprend le code de commande avec CMD_RESPONSE_FLAG ; son premier
+// octet de donnes est un code d'tat (PARAM_OK, PARAM_ERR_xxx ou CMD_ERR_xxx).
+
+#define STX_CMD_code       (-85)    // Code de dbut de trame de commande (0xAB).
+#define CMD_HEADER_SIZE    (3 + RS232_ADDR_SIZE) // STX_CMD + [Addr] + Cmd + Len.
+#define CMD_LEN_OFFSET     (CMD_HEADER_SIZE - 1) // Position de l'octet Len dans la trame.
+#define CMD_CRC_SIZE       2        // CRC16 (MSB puis LSB).
+#define CMD_PAYLOAD_MAX    48       // Nombre max. d'octets de donnes par trame.
+#define CMD_MESS_SIZE(len) (CMD_HEADER_SIZE + (len) + CMD_CRC_SIZE) // Taille d'une trame complte.
+
+#define CMD_PARAM_READ     0x01     // Lecture paramtre  : [Id]               -> [Etat, Id, ValMsb, ValLsb]
+#define CMD_PARAM_WRITE    0x02     // criture paramtre : [Id, ValMsb, ValLsb] -> [Etat, Id, ValMsb, ValLsb]
+#define CMD_GET_LINK_STATS 0x03     // Statistiques liaison  : []  -> [Etat, S_rs232LinkStats]
+#define CMD_GET_FLOW_STATS 0x04     // Statistiques RTS/CTS  : []  -> [Etat, S_rs232FlowStats]
+#define CMD_PING           0x05     // Sonde de latence : [Seq] -> [Etat, Seq, tRx, tParse, tApply, tReply]
+// Les instants du ping sont des valeurs 32 bits du core timer (RS232_CORE_TICKS_PER_US par us) :
+// tRx = ISR de rception du code de dbut, tParse = dcodage de la trame,
+// tApply = GPWM_ExecPWM suivant le dcodage, tReply = mise en FIFO de la rponse.
+#define CMD_TRAJ_LOAD      0x06     // Points de trajectoire : [n x (TimeMsb, TimeLsb, Speed, Angle)]
+                                    //                      -> [Etat, Accepts, Places libres]
+#define CMD_TRAJ_CTRL      0x07     // Contrle trajectoire : [0 = arrt, 1 = dpart, 2 = dernier point charg] -> [Etat]
+#define CMD_TRAJ_STATUS    0x08     // tat trajectoire : [] -> [Etat, State, Count, TimeMsb, TimeLsb,
+                                    //                          Underruns(32 bits), Overruns(32 bits)]
+#define CMD_PLAYOUT_STATUS 0x09     // Buffer de restitution : [] -> [Etat, Count, LateTicks(32 bits), Overruns(32 bits)]
+#define CMD_TELEMETRY      (0x0A | CMD_RESPONSE_FLAG) // Tlmtrie spontane (format : gestTelem.h)
+#define CMD_BOOT_START     0x0B     // Tlchargement firmware (protocole : gestBoot.h)
+#define CMD_BOOT_DATA      0x0C
+#define CMD_BOOT_END       0x0D
+#define CMD_REL_DATA       0x0E     // Trame fiable : [Seq, Cmd, Data...] -> [Seq, CumAck, Sack, Rponse de Cmd...]
+#define CMD_REL_RESET      0x0F     // Synchronisation du canal fiable : [Seq attendu] -> [Etat]
+#define CMD_GET_SYNC_STATS 0x10     // Resynchronisations : [] -> [Etat, Resyncs, RealignTicks, RealignMaxTicks]
+#define CMD_STATS_RESET    0x11     // Remise  zro des compteurs de liaison : [] -> [Etat]
+#define CMD_CALIBRATE      0x12     // Calibration des potentiomtres (protocole : gestCal.h)
+#define CMD_DIAG           0x13     // Analyse du bruit ADC (protocole : gestDiag.h)
+// RealignTicks : dure cumule (core timer) entre l'arrive du premier octet
+// rejet et celle de la trame valide suivante, sur toutes les resynchronisations.
+#define CMD_RESPONSE_FLAG  0x80     // Ajout au code de commande dans la rponse.
+// Les compteurs 32 bits sont transmis dans l'ordre des champs, MSB en premier.
+
+#define CMD_ERR_LENGTH     0x80     // Longueur de donnes incorrecte pour la commande.
+#define CMD_ERR_UNKNOWN    0x81     // Code de commande inconnu.
+#define CMD_ERR_OVERRUN    0x82     // Buffer de destination plein, donnes partiellement refuses.
+#define CMD_ERR_VALUE      0x83     // Valeur d'argument invalide.
+
+//--------------------------  Canal fiable  ---------------------------------//
+// Les consignes restent des trames sans acquittement (une perte est corrige
+// par la trame suivante). Les critures de paramtres et les chargements de
+// trajectoire peuvent tre encapsuls dans CMD_REL_DATA :
+// - Seq (modulo 256) numrote les trames ; l'hte peut en avoir jusqu'
+//   RS232_REL_WINDOW en vol sans attendre les acquittements.
+// - Les trames en avance sont mmorises et excutes dans l'ordre ds que
+//   le trou est combl ; chaque trame excute produit une rponse.
+// - CumAck = prochain Seq attendu (tous les prcdents sont excuts).
+//   Sack bit i = trame CumAck + 1 + i reue et mmorise.
+// - La rponse de la commande interne (sans son code) suit l'acquittement ;
+//   elle est absente si la trame n'est pas encore excute.
+// - Les temporisateurs de retransmission sont ct hte : une trame sans
+//   rponse est rmise ; une rptition d'une trame dj excute n'est pas
+//   rejoue, la rponse mmorise est renvoye.
+// - CMD_PING et les trames de rponse ne sont pas accepts dans le canal
+//   fiable (CMD_ERR_VALUE) ; en mode multipoint, la diffusion est ignore.
+
+#define RS232_REL_WINDOW      8       // Trames en vol (puissance de 2, <= 8)
+#define RS232_REL_ACK_SIZE    3       // Seq, CumAck, Sack en tte de rponse
+
+#if ((RS232_REL_WINDOW > 8) || ((RS232_REL_WINDOW & (RS232_REL_WINDOW - 1)) != 0))
+#error "RS232_REL_WINDOW doit etre une puissance de 2 inferieure ou egale a 8"
+#endif
+
+//--------------------------  Structures de donnes  --------------------------//
+/**
+ * @brief Structure reprsentant le format d'un message transmis via RS232.
+ *
+ * - Start  : Octet de synchronisation (STX_code).
+ * - Speed  : Valeur de consigne de vitesse.
+ * - Angle  : Valeur de consigne d'angle.
+ * - MsbCrc : Octet de poids fort du code de contrle CRC.
+ * - LsbCrc : Octet de poids faible du code de contrle CRC.
+ */
+typedef struct {
+    uint8_t Start;  // Code de dpart pour synchroniser la rception.
+#if RS232_MULTIDROP
+    uint8_t Addr;   // Adresse du noeud destinataire (ou metteur pour une rponse).
+#endif
+    int8_t  Speed;  // Valeur de consigne de la vitesse.
+    int8_t  Angle;  // Valeur de consigne de l'angle.
+    uint8_t MsbCrc; // Octet de poids fort du CRC pour vrifier l'intgrit des donnes.
+    uint8_t LsbCrc; // Octet de poids faible du CRC.
+} StruMess;
+
+/**
+ * @brief Structure reprsentant une trame de commande (requte ou rponse).
+ */
+typedef struct {
+    uint8_t Start;                  // Code de dpart (STX_CMD_code).
+#if RS232_MULTIDROP
+    uint8_t Addr;                   // Adresse du noeud.
+#endif
+    uint8_t Cmd;                    // Code de commande.
+    uint8_t Len;                    // Nombre d'octets de donnes.
+    uint8_t Data[CMD_PAYLOAD_MAX];  // Donnes de la commande.
+    uint8_t MsbCrc;                 // Octet de poids fort du CRC.
+    uint8_t LsbCrc;                 // Octet de poids faible du CRC.
+} StruCmdMess;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+// L'adresse n'est mise que si RS232_MULTIDROP = 1 (ignore sinon).
+
+/**
+ * @brief Construit une trame de consigne.
+ * @param pFrame Buffer de MESS_SIZE octets.
+ * @param addr   Adresse du noeud.
+ * @param speed  Consigne de vitesse.
+ * @param angle  Consigne d'angle.
+ * @return Taille de la trame (MESS_SIZE).
+ */
+uint8_t GFRAME_EncodeSetpoint(uint8_t *pFrame, uint8_t addr, int8_t speed, int8_t angle);
+
+/**
+ * @brief Construit une trame de commande.
+ * @param pFrame   Buffer de CMD_MESS_SIZE(len) octets.
+ * @param addr     Adresse du noeud.
+ * @param cmd      Code de commande (avec CMD_RESPONSE_FLAG pour une rponse).
+ * @param pPayload Donnes (peut tre NULL si len = 0).
+ * @param len      Nombre d'octets de donnes (<= CMD_PAYLOAD_MAX).
+ * @return Taille de la trame, 0 si longueur invalide.
+ */
+uint8_t GFRAME_EncodeCommand(uint8_t *pFrame, uint8_t addr, uint8_t cmd,
+                             const uint8_t *pPayload, uint8_t len);
+
+/**
+ * @brief Vrifie le CRC16 d'une trame complte (consigne ou commande).
+ * @param pFrame Trame, code de dbut compris.
+ * @param size   Taille totale, CRC compris.
+ * @return 1 si le CRC est correct, 0 sinon.
+ */
+uint8_t GFRAME_CheckCrc(const uint8_t *pFrame, uint8_t size);
+
+#endif // GestFrame_H
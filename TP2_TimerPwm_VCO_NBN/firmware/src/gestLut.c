@@ -0,0 +1,97 @@
+/*--------------------------------------------------------*/
+// GestLut.c
+/*--------------------------------------------------------*/
+//	Description :	Tables de correspondance interpoles
+//			        (64 segments, valuation sans division)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestLut.h"
+
+/**
+ * @brief Construit une table  partir d'une courbe affine par morceaux.
+ *
+ * @param pLut     Table.
+ * @param inMax    Valeur d'entre maximale.
+ * @param pPoints  Points de la courbe.
+ * @param nbPoints Nombre de points.
+ * @return GLUT_OK ou GLUT_ERR_POINTS (table inchange).
+ *
+ * @details Les divisions (64 bits) ne sont faites qu'ici,  l'initialisation
+ *          ou lors d'un changement de configuration. La largeur des segments
+ *          est la plus petite puissance de 2 couvrant inMax en 64 segments.
+ */
+uint8_t GLUT_Build(S_lut *pLut, uint16_t inMax, const S_lutPoint *pPoints, uint8_t nbPoints)
+{
+    uint8_t shift = 0;
+    uint8_t seg = 0;
+    uint8_t i;
+    int32_t x;
+    int32_t dx;
+    int64_t num;
+
+    if (nbPoints < 2) {
+        return GLUT_ERR_POINTS;
+    }
+    for (i = 1; i < nbPoints; i++) {
+        if (pPoints[i].X <= pPoints[i - 1].X) {
+            return GLUT_ERR_POINTS;
+        }
+    }
+
+    while (((uint32_t)GLUT_SEGMENTS << shift) <= inMax) {
+        shift++;
+    }
+    pLut->SegShift = shift;
+
+    for (i = 0; i < GLUT_SIZE; i++)
+    {
+        x = (int32_t)i << shift;
+        // Segment de la courbe contenant x (le premier ou le dernier pour prolonger)
+        while ((seg < (nbPoints - 2)) && (x > pPoints[seg + 1].X)) {
+            seg++;
+        }
+        dx = pPoints[seg + 1].X - pPoints[seg].X;
+        // Mise  l'chelle par multiplication : dcaler  gauche une valeur ngative est indfini en C
+        num = (int64_t)(pPoints[seg + 1].Y - pPoints[seg].Y) * (x - pPoints[seg].X) * (1 << GLUT_FRAC);
+        // Division arrondie  l'entier le plus proche
+        if (num >= 0) {
+            num = (num + (dx / 2)) / dx;
+        } else {
+            num = (num - (dx / 2)) / dx;
+        }
+        pLut->Node[i] = ((int32_t)pPoints[seg].Y * (1 << GLUT_FRAC)) + (int32_t)num;
+    }
+    return GLUT_OK;
+}
+
+/**
+ * @brief value la table.
+ *
+ * @param pLut Table.
+ * @param x    Entre.
+ * @return Sortie interpole, partie entire par dfaut.
+ *
+ * @details Un dcalage, une multiplication 32 x 32 -> 64 bits et deux additions.
+ */
+int32_t GLUT_Eval(const S_lut *pLut, uint16_t x)
+{
+    uint32_t xMax = ((uint32_t)GLUT_SEGMENTS << pLut->SegShift) - 1;
+    uint8_t i;
+    uint32_t frac;
+    int32_t y;
+
+    if (x > xMax) {
+        x = (uint16_t)xMax;
+    }
+    i = x >> pLut->SegShift;
+    frac = x & ((1u << pLut->SegShift) - 1);
+    y = pLut->Node[i] + (int32_t)(((int64_t)(pLut->Node[i + 1] - pLut->Node[i]) * frac) >> pLut->SegShift);
+    // +1 LSB : compense l'arrondi des noeuds, les valeurs entires exactes
+    // (extrmits de la courbe) ne tombent pas sur l'entier infrieur
+    return (y + 1) >> GLUT_FRAC;
+}
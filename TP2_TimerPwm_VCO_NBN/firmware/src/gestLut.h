@@ -0,0 +1,70 @@
+#ifndef GestLut_H
+#define GestLut_H
+
+/*--------------------------------------------------------*/
+// GestLut.h
+/*--------------------------------------------------------*/
+// Description : Tables de correspondance interpoles (mesure ADC -> consigne),
+//               construites  l'initialisation, values sans division
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GLUT_SEGMENTS_BITS  6
+#define GLUT_SEGMENTS       (1 << GLUT_SEGMENTS_BITS)  // 64 segments
+#define GLUT_SIZE           (GLUT_SEGMENTS + 1)        // 65 noeuds
+#define GLUT_FRAC           12                         // Bits fractionnaires des noeuds (|Y| < 2^19)
+
+#define GLUT_OK             0
+#define GLUT_ERR_POINTS     1   // Moins de 2 points ou abscisses non croissantes
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Point de la courbe de rponse (abscisse en pas ADC, ordonne en units de sortie).
+ */
+typedef struct {
+    uint16_t X;
+    int32_t Y;
+} S_lutPoint;
+
+/**
+ * @brief Table de correspondance : noeuds rgulirement espacs de 2^SegShift.
+ */
+typedef struct {
+    int32_t Node[GLUT_SIZE];    // Ordonnes en Q(GLUT_FRAC)
+    uint8_t SegShift;           // log2 de la largeur d'un segment
+} S_lut;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Construit une table  partir d'une courbe affine par morceaux.
+ * @param pLut     Table.
+ * @param inMax    Valeur d'entre maximale (ex. 1023, ou 1023 << n surchantillonn).
+ * @param pPoints  Points de la courbe, abscisses strictement croissantes.
+ * @param nbPoints Nombre de points (>= 2) ; la courbe est prolonge au-del des extrmits.
+ * @return GLUT_OK ou GLUT_ERR_POINTS.
+ */
+uint8_t GLUT_Build(S_lut *pLut, uint16_t inMax, const S_lutPoint *pPoints, uint8_t nbPoints);
+
+/**
+ * @brief value la table par interpolation linaire entre deux noeuds.
+ * @param pLut Table.
+ * @param x    Entre (borne au domaine de la table).
+ * @return Sortie en units des points (partie entire par dfaut).
+ */
+int32_t GLUT_Eval(const S_lut *pLut, uint16_t x);
+
+#endif // GestLut_H
@@ -0,0 +1,114 @@
+/*--------------------------------------------------------*/
+// GestNvm.c
+/*--------------------------------------------------------*/
+//	Description :	Effacement et programmation de la flash programme
+//			        (squence du Family Reference Manual, section 5)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <xc.h>
+#include <stdint.h>
+
+#include "gestNvm.h"
+
+// Oprations NVMCON (NVMOP) avec WREN
+#define GNVM_OP_WORD_PROGRAM  0x4001
+#define GNVM_OP_PAGE_ERASE    0x4004
+
+#define GNVM_CON_WR           0x8000   // Dmarrage de l'opration
+#define GNVM_CON_WREN         0x4000   // Autorisation d'criture
+#define GNVM_CON_ERR_MASK     0x3000   // WRERR | LVDERR
+
+#define GNVM_LVD_DELAY_TICKS  (6 * 40) // 6 us de stabilisation LVD (core timer 40 MHz)
+
+/**
+ * @brief Excute une opration NVM aprs la squence de dverrouillage.
+ *
+ * @param nvmop Opration NVMCON (avec WREN).
+ * @return 0 si OK, 1 si WRERR ou LVDERR.
+ *
+ * @details Les interruptions sont masques pendant la squence de cls qui
+ *          doit tre ininterrompue ; le CPU est ensuite bloqu par le
+ *          contrleur flash jusqu' la fin de l'opration.
+ */
+static uint8_t GNVM_Execute(uint32_t nvmop)
+{
+    uint32_t intStatus;
+    uint32_t start;
+
+    NVMCON = nvmop;
+    start = _CP0_GET_COUNT();
+    while ((_CP0_GET_COUNT() - start) < GNVM_LVD_DELAY_TICKS) {
+        // Attente de la stabilisation du dtecteur de basse tension
+    }
+
+    intStatus = __builtin_disable_interrupts();
+    NVMKEY = 0xAA996655;
+    NVMKEY = 0x556699AA;
+    NVMCONSET = GNVM_CON_WR;
+    if (intStatus & 0x00000001) {
+        __builtin_enable_interrupts();
+    }
+
+    while (NVMCON & GNVM_CON_WR) {
+        // Attente de la fin de l'opration
+    }
+    NVMCONCLR = GNVM_CON_WREN;
+
+    return ((NVMCON & GNVM_CON_ERR_MASK) != 0) ? 1 : 0;
+}
+
+/**
+ * @brief Vrifie qu'une adresse physique est dans la flash programme.
+ */
+static uint8_t GNVM_IsValid(uint32_t physAddr, uint32_t align)
+{
+    return (physAddr >= GNVM_FLASH_BASE) &&
+           (physAddr < (GNVM_FLASH_BASE + GNVM_FLASH_SIZE)) &&
+           ((physAddr & (align - 1)) == 0);
+}
+
+/**
+ * @brief Efface une page de flash.
+ *
+ * @param physAddr Adresse physique, aligne sur GNVM_PAGE_SIZE.
+ * @return 0 si OK, 1 si erreur.
+ */
+uint8_t GNVM_ErasePage(uint32_t physAddr)
+{
+    if (!GNVM_IsValid(physAddr, GNVM_PAGE_SIZE)) {
+        return 1;
+    }
+    NVMADDR = physAddr;
+    return GNVM_Execute(GNVM_OP_PAGE_ERASE);
+}
+
+/**
+ * @brief Programme un mot de 32 bits.
+ *
+ * @param physAddr Adresse physique, aligne sur GNVM_WORD_SIZE.
+ * @param data     Valeur  programmer.
+ * @return 0 si OK, 1 si erreur.
+ */
+uint8_t GNVM_WriteWord(uint32_t physAddr, uint32_t data)
+{
+    if (!GNVM_IsValid(physAddr, GNVM_WORD_SIZE)) {
+        return 1;
+    }
+    NVMADDR = physAddr;
+    NVMDATA = data;
+    return GNVM_Execute(GNVM_OP_WORD_PROGRAM);
+}
+
+/**
+ * @brief Lit un mot de la flash par le segment non cach (KSEG1).
+ *
+ * @param physAddr Adresse physique du mot.
+ * @return Valeur lue.
+ */
+uint32_t GNVM_ReadWord(uint32_t physAddr)
+{
+    return *(volatile uint32_t *)PA_TO_KVA1(physAddr);
+}
@@ -0,0 +1,66 @@
+#ifndef GestNvm_H
+#define GestNvm_H
+
+/*--------------------------------------------------------*/
+// GestNvm.h
+/*--------------------------------------------------------*/
+// Description : Effacement et programmation de la flash programme
+//               (contrleur NVM du PIC32MX795F512L)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GNVM_PAGE_SIZE      4096         // Taille d'une page effaable [octets]
+#define GNVM_WORD_SIZE      4            // Unit de programmation [octets]
+
+#define GNVM_FLASH_BASE     0x1D000000   // Adresse physique de la flash programme
+#define GNVM_FLASH_SIZE     0x00080000   // 512 ko
+#define GNVM_KSEG0(physAddr) ((physAddr) | 0x80000000) // Adresse virtuelle (KSEG0)
+
+// Rservation d'une zone efface ou programme  l'excution : tableau non
+// charg (noload)  adresse fixe. L'diteur de liens retire la zone de
+// kseg0_program_mem, aucun code ni constante ne peut y tre plac ; la
+// rservation choue  l'dition des liens si l'application la chevauche.
+#if defined(__XC32)
+#define GNVM_RESERVE(name, physAddr, size) \
+    const uint8_t name[size] __attribute__((space(prog), address(GNVM_KSEG0(physAddr)), noload, keep))
+#else
+#define GNVM_RESERVE(name, physAddr, size) extern const uint8_t name[size]
+#endif
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+// Les adresses sont physiques (KVA_TO_PA) et alignes sur la page ou le mot.
+// Retour : 0 si OK, 1 si erreur (adresse invalide, WRERR ou LVDERR).
+
+/**
+ * @brief Efface une page de flash (environ 20 ms, CPU bloqu).
+ * @param physAddr Adresse physique du dbut de la page.
+ * @return 0 si OK, 1 si erreur.
+ */
+uint8_t GNVM_ErasePage(uint32_t physAddr);
+
+/**
+ * @brief Programme un mot de 32 bits (environ 20 us, CPU bloqu).
+ * @param physAddr Adresse physique du mot (effac au pralable).
+ * @param data     Valeur  programmer.
+ * @return 0 si OK, 1 si erreur.
+ */
+uint8_t GNVM_WriteWord(uint32_t physAddr, uint32_t data);
+
+/**
+ * @brief Lit un mot de la flash (accs non cach).
+ * @param physAddr Adresse physique du mot.
+ * @return Valeur lue.
+ */
+uint32_t GNVM_ReadWord(uint32_t physAddr);
+
+#endif // GestNvm_H
@@ -21,12 +21,45 @@
 // --------------- Inclusions supplmentaires ---------------
 // (cran LCD, ADC, etc.)
 #include "Mc32DriverLcd.h"          // Pilote pour cran LCD
-#include "Mc32DriverAdc.h"          // Pilote pour ADC
 #include "gestPWM.h"                // gestion des pwm
+#include "gestParam.h"              // Paramtres rglables  l'excution
+#include "gestAdc.h"                // Acquisition ADC sous interruption
+#include "gestFilter.h"             // Filtres des mesures ADC
+#include "gestLut.h"                // Tables mesure -> consigne
+#include "gestCal.h"                // Calibration des potentiomtres
 #include "peripheral/oc/plib_oc.h"  // Pilote pour Output Compare
 
 S_pwmSettings PWMData;  // pour les settings
 
+static uint32_t applyStamp; // Instant (core timer) de la dernire application des consignes
+/**
+ * @brief Canal ADC trait par le banc de filtres de GPWM_GetSettings.
+ */
+typedef struct {
+    uint8_t AdcChan;   // Canal de gestAdc
+    uint16_t InMax;    // Pleine chelle de la mesure (10 bits)
+    int32_t Scale;     // Pleine chelle de la sortie
+    int32_t Offset;    // Dcalage de la sortie
+} S_adcChanDef;
+
+// Canaux mesurs : ajouter un canal = une ligne (et son entre dans gestAdc)
+static const S_adcChanDef adcChanDefs[GPWM_NB_ADC_CHAN] = {
+    { GADC_CHAN_SPEED, ADC1_MAX, ADC1_VALUE_MAX, -(ADC1_VALUE_MAX / 2) },  // Vitesse signe (-99  +99)
+    { GADC_CHAN_ANGLE, ADC2_MAX, ADC2_ANGLE_MAX * ADC2_ANGLE_FRAC, 0 },    // Angle en 1/256 de degr (0  180)
+};
+
+static uint16_t rawAdc[GPWM_NB_ADC_CHAN];  // Dernires mesures brutes, pour la tlmtrie
+static S_lut adcMaps[GPWM_NB_ADC_CHAN];    // Tables de adcChanDefs  l'chelle du surchantillonnage
+
+// Coefficient OC3 (Q32) : largeur = oc3Min + ((angle * gain) >> 32), recalcul si les bornes changent
+static uint16_t oc3MinUsed = 0;
+static uint16_t oc3MaxUsed = 0;
+static uint32_t oc3Gain = 0;
+
+#if (ADC_SAMPLING_SIZE > GFILT_BOXCAR_MAX)
+#error "ADC_SAMPLING_SIZE depasse la longueur max. de la moyenne glissante"
+#endif
+
 /**
  * @brief Initialise les paramtres et l'tat pour le module PWM.
  * @author LMS - VCO
@@ -60,6 +93,75 @@ void GPWM_Initialize(S_pwmSettings *pData)
     DRV_OC1_Start(); // Output Compare N1 = OC3
 }
 
+/**
+ * @brief Hystrsis : la valeur retenue ne suit la mesure que si l'cart dpasse la bande.
+ *
+ * @param value Nouvelle valeur.
+ * @param held  Valeur retenue.
+ * @param band  Demi-largeur de la bande (0 = sans effet).
+ * @param min   Borne basse de la plage (toujours atteinte).
+ * @param max   Borne haute de la plage (toujours atteinte).
+ * @return Nouvelle valeur retenue.
+ */
+static int32_t GPWM_Hysteresis(int32_t value, int32_t held, int32_t band, int32_t min, int32_t max)
+{
+    if ((value > (held + band)) || (value < (held - band)) || (value <= min) || (value >= max)) {
+        return value;
+    }
+    return held;
+}
+
+/**
+ * @brief Construit la table d'un canal  partir de sa calibration.
+ *
+ * @param ch     Canal de adcChanDefs.
+ * @param osBits Bits de surchantillonnage (chelle des abscisses).
+ *
+ * @details Sans calibration : droite de 0  InMax (comportement d'origine).
+ *          Avec calibration : Offset  la bute basse, milieu de la plage au
+ *          point milieu, Offset + Scale  la bute haute, saturation au-del.
+ */
+static void GPWM_BuildMap(uint8_t ch, uint8_t osBits)
+{
+    const S_adcChanDef *pDef = &adcChanDefs[ch];
+    S_lutPoint curve[5];
+    S_calChan cal;
+    uint16_t inMax = pDef->InMax << osBits;
+    uint8_t n = 0;
+
+    if (!GCAL_Get(pDef->AdcChan, &cal))
+    {
+        curve[0].X = 0;
+        curve[0].Y = pDef->Offset;
+        curve[1].X = inMax;
+        curve[1].Y = pDef->Offset + pDef->Scale;
+        n = 2;
+    }
+    else
+    {
+        if (cal.Min > 0) {
+            curve[n].X = 0;
+            curve[n].Y = pDef->Offset;
+            n++;
+        }
+        curve[n].X = cal.Min << osBits;
+        curve[n].Y = pDef->Offset;
+        n++;
+        curve[n].X = cal.Center << osBits;
+        curve[n].Y = pDef->Offset + (pDef->Scale / 2);
+        n++;
+        curve[n].X = cal.Max << osBits;
+        curve[n].Y = pDef->Offset + pDef->Scale;
+        n++;
+        if (cal.Max < pDef->InMax) {
+            curve[n].X = inMax;
+            curve[n].Y = pDef->Offset + pDef->Scale;
+            n++;
+        }
+    }
+    GLUT_Build(&adcMaps[ch], inMax, curve, n);
+}
+
 /**
  * @brief Lit les paramtres PWM  partir des valeurs des ADC (moyennes glissantes).
  * @author LMS - VCO
@@ -67,50 +169,107 @@ void GPWM_Initialize(S_pwmSettings *pData)
  *
  * @param pData Pointeur vers une structure S_pwmSettings pour stocker les paramtres calculs.
  *
- * @details Cette fonction lit les rsultats bruts des ADC, calcule les moyennes glissantes
- *          pour les canaux spcifis, et met  jour les rglages de vitesse et d'angle
+ * @details Cette fonction lit les mesures des canaux de adcChanDefs, les filtre et les met
+ *           l'chelle en un passage du banc de filtres (moyenne glissante, EMA ou biquad
+ *          selon PARAM_ID_ADC_FILTER), puis met  jour les rglages de vitesse et d'angle
  *          dans la structure `pData`.
  */
 void GPWM_GetSettings(S_pwmSettings *pData) 
 {
-    // Buffers circulaires pour les valeurs ADC du canal 1 (statique pour conserver les donnes entre appels)
-    static uint16_t adc1Values[ADC_SAMPLING_SIZE] = {0}; // Stocke les dernires valeurs ADC du canal 1
-    static uint32_t adc1Sum = 0; // Somme des valeurs dans le buffer circulaire du canal 1
-    // Buffers circulaires pour les valeurs ADC du canal 2 (statique pour conserver les donnes entre appels)
-    static uint16_t adc2Values[ADC_SAMPLING_SIZE] = {0}; // Stocke les dernires valeurs ADC du canal 2
-    static uint32_t adc2Sum = 0; // Somme des valeurs dans le buffer circulaire du canal 2
-    // Index statique pour suivre la position actuelle dans les buffers circulaires
-    static uint8_t index = 0;
+    // Banc de filtres des canaux de adcChanDefs (type, rglage et chelle au cycle prcdent)
+    static S_filterBank adcBank;
+    static E_filterType filterType = GFILT_TYPE_NB; // Forcer l'initialisation au premier appel
+    static uint8_t filterParam = 0;
+    static uint8_t osBits = 0; // Bits supplmentaires par surchantillonnage
+    E_filterType newFilterType;
+    uint8_t newFilterParam;
+    uint8_t newOsBits;
+    S_filterChanCfg cfg;
+    static uint8_t calRevision = 0; // Calibration utilise pour les tables
+    uint16_t adcIn[GPWM_NB_ADC_CHAN];
+    int32_t adcOut[GPWM_NB_ADC_CHAN];
+    S_adcSnapshot adcSnap;
+    uint32_t angleFine;
+    uint8_t ch;
 
     // Variables intermdiaires pour le traitement
-    static uint32_t avgAdc1 = 0; // Moyenne glissante pour le canal 1
-    static uint32_t avgAdc2 = 0; // Moyenne glissante pour le canal 2
     static int16_t speedSigned = 0; // Vitesse signe calcule  partir du canal 1
     static uint8_t speedAbsolute = 0; // Vitesse absolue calcule  partir de speedSigned
     static uint8_t angle = 0; // Angle calcul  partir du canal 2
+    static int32_t speedHeld = 0; // Vitesse retenue par l'hystrsis
+    static int32_t angleHeld = 0; // Angle (1/ADC2_ANGLE_FRAC de degr) retenu par l'hystrsis
 
-    // Lecture des valeurs brutes des ADC  partir du matriel
-    S_ADCResults adcResults = BSP_ReadAllADC(); // Rcupre les dernires mesures des canaux ADC
+    // Lecture des mesures ADC : moyenne des chantillons acquis sous interruption
+    // depuis le cycle prcdent (cadence fixe, sans attente du convertisseur),
+    // ou dcimation de 4^n chantillons sur 10 + n bits
+    GADC_SetTrigger((uint8_t)GPARAM_Get(PARAM_ID_ADC_SYNC),
+                    (uint8_t)GPARAM_Get(PARAM_ID_ADC_SYNC_DELAY)); // Libre ou synchronis sur la PWM
+    GADC_SetMedian((uint8_t)GPARAM_Get(PARAM_ID_ADC_MEDIAN)); // Rejet des pics avant moyenne
+    newOsBits = (uint8_t)GPARAM_Get(PARAM_ID_ADC_OVERSAMPLE);
+    GADC_GetLatestSeq(&adcSnap); // Mesures brutes d'un mme balayage, pour la tlmtrie
+    for (ch = 0; ch < GPWM_NB_ADC_CHAN; ch++)
+    {
+        rawAdc[ch] = adcSnap.Sample[adcChanDefs[ch].AdcChan];
+        if (newOsBits == 0) {
+            adcIn[ch] = GADC_GetMean(adcChanDefs[ch].AdcChan);
+        } else {
+            adcIn[ch] = GADC_GetOversampled(adcChanDefs[ch].AdcChan, newOsBits);
+        }
+        GCAL_Capture(adcChanDefs[ch].AdcChan, adcIn[ch] >> newOsBits); // Butes (si capture en cours)
+    }
 
-    // Mise  jour des buffers circulaires pour le canal 1
-    adc1Sum = adc1Sum - adc1Values[index]; // Retire la plus ancienne valeur de la somme
-    adc1Values[index] = adcResults.Chan0; // Ajoute la nouvelle valeur dans le buffer
-    adc1Sum = adc1Sum + adc1Values[index]; // Ajoute la nouvelle valeur  la somme
+    // Choix du filtre : moyenne glissante (longueur rglable) ou EMA (k rglable)
+    newFilterType = (E_filterType)GPARAM_Get(PARAM_ID_ADC_FILTER);
+    if (newFilterType == GFILT_TYPE_EMA) {
+        newFilterParam = (uint8_t)GPARAM_Get(PARAM_ID_ADC_EMA_SHIFT);
+    } else {
+        newFilterParam = (uint8_t)GPARAM_Get(PARAM_ID_ADC_SAMPLING_SIZE);
+    }
 
-    // Mise  jour des buffers circulaires pour le canal 2
-    adc2Sum = adc2Sum - adc2Values[index]; // Retire la plus ancienne valeur de la somme
-    adc2Values[index] = adcResults.Chan1; // Ajoute la nouvelle valeur dans le buffer
-    adc2Sum = adc2Sum + adc2Values[index]; // Ajoute la nouvelle valeur  la somme
+    // Changement de filtre ou d'chelle => redmarrage sur la mesure courante (sans transitoire)
+    // et reconstruction des tables (la pleine chelle vaut InMax << osBits avec le surchantillonnage)
+    if ((newFilterType != filterType) || (newFilterParam != filterParam) || (newOsBits != osBits) ||
+        (GCAL_GetRevision() != calRevision))
+    {
+        filterType = newFilterType;
+        filterParam = newFilterParam;
+        osBits = newOsBits;
+        calRevision = GCAL_GetRevision();
+        GFILT_BankInit(&adcBank, GPWM_NB_ADC_CHAN);
+        for (ch = 0; ch < GPWM_NB_ADC_CHAN; ch++)
+        {
+            GPWM_BuildMap(ch, osBits);
 
-    // Incrmentation de l'index et gestion du dbordement
-    index = (index + 1) % ADC_SAMPLING_SIZE; // Passe  l'emplacement suivant dans le buffer circulaire
+            cfg.Type = filterType;
+            cfg.Param = filterParam;
+            cfg.pMap = &adcMaps[ch];
+            GFILT_BankConfig(&adcBank, ch, &cfg, adcIn[ch]);
+        }
+    }
 
-    // Calcul des moyennes glissantes
-    avgAdc1 = adc1Sum / ADC_SAMPLING_SIZE; // Moyenne glissante des valeurs ADC pour le canal 1
-    avgAdc2 = adc2Sum / ADC_SAMPLING_SIZE; // Moyenne glissante des valeurs ADC pour le canal 2
+    // Filtrage et mise  l'chelle de tous les canaux (tables interpoles, sans division)
+    GFILT_BankProcess(&adcBank, adcIn, adcOut);
 
-    // Conversion des donnes ADC du canal 1 en une vitesse signe
-    speedSigned = ((avgAdc1 * ADC1_VALUE_MAX) / ADC1_MAX) - (ADC1_VALUE_MAX / 2); // Centre les valeurs autour de 0
+    // Vitesse signe, centre autour de 0 par l'offset du canal
+    // Hystrsis : le bruit de 1 pas ne modifie plus les consignes
+    speedHeld = GPWM_Hysteresis(adcOut[GPWM_ADC_SPEED], speedHeld,
+                                GPARAM_Get(PARAM_ID_SPEED_HYST),
+                                -(ADC1_VALUE_MAX / 2), ADC1_VALUE_MAX / 2);
+    angleHeld = GPWM_Hysteresis(adcOut[GPWM_ADC_ANGLE], angleHeld,
+                                GPARAM_Get(PARAM_ID_ANGLE_HYST) * ADC2_ANGLE_FRAC,
+                                0, ADC2_ANGLE_MAX * ADC2_ANGLE_FRAC);
+    speedSigned = speedHeld;
+
+    // Zone morte : moteur rellement arrt autour du point milieu
+    if ((speedSigned <= GPARAM_Get(PARAM_ID_SPEED_DEADBAND)) &&
+        (speedSigned >= -GPARAM_Get(PARAM_ID_SPEED_DEADBAND))) {
+        speedSigned = 0;
+    }
+
+    // Capture de calibration : les potentiomtres sont amens en bute, moteur arrt
+    if (GCAL_IsCapturing()) {
+        speedSigned = 0;
+    }
 
     // Calcul de la vitesse absolue
     if (speedSigned < 0) {
@@ -119,13 +278,21 @@ void GPWM_GetSettings(S_pwmSettings *pData)
         speedAbsolute = speedSigned; // Sinon, on garde la valeur telle quelle
     }
 
+    // Angle absolu en 1/ADC2_ANGLE_FRAC de degr
+    // La fraction de degr conserve la rsolution de la mesure pour la PWM servo
+    angleFine = angleHeld;
+    angle = angleFine / ADC2_ANGLE_FRAC; // chelle la valeur entre 0 et 180
+
+    // Indicateur de modification pour les tapes suivantes
+    pData->Changed = (pData->SpeedSetting != speedSigned) || (pData->absAngle != angle) ||
+                     (pData->AngleFrac != (angleFine % ADC2_ANGLE_FRAC));
+
     // Mise  jour de la structure avec les valeurs calcules pour la vitesse
     pData->SpeedSetting = speedSigned; // Met  jour la vitesse signe (-99  +99)
     pData->absSpeed = speedAbsolute;   // Met  jour la vitesse absolue (0  99)
 
-    // Conversion des donnes ADC du canal 2 en un angle absolu
-    angle = (avgAdc2 * ADC2_ANGLE_MAX) / ADC2_MAX; // chelle la valeur entre 0 et 180
     pData->absAngle = angle; // Met  jour l'angle absolu (0  180 degrs)
+    pData->AngleFrac = angleFine % ADC2_ANGLE_FRAC;
     pData->AngleSetting = angle-90;
 }
 
@@ -144,16 +311,24 @@ void GPWM_GetSettings(S_pwmSettings *pData)
  */
 void GPWM_DispSettings(S_pwmSettings *pData, int remote)
 {
+    static int lastRemote = -1; // Mode affich (-1 = cran jamais rempli)
+
+    // Rien n'a chang => l'cran n'est pas rcrit
+    if (!pData->Changed && (remote == lastRemote)) {
+        return;
+    }
+    lastRemote = remote;
 
     lcd_gotoxy(1, 1);
     // Affiche si les paramtres sont locaux ou distants
+    // (titres de mme largeur : l'cran n'est plus effac, le nouveau recouvre l'ancien)
     if (remote == 1) 
     {
         printf_lcd("Remote Settings");
     } 
     else 
     {
-        printf_lcd("Local Settings");
+        printf_lcd("Local Settings ");
     }
     lcd_gotoxy(1, 2); // Place le curseur pour le texte statique
     printf_lcd("Speed:"); // Affiche l'tiquette "Speed"
@@ -215,6 +390,18 @@ void GPWM_ExecPWM(S_pwmSettings *pData)
     // Variables pour les largeurs d'impulsion PWM
     static uint16_t PulseWidthOC2;
     static uint16_t PulseWidthOC3;
+    // Bornes OC3 lues dans le registre de paramtres
+    uint16_t oc3Min = (uint16_t)GPARAM_Get(PARAM_ID_PWM_OC3_MIN);
+    uint16_t oc3Max = (uint16_t)GPARAM_Get(PARAM_ID_PWM_OC3_MAX);
+    static const S_pwmSettings *pLastApplied = 0; // Consignes appliques au dernier appel
+
+    // Mmes consignes, inchanges, mmes bornes OC3 => registres dj  jour
+    if (!pData->Changed && (pData == pLastApplied) && (oc3Min == oc3MinUsed) && (oc3Max == oc3MaxUsed))
+    {
+        applyStamp = _CP0_GET_COUNT();
+        return;
+    }
+    pLastApplied = pData;
 
     // Contrle de l'tat du pont en H en fonction de la vitesse
     if (pData->SpeedSetting < 0)
@@ -237,12 +424,62 @@ void GPWM_ExecPWM(S_pwmSettings *pData)
     }
 
     // Calcul de la largeur d'impulsion pour OC2 (PWM pour la vitesse)
-    PulseWidthOC2 = pData->absSpeed * PWM_OC2_SCALE; // tape 1 : Multiplie par l'chelle 125
-    PulseWidthOC2 = PulseWidthOC2 / PWM_OC2_DIV;   // tape 2 : Divise par 99 pour normaliser (0%  100%)
+    // absSpeed * 125 / 99 (0%  100%), division remplace par l'inverse en Q16
+    PulseWidthOC2 = ((uint32_t)pData->absSpeed * PWM_OC2_RECIP) >> 16;
     PLIB_OC_PulseWidth16BitSet(OC_ID_2, PulseWidthOC2); // Applique la largeur calcule  OC2
 
     // Calcul de la largeur d'impulsion pour OC3 (PWM pour l'angle)
-    PulseWidthOC3 = ((pData->absAngle * (PWM_OC3_MAX - PWM_OC3_MIN)) / PWM_OC3_DIV) + PWM_OC3_MIN; // 0.6 ms  2.4 ms
+    // (angle en 1/ADC2_ANGLE_FRAC de degr : ~2250 pas au lieu de 180 en mode local)
+    // La division n'est faite qu'au changement des bornes ; le gain arrondi par
+    // excs en Q32 donne le mme rsultat que angle * (max - min) / (180 * 256).
+    if ((oc3Min != oc3MinUsed) || (oc3Max != oc3MaxUsed))
+    {
+        oc3Gain = (uint32_t)((((uint64_t)(oc3Max - oc3Min) << 32) + (PWM_OC3_DIV * ADC2_ANGLE_FRAC) - 1)
+                             / (PWM_OC3_DIV * ADC2_ANGLE_FRAC));
+        oc3MinUsed = oc3Min;
+        oc3MaxUsed = oc3Max;
+    }
+    PulseWidthOC3 = (uint16_t)(((uint64_t)(((uint32_t)pData->absAngle * ADC2_ANGLE_FRAC) + pData->AngleFrac)
+                                * oc3Gain) >> 32) + oc3Min; // 0.6 ms  2.4 ms par dfaut
     PLIB_OC_PulseWidth16BitSet(OC_ID_3, PulseWidthOC3); // Applique la largeur calcule  OC3
+
+    // Horodatage de l'application (mesure de latence, commande ping)
+    applyStamp = _CP0_GET_COUNT();
+}
+
+/**
+ * @brief Retourne l'instant de la dernire application des consignes PWM.
+ *
+ * @return Valeur du core timer (SYS_CLK / 2) releve  la fin de GPWM_ExecPWM.
+ */
+uint32_t GPWM_GetApplyStamp(void)
+{
+    return applyStamp;
+}
+
+/**
+ * @brief Angle absolu d'une consigne reue.
+ *
+ * @param angle Consigne signe (-90  +90).
+ * @return abs(angle - 90) : mme position du servo pour une consigne reue en
+ *         trame ou en point de trajectoire.
+ */
+uint8_t GPWM_RemoteAbsAngle(int16_t angle)
+{
+    return (uint8_t)abs(angle - ADC2_ANGLE_OFFSET);
+}
+
+/**
+ * @brief Retourne la dernire mesure brute d'un canal ADC.
+ *
+ * @param chan Canal (0 ou 1).
+ * @return Valeur brute lue au dernier appel de GPWM_GetSettings.
+ */
+uint16_t GPWM_GetRawAdc(uint8_t chan)
+{
+    if (chan >= GPWM_NB_ADC_CHAN) {
+        return 0;
+    }
+    return rawAdc[chan];
 }
 
@@ -32,14 +32,31 @@
 #define ADC2_MAX 1023         // Rsolution maximale de l'ADC (10 bits)
 #define ADC2_ANGLE_MAX 180    // Plage angulaire (0  180)
 #define ADC2_ANGLE_OFFSET 90  // Dcalage pour angle (-90  +90)
+#define ADC2_ANGLE_FRAC 256   // Subdivisions d'un degr (AngleFrac), mesures surchantillonnes
+
+// Canaux du banc de filtres ADC (indices de adcChanDefs dans gestPWM.c)
+#define GPWM_NB_ADC_CHAN 2
+#define GPWM_ADC_SPEED 0      // Vitesse
+#define GPWM_ADC_ANGLE 1      // Angle
 
 // Gestions des Output compare 
 #define PWM_OC2_SCALE 125    // chelle pour le calcul de la largeur d'impulsion OC2
 #define PWM_OC2_DIV 99       // Diviseur pour normaliser la largeur d'impulsion OC2
+// Inverse de PWM_OC2_DIV en Q16, arrondi par excs : (v * RECIP) >> 16 = v / 99 pour v <= 99 * 125
+#define PWM_OC2_RECIP (((PWM_OC2_SCALE << 16) + PWM_OC2_DIV - 1) / PWM_OC2_DIV)
 
 #define PWM_OC3_MIN 749      // Valeur minimale pour la largeur d'impulsion OC3
 #define PWM_OC3_MAX 2999     // Valeur maximale pour la largeur d'impulsion OC3
 #define PWM_OC3_DIV 180      // Diviseur pour normaliser la largeur d'impulsion OC3
+#define PWM_TMR3_PERIOD 8749 // Priode du timer 3 (limite haute de la largeur OC3)
+
+// Bornes des rglages anti-scintillement (registre de paramtres)
+#define PWM_SPEED_DEADBAND_MAX 20  // Zone morte de vitesse autour de 0 (pas de vitesse)
+#define PWM_HYST_MAX 10            // Hystrsis de vitesse (pas) ou d'angle (degrs)
+
+// Les valeurs ADC_SAMPLING_SIZE et PWM_OC3_MIN/MAX sont les valeurs par dfaut
+// du registre de paramtres (gestParam) ; ADC_SAMPLING_SIZE fixe aussi la taille
+// maximale des buffers de moyenne glissante.
 /*--------------------------------------------------------*/
 // Dfinition de la structure S_pwmSettings
 /*--------------------------------------------------------*/
@@ -52,6 +69,8 @@ typedef struct {
     uint8_t absAngle;    // Angle absolu (0  180)
     int8_t SpeedSetting; // Consigne de vitesse (-99  +99)
     int8_t AngleSetting; // Consigne de vitesse (-99  +99)
+    uint8_t AngleFrac;   // Fraction de degr de absAngle (1/ADC2_ANGLE_FRAC), 0 pour les consignes reues
+    uint8_t Changed;     // 1 = consignes modifies par le dernier cycle (PWM, affichage et envoi non refaits sinon)
 } S_pwmSettings;
 
 /*--------------------------------------------------------*/
@@ -82,4 +101,24 @@ void GPWM_DispSettings(S_pwmSettings *pData, int remote);
  */
 void GPWM_ExecPWM(S_pwmSettings *pData);
 
+/**
+ * @brief Retourne l'instant (core timer) de la dernire mise  jour des registres OC.
+ * @return Valeur du core timer mmorise  la fin de GPWM_ExecPWM.
+ */
+uint32_t GPWM_GetApplyStamp(void);
+
+/**
+ * @brief Angle absolu d'une consigne reue (trame, trajectoire, restitution).
+ * @param angle Consigne signe (-90  +90).
+ * @return Angle absolu (0  180), convention de GetMessage.
+ */
+uint8_t GPWM_RemoteAbsAngle(int16_t angle);
+
+/**
+ * @brief Retourne la dernire mesure brute d'un canal ADC lue par GPWM_GetSettings.
+ * @param chan Canal (GPWM_ADC_SPEED ou GPWM_ADC_ANGLE).
+ * @return Valeur brute 10 bits.
+ */
+uint16_t GPWM_GetRawAdc(uint8_t chan);
+
 #endif // GestPWM_H
@@ -0,0 +1,106 @@
+/*--------------------------------------------------------*/
+// GestParam.c
+/*--------------------------------------------------------*/
+//	Description :	Registre des paramtres rglables  l'excution
+//			        (filtre ADC, PWM, communication)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestParam.h"
+#include "gestPWM.h"             // Valeurs par dfaut PWM / ADC
+#include "Mc32gest_RS232.h"      // Valeurs par dfaut communication
+#include "gestPlayout.h"         // Plages du buffer de restitution
+#include "gestTelem.h"           // Modes de tlmtrie
+#include "gestFilter.h"          // Types de filtre ADC
+#include "gestAdc.h"             // Surchantillonnage maximal, dclenchement ADC
+
+// Registre des paramtres (valeur, min, max), index par E_paramId
+static S_param paramTable[PARAM_NB];
+
+/**
+ * @brief Charge les valeurs par dfaut dans le registre des paramtres.
+ *
+ * @details Les valeurs par dfaut sont les constantes de compilation d'origine ;
+ *          sans commande d'criture le comportement est donc inchang.
+ */
+void GPARAM_Initialize(void)
+{
+    paramTable[PARAM_ID_ADC_SAMPLING_SIZE] = (S_param){ ADC_SAMPLING_SIZE, 1, ADC_SAMPLING_SIZE };
+    paramTable[PARAM_ID_PWM_OC3_MIN]       = (S_param){ PWM_OC3_MIN, 0, PWM_TMR3_PERIOD };
+    paramTable[PARAM_ID_PWM_OC3_MAX]       = (S_param){ PWM_OC3_MAX, 0, PWM_TMR3_PERIOD };
+    paramTable[PARAM_ID_COMM_TIMEOUT]      = (S_param){ COMM_TIMEOUT_ITERATION, 1, 255 };
+#if RS232_MULTIDROP
+    // Bus multipoint : l'tat n'est mis qu'en rponse  une interrogation, sans attente
+    paramTable[PARAM_ID_SEND_DIVIDER]      = (S_param){ 0, 0, 100 };
+#else
+    paramTable[PARAM_ID_SEND_DIVIDER]      = (S_param){ SEND_DIVIDER, 0, 100 };
+#endif
+    paramTable[PARAM_ID_NODE_ADDRESS]      = (S_param){ RS232_NODE_ADDRESS, 0, RS232_ADDR_BROADCAST - 1 };
+    paramTable[PARAM_ID_PLAYOUT_DELAY]     = (S_param){ 0, 0, GPLAY_DELAY_MAX };
+    paramTable[PARAM_ID_PLAYOUT_ORDER]     = (S_param){ GPLAY_ORDER_LINEAR, GPLAY_ORDER_STEP, GPLAY_ORDER_CUBIC };
+#if RS232_MULTIDROP
+    // Bus multipoint : la tlmtrie serait mise sans interrogation, elle reste  l'arrt
+    paramTable[PARAM_ID_TELEM_MODE]        = (S_param){ GTELEM_MODE_OFF, GTELEM_MODE_OFF, GTELEM_MODE_OFF };
+#else
+    paramTable[PARAM_ID_TELEM_MODE]        = (S_param){ GTELEM_MODE_OFF, GTELEM_MODE_OFF, GTELEM_MODE_RLE };
+#endif
+    paramTable[PARAM_ID_ADC_FILTER]        = (S_param){ GFILT_TYPE_BOXCAR, GFILT_TYPE_BOXCAR, GFILT_TYPE_NB - 1 };
+    paramTable[PARAM_ID_ADC_EMA_SHIFT]     = (S_param){ GFILT_EMA_SHIFT, GFILT_EMA_SHIFT_MIN, GFILT_EMA_SHIFT_MAX };
+    paramTable[PARAM_ID_ADC_OVERSAMPLE]    = (S_param){ 0, 0, GADC_OVERSAMPLE_MAX };
+    paramTable[PARAM_ID_ADC_MEDIAN]        = (S_param){ 0, 0, GFILT_MEDIAN_MAX };
+    paramTable[PARAM_ID_SPEED_DEADBAND]    = (S_param){ 0, 0, PWM_SPEED_DEADBAND_MAX };
+    paramTable[PARAM_ID_SPEED_HYST]        = (S_param){ 0, 0, PWM_HYST_MAX };
+    paramTable[PARAM_ID_ANGLE_HYST]        = (S_param){ 0, 0, PWM_HYST_MAX };
+    paramTable[PARAM_ID_ADC_SYNC]          = (S_param){ GADC_MODE_FREE, GADC_MODE_FREE, GADC_MODE_PWM_SYNC };
+    paramTable[PARAM_ID_ADC_SYNC_DELAY]    = (S_param){ GADC_SYNC_SAMC, GADC_SYNC_SAMC_MIN, GADC_SYNC_SAMC_MAX };
+}
+
+/**
+ * @brief Retourne la valeur courante d'un paramtre.
+ *
+ * @param id Identifiant du paramtre.
+ * @return Valeur courante du paramtre.
+ */
+int16_t GPARAM_Get(E_paramId id)
+{
+    return paramTable[id].Value;
+}
+
+/**
+ * @brief Modifie un paramtre si l'identifiant et la valeur sont valides.
+ *
+ * @param id    Identifiant du paramtre (octet reu, vrifi ici).
+ * @param value Valeur demande.
+ * @return PARAM_OK si accept, PARAM_ERR_ID ou PARAM_ERR_RANGE sinon.
+ *
+ * @details En plus de la plage propre  chaque paramtre, la cohrence
+ *          OC3 min < OC3 max est garantie et la mdiane n'accepte que
+ *          0, 3 ou 5 points (GFILT_MedianInit ramnerait sinon la longueur).
+ */
+uint8_t GPARAM_Set(uint8_t id, int16_t value)
+{
+    if (id >= PARAM_NB) {
+        return PARAM_ERR_ID;
+    }
+    if ((value < paramTable[id].Min) || (value > paramTable[id].Max)) {
+        return PARAM_ERR_RANGE;
+    }
+    // Contrle de cohrence des bornes OC3
+    if ((id == PARAM_ID_PWM_OC3_MIN) && (value >= paramTable[PARAM_ID_PWM_OC3_MAX].Value)) {
+        return PARAM_ERR_RANGE;
+    }
+    if ((id == PARAM_ID_PWM_OC3_MAX) && (value <= paramTable[PARAM_ID_PWM_OC3_MIN].Value)) {
+        return PARAM_ERR_RANGE;
+    }
+    // Longueurs de mdiane rellement appliques
+    if ((id == PARAM_ID_ADC_MEDIAN) && (value != 0) && (value != 3) && (value != 5)) {
+        return PARAM_ERR_RANGE;
+    }
+
+    paramTable[id].Value = value;
+    return PARAM_OK;
+}
@@ -0,0 +1,92 @@
+#ifndef GestParam_H
+#define GestParam_H
+
+/*--------------------------------------------------------*/
+// GestParam.h
+/*--------------------------------------------------------*/
+// Description : Registre des paramtres rglables  l'excution
+//               (lecture/criture par identifiant via RS232)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+/*--------------------------------------------------------*/
+// Identifiants des paramtres
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Identifiants des paramtres du registre.
+ *
+ * L'identifiant est l'octet transmis dans les commandes de lecture/criture.
+ * Ne pas rordonner : les valeurs font partie du protocole.
+ */
+typedef enum {
+    PARAM_ID_ADC_SAMPLING_SIZE = 0, // Longueur de la moyenne glissante ADC
+    PARAM_ID_PWM_OC3_MIN,           // Largeur d'impulsion OC3 minimale (angle 0)
+    PARAM_ID_PWM_OC3_MAX,           // Largeur d'impulsion OC3 maximale (angle 180)
+    PARAM_ID_COMM_TIMEOUT,          // Itrations sans message avant retour en local
+    PARAM_ID_SEND_DIVIDER,          // Nb d'itrations entre deux envois (APP_Tasks)
+    PARAM_ID_NODE_ADDRESS,          // Adresse du noeud sur le bus multipoint
+    PARAM_ID_PLAYOUT_DELAY,         // Retard de restitution des consignes remote (priodes Timer 4, 0 = direct)
+    PARAM_ID_PLAYOUT_ORDER,         // Interpolation : 0 = paliers, 1 = linaire, 2 = spline cubique
+    PARAM_ID_TELEM_MODE,            // Tlmtrie : 0 = arrt, 1 = brut, 2 = delta, 3 = delta + RLE (0 en multipoint)
+    PARAM_ID_ADC_FILTER,            // Filtre ADC : 0 = moyenne glissante, 1 = EMA, 2 = biquad
+    PARAM_ID_ADC_EMA_SHIFT,         // EMA : coefficient alpha = 1 / 2^k
+    PARAM_ID_ADC_OVERSAMPLE,        // Surchantillonnage : 4^n chantillons => 10 + n bits (0 = moyenne par cycle)
+    PARAM_ID_ADC_MEDIAN,            // Mdiane glissante avant moyenne : 0 = sans, 3 ou 5 points
+    PARAM_ID_SPEED_DEADBAND,        // Vitesse locale force  0 si |vitesse| <= zone morte
+    PARAM_ID_SPEED_HYST,            // Hystrsis de la vitesse locale (pas de vitesse, 0 = sans)
+    PARAM_ID_ANGLE_HYST,            // Hystrsis de l'angle local (degrs, 0 = sans)
+    PARAM_ID_ADC_SYNC,              // Dclenchement ADC : 0 = libre, 1 = synchronis sur la PWM
+    PARAM_ID_ADC_SYNC_DELAY,        // Retard d'chantillonnage aprs le dbut de la priode PWM (TAD de 400 ns)
+    PARAM_NB                        // Nombre de paramtres (doit rester le dernier)
+} E_paramId;
+
+/*--------------------------------------------------------*/
+// Codes de retour
+/*--------------------------------------------------------*/
+#define PARAM_OK         0   // criture accepte
+#define PARAM_ERR_ID     1   // Identifiant inconnu
+#define PARAM_ERR_RANGE  2   // Valeur hors plage (ou incohrente avec un autre paramtre)
+
+/*--------------------------------------------------------*/
+// Structure d'un paramtre
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Valeur courante et plage admise d'un paramtre.
+ */
+typedef struct {
+    int16_t Value;   // Valeur courante
+    int16_t Min;     // Valeur minimale admise
+    int16_t Max;     // Valeur maximale admise
+} S_param;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Charge les valeurs par dfaut (constantes de compilation) dans le registre.
+ */
+void GPARAM_Initialize(void);
+
+/**
+ * @brief Lit la valeur courante d'un paramtre.
+ * @param id Identifiant du paramtre (doit tre < PARAM_NB).
+ * @return Valeur courante.
+ */
+int16_t GPARAM_Get(E_paramId id);
+
+/**
+ * @brief crit un paramtre aprs contrle de l'identifiant et de la plage.
+ * @param id    Identifiant reu (non vrifi par l'appelant).
+ * @param value Nouvelle valeur.
+ * @return PARAM_OK, PARAM_ERR_ID ou PARAM_ERR_RANGE.
+ */
+uint8_t GPARAM_Set(uint8_t id, int16_t value);
+
+#endif // GestParam_H
@@ -0,0 +1,251 @@
+/*--------------------------------------------------------*/
+// GestPlayout.c
+/*--------------------------------------------------------*/
+//	Description :	Restitution retarde et interpole des consignes
+//			        remote (jitter buffer), cadence par le Timer 4
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "system_config.h"
+#include "system_definitions.h"
+
+#include "gestPlayout.h"
+#include "gestPWM.h"
+#include "gestParam.h"
+#include "gestTraj.h"
+
+#define GPLAY_INDEX_MASK  (GPLAY_BUFFER_SIZE - 1)
+
+#if (GPLAY_BUFFER_SIZE & GPLAY_INDEX_MASK) != 0
+#error "GPLAY_BUFFER_SIZE doit etre une puissance de 2"
+#endif
+
+// Grandeurs interpoles
+#define GPLAY_CH_SPEED      0    // SpeedSetting
+#define GPLAY_CH_ANGLE      1    // AngleSetting
+#define GPLAY_CH_ABS_ANGLE  2    // absAngle
+#define GPLAY_NB_CHANNELS   3
+
+// Position entre deux consignes : 0  GPLAY_U_ONE (virgule fixe 8 bits)
+#define GPLAY_U_SHIFT       8
+#define GPLAY_U_ONE         (1 << GPLAY_U_SHIFT)
+
+/**
+ * @brief Consigne horodate en priodes du Timer 4.
+ */
+typedef struct {
+    uint16_t Time;
+    int16_t Val[GPLAY_NB_CHANNELS];
+} S_playPoint;
+
+// Buffer circulaire : crit par le programme principal, lu par l'ISR du Timer 4
+static S_playPoint playBuffer[GPLAY_BUFFER_SIZE];
+static volatile uint8_t playHead = 0;   // Consigne courante (dbut du segment interpol)
+static volatile uint8_t playTail = 0;   // Prochain emplacement libre
+
+static S_playPoint playPrev;            // Consigne prcdant playHead (spline)
+static uint8_t playHasPrev = 0;
+
+static volatile uint8_t playActive = 0;
+static volatile uint16_t playTime = 0;  // Horloge de restitution (priodes du Timer 4)
+static volatile uint32_t lateTicks = 0;
+static uint32_t overrunCount = 0;
+
+static S_pwmSettings playSettings;      // Consignes appliques par l'ISR
+
+/**
+ * @brief Active la restitution retarde en mode remote.
+ *
+ * @param remote 1 si des consignes remote sont reues, 0 sinon.
+ *
+ * @details Appele  chaque cycle de APP_Tasks. Hors mode remote, ou avec un
+ *          retard nul, le buffer est vid : le comportement est alors celui
+ *          d'origine (consigne applique telle quelle par GPWM_ExecPWM).
+ */
+void GPLAY_Enable(uint8_t remote)
+{
+    if (remote && (GPARAM_Get(PARAM_ID_PLAYOUT_DELAY) > 0)) {
+        playActive = 1;
+    } else {
+        playActive = 0;     // L'ISR n'accde plus au buffer
+        playHead = playTail;
+        playHasPrev = 0;
+    }
+}
+
+/**
+ * @brief Indique si la PWM est pilote par le buffer de restitution.
+ *
+ * @return 1 si actif, 0 sinon.
+ */
+uint8_t GPLAY_IsActive(void)
+{
+    return playActive;
+}
+
+/**
+ * @brief Mmorise une consigne reue avec l'heure de restitution courante.
+ *
+ * @param pData Consigne reue.
+ */
+void GPLAY_Push(const S_pwmSettings *pData)
+{
+    uint8_t next = (playTail + 1) & GPLAY_INDEX_MASK;
+    S_playPoint *pPoint;
+
+    if (GPARAM_Get(PARAM_ID_PLAYOUT_DELAY) == 0) {
+        return;
+    }
+    if (next == playHead) {
+        overrunCount++; // Buffer plein : consigne perdue
+        return;
+    }
+    pPoint = &playBuffer[playTail];
+    pPoint->Time = playTime;
+    pPoint->Val[GPLAY_CH_SPEED] = pData->SpeedSetting;
+    pPoint->Val[GPLAY_CH_ANGLE] = pData->AngleSetting;
+    pPoint->Val[GPLAY_CH_ABS_ANGLE] = pData->absAngle;
+    playTail = next; // Publi aprs criture complte du point
+}
+
+/**
+ * @brief Copie l'tat du buffer de restitution.
+ *
+ * @param pStatus Structure recevant l'tat et les compteurs.
+ */
+void GPLAY_GetStatus(S_playStatus *pStatus)
+{
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_TIMER_4);
+    pStatus->Count = (playTail - playHead) & GPLAY_INDEX_MASK;
+    pStatus->LateTicks = lateTicks;
+    pStatus->OverrunCount = overrunCount;
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_TIMER_4);
+}
+
+/**
+ * @brief Interpolation Catmull-Rom entre p1 et p2.
+ *
+ * @param p0 Consigne prcdant p1.
+ * @param p1 Dbut du segment.
+ * @param p2 Fin du segment.
+ * @param p3 Consigne suivant p2.
+ * @param u  Position dans le segment (0  GPLAY_U_ONE).
+ * @return Valeur interpole.
+ *
+ * @details 2 v = 2 p1 + a u + b u + c u, valu par Horner en virgule fixe.
+ */
+static int16_t GPLAY_Cubic(int32_t p0, int32_t p1, int32_t p2, int32_t p3, int32_t u)
+{
+    int32_t a = p2 - p0;
+    int32_t b = (2 * p0) - (5 * p1) + (4 * p2) - p3;
+    int32_t c = (3 * (p1 - p2)) + p3 - p0;
+    int32_t t;
+
+    t = (c * u) / GPLAY_U_ONE;
+    t = ((b + t) * u) / GPLAY_U_ONE;
+    t = ((a + t) * u) / GPLAY_U_ONE;
+    return (int16_t)(((2 * p1) + t) / 2);
+}
+
+/**
+ * @brief Sature une valeur dans [min, max].
+ */
+static int16_t GPLAY_Clamp(int16_t value, int16_t min, int16_t max)
+{
+    if (value < min) {
+        return min;
+    }
+    if (value > max) {
+        return max;
+    }
+    return value;
+}
+
+/**
+ * @brief Restitue la consigne retarde ; appele par l'interruption du Timer 4.
+ *
+ * @details L'instant restitu est l'horloge courante moins le retard
+ *          PARAM_ID_PLAYOUT_DELAY. Le segment [p1, p2] encadrant cet instant est
+ *          interpol selon PARAM_ID_PLAYOUT_ORDER. Sans consigne suivante
+ *          (retard insuffisant face  la gigue), la dernire est maintenue et
+ *          l'vnement est compt.
+ *          Une trajectoire en cours a la priorit : GTRAJ_Start (appele depuis
+ *          GetMessage) prcde le GPLAY_Enable(0) de APP_Tasks, la restitution
+ *          craserait sinon le premier point jusqu'au suivant.
+ */
+void GPLAY_Tick(void)
+{
+    uint16_t renderTime;
+    uint8_t count;
+    int16_t order;
+    int32_t u;
+    uint8_t ch;
+    const S_playPoint *p0;
+    const S_playPoint *p1;
+    const S_playPoint *p2;
+    const S_playPoint *p3;
+    int16_t out[GPLAY_NB_CHANNELS];
+
+    playTime++;
+    if (!playActive || GTRAJ_IsRunning()) {
+        return;
+    }
+
+    renderTime = playTime - (uint16_t)GPARAM_Get(PARAM_ID_PLAYOUT_DELAY);
+    count = (playTail - playHead) & GPLAY_INDEX_MASK;
+
+    // Avance jusqu'au segment contenant l'instant restitu
+    while ((count >= 2) &&
+           ((int16_t)(renderTime - playBuffer[(playHead + 1) & GPLAY_INDEX_MASK].Time) >= 0))
+    {
+        playPrev = playBuffer[playHead];
+        playHasPrev = 1;
+        playHead = (playHead + 1) & GPLAY_INDEX_MASK;
+        count--;
+    }
+
+    // Rien d'chu (dmarrage) : la PWM conserve la consigne prcdente
+    if ((count == 0) || ((int16_t)(renderTime - playBuffer[playHead].Time) < 0)) {
+        return;
+    }
+
+    p1 = &playBuffer[playHead];
+    order = GPARAM_Get(PARAM_ID_PLAYOUT_ORDER);
+    if (count < 2) {
+        lateTicks++;
+        order = GPLAY_ORDER_STEP; // Pas de consigne suivante : maintien
+    }
+    p2 = &playBuffer[(playHead + 1) & GPLAY_INDEX_MASK];
+    p0 = playHasPrev ? &playPrev : p1;
+    p3 = (count >= 3) ? &playBuffer[(playHead + 2) & GPLAY_INDEX_MASK] : p2;
+
+    u = 0;
+    if ((order != GPLAY_ORDER_STEP) && (p2->Time != p1->Time)) {
+        u = ((int32_t)(uint16_t)(renderTime - p1->Time) << GPLAY_U_SHIFT) /
+            (uint16_t)(p2->Time - p1->Time);
+    }
+
+    for (ch = 0; ch < GPLAY_NB_CHANNELS; ch++)
+    {
+        if (order == GPLAY_ORDER_STEP) {
+            out[ch] = p1->Val[ch];
+        } else if (order == GPLAY_ORDER_LINEAR) {
+            out[ch] = p1->Val[ch] + (int16_t)(((p2->Val[ch] - p1->Val[ch]) * u) / GPLAY_U_ONE);
+        } else {
+            out[ch] = GPLAY_Cubic(p0->Val[ch], p1->Val[ch], p2->Val[ch], p3->Val[ch], u);
+        }
+    }
+
+    // La spline peut dpasser les consignes : saturation aux plages de la PWM
+    playSettings.SpeedSetting = GPLAY_Clamp(out[GPLAY_CH_SPEED], -99, 99);
+    playSettings.absSpeed = abs(playSettings.SpeedSetting);
+    playSettings.AngleSetting = GPLAY_Clamp(out[GPLAY_CH_ANGLE], -ADC2_ANGLE_OFFSET, ADC2_ANGLE_OFFSET);
+    playSettings.absAngle = GPLAY_Clamp(out[GPLAY_CH_ABS_ANGLE], 0, ADC2_ANGLE_MAX);
+    playSettings.Changed = 1;
+    GPWM_ExecPWM(&playSettings);
+}
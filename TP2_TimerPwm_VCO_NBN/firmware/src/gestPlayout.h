@@ -0,0 +1,79 @@
+#ifndef GestPlayout_H
+#define GestPlayout_H
+
+/*--------------------------------------------------------*/
+// GestPlayout.h
+/*--------------------------------------------------------*/
+// Description : Buffer de restitution (jitter buffer) des consignes
+//               reues en mode remote, avec interpolation au rythme
+//               du Timer 4
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestPWM.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+#define GPLAY_BUFFER_SIZE   16   // Nombre de consignes en attente (puissance de 2)
+#define GPLAY_DELAY_MAX     50   // Retard max. en priodes du Timer 4 (500 ms  100 Hz)
+
+// Ordre d'interpolation (paramtre PARAM_ID_PLAYOUT_ORDER)
+#define GPLAY_ORDER_STEP    0    // Paliers (consigne maintenue jusqu' la suivante)
+#define GPLAY_ORDER_LINEAR  1    // Interpolation linaire
+#define GPLAY_ORDER_CUBIC   2    // Spline cubique (Catmull-Rom)
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Compteurs du buffer de restitution, rapports  l'hte.
+ */
+typedef struct {
+    uint8_t Count;          // Consignes en attente
+    uint32_t LateTicks;     // Priodes sans consigne suivante (retard insuffisant)
+    uint32_t OverrunCount;  // Consignes perdues, buffer plein
+} S_playStatus;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Active ou dsactive la restitution retarde.
+ * @param remote 1 en mode remote, 0 sinon.
+ *
+ * La restitution n'est active qu'en mode remote avec un retard non nul ;
+ * sinon le buffer est vid et les consignes sont appliques directement.
+ */
+void GPLAY_Enable(uint8_t remote);
+
+/**
+ * @brief Indique si le Timer 4 pilote la PWM  partir du buffer.
+ * @return 1 si la restitution est active, 0 sinon.
+ */
+uint8_t GPLAY_IsActive(void);
+
+/**
+ * @brief Horodate et mmorise une consigne reue.
+ * @param pData Consigne dcode (mmes champs que pour GPWM_ExecPWM).
+ */
+void GPLAY_Push(const S_pwmSettings *pData);
+
+/**
+ * @brief Copie l'tat et les compteurs du buffer.
+ * @param pStatus Structure recevant la copie.
+ */
+void GPLAY_GetStatus(S_playStatus *pStatus);
+
+/**
+ * @brief Calcule et applique la consigne interpole ; appele  chaque interruption du Timer 4.
+ */
+void GPLAY_Tick(void);
+
+#endif // GestPlayout_H
@@ -0,0 +1,183 @@
+/*--------------------------------------------------------*/
+// GestTelem.c
+/*--------------------------------------------------------*/
+//	Description :	Tlmtrie multi-canaux compresse
+//			        (delta + varint zig-zag, run-length)
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#include "gestTelem.h"
+#include "gestPWM.h"
+#include "gestParam.h"
+#include "Mc32gest_RS232.h"
+
+// Taille max. d'un chantillon cod selon le mode
+#define GTELEM_RAW_SIZE     (2 * GTELEM_NB_CHANNELS)    // 16 bits par valeur
+#define GTELEM_DELTA_MAX    (3 * GTELEM_NB_CHANNELS)    // 3 octets de varint par valeur
+// Octet R : rptition en attente, marqueur d'chantillon ou rptition finale
+#define GTELEM_RUN_SIZE     1
+// RLE : rptition en attente + marqueur + chantillon + rserve pour la rptition finale
+#define GTELEM_RLE_MAX      (GTELEM_RUN_SIZE + GTELEM_RUN_SIZE + GTELEM_DELTA_MAX + GTELEM_RUN_SIZE)
+
+#if GTELEM_FLUSH_SAMPLES > 127
+#error "GTELEM_FLUSH_SAMPLES doit tenir dans un octet R (< 128)"
+#endif
+
+static uint8_t telemBuf[CMD_PAYLOAD_MAX];   // Trame en cours de construction
+static uint8_t telemLen = 0;                // Octets utiliss, en-tte compris
+static uint8_t telemNb = 0;                 // chantillons dans la trame
+static uint8_t telemRun = 0;                // Rptitions en attente (mode RLE)
+static uint8_t telemMode = GTELEM_MODE_OFF; // Mode de la trame en cours
+static uint8_t telemSeq = 0;                // Numro de trame
+static int16_t telemPrev[GTELEM_NB_CHANNELS];
+static uint32_t telemDropped = 0;
+
+/**
+ * @brief crit une valeur en varint (7 bits par octet, poids faibles en premier).
+ *
+ * @param pDest Destination.
+ * @param value Valeur  coder.
+ * @return Nombre d'octets crits (1  3).
+ */
+static uint8_t GTELEM_PutVarint(uint8_t *pDest, uint16_t value)
+{
+    uint8_t n = 0;
+
+    while (value >= 0x80) {
+        pDest[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    pDest[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+ * @brief Codage zig-zag : les petites valeurs ngatives deviennent de petits entiers.
+ *
+ * @param value Valeur signe.
+ * @return 0, -1, 1, -2... => 0, 1, 2, 3...
+ */
+static uint16_t GTELEM_ZigZag(int16_t value)
+{
+    return (uint16_t)((uint16_t)value << 1) ^ (uint16_t)((value < 0) ? 0xFFFF : 0x0000);
+}
+
+/**
+ * @brief met la trame en cours et en prpare une nouvelle.
+ */
+static void GTELEM_Flush(void)
+{
+    uint8_t i;
+
+    if (telemNb > 0)
+    {
+        if (telemRun > 0) {
+            telemBuf[telemLen++] = telemRun; // Rptitions en fin de trame
+        }
+        telemBuf[0] = telemMode;
+        telemBuf[1] = telemSeq;
+        telemBuf[2] = telemNb;
+        if (SendCommand(CMD_TELEMETRY, telemBuf, telemLen) != 0) {
+            telemDropped++;
+        }
+        telemSeq++;
+    }
+
+    // Trame autonome : les valeurs de rfrence repartent de 0
+    telemLen = GTELEM_HEADER_SIZE;
+    telemNb = 0;
+    telemRun = 0;
+    for (i = 0; i < GTELEM_NB_CHANNELS; i++) {
+        telemPrev[i] = 0;
+    }
+}
+
+/**
+ * @brief Code l'chantillon courant dans la trame de tlmtrie.
+ *
+ * @param pData Consignes appliques au cycle courant.
+ */
+void GTELEM_Sample(const S_pwmSettings *pData)
+{
+    int16_t values[GTELEM_NB_CHANNELS];
+    uint8_t mode = (uint8_t)GPARAM_Get(PARAM_ID_TELEM_MODE);
+    uint8_t same = 1;
+    uint8_t need;
+    uint8_t i;
+
+    // Changement de mode => la trame en cours est mise dans l'ancien mode
+    if (mode != telemMode) {
+        GTELEM_Flush();
+        telemMode = mode;
+    }
+    if (mode == GTELEM_MODE_OFF) {
+        return;
+    }
+
+    values[0] = pData->SpeedSetting;
+    values[1] = pData->AngleSetting;
+    values[2] = (int16_t)GPWM_GetRawAdc(0);
+    values[3] = (int16_t)GPWM_GetRawAdc(1);
+    for (i = 0; i < GTELEM_NB_CHANNELS; i++) {
+        if (values[i] != telemPrev[i]) {
+            same = 0;
+        }
+    }
+
+    if ((mode == GTELEM_MODE_RLE) && (telemNb > 0) && same)
+    {
+        // chantillon rpt : seul le compteur augmente
+        telemRun++;
+    }
+    else
+    {
+        // Place rserve selon le mode : une trame brute ne garde pas de place de varint
+        if (mode == GTELEM_MODE_RAW) {
+            need = GTELEM_RAW_SIZE;
+        } else if (mode == GTELEM_MODE_DELTA) {
+            need = GTELEM_DELTA_MAX;
+        } else {
+            need = GTELEM_RLE_MAX;
+        }
+        if ((telemLen + need) > CMD_PAYLOAD_MAX) {
+            GTELEM_Flush();
+        }
+        if (telemRun > 0) {
+            telemBuf[telemLen++] = telemRun;
+            telemRun = 0;
+        }
+        if (mode == GTELEM_MODE_RLE) {
+            telemBuf[telemLen++] = 0; // Nouvel chantillon
+        }
+        for (i = 0; i < GTELEM_NB_CHANNELS; i++)
+        {
+            if (mode == GTELEM_MODE_RAW) {
+                telemBuf[telemLen++] = (uint8_t)((uint16_t)values[i] >> 8);
+                telemBuf[telemLen++] = (uint8_t)values[i];
+            } else {
+                telemLen += GTELEM_PutVarint(&telemBuf[telemLen],
+                                             GTELEM_ZigZag(values[i] - telemPrev[i]));
+            }
+            telemPrev[i] = values[i];
+        }
+    }
+
+    telemNb++;
+    if (telemNb >= GTELEM_FLUSH_SAMPLES) {
+        GTELEM_Flush();
+    }
+}
+
+/**
+ * @brief Retourne le nombre de trames de tlmtrie non mises.
+ *
+ * @return Trames perdues faute de place dans le FIFO TX.
+ */
+uint32_t GTELEM_GetDroppedCount(void)
+{
+    return telemDropped;
+}
@@ -0,0 +1,65 @@
+#ifndef GestTelem_H
+#define GestTelem_H
+
+/*--------------------------------------------------------*/
+// GestTelem.h
+/*--------------------------------------------------------*/
+// Description : Tlmtrie multi-canaux compresse sur RS232
+//               (delta + varint zig-zag, option run-length)
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestPWM.h"
+
+/*--------------------------------------------------------*/
+// Format des trames de tlmtrie
+/*--------------------------------------------------------*/
+// Trame de commande CMD_TELEMETRY (mise spontanment par la carte) :
+//   Data = Mode | Seq | NbSamples | chantillons...
+// Chaque trame est autonome : les valeurs prcdentes valent 0 en dbut de
+// trame, une trame perdue (Seq non conscutif) n'affecte pas les suivantes.
+//
+// Un chantillon = GTELEM_NB_CHANNELS valeurs 16 bits signes, dans l'ordre :
+//   SpeedSetting, AngleSetting, ADC canal 0 (brut), ADC canal 1 (brut).
+//
+// GTELEM_MODE_RAW   : chaque valeur en 16 bits, MSB en premier.
+// GTELEM_MODE_DELTA : chaque valeur = varint(zigzag(valeur - prcdente)).
+// GTELEM_MODE_RLE   : suite d'enregistrements, chacun commenant par un octet
+//                     R : R = 0 => un chantillon cod comme en mode DELTA suit,
+//                         R > 0 => R chantillons identiques au prcdent.
+//
+// varint   : 7 bits par octet, poids faibles en premier, bit 7 = octet suivant.
+// zigzag   : 0, -1, 1, -2, 2... => 0, 1, 2, 3, 4...
+
+#define GTELEM_MODE_OFF     0    // Pas de tlmtrie
+#define GTELEM_MODE_RAW     1    // Valeurs brutes (rfrence de dbit)
+#define GTELEM_MODE_DELTA   2    // Delta + varint zig-zag
+#define GTELEM_MODE_RLE     3    // Delta + varint zig-zag + chantillons rpts
+
+#define GTELEM_NB_CHANNELS  4    // Nombre de valeurs par chantillon
+#define GTELEM_HEADER_SIZE  3    // Mode, Seq, NbSamples
+#define GTELEM_FLUSH_SAMPLES 25  // chantillons max. par trame (latence 0.5 s  50 Hz)
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Ajoute l'chantillon courant  la trame de tlmtrie en cours.
+ * @param pData Consignes appliques au cycle courant.
+ *
+ * Le mode est lu dans le registre (PARAM_ID_TELEM_MODE). La trame est mise
+ * lorsqu'elle est pleine ou contient GTELEM_FLUSH_SAMPLES chantillons.
+ */
+void GTELEM_Sample(const S_pwmSettings *pData);
+
+/**
+ * @brief Retourne le nombre de trames de tlmtrie perdues (FIFO TX plein).
+ * @return Nombre de trames non mises.
+ */
+uint32_t GTELEM_GetDroppedCount(void);
+
+#endif // GestTelem_H
@@ -0,0 +1,217 @@
+/*--------------------------------------------------------*/
+// GestTraj.c
+/*--------------------------------------------------------*/
+//	Description :	Lecture  cadence fixe (Timer 4) de trajectoires
+//			        de consignes vitesse/angle reues par RS232
+//
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "system_config.h"
+#include "system_definitions.h"
+
+#include "gestTraj.h"
+#include "gestPWM.h"
+
+#define GTRAJ_INDEX_MASK  (GTRAJ_BUFFER_SIZE - 1)
+
+#if (GTRAJ_BUFFER_SIZE & GTRAJ_INDEX_MASK) != 0
+#error "GTRAJ_BUFFER_SIZE doit etre une puissance de 2"
+#endif
+
+// Buffer circulaire : crit par le programme principal, lu par l'ISR du Timer 4
+static S_trajPoint trajBuffer[GTRAJ_BUFFER_SIZE];
+static volatile uint8_t trajHead = 0;   // Prochain point  jouer (ISR)
+static volatile uint8_t trajTail = 0;   // Prochain emplacement libre (chargement)
+
+static volatile E_trajState trajState = GTRAJ_STATE_IDLE;
+static volatile uint8_t trajEnd = 0;    // 1 = plus aucun point attendu aprs ceux du buffer
+static volatile uint16_t trajTime = 0;  // Temps de lecture en priodes du Timer 4
+static volatile uint32_t underrunCount = 0;
+static uint32_t overrunCount = 0;
+
+static S_pwmSettings trajSettings;      // Consignes appliques par l'ISR
+
+/**
+ * @brief Configure le Timer 4 (100 Hz) et son interruption.
+ *
+ * @details Le Timer 4 n'est pas gr par les drivers statiques Harmony ; il est
+ *          configur ici par les PLIB, sur le modle de DRV_TMR2_Initialize.
+ */
+void GTRAJ_Initialize(void)
+{
+    trajHead = 0;
+    trajTail = 0;
+    trajState = GTRAJ_STATE_IDLE;
+    trajEnd = 0;
+
+    PLIB_TMR_Stop(TMR_ID_4);
+    PLIB_TMR_ClockSourceSelect(TMR_ID_4, TMR_CLOCK_SOURCE_PERIPHERAL_CLOCK);
+    PLIB_TMR_PrescaleSelect(TMR_ID_4, TMR_PRESCALE_VALUE_256);
+    PLIB_TMR_Mode16BitEnable(TMR_ID_4);
+    PLIB_TMR_Counter16BitClear(TMR_ID_4);
+    PLIB_TMR_Period16BitSet(TMR_ID_4, GTRAJ_TMR4_PERIOD);
+
+    // Priorit infrieure  l'UART (5) et au Timer 1 (4)
+    PLIB_INT_VectorPrioritySet(INT_ID_0, INT_VECTOR_T4, INT_PRIORITY_LEVEL3);
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, INT_VECTOR_T4, INT_SUBPRIORITY_LEVEL0);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_4);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_TIMER_4);
+    PLIB_TMR_Start(TMR_ID_4);
+}
+
+/**
+ * @brief Ajoute des points  la trajectoire.
+ *
+ * @param pData    Points reus : TimeMsb, TimeLsb, Speed, Angle.
+ * @param nbPoints Nombre de points.
+ * @return Nombre de points accepts.
+ *
+ * @details Les consignes sont satures aux plages de la PWM. Les points qui ne
+ *          tiennent plus dans le buffer sont refuss et compts en overrun.
+ */
+uint8_t GTRAJ_Load(const uint8_t *pData, uint8_t nbPoints)
+{
+    uint8_t i;
+    uint8_t next;
+    S_trajPoint *pPoint;
+    int8_t speed;
+    int8_t angle;
+
+    for (i = 0; i < nbPoints; i++)
+    {
+        next = (trajTail + 1) & GTRAJ_INDEX_MASK;
+        if (next == trajHead) {
+            overrunCount += nbPoints - i; // Buffer plein
+            break;
+        }
+        speed = (int8_t)pData[2];
+        angle = (int8_t)pData[3];
+        if (speed > GTRAJ_SPEED_MAX) {
+            speed = GTRAJ_SPEED_MAX;
+        } else if (speed < -GTRAJ_SPEED_MAX) {
+            speed = -GTRAJ_SPEED_MAX;
+        }
+        if (angle > GTRAJ_ANGLE_MAX) {
+            angle = GTRAJ_ANGLE_MAX;
+        } else if (angle < -GTRAJ_ANGLE_MAX) {
+            angle = -GTRAJ_ANGLE_MAX;
+        }
+
+        pPoint = &trajBuffer[trajTail];
+        pPoint->Time = ((uint16_t)pData[0] << 8) | pData[1];
+        pPoint->Speed = speed;
+        pPoint->Angle = angle;
+        trajTail = next; // Publi aprs criture complte du point
+        pData += GTRAJ_POINT_SIZE;
+    }
+    return i;
+}
+
+/**
+ * @brief Dmarre la lecture de la trajectoire charge.
+ */
+void GTRAJ_Start(void)
+{
+    trajTime = 0;
+    trajState = GTRAJ_STATE_RUNNING;
+}
+
+/**
+ * @brief Marque la fin de la trajectoire charge.
+ *
+ * @details Appele par l'hte aprs le dernier GTRAJ_Load, avant ou pendant la
+ *          lecture. Les points dj chargs sont jous normalement.
+ */
+void GTRAJ_End(void)
+{
+    trajEnd = 1;
+}
+
+/**
+ * @brief Arrte la lecture et abandonne les points restants.
+ */
+void GTRAJ_Stop(void)
+{
+    trajState = GTRAJ_STATE_IDLE;
+    trajEnd = 0;
+    trajHead = trajTail;
+}
+
+/**
+ * @brief Indique si la lecture est en cours.
+ *
+ * @return 1 si le Timer 4 pilote la PWM, 0 sinon.
+ */
+uint8_t GTRAJ_IsRunning(void)
+{
+    return (trajState == GTRAJ_STATE_RUNNING);
+}
+
+/**
+ * @brief Copie l'tat du lecteur.
+ *
+ * @param pStatus Structure recevant l'tat et les compteurs.
+ */
+void GTRAJ_GetStatus(S_trajStatus *pStatus)
+{
+    PLIB_INT_SourceDisable(INT_ID_0, INT_SOURCE_TIMER_4);
+    pStatus->State = trajState;
+    pStatus->Count = (trajTail - trajHead) & GTRAJ_INDEX_MASK;
+    pStatus->Time = trajTime;
+    pStatus->UnderrunCount = underrunCount;
+    pStatus->OverrunCount = overrunCount;
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_TIMER_4);
+}
+
+/**
+ * @brief Applique les points chus ; appele par l'interruption du Timer 4.
+ *
+ * @details Tous les points dont l'instant est atteint sont consomms, le dernier
+ *          est appliqu aux OC. Entre deux points la consigne est maintenue.
+ *          Si le buffer est vide sans nouveau point  appliquer, la lecture
+ *          s'arrte et la PWM revient aux consignes habituelles : fin normale
+ *          (GTRAJ_STATE_DONE) si GTRAJ_End a t appele, underrun sinon.
+ */
+void GTRAJ_Tick(void)
+{
+    S_trajPoint *pPoint;
+    uint8_t applied = 0;
+
+    if (trajState != GTRAJ_STATE_RUNNING) {
+        return;
+    }
+
+    while (trajHead != trajTail)
+    {
+        pPoint = &trajBuffer[trajHead];
+        // Comparaison signe : robuste au dbordement du temps 16 bits
+        if ((int16_t)(trajTime - pPoint->Time) < 0) {
+            break;
+        }
+        trajSettings.SpeedSetting = pPoint->Speed;
+        trajSettings.absSpeed = abs(pPoint->Speed);
+        trajSettings.AngleSetting = pPoint->Angle;
+        trajSettings.absAngle = GPWM_RemoteAbsAngle(pPoint->Angle);
+        trajSettings.Changed = 1;
+        trajHead = (trajHead + 1) & GTRAJ_INDEX_MASK;
+        applied = 1;
+    }
+
+    if (applied) {
+        GPWM_ExecPWM(&trajSettings);
+    } else if (trajHead == trajTail) {
+        if (trajEnd) {
+            trajState = GTRAJ_STATE_DONE;
+        } else {
+            trajState = GTRAJ_STATE_UNDERRUN;
+            underrunCount++;
+        }
+        trajEnd = 0;
+    }
+    trajTime++;
+}
@@ -0,0 +1,115 @@
+#ifndef GestTraj_H
+#define GestTraj_H
+
+/*--------------------------------------------------------*/
+// GestTraj.h
+/*--------------------------------------------------------*/
+// Description : Excution de trajectoires de consignes (vitesse, angle)
+//               tlcharges par RS232 et joues  cadence fixe par le Timer 4
+//
+// Version      : V1.0
+// Compilateur  : XC32 V1.42 + Harmony 1.08
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestPWM.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+
+// Cadence de lecture : Timer 4, PBCLK 80 MHz / 256 / (3124 + 1) = 100 Hz
+#define GTRAJ_TICK_HZ       100
+#define GTRAJ_TMR4_PERIOD   3124
+
+#define GTRAJ_BUFFER_SIZE   64   // Nombre de points mmorisables (puissance de 2)
+#define GTRAJ_POINT_SIZE    4    // Octets par point transmis : TimeMsb, TimeLsb, Speed, Angle
+
+#define GTRAJ_SPEED_MAX     99   // Consigne de vitesse : -99  +99
+#define GTRAJ_ANGLE_MAX     90   // Consigne d'angle : -90  +90
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief tats du lecteur de trajectoire.
+ */
+typedef enum {
+    GTRAJ_STATE_IDLE = 0,   // Arrt, la PWM suit les consignes habituelles
+    GTRAJ_STATE_RUNNING,    // Lecture en cours, la PWM est pilote par le Timer 4
+    GTRAJ_STATE_UNDERRUN,   // Arrt faute de point  jouer (chargement trop lent)
+    GTRAJ_STATE_DONE        // Termin : dernier point (GTRAJ_End) appliqu
+} E_trajState;
+
+/**
+ * @brief Point de trajectoire.
+ */
+typedef struct {
+    uint16_t Time;   // Instant d'application en priodes du Timer 4 depuis le dpart
+    int8_t Speed;    // Consigne de vitesse
+    int8_t Angle;    // Consigne d'angle
+} S_trajPoint;
+
+/**
+ * @brief tat et compteurs du lecteur, rapports  l'hte.
+ */
+typedef struct {
+    uint8_t State;          // E_trajState
+    uint8_t Count;          // Points en attente
+    uint16_t Time;          // Temps de lecture courant (priodes du Timer 4)
+    uint32_t UnderrunCount; // Lectures interrompues faute de point
+    uint32_t OverrunCount;  // Points refuss, buffer plein
+} S_trajStatus;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Configure le Timer 4 et vide le buffer de trajectoire.
+ */
+void GTRAJ_Initialize(void);
+
+/**
+ * @brief Ajoute des points reus (format GTRAJ_POINT_SIZE octets par point).
+ * @param pData    Points transmis, MSB du temps en premier.
+ * @param nbPoints Nombre de points.
+ * @return Nombre de points accepts (les suivants sont compts en overrun).
+ */
+uint8_t GTRAJ_Load(const uint8_t *pData, uint8_t nbPoints);
+
+/**
+ * @brief Dmarre la lecture depuis le temps 0.
+ */
+void GTRAJ_Start(void);
+
+/**
+ * @brief Indique que le dernier point de la trajectoire est charg : le buffer
+ *        vide aprs ce point termine la lecture (GTRAJ_STATE_DONE) sans underrun.
+ */
+void GTRAJ_End(void);
+
+/**
+ * @brief Arrte la lecture et vide le buffer.
+ */
+void GTRAJ_Stop(void);
+
+/**
+ * @brief Indique si le Timer 4 pilote actuellement la PWM.
+ * @return 1 si la lecture est en cours, 0 sinon.
+ */
+uint8_t GTRAJ_IsRunning(void);
+
+/**
+ * @brief Copie l'tat et les compteurs du lecteur.
+ * @param pStatus Structure recevant la copie.
+ */
+void GTRAJ_GetStatus(S_trajStatus *pStatus);
+
+/**
+ * @brief Joue les points chus ; appele  chaque interruption du Timer 4.
+ */
+void GTRAJ_Tick(void);
+
+#endif // GestTraj_H
@@ -0,0 +1,335 @@
+/*--------------------------------------------------------*/
+// Fuzz_rs232.c
+/*--------------------------------------------------------*/
+//	Description :	Fuzzing de la rception RS232 sur l'appareil
+//			        simul : les octets de l'entre arrivent sur la
+//			        ligne RX, traversent l'ISR UART1 (FIFO matriel,
+//			        erreurs de trame et de parit, RTS), RS232_RxByte,
+//			        descrFifoRX puis GetMessage dans APP_Tasks.
+//
+//	Invariants (abort() en cas de violation) :
+//	  - descripteurs des FIFO RX et TX cohrents (pointeurs dans le buffer)
+//	  - S_pwmSettings dans sa plage  l'entre et  la sortie de GetMessage
+//	  - GetMessage ne consomme pas plus que le contenu du FIFO RX et ne
+//	    laisse jamais une trame complte (reste < une trame maximale)
+//	  - la ligne RX progresse (RTS finit par tre relch)
+//	Les accs hors des buffers sont dtects par ASan (TP2_SANITIZE=ON).
+//
+//	Format de l'entre (premier octet) :
+//	  pair   octets bruts sur la ligne
+//	  impair enregistrements, trames construites avec un CRC valide :
+//	         [Cmd < 0x80, Addr, Len, Donnes...]  trame de commande
+//	         [0x80..0xBF, Addr, Vitesse, Angle]   trame de consigne
+//	         [0xC0..0xDF, Octet]                  octet hors trame
+//	         [0xE0..0xFF, Octet]                  octet avec erreurs (bits 0-1)
+//	L'adresse n'est mise qu'en multipoint (fuzz_rs232_md).
+//
+//	L'tat du firmware est conserv d'une entre  l'autre (un seul
+//	appareil simul par processus).
+//
+//	Usage :	libFuzzer (Clang) : fuzz_rs232 [options libFuzzer] CORPUS
+//		    Autres compilateurs, AFL : fuzz_rs232 [FICHIER | REPERTOIRE]...
+//		    (rejoue chaque entre ; sans argument, lit l'entre standard)
+//
+/*--------------------------------------------------------*/
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simDevice.h"
+#include "hostFrame.h"
+#include "Mc32gest_RS232.h"
+#include "gestBoot.h"
+#include "gestNvm.h"
+
+#define FUZZ_MAX_INPUT      4096                    // Octets traits par entre
+#define FUZZ_INTRO_NS       (3100 * SIM_NS_PER_MS)  // Fin de l'introduction (3 s)
+#define FUZZ_SETTLE_NS      (60 * SIM_NS_PER_MS)    // Trois cycles de Timer 1 aprs le dernier octet
+#define FUZZ_RX_LEFT_MAX    (CMD_MESS_SIZE(CMD_PAYLOAD_MAX) - 1) // Reste max. : trame incomplte
+
+// Pire blocage de la ligne : FIFO RX plein de CMD_BOOT_START (6 octets de donnes)
+// effaant chacun toute la zone de transit
+#define FUZZ_STALL_NS       (((FIFO_RX_SIZE / CMD_MESS_SIZE(6)) + 1) * \
+                             (GBOOT_STAGING_SIZE / GNVM_PAGE_SIZE) * SIM_NVM_ERASE_NS + SIM_NS_PER_S)
+
+// Enregistrements du mode trames
+#define FUZZ_REC_SETPOINT   0x80
+#define FUZZ_REC_JUNK       0xC0
+#define FUZZ_REC_ERROR      0xE0
+
+#define FUZZ_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: invariant viole : %s\n", __FILE__, __LINE__, #cond); \
+            abort(); \
+        } \
+    } while (0)
+
+// GetMessage de Mc32gest_RS232.c, appel par APP_Tasks via -Wl,--wrap=GetMessage
+int __real_GetMessage(S_pwmSettings *pData);
+int __wrap_GetMessage(S_pwmSettings *pData);
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t size);
+
+/**
+ * @brief Descripteur de FIFO : taille attendue, pointeurs dans le buffer.
+ */
+static void FUZZ_CheckFifo(S_fifo *pFifo, int32_t size)
+{
+    FUZZ_CHECK(pFifo->fifoSize == size);
+    FUZZ_CHECK(pFifo->pFinFifo == (pFifo->pDebFifo + (size - 1)));
+    FUZZ_CHECK((pFifo->pRead >= pFifo->pDebFifo) && (pFifo->pRead <= pFifo->pFinFifo));
+    FUZZ_CHECK((pFifo->pWrite >= pFifo->pDebFifo) && (pFifo->pWrite <= pFifo->pFinFifo));
+    FUZZ_CHECK((GetReadSize(pFifo) >= 0) && (GetReadSize(pFifo) < size));
+}
+
+/**
+ * @brief Consignes dans la plage documente de S_pwmSettings.
+ */
+static void FUZZ_CheckSettings(const S_pwmSettings *pData)
+{
+    FUZZ_CHECK(abs(pData->SpeedSetting) <= (ADC1_VALUE_MAX / 2));
+    FUZZ_CHECK(pData->absSpeed <= (ADC1_VALUE_MAX / 2));
+    FUZZ_CHECK(abs(pData->AngleSetting) <= ADC2_ANGLE_OFFSET);
+    FUZZ_CHECK(pData->absAngle <= (2 * ADC2_ANGLE_OFFSET));
+    FUZZ_CHECK(pData->Changed <= 1);
+}
+
+int __wrap_GetMessage(S_pwmSettings *pData)
+{
+    int32_t before;
+    int32_t after;
+    int status;
+
+    FUZZ_CheckFifo(&descrFifoRX, FIFO_RX_SIZE);
+    FUZZ_CheckFifo(&descrFifoTX, FIFO_TX_SIZE);
+    FUZZ_CheckSettings(pData);
+
+    // Les interruptions ne s'excutent pas pendant la boucle principale simule
+    before = GetReadSize(&descrFifoRX);
+    status = __real_GetMessage(pData);
+    after = GetReadSize(&descrFifoRX);
+
+    FUZZ_CHECK((after >= 0) && (after <= before));
+    FUZZ_CHECK(after <= FUZZ_RX_LEFT_MAX);
+    FUZZ_CheckFifo(&descrFifoRX, FIFO_RX_SIZE);
+    FUZZ_CheckFifo(&descrFifoTX, FIFO_TX_SIZE);
+    FUZZ_CheckSettings(pData);
+    return status;
+}
+
+/**
+ * @brief Jette les octets mis par la carte.
+ */
+static void FUZZ_DrainTx(void)
+{
+    uint8_t buf[256];
+
+    while (SIM_UartRead(buf, sizeof(buf)) > 0) {
+    }
+}
+
+/**
+ * @brief Dmarrage de l'appareil (une fois par processus).
+ */
+static void FUZZ_Init(void)
+{
+    const S_simConfig config = { NULL, 1, 1 };
+
+    FUZZ_CHECK(SIM_Init(&config) == 0);
+    SIM_RunFor(FUZZ_INTRO_NS);
+    FUZZ_DrainTx();
+}
+
+/**
+ * @brief Dpose les enregistrements du mode trames sur la ligne.
+ */
+static void FUZZ_PushRecords(const uint8_t *pData, size_t size)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t payload[CMD_PAYLOAD_MAX];
+    uint8_t kind;
+    uint8_t addr;
+    uint8_t len;
+    size_t i = 0;
+
+    while (i < size) {
+        kind = pData[i++];
+        if (kind >= FUZZ_REC_JUNK) {
+            if (i < size) {
+                SIM_UartPushByte(pData[i++], (kind >= FUZZ_REC_ERROR) ?
+                                 (kind & (SIM_UART_ERR_FRAMING | SIM_UART_ERR_PARITY)) : 0);
+            }
+            continue;
+        }
+        addr = (i < size) ? pData[i++] : RS232_NODE_ADDRESS;
+        if (kind >= FUZZ_REC_SETPOINT) {
+            if ((i + 2) > size) {
+                break;
+            }
+            SIM_UartWrite(frame, HFRAME_EncodeSetpoint(frame, RS232_MULTIDROP, addr,
+                                                       (int8_t)pData[i], (int8_t)pData[i + 1]));
+            i += 2;
+        } else {
+            len = (i < size) ? (uint8_t)(pData[i++] % (CMD_PAYLOAD_MAX + 1)) : 0;
+            if (len > (size - i)) {
+                len = (uint8_t)(size - i);
+            }
+            memcpy(payload, &pData[i], len);
+            i += len;
+            SIM_UartWrite(frame, HFRAME_EncodeCommand(frame, RS232_MULTIDROP, addr, kind,
+                                                      payload, len));
+        }
+    }
+}
+
+/**
+ * @brief Excute l'appareil jusqu' l'arrive de tous les octets de la ligne.
+ */
+static void FUZZ_Run(void)
+{
+    size_t pending = SIM_UartPending();
+    uint64_t progress = SIM_Now();
+
+    while (pending > 0) {
+        SIM_RunFor(SIM_NS_PER_MS);
+        FUZZ_DrainTx();
+        if (SIM_UartPending() != pending) {
+            pending = SIM_UartPending();
+            progress = SIM_Now();
+        }
+        FUZZ_CHECK((SIM_Now() - progress) <= FUZZ_STALL_NS);
+    }
+    SIM_RunFor(FUZZ_SETTLE_NS);
+    FUZZ_DrainTx();
+#if !RS232_MULTIDROP
+    // Reste < trame maximale : place libre au-dessus du seuil bas
+    FUZZ_CHECK(SIM_GetRts() == 0);
+#endif
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *pData, size_t size)
+{
+    static uint8_t initDone = 0;
+
+    if (!initDone) {
+        FUZZ_Init();
+        initDone = 1;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    if (size > FUZZ_MAX_INPUT) {
+        size = FUZZ_MAX_INPUT;
+    }
+
+    if ((pData[0] & 1) == 0) {
+        SIM_UartWrite(pData + 1, size - 1);
+    } else {
+        FUZZ_PushRecords(pData + 1, size - 1);
+    }
+    FUZZ_Run();
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+/*--------------------------------------------------------*/
+// Rejeu (compilateurs sans libFuzzer, AFL)
+/*--------------------------------------------------------*/
+
+static uint8_t fuzzBuf[FUZZ_MAX_INPUT];
+
+/**
+ * @brief Rejoue un fichier.
+ * @return 0 si OK, -1 si illisible.
+ */
+static int FUZZ_ReplayFile(const char *pPath)
+{
+    FILE *pFile = (strcmp(pPath, "-") == 0) ? stdin : fopen(pPath, "rb");
+    size_t size;
+
+    if (pFile == NULL) {
+        return -1;
+    }
+    size = fread(fuzzBuf, 1, sizeof(fuzzBuf), pFile);
+    if (pFile != stdin) {
+        fclose(pFile);
+    }
+    LLVMFuzzerTestOneInput(fuzzBuf, size);
+    return 0;
+}
+
+static int FUZZ_CompareNames(const void *pA, const void *pB)
+{
+    return strcmp(*(char * const *)pA, *(char * const *)pB);
+}
+
+/**
+ * @brief Rejoue un fichier ou tous les fichiers d'un rpertoire (ordre alphabtique).
+ * @return Nombre d'entres rejoues, -1 en cas d'erreur.
+ */
+static int FUZZ_ReplayPath(const char *pPath)
+{
+    DIR *pDir = opendir(pPath);
+    struct dirent *pEntry;
+    char **names = NULL;
+    char file[1024];
+    size_t count = 0;
+    size_t i;
+    int done = 0;
+
+    if (pDir == NULL) {
+        return (FUZZ_ReplayFile(pPath) == 0) ? 1 : -1;
+    }
+    while ((pEntry = readdir(pDir)) != NULL) {
+        if (pEntry->d_name[0] == '.') {
+            continue;
+        }
+        names = realloc(names, (count + 1) * sizeof(*names));
+        FUZZ_CHECK(names != NULL);
+        names[count] = strdup(pEntry->d_name);
+        FUZZ_CHECK(names[count] != NULL);
+        count++;
+    }
+    closedir(pDir);
+    if (count > 0) {
+        qsort(names, count, sizeof(*names), FUZZ_CompareNames);
+    }
+
+    for (i = 0; i < count; i++) {
+        snprintf(file, sizeof(file), "%s/%s", pPath, names[i]);
+        if ((done >= 0) && (FUZZ_ReplayFile(file) == 0)) {
+            done++;
+        } else {
+            done = -1;
+        }
+        free(names[i]);
+    }
+    free(names);
+    return done;
+}
+
+int main(int argc, char **argv)
+{
+    int total = 0;
+    int n;
+    int i;
+
+    if (argc < 2) {
+        return (FUZZ_ReplayFile("-") == 0) ? 0 : 1;
+    }
+    for (i = 1; i < argc; i++) {
+        n = FUZZ_ReplayPath(argv[i]);
+        if (n < 0) {
+            fprintf(stderr, "fuzz_rs232: %s illisible\n", argv[i]);
+            return 1;
+        }
+        total += n;
+    }
+    printf("%d entrees rejouees, invariants respectes\n", total);
+    return 0;
+}
+
+#endif // FUZZ_LIBFUZZER
@@ -0,0 +1,28 @@
+#ifndef SimMc32DriverLcd_H
+#define SimMc32DriverLcd_H
+
+/*--------------------------------------------------------*/
+// Mc32DriverLcd.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Afficheur 4 x 20 caractres simul ; le contenu est lu
+//               par SIM_GetLcdLine (sim/simDevice.h).
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void lcd_init(void);
+void lcd_bl_on(void);
+void lcd_bl_off(void);
+void lcd_gotoxy(uint8_t x, uint8_t y);
+void lcd_ClearLine(uint8_t noLine);
+void printf_lcd(const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SimMc32DriverLcd_H
@@ -0,0 +1,69 @@
+#ifndef SimBsp_H
+#define SimBsp_H
+
+/*--------------------------------------------------------*/
+// bsp.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Board Support Package du kit pic32mx_skes rduit aux
+//               broches utilises par l'application. Les lignes RTS/CTS
+//               et les LED de diagnostic sont des variables du simulateur.
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <xc.h>
+#include "system_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BSP_LED_0 = 0,
+    BSP_LED_1,
+    BSP_LED_2,
+    BSP_LED_3,
+    BSP_LED_4,
+    BSP_LED_5,
+    BSP_LED_6,
+    BSP_LED_7,
+    BSP_LED_NB
+} BSP_LED;
+
+/**
+ * @brief Broches tenues par le simulateur (1 = niveau haut).
+ */
+typedef struct {
+    volatile uint8_t Rts;       // Sortie : 1 = rception bloque (DE en multipoint)
+    volatile uint8_t Cts;       // Entre : 1 = mission interdite par le distant
+    volatile uint8_t Led3;
+    volatile uint8_t Led4;
+    volatile uint8_t Led5;
+} S_simPins;
+
+extern S_simPins SIM_Pins;
+
+#define RS232_RTS   (SIM_Pins.Rts)
+#define RS232_CTS   (SIM_Pins.Cts)
+#define LED3_W      (SIM_Pins.Led3)
+#define LED4_W      (SIM_Pins.Led4)
+#define LED4_R      (SIM_Pins.Led4)
+#define LED5_W      (SIM_Pins.Led5)
+#define LED5_R      (SIM_Pins.Led5)
+
+// Commande du sens du pont en H (PORTD, comme sur le kit)
+#define AIN1_HBRIDGE_PORT   PORT_CHANNEL_D
+#define AIN1_HBRIDGE_BIT    PORTS_BIT_POS_6
+#define AIN2_HBRIDGE_PORT   PORT_CHANNEL_D
+#define AIN2_HBRIDGE_BIT    PORTS_BIT_POS_7
+
+void BSP_LEDOn(BSP_LED led);
+void BSP_LEDOff(BSP_LED led);
+void BSP_LEDToggle(BSP_LED led);
+void BSP_EnableHbrige(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SimBsp_H
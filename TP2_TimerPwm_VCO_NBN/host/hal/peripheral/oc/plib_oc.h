@@ -0,0 +1,12 @@
+#ifndef SimPlibOc_H
+#define SimPlibOc_H
+
+/*--------------------------------------------------------*/
+// peripheral/oc/plib_oc.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Les PLIB simules sont dclares dans system_definitions.h
+//
+/*--------------------------------------------------------*/
+#include "system_definitions.h"
+
+#endif // SimPlibOc_H
@@ -0,0 +1,12 @@
+#ifndef SimPlibPorts_H
+#define SimPlibPorts_H
+
+/*--------------------------------------------------------*/
+// peripheral/ports/plib_ports.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Les PLIB simules sont dclares dans system_definitions.h
+//
+/*--------------------------------------------------------*/
+#include "system_definitions.h"
+
+#endif // SimPlibPorts_H
@@ -0,0 +1,16 @@
+#ifndef SimAttribs_H
+#define SimAttribs_H
+
+/*--------------------------------------------------------*/
+// sys/attribs.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Les routines d'interruption sont des fonctions ordinaires,
+//               appeles par l'ordonnanceur du simulateur (sim/simDevice.c).
+//
+/*--------------------------------------------------------*/
+
+#define __ISR(vector, ipl)
+#define __ramfunc__
+#define __longramfunc__
+
+#endif // SimAttribs_H
@@ -0,0 +1,15 @@
+#ifndef SimSystemConfig_H
+#define SimSystemConfig_H
+
+/*--------------------------------------------------------*/
+// system_config.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Horloges de la configuration Harmony "default"
+//               (firmware/src/system_config/default/system_config.h)
+//
+/*--------------------------------------------------------*/
+
+#define SYS_CLK_FREQ                80000000ul
+#define SYS_CLK_BUS_PERIPHERAL_1    80000000ul
+
+#endif // SimSystemConfig_H
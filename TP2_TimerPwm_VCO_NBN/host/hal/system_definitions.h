@@ -0,0 +1,212 @@
+#ifndef SimSystemDefinitions_H
+#define SimSystemDefinitions_H
+
+/*--------------------------------------------------------*/
+// system_definitions.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Sous-ensemble des PLIB et pilotes Harmony utiliss par
+//               l'application (INT, USART, PORTS, OC, TMR, DRV_xxx).
+//               Les fonctions sont implmentes par sim/simHal.c ; les
+//               noms et signatures sont ceux de Harmony 1.08.
+//
+/*--------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "system_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uintptr_t SYS_MODULE_OBJ;
+
+/*--------------------------------------------------------*/
+// Contrleur d'interruptions
+/*--------------------------------------------------------*/
+typedef enum {
+    INT_ID_0 = 0
+} INT_MODULE_ID;
+
+// L'ordre n'a pas d'importance : la priorit est celle des vecteurs
+typedef enum {
+    INT_SOURCE_TIMER_1 = 0,
+    INT_SOURCE_TIMER_2,
+    INT_SOURCE_TIMER_3,
+    INT_SOURCE_TIMER_4,
+    INT_SOURCE_TIMER_5,
+    INT_SOURCE_USART_1_ERROR,
+    INT_SOURCE_USART_1_RECEIVE,
+    INT_SOURCE_USART_1_TRANSMIT,
+    INT_SOURCE_ADC_1,
+    INT_SOURCE_NB
+} INT_SOURCE;
+
+typedef enum {
+    INT_VECTOR_T1 = 0,
+    INT_VECTOR_T2,
+    INT_VECTOR_T3,
+    INT_VECTOR_T4,
+    INT_VECTOR_T5,
+    INT_VECTOR_UART1,
+    INT_VECTOR_AD1,
+    INT_VECTOR_NB
+} INT_VECTOR;
+
+typedef enum {
+    INT_DISABLE_INTERRUPT = 0,
+    INT_PRIORITY_LEVEL1,
+    INT_PRIORITY_LEVEL2,
+    INT_PRIORITY_LEVEL3,
+    INT_PRIORITY_LEVEL4,
+    INT_PRIORITY_LEVEL5,
+    INT_PRIORITY_LEVEL6,
+    INT_PRIORITY_LEVEL7
+} INT_PRIORITY_LEVEL;
+
+typedef enum {
+    INT_SUBPRIORITY_LEVEL0 = 0,
+    INT_SUBPRIORITY_LEVEL1,
+    INT_SUBPRIORITY_LEVEL2,
+    INT_SUBPRIORITY_LEVEL3
+} INT_SUBPRIORITY_LEVEL;
+
+bool PLIB_INT_SourceFlagGet(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceFlagSet(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source);
+bool PLIB_INT_SourceIsEnabled(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority);
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector,
+                                   INT_SUBPRIORITY_LEVEL subPriority);
+
+/*--------------------------------------------------------*/
+// UART
+/*--------------------------------------------------------*/
+typedef enum {
+    USART_ID_1 = 0
+} USART_MODULE_ID;
+
+typedef enum {
+    USART_ERROR_NONE = 0x00,
+    USART_ERROR_RECEIVER_OVERRUN = 0x02,
+    USART_ERROR_FRAMING = 0x04,
+    USART_ERROR_PARITY = 0x08
+} USART_ERROR;
+
+typedef enum {
+    USART_TRANSMIT_FIFO_NOT_FULL = 0,   // Au moins une place libre
+    USART_TRANSMIT_FIFO_IDLE = 1,       // Dernier bit sorti (registre  dcalage vide)
+    USART_TRANSMIT_FIFO_EMPTY = 2       // FIFO matriel vide
+} USART_TRANSMIT_INTR_MODE;
+
+USART_ERROR PLIB_USART_ErrorsGet(USART_MODULE_ID index);
+void PLIB_USART_ReceiverOverrunErrorClear(USART_MODULE_ID index);
+bool PLIB_USART_ReceiverDataIsAvailable(USART_MODULE_ID index);
+uint8_t PLIB_USART_ReceiverByteReceive(USART_MODULE_ID index);
+bool PLIB_USART_TransmitterBufferIsFull(USART_MODULE_ID index);
+void PLIB_USART_TransmitterByteSend(USART_MODULE_ID index, uint8_t data);
+bool PLIB_USART_TransmitterIsEmpty(USART_MODULE_ID index);
+void PLIB_USART_TransmitterInterruptModeSelect(USART_MODULE_ID index,
+                                               USART_TRANSMIT_INTR_MODE fifoLevel);
+
+/*--------------------------------------------------------*/
+// Ports
+/*--------------------------------------------------------*/
+typedef enum {
+    PORTS_ID_0 = 0
+} PORTS_MODULE_ID;
+
+typedef enum {
+    PORT_CHANNEL_A = 0,
+    PORT_CHANNEL_B,
+    PORT_CHANNEL_C,
+    PORT_CHANNEL_D,
+    PORT_CHANNEL_E,
+    PORT_CHANNEL_F,
+    PORT_CHANNEL_G,
+    PORT_CHANNEL_NB
+} PORTS_CHANNEL;
+
+typedef enum {
+    PORTS_BIT_POS_0 = 0, PORTS_BIT_POS_1, PORTS_BIT_POS_2, PORTS_BIT_POS_3,
+    PORTS_BIT_POS_4, PORTS_BIT_POS_5, PORTS_BIT_POS_6, PORTS_BIT_POS_7,
+    PORTS_BIT_POS_8, PORTS_BIT_POS_9, PORTS_BIT_POS_10, PORTS_BIT_POS_11,
+    PORTS_BIT_POS_12, PORTS_BIT_POS_13, PORTS_BIT_POS_14, PORTS_BIT_POS_15
+} PORTS_BIT_POS;
+
+typedef uint32_t PORTS_DATA_TYPE;
+
+void PLIB_PORTS_PinSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+void PLIB_PORTS_PinClear(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+PORTS_DATA_TYPE PLIB_PORTS_Read(PORTS_MODULE_ID index, PORTS_CHANNEL channel);
+void PLIB_PORTS_Write(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_DATA_TYPE value);
+
+/*--------------------------------------------------------*/
+// Output Compare
+/*--------------------------------------------------------*/
+typedef enum {
+    OC_ID_1 = 0,
+    OC_ID_2,
+    OC_ID_3,
+    OC_ID_4,
+    OC_ID_5,
+    OC_NUMBER_OF_MODULES
+} OC_MODULE_ID;
+
+void PLIB_OC_PulseWidth16BitSet(OC_MODULE_ID index, uint16_t pulseWidth);
+
+/*--------------------------------------------------------*/
+// Timers
+/*--------------------------------------------------------*/
+typedef enum {
+    TMR_ID_1 = 0,
+    TMR_ID_2,
+    TMR_ID_3,
+    TMR_ID_4,
+    TMR_ID_5,
+    TMR_NUMBER_OF_MODULES
+} TMR_MODULE_ID;
+
+typedef enum {
+    TMR_PRESCALE_VALUE_1 = 0,
+    TMR_PRESCALE_VALUE_2,
+    TMR_PRESCALE_VALUE_4,
+    TMR_PRESCALE_VALUE_8,
+    TMR_PRESCALE_VALUE_16,
+    TMR_PRESCALE_VALUE_32,
+    TMR_PRESCALE_VALUE_64,
+    TMR_PRESCALE_VALUE_256
+} TMR_PRESCALE;
+
+typedef enum {
+    TMR_CLOCK_SOURCE_PERIPHERAL_CLOCK = 0
+} TMR_CLOCK_SOURCE;
+
+void PLIB_TMR_Start(TMR_MODULE_ID index);
+void PLIB_TMR_Stop(TMR_MODULE_ID index);
+void PLIB_TMR_ClockSourceSelect(TMR_MODULE_ID index, TMR_CLOCK_SOURCE source);
+void PLIB_TMR_PrescaleSelect(TMR_MODULE_ID index, TMR_PRESCALE prescale);
+void PLIB_TMR_Mode16BitEnable(TMR_MODULE_ID index);
+void PLIB_TMR_Counter16BitClear(TMR_MODULE_ID index);
+void PLIB_TMR_Period16BitSet(TMR_MODULE_ID index, uint16_t period);
+uint16_t PLIB_TMR_Counter16BitGet(TMR_MODULE_ID index);
+
+/*--------------------------------------------------------*/
+// Pilotes statiques (configuration de system_init.c)
+/*--------------------------------------------------------*/
+bool DRV_TMR0_Start(void);      // Timer 1 : 50 Hz, interruption ipl4
+bool DRV_TMR1_Start(void);      // Timer 2 : 40 kHz (PWM OC2), vecteur dsactiv (ipl6 en mode synchronis)
+bool DRV_TMR2_Start(void);      // Timer 3 : 50 Hz (servo OC3), vecteur dsactiv
+void DRV_OC0_Start(void);       // OC2
+void DRV_OC1_Start(void);       // OC3
+SYS_MODULE_OBJ DRV_USART0_Initialize(void);  // 57600 8N1, interruptions RX et erreur
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "bsp.h"
+
+#endif // SimSystemDefinitions_H
@@ -0,0 +1,135 @@
+#ifndef SimXc_H
+#define SimXc_H
+
+/*--------------------------------------------------------*/
+// xc.h (simulation hte)
+/*--------------------------------------------------------*/
+// Description : Remplace <xc.h> de XC32 pour compiler le firmware sur Linux.
+//               Seuls les registres utiliss par l'application existent ;
+//               ils sont tenus par le simulateur (sim/simHal.c).
+//
+//               Les champs de bits suivent l'ordre du PIC32MX (bit 0 en
+//               premier) : une criture du registre entier met  jour les
+//               champs, comme sur la cible.
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------*/
+// ADC10
+/*--------------------------------------------------------*/
+typedef union {
+    uint32_t w;
+    struct {
+        uint32_t DONE:1;
+        uint32_t SAMP:1;
+        uint32_t ASAM:1;
+        uint32_t :1;
+        uint32_t CLRASAM:1;
+        uint32_t SSRC:3;
+        uint32_t FORM:3;
+        uint32_t :2;
+        uint32_t SIDL:1;
+        uint32_t :1;
+        uint32_t ON:1;
+    } bits;
+} U_simAd1Con1;
+
+typedef union {
+    uint32_t w;
+    struct {
+        uint32_t ALTS:1;
+        uint32_t BUFM:1;
+        uint32_t SMPI:4;
+        uint32_t :1;
+        uint32_t BUFS:1;
+        uint32_t :2;
+        uint32_t CSCNA:1;
+        uint32_t :1;
+        uint32_t OFFCAL:1;
+        uint32_t VCFG:3;
+    } bits;
+} U_simAd1Con2;
+
+typedef union {
+    uint32_t w;
+    struct {
+        uint32_t ADCS:8;
+        uint32_t SAMC:5;
+        uint32_t :2;
+        uint32_t ADRC:1;
+    } bits;
+} U_simAd1Con3;
+
+#define SIM_ADC1BUF_WORDS   64      // ADC1BUF0..F espacs de 4 mots (16 octets)
+
+extern volatile U_simAd1Con1 SIM_Ad1Con1;
+extern volatile U_simAd1Con2 SIM_Ad1Con2;
+extern volatile U_simAd1Con3 SIM_Ad1Con3;
+extern volatile uint32_t SIM_Ad1Chs;
+extern volatile uint32_t SIM_Ad1Cssl;
+extern volatile uint32_t SIM_Ad1Pcfg;
+extern volatile uint32_t SIM_Adc1Buf[SIM_ADC1BUF_WORDS];
+
+#define AD1CON1         (SIM_Ad1Con1.w)
+#define AD1CON1bits     (SIM_Ad1Con1.bits)
+#define AD1CON2         (SIM_Ad1Con2.w)
+#define AD1CON2bits     (SIM_Ad1Con2.bits)
+#define AD1CON3         (SIM_Ad1Con3.w)
+#define AD1CON3bits     (SIM_Ad1Con3.bits)
+#define AD1CHS          SIM_Ad1Chs
+#define AD1CSSL         SIM_Ad1Cssl
+#define AD1PCFG         SIM_Ad1Pcfg
+#define ADC1BUF0        (SIM_Adc1Buf[0])
+#define ADC1BUF8        (SIM_Adc1Buf[32])
+
+/*--------------------------------------------------------*/
+// Contrleur flash (NVM)
+/*--------------------------------------------------------*/
+// NVMCON est lu au travers d'une fonction : l'opration lance par
+// NVMCONSET = WR est excute  la relecture (attente de fin de WR).
+volatile uint32_t *SIM_NvmConReg(void);
+volatile uint32_t *SIM_NvmConSetReg(void);
+volatile uint32_t *SIM_NvmConClrReg(void);
+extern volatile uint32_t SIM_NvmKey;
+extern volatile uint32_t SIM_NvmAddr;
+extern volatile uint32_t SIM_NvmData;
+
+#define NVMCON          (*SIM_NvmConReg())
+#define NVMCONSET       (*SIM_NvmConSetReg())
+#define NVMCONCLR       (*SIM_NvmConClrReg())
+#define NVMKEY          SIM_NvmKey
+#define NVMADDR         SIM_NvmAddr
+#define NVMDATA         SIM_NvmData
+
+/*--------------------------------------------------------*/
+// Coeur MIPS
+/*--------------------------------------------------------*/
+// Core timer  SYS_CLK / 2 ; chaque lecture consomme un tick de temps simul
+// (les attentes actives du firmware se terminent).
+uint32_t SIM_CoreTimerRead(void);
+unsigned int SIM_DisableInterrupts(void);
+void SIM_EnableInterrupts(void);
+
+#define _CP0_GET_COUNT()                SIM_CoreTimerRead()
+#define __builtin_disable_interrupts()  SIM_DisableInterrupts()
+#define __builtin_enable_interrupts()   SIM_EnableInterrupts()
+
+// Segments KSEG0/KSEG1 : la flash programme est une image en mmoire hte
+uintptr_t SIM_FlashVa(uint32_t physAddr);
+
+#define KVA_TO_PA(v)    ((uint32_t)(v) & 0x1FFFFFFF)
+#define PA_TO_KVA0(pa)  SIM_FlashVa(pa)
+#define PA_TO_KVA1(pa)  SIM_FlashVa(pa)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SimXc_H
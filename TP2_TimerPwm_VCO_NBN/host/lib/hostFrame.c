@@ -0,0 +1,154 @@
+/*--------------------------------------------------------*/
+// HostFrame.c
+/*--------------------------------------------------------*/
+//	Description :	Codage et dcoupage des trames RS232 ct hte
+//
+/*--------------------------------------------------------*/
+#include <string.h>
+
+#include "hostFrame.h"
+#include "Mc32CalCrc16.h"
+
+uint16_t HFRAME_Crc(const uint8_t *pData, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        crc = updateCRC16(crc, pData[i]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Ajoute le CRC16 des octets dj placs.
+ *
+ * @return Taille totale de la trame.
+ */
+static uint8_t HFRAME_PutCrc(uint8_t *pFrame, uint8_t size)
+{
+    uint16_t crc = HFRAME_Crc(pFrame, size);
+
+    pFrame[size] = (uint8_t)(crc >> 8);
+    pFrame[size + 1] = (uint8_t)(crc & 0x00FF);
+    return size + CMD_CRC_SIZE;
+}
+
+uint8_t HFRAME_EncodeSetpoint(uint8_t *pFrame, uint8_t multidrop, uint8_t addr,
+                              int8_t speed, int8_t angle)
+{
+    uint8_t n = 0;
+
+    pFrame[n++] = HFRAME_STX_SETPOINT;
+    if (multidrop) {
+        pFrame[n++] = addr;
+    }
+    pFrame[n++] = (uint8_t)speed;
+    pFrame[n++] = (uint8_t)angle;
+    return HFRAME_PutCrc(pFrame, n);
+}
+
+uint8_t HFRAME_EncodeCommand(uint8_t *pFrame, uint8_t multidrop, uint8_t addr, uint8_t cmd,
+                             const uint8_t *pPayload, uint8_t len)
+{
+    uint8_t n = 0;
+
+    if (len > CMD_PAYLOAD_MAX) {
+        return 0;
+    }
+    pFrame[n++] = HFRAME_STX_CMD;
+    if (multidrop) {
+        pFrame[n++] = addr;
+    }
+    pFrame[n++] = cmd;
+    pFrame[n++] = len;
+    if (len > 0) {
+        memcpy(&pFrame[n], pPayload, len);
+        n += len;
+    }
+    return HFRAME_PutCrc(pFrame, n);
+}
+
+void HFRAME_Init(S_hframeScanner *pScan, uint8_t multidrop)
+{
+    memset(pScan, 0, sizeof(*pScan));
+    pScan->AddrSize = multidrop ? 1 : 0;
+}
+
+/**
+ * @brief Retire les n premiers octets du buffer.
+ */
+static void HFRAME_Drop(S_hframeScanner *pScan, uint8_t n)
+{
+    pScan->Count -= n;
+    memmove(pScan->Buf, &pScan->Buf[n], pScan->Count);
+}
+
+int HFRAME_Feed(S_hframeScanner *pScan, uint8_t byte, S_hframe *pOut)
+{
+    uint8_t *pBuf = pScan->Buf;
+    uint8_t a = pScan->AddrSize;
+    uint8_t size;
+    int type;
+
+    pBuf[pScan->Count++] = byte;
+
+    while (pScan->Count > 0)
+    {
+        // Recherche du code de dbut
+        if ((pBuf[0] != HFRAME_STX_SETPOINT) && (pBuf[0] != HFRAME_STX_CMD)) {
+            pScan->Skipped++;
+            HFRAME_Drop(pScan, 1);
+            continue;
+        }
+
+        if (pBuf[0] == HFRAME_STX_SETPOINT) {
+            type = HFRAME_SETPOINT;
+            size = 1 + a + 2 + CMD_CRC_SIZE;
+        } else {
+            type = HFRAME_COMMAND;
+            if (pScan->Count < (3 + a)) {
+                return HFRAME_NONE;
+            }
+            if (pBuf[2 + a] > CMD_PAYLOAD_MAX) {
+                pScan->Skipped++;
+                HFRAME_Drop(pScan, 1);
+                continue;
+            }
+            size = 3 + a + pBuf[2 + a] + CMD_CRC_SIZE;
+        }
+        if (pScan->Count < size) {
+            return HFRAME_NONE;
+        }
+
+        // Trame complte : CRC faux => faux code de dbut, dcalage d'un octet
+        if (HFRAME_Crc(pBuf, size - CMD_CRC_SIZE) !=
+            (uint16_t)((pBuf[size - 2] << 8) | pBuf[size - 1])) {
+            pScan->BadCrc++;
+            pScan->Skipped++;
+            HFRAME_Drop(pScan, 1);
+            continue;
+        }
+
+        memset(pOut, 0, sizeof(*pOut));
+        pOut->Addr = a ? pBuf[1] : 0;
+        if (type == HFRAME_SETPOINT) {
+            pOut->Speed = (int8_t)pBuf[1 + a];
+            pOut->Angle = (int8_t)pBuf[2 + a];
+        } else {
+            pOut->Cmd = pBuf[1 + a];
+            pOut->Len = pBuf[2 + a];
+            memcpy(pOut->Data, &pBuf[3 + a], pOut->Len);
+        }
+        pScan->Frames++;
+        HFRAME_Drop(pScan, size);
+        return type;
+    }
+    return HFRAME_NONE;
+}
+
+uint32_t HFRAME_GetU32(const uint8_t *pData)
+{
+    return ((uint32_t)pData[0] << 24) | ((uint32_t)pData[1] << 16) |
+           ((uint32_t)pData[2] << 8) | pData[3];
+}
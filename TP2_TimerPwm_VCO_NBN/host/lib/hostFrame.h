@@ -0,0 +1,111 @@
+#ifndef HostFrame_H
+#define HostFrame_H
+
+/*--------------------------------------------------------*/
+// HostFrame.h
+/*--------------------------------------------------------*/
+// Description : Trames RS232 ct hte (format dcrit dans
+//               firmware/src/gestFrame.h) : codage et dcoupage d'un flux
+//               d'octets reus en trames de consigne et de commande.
+//
+//               Le mode multipoint est un choix  l'excution (un mme
+//               outil parle aux deux variantes du firmware), contrairement
+//                gestFrame o RS232_MULTIDROP est fix  la compilation.
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "gestFrame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+#define HFRAME_STX_SETPOINT  0xAA
+#define HFRAME_STX_CMD       0xAB
+#define HFRAME_MAX_SIZE      (4 + CMD_PAYLOAD_MAX + CMD_CRC_SIZE) // Commande multipoint pleine
+
+// Rsultat de HFRAME_Feed
+#define HFRAME_NONE          0      // Trame incomplte
+#define HFRAME_SETPOINT      1      // Trame de consigne valide
+#define HFRAME_COMMAND       2      // Trame de commande valide
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Trame dcode.
+ */
+typedef struct {
+    uint8_t Addr;                   // Adresse (multipoint), 0 sinon
+    int8_t Speed;                   // Consigne (HFRAME_SETPOINT)
+    int8_t Angle;
+    uint8_t Cmd;                    // Code de commande (HFRAME_COMMAND)
+    uint8_t Len;
+    uint8_t Data[CMD_PAYLOAD_MAX];
+} S_hframe;
+
+/**
+ * @brief Dcoupeur de flux : resynchronise sur le code de dbut suivant
+ *        aprs un CRC faux ou une longueur invalide.
+ */
+typedef struct {
+    uint8_t AddrSize;               // 1 = multipoint (octet d'adresse)
+    uint8_t Buf[HFRAME_MAX_SIZE];
+    uint8_t Count;                  // Octets de la trame en cours
+    uint32_t Frames;                // Trames valides
+    uint32_t BadCrc;                // Trames compltes au CRC faux
+    uint32_t Skipped;               // Octets carts hors trame
+} S_hframeScanner;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief CRC16 d'une suite d'octets (mme table que la carte).
+ */
+uint16_t HFRAME_Crc(const uint8_t *pData, size_t size);
+
+/**
+ * @brief Construit une trame de consigne.
+ * @param multidrop 1 = octet d'adresse aprs le code de dbut.
+ * @return Taille de la trame.
+ */
+uint8_t HFRAME_EncodeSetpoint(uint8_t *pFrame, uint8_t multidrop, uint8_t addr,
+                              int8_t speed, int8_t angle);
+
+/**
+ * @brief Construit une trame de commande.
+ * @return Taille de la trame, 0 si len > CMD_PAYLOAD_MAX.
+ */
+uint8_t HFRAME_EncodeCommand(uint8_t *pFrame, uint8_t multidrop, uint8_t addr, uint8_t cmd,
+                             const uint8_t *pPayload, uint8_t len);
+
+/**
+ * @brief Initialise un dcoupeur.
+ * @param multidrop 1 = trames avec octet d'adresse.
+ */
+void HFRAME_Init(S_hframeScanner *pScan, uint8_t multidrop);
+
+/**
+ * @brief Ajoute un octet reu.
+ * @param pOut Trame dcode quand le rsultat est diffrent de HFRAME_NONE.
+ * @return HFRAME_NONE, HFRAME_SETPOINT ou HFRAME_COMMAND.
+ */
+int HFRAME_Feed(S_hframeScanner *pScan, uint8_t byte, S_hframe *pOut);
+
+/**
+ * @brief Lit un entier 32 bits MSB en premier (compteurs des rponses).
+ */
+uint32_t HFRAME_GetU32(const uint8_t *pData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HostFrame_H
@@ -0,0 +1,211 @@
+/*--------------------------------------------------------*/
+// HostTelem.c
+/*--------------------------------------------------------*/
+//	Description :	Dcodage des trames de tlmtrie (brut, delta
+//			        + varint zig-zag, run-length) et suivi des pertes
+//
+/*--------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hostTelem.h"
+
+#define HTELEM_VARINT_MAX   3   // Octets max. d'un varint 16 bits
+
+/**
+ * @brief Lit un varint (7 bits par octet, poids faibles en premier).
+ *
+ * @param pData  Donnes.
+ * @param len    Taille des donnes.
+ * @param pPos   Position courante, avance aprs lecture.
+ * @param pValue Valeur lue.
+ * @return 1 si lu, 0 si donnes puises ou varint trop long.
+ */
+static int HTELEM_GetVarint(const uint8_t *pData, uint8_t len, uint8_t *pPos, uint16_t *pValue)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t n;
+    uint8_t c;
+
+    for (n = 0; n < HTELEM_VARINT_MAX; n++)
+    {
+        if (*pPos >= len) {
+            return 0;
+        }
+        c = pData[(*pPos)++];
+        value |= (uint32_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            *pValue = (uint16_t)value;
+            return 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+/**
+ * @brief Dcodage zig-zag : 0, 1, 2, 3... => 0, -1, 1, -2...
+ */
+static int16_t HTELEM_UnZigZag(uint16_t value)
+{
+    return (int16_t)((value >> 1) ^ (uint16_t)(-(int16_t)(value & 1)));
+}
+
+/**
+ * @brief Lit un chantillon cod en delta.
+ *
+ * @return 1 si lu, 0 si donnes puises.
+ */
+static int HTELEM_GetDelta(const uint8_t *pData, uint8_t len, uint8_t *pPos, S_telemSample *pPrev)
+{
+    uint16_t zz;
+    uint8_t i;
+
+    for (i = 0; i < GTELEM_NB_CHANNELS; i++)
+    {
+        if (!HTELEM_GetVarint(pData, len, pPos, &zz)) {
+            return 0;
+        }
+        pPrev->Value[i] = (int16_t)(uint16_t)(pPrev->Value[i] + HTELEM_UnZigZag(zz));
+    }
+    return 1;
+}
+
+/**
+ * @brief Dcode les donnes d'une trame CMD_TELEMETRY.
+ *
+ * @param pData    Donnes de la trame, en-tte compris.
+ * @param len      Nombre d'octets de donnes.
+ * @param pHeader  En-tte lu (peut tre NULL).
+ * @param pOut     chantillons dcods.
+ * @param maxOut   Taille de pOut.
+ * @return Nombre d'chantillons, ou HTELEM_ERR_xxx.
+ */
+int HTELEM_DecodeFrame(const uint8_t *pData, uint8_t len, S_telemHeader *pHeader,
+                       S_telemSample *pOut, uint8_t maxOut)
+{
+    S_telemSample prev = { { 0 } };    // Valeurs de rfrence  0 en dbut de trame
+    uint8_t pos = GTELEM_HEADER_SIZE;
+    uint8_t nb;
+    uint8_t count = 0;
+    uint8_t run;
+    uint8_t i;
+
+    if (len < GTELEM_HEADER_SIZE) {
+        return HTELEM_ERR_HEADER;
+    }
+    if (pHeader != NULL) {
+        pHeader->Mode = pData[0];
+        pHeader->Seq = pData[1];
+        pHeader->NbSamples = pData[2];
+    }
+    nb = pData[2];
+    if (nb > maxOut) {
+        return HTELEM_ERR_SPACE;
+    }
+
+    switch (pData[0])
+    {
+        case GTELEM_MODE_RAW:
+        {
+            for (count = 0; count < nb; count++) {
+                if ((pos + (2 * GTELEM_NB_CHANNELS)) > len) {
+                    return HTELEM_ERR_TRUNC;
+                }
+                for (i = 0; i < GTELEM_NB_CHANNELS; i++) {
+                    pOut[count].Value[i] = (int16_t)(((uint16_t)pData[pos] << 8) | pData[pos + 1]);
+                    pos += 2;
+                }
+            }
+            break;
+        }
+
+        case GTELEM_MODE_DELTA:
+        {
+            for (count = 0; count < nb; count++) {
+                if (!HTELEM_GetDelta(pData, len, &pos, &prev)) {
+                    return HTELEM_ERR_TRUNC;
+                }
+                pOut[count] = prev;
+            }
+            break;
+        }
+
+        case GTELEM_MODE_RLE:
+        {
+            while (count < nb)
+            {
+                if (pos >= len) {
+                    return HTELEM_ERR_TRUNC;
+                }
+                run = pData[pos++];
+                if (run == 0) {
+                    if (!HTELEM_GetDelta(pData, len, &pos, &prev)) {
+                        return HTELEM_ERR_TRUNC;
+                    }
+                    pOut[count++] = prev;
+                } else {
+                    // Une rptition suit toujours un chantillon de la trame
+                    if ((count == 0) || ((count + run) > nb)) {
+                        return HTELEM_ERR_TRUNC;
+                    }
+                    for (i = 0; i < run; i++) {
+                        pOut[count++] = prev;
+                    }
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            return HTELEM_ERR_MODE;
+        }
+    }
+
+    if (pos != len) {
+        return HTELEM_ERR_EXTRA;
+    }
+    return count;
+}
+
+/**
+ * @brief Remet  zro le suivi d'un flux.
+ */
+void HTELEM_StreamInit(S_telemStream *pS)
+{
+    pS->Synced = 0;
+    pS->NextSeq = 0;
+    pS->Frames = 0;
+    pS->Samples = 0;
+    pS->FramesLost = 0;
+    pS->FramesBad = 0;
+}
+
+/**
+ * @brief Dcode une trame du flux et compte les trames perdues avant elle.
+ *
+ * @details Une trame rejete ne resynchronise pas Seq : si elle est perdue
+ *          (CRC valide mais contenu incohrent), la suivante compte l'cart.
+ */
+int HTELEM_StreamFrame(S_telemStream *pS, const uint8_t *pData, uint8_t len,
+                       S_telemSample *pOut, uint8_t maxOut)
+{
+    S_telemHeader header;
+    int nb;
+
+    nb = HTELEM_DecodeFrame(pData, len, &header, pOut, maxOut);
+    if (nb < 0) {
+        pS->FramesBad++;
+        return nb;
+    }
+    if (pS->Synced) {
+        pS->FramesLost += (uint8_t)(header.Seq - pS->NextSeq);
+    }
+    pS->Synced = 1;
+    pS->NextSeq = (uint8_t)(header.Seq + 1);
+    pS->Frames++;
+    pS->Samples += (uint32_t)nb;
+    return nb;
+}
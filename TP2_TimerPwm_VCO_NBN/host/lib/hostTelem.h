@@ -0,0 +1,102 @@
+#ifndef HostTelem_H
+#define HostTelem_H
+
+/*--------------------------------------------------------*/
+// HostTelem.h
+/*--------------------------------------------------------*/
+// Description : Dcodage ct hte des trames CMD_TELEMETRY
+//               (format dcrit dans firmware/src/gestTelem.h)
+//
+//               Module C sans dpendance : utilis par les tests et par
+//               la bibliothque client tp2link.
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include "gestTelem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+#define HTELEM_ERR_HEADER   (-1)    // Trame plus courte que l'en-tte
+#define HTELEM_ERR_MODE     (-2)    // Mode inconnu ou GTELEM_MODE_OFF
+#define HTELEM_ERR_TRUNC    (-3)    // Donnes puises avant NbSamples chantillons
+#define HTELEM_ERR_EXTRA    (-4)    // Octets en trop aprs NbSamples chantillons
+#define HTELEM_ERR_SPACE    (-5)    // Buffer de sortie trop petit
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Un chantillon : valeurs dans l'ordre de gestTelem.h.
+ */
+typedef struct {
+    int16_t Value[GTELEM_NB_CHANNELS];  // SpeedSetting, AngleSetting, ADC 0, ADC 1
+} S_telemSample;
+
+/**
+ * @brief En-tte d'une trame dcode.
+ */
+typedef struct {
+    uint8_t Mode;
+    uint8_t Seq;
+    uint8_t NbSamples;
+} S_telemHeader;
+
+/**
+ * @brief Suivi d'un flux de trames : dtection des trames perdues par Seq.
+ */
+typedef struct {
+    uint8_t Synced;         // 0 tant qu'aucune trame n'a t reue
+    uint8_t NextSeq;        // Seq attendu
+    uint32_t Frames;        // Trames dcodes
+    uint32_t Samples;       // chantillons dcods
+    uint32_t FramesLost;    // Trames manquantes (carts de Seq)
+    uint32_t FramesBad;     // Trames rejetes par le dcodeur
+} S_telemStream;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Dcode les donnes d'une trame CMD_TELEMETRY.
+ * @param pData    Donnes de la trame (en-tte Mode, Seq, NbSamples compris).
+ * @param len      Nombre d'octets de donnes.
+ * @param pHeader  En-tte lu (peut tre NULL).
+ * @param pOut     chantillons dcods.
+ * @param maxOut   Taille de pOut.
+ * @return Nombre d'chantillons (= NbSamples), ou HTELEM_ERR_xxx.
+ */
+int HTELEM_DecodeFrame(const uint8_t *pData, uint8_t len, S_telemHeader *pHeader,
+                       S_telemSample *pOut, uint8_t maxOut);
+
+/**
+ * @brief Remet  zro le suivi d'un flux.
+ */
+void HTELEM_StreamInit(S_telemStream *pS);
+
+/**
+ * @brief Dcode une trame du flux et compte les trames perdues avant elle.
+ * @param pS     Flux.
+ * @param pData  Donnes de la trame.
+ * @param len    Nombre d'octets de donnes.
+ * @param pOut   chantillons dcods.
+ * @param maxOut Taille de pOut.
+ * @return Nombre d'chantillons, ou HTELEM_ERR_xxx (trame compte dans FramesBad).
+ *
+ * @details Les trames tant autonomes, une perte n'affecte que ses propres
+ *          chantillons : le dcodage reprend  la trame suivante.
+ */
+int HTELEM_StreamFrame(S_telemStream *pS, const uint8_t *pData, uint8_t len,
+                       S_telemSample *pOut, uint8_t maxOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HostTelem_H
@@ -0,0 +1,226 @@
+/*--------------------------------------------------------*/
+// EventLoop.cpp
+/*--------------------------------------------------------*/
+//	Description :	Boucle d'vnements epoll + timerfd + eventfd
+//
+/*--------------------------------------------------------*/
+#include "eventLoop.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace tp2link {
+
+namespace {
+
+constexpr int kMaxEvents = 32;
+
+[[noreturn]] void throwErrno(const char *what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+EventLoop::EventLoop()
+{
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((epfd_ < 0) || (timerFd_ < 0) || (eventFd_ < 0)) {
+        throwErrno("EventLoop");
+    }
+    add(timerFd_, EPOLLIN, [this](uint32_t) {
+        uint64_t expirations;
+        (void)!read(timerFd_, &expirations, sizeof(expirations));
+        runTimers();
+    });
+    add(eventFd_, EPOLLIN, [this](uint32_t) {
+        uint64_t count;
+        (void)!read(eventFd_, &count, sizeof(count));
+        runPosted();
+    });
+}
+
+EventLoop::~EventLoop()
+{
+    close(eventFd_);
+    close(timerFd_);
+    close(epfd_);
+}
+
+void EventLoop::add(int fd, uint32_t events, FdHandler handler)
+{
+    struct epoll_event ev;
+
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        throwErrno("epoll_ctl ADD");
+    }
+    handlers_[fd] = std::move(handler);
+}
+
+void EventLoop::modify(int fd, uint32_t events)
+{
+    struct epoll_event ev;
+
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        throwErrno("epoll_ctl MOD");
+    }
+}
+
+void EventLoop::remove(int fd)
+{
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(fd);
+}
+
+EventLoop::TimerId EventLoop::addTimer(Clock::duration delay, std::function<void()> cb)
+{
+    TimerId id = nextTimer_++;
+    Clock::time_point due = Clock::now() + delay;
+
+    timers_.emplace(id, std::make_pair(due, std::move(cb)));
+    deadlines_.emplace(due, id);
+    if (deadlines_.begin()->second == id) {
+        armTimerFd();
+    }
+    return id;
+}
+
+void EventLoop::cancelTimer(TimerId id)
+{
+    auto it = timers_.find(id);
+
+    if (it == timers_.end()) {
+        return;
+    }
+    auto range = deadlines_.equal_range(it->second.first);
+    for (auto d = range.first; d != range.second; ++d) {
+        if (d->second == id) {
+            deadlines_.erase(d);
+            break;
+        }
+    }
+    timers_.erase(it);
+    // Le timerfd peut rester arm sur l'chance annule : runTimers n'y trouve rien
+}
+
+void EventLoop::armTimerFd()
+{
+    struct itimerspec its;
+
+    std::memset(&its, 0, sizeof(its));
+    if (!deadlines_.empty()) {
+        auto delay = deadlines_.begin()->first - Clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+        if (ns < 1) {
+            ns = 1;             // 0 dsarmerait le timerfd
+        }
+        its.it_value.tv_sec = ns / 1000000000;
+        its.it_value.tv_nsec = ns % 1000000000;
+    }
+    timerfd_settime(timerFd_, 0, &its, nullptr);
+}
+
+void EventLoop::runTimers()
+{
+    Clock::time_point now = Clock::now();
+
+    while (!deadlines_.empty() && (deadlines_.begin()->first <= now)) {
+        TimerId id = deadlines_.begin()->second;
+        deadlines_.erase(deadlines_.begin());
+        auto it = timers_.find(id);
+        if (it != timers_.end()) {
+            std::function<void()> cb = std::move(it->second.second);
+            timers_.erase(it);
+            cb();
+        }
+    }
+    armTimerFd();
+}
+
+void EventLoop::post(std::function<void()> cb)
+{
+    uint64_t one = 1;
+
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        posted_.push_back(std::move(cb));
+    }
+    (void)!write(eventFd_, &one, sizeof(one));
+}
+
+void EventLoop::runPosted()
+{
+    std::vector<std::function<void()>> tasks;
+
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        tasks.swap(posted_);
+    }
+    for (auto &task : tasks) {
+        task();
+    }
+}
+
+void EventLoop::runOnce(Clock::duration timeout)
+{
+    struct epoll_event events[kMaxEvents];
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+    int nb = epoll_wait(epfd_, events, kMaxEvents, (ms < 0) ? -1 : (int)ms);
+
+    if (nb < 0) {
+        if (errno == EINTR) {
+            return;
+        }
+        throwErrno("epoll_wait");
+    }
+    for (int i = 0; i < nb; i++) {
+        // Un gestionnaire prcdent a pu retirer ce descripteur
+        auto it = handlers_.find(events[i].data.fd);
+        if (it != handlers_.end()) {
+            FdHandler handler = it->second;
+            handler(events[i].events);
+        }
+    }
+}
+
+bool EventLoop::runUntil(const std::function<bool()> &pred, Clock::duration timeout)
+{
+    Clock::time_point end = Clock::now() + timeout;
+
+    while (!pred()) {
+        Clock::time_point now = Clock::now();
+        if (now >= end) {
+            return false;
+        }
+        runOnce(end - now + std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void EventLoop::run()
+{
+    stopped_ = false;
+    while (!stopped_) {
+        runOnce(std::chrono::milliseconds(-1));
+    }
+}
+
+void EventLoop::stop()
+{
+    post([this] { stopped_ = true; });
+}
+
+} // namespace tp2link
@@ -0,0 +1,92 @@
+#ifndef Tp2link_EventLoop_HPP
+#define Tp2link_EventLoop_HPP
+
+/*--------------------------------------------------------*/
+// EventLoop.hpp
+/*--------------------------------------------------------*/
+// Description : Boucle d'vnements mono-thread (epoll) : descripteurs,
+//               temporisations (un timerfd arm sur la plus proche
+//               chance) et tches postes depuis d'autres threads
+//               (eventfd).
+//
+//               Seuls post() et stop() peuvent tre appels hors du
+//               thread qui excute run().
+//
+/*--------------------------------------------------------*/
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tp2link {
+
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using FdHandler = std::function<void(uint32_t events)>;
+    using TimerId = uint64_t;
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    /**
+     * @brief Surveille un descripteur (EPOLLIN, EPOLLOUT...).
+     */
+    void add(int fd, uint32_t events, FdHandler handler);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    /**
+     * @brief Appelle cb une fois aprs delay.
+     * @return Identifiant pour cancelTimer.
+     */
+    TimerId addTimer(Clock::duration delay, std::function<void()> cb);
+    void cancelTimer(TimerId id);
+
+    /**
+     * @brief Excute cb dans le thread de la boucle (thread-safe).
+     */
+    void post(std::function<void()> cb);
+
+    /**
+     * @brief Traite les vnements prts, en attendant au plus timeout.
+     */
+    void runOnce(Clock::duration timeout);
+
+    /**
+     * @brief Traite les vnements jusqu' ce que pred soit vrai.
+     * @return false si timeout est coul avant.
+     */
+    bool runUntil(const std::function<bool()> &pred, Clock::duration timeout);
+
+    /**
+     * @brief Traite les vnements jusqu' stop().
+     */
+    void run();
+    void stop();
+
+private:
+    void armTimerFd();
+    void runTimers();
+    void runPosted();
+
+    int epfd_;
+    int timerFd_;
+    int eventFd_;
+    bool stopped_ = false;
+    std::unordered_map<int, FdHandler> handlers_;
+    std::multimap<Clock::time_point, TimerId> deadlines_;
+    std::unordered_map<TimerId, std::pair<Clock::time_point, std::function<void()>>> timers_;
+    TimerId nextTimer_ = 1;
+    std::mutex postMutex_;
+    std::vector<std::function<void()>> posted_;
+};
+
+} // namespace tp2link
+
+#endif // Tp2link_EventLoop_HPP
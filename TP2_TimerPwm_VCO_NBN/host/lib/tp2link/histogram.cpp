@@ -0,0 +1,130 @@
+/*--------------------------------------------------------*/
+// Histogram.cpp
+/*--------------------------------------------------------*/
+//	Description :	Distribution de dures (percentiles, barres)
+//
+/*--------------------------------------------------------*/
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace tp2link {
+
+namespace {
+
+constexpr int kBarWidth = 40;
+
+/**
+ * @brief Borne de tranche suivante dans la suite 1, 2, 5, 10, 20...
+ */
+double nextBound(double bound)
+{
+    double decade = std::pow(10.0, std::floor(std::log10(bound) + 1e-9));
+    double mantissa = bound / decade;
+
+    if (mantissa < 1.5) {
+        return 2 * decade;
+    }
+    if (mantissa < 3.5) {
+        return 5 * decade;
+    }
+    return 10 * decade;
+}
+
+} // namespace
+
+void Histogram::sort() const
+{
+    if (!sorted_) {
+        std::sort(values_.begin(), values_.end());
+        sorted_ = true;
+    }
+}
+
+void Histogram::merge(const Histogram &other)
+{
+    values_.insert(values_.end(), other.values_.begin(), other.values_.end());
+    sorted_ = false;
+}
+
+double Histogram::min() const
+{
+    sort();
+    return values_.empty() ? 0.0 : values_.front();
+}
+
+double Histogram::max() const
+{
+    sort();
+    return values_.empty() ? 0.0 : values_.back();
+}
+
+double Histogram::mean() const
+{
+    if (values_.empty()) {
+        return 0.0;
+    }
+    return std::accumulate(values_.begin(), values_.end(), 0.0) / (double)values_.size();
+}
+
+double Histogram::percentile(double p) const
+{
+    if (values_.empty()) {
+        return 0.0;
+    }
+    sort();
+    // Rang le plus proche
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)values_.size());
+    if (rank > 0) {
+        rank--;
+    }
+    return values_[std::min(rank, values_.size() - 1)];
+}
+
+std::string Histogram::summary(const char *unit) const
+{
+    char line[200];
+
+    std::snprintf(line, sizeof(line), "n=%zu min=%.1f p50=%.1f p90=%.1f p99=%.1f max=%.1f %s",
+                  count(), min(), percentile(50), percentile(90), percentile(99), max(), unit);
+    return line;
+}
+
+void Histogram::print(FILE *out, const char *title, const char *unit) const
+{
+    std::fprintf(out, "%s : %s\n", title, summary(unit).c_str());
+    if (values_.empty()) {
+        return;
+    }
+    sort();
+
+    // Premire tranche : plus grande borne 1, 2, 5 x 10^k infrieure au minimum
+    double first = std::max(values_.front(), 1e-3);
+    double low = std::pow(10.0, std::floor(std::log10(first)));
+    while (nextBound(low) <= first) {
+        low = nextBound(low);
+    }
+
+    std::vector<std::pair<double, size_t>> bins;
+    size_t i = 0;
+    size_t peak = 1;
+    for (double bound = low; i < values_.size(); bound = nextBound(bound)) {
+        double high = nextBound(bound);
+        size_t n = 0;
+        while ((i < values_.size()) && (values_[i] < high)) {
+            n++;
+            i++;
+        }
+        bins.emplace_back(bound, n);
+        peak = std::max(peak, n);
+    }
+    for (size_t b = 0; b < bins.size(); b++) {
+        int width = (int)((bins[b].second * kBarWidth + peak - 1) / peak);
+        std::fprintf(out, "  >= %8.1f %-3s %7zu %s\n", bins[b].first, unit, bins[b].second,
+                     std::string((size_t)width, '#').c_str());
+    }
+}
+
+} // namespace tp2link
@@ -0,0 +1,53 @@
+#ifndef Tp2link_Histogram_HPP
+#define Tp2link_Histogram_HPP
+
+/*--------------------------------------------------------*/
+// Histogram.hpp
+/*--------------------------------------------------------*/
+// Description : Distribution de dures pour les outils de mesure :
+//               chantillons conservs (percentiles exacts) et affichage
+//               en barres par tranches logarithmiques.
+//
+/*--------------------------------------------------------*/
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace tp2link {
+
+class Histogram {
+public:
+    void add(double value) { values_.push_back(value); sorted_ = false; }
+    void clear() { values_.clear(); }
+    void merge(const Histogram &other);
+    size_t count() const { return values_.size(); }
+
+    double min() const;
+    double max() const;
+    double mean() const;
+
+    /**
+     * @brief Percentile p (0  100), 0 si vide.
+     */
+    double percentile(double p) const;
+
+    /**
+     * @brief Ligne de rsum : n, min, p50, p90, p99, max.
+     */
+    std::string summary(const char *unit) const;
+
+    /**
+     * @brief Barres par tranches (bornes 1, 2, 5 x 10^k).
+     */
+    void print(FILE *out, const char *title, const char *unit) const;
+
+private:
+    void sort() const;
+
+    mutable std::vector<double> values_;
+    mutable bool sorted_ = true;
+};
+
+} // namespace tp2link
+
+#endif // Tp2link_Histogram_HPP
@@ -0,0 +1,419 @@
+/*--------------------------------------------------------*/
+// Port.cpp
+/*--------------------------------------------------------*/
+//	Description :	Protocole RS232 ct hte : file des requtes,
+//			        association des rponses, dlais
+//
+/*--------------------------------------------------------*/
+#include "port.hpp"
+
+#include <stdexcept>
+
+namespace tp2link {
+
+/*--------------------------------------------------------*/
+// Erreurs
+/*--------------------------------------------------------*/
+
+namespace {
+
+class ErrorCategory : public std::error_category {
+public:
+    const char *name() const noexcept override { return "tp2link"; }
+    std::string message(int ev) const override
+    {
+        switch (static_cast<Errc>(ev)) {
+            case Errc::Timeout: return "pas de reponse";
+            case Errc::Closed: return "port ferme";
+            case Errc::BadResponse: return "reponse invalide";
+        }
+        return "erreur inconnue";
+    }
+};
+
+constexpr uint8_t kPingSeqOffset = 1;   // [Etat, Seq, ...]
+constexpr uint8_t kRelSeqOffset = 0;    // [Seq, CumAck, Sack, ...]
+constexpr size_t kPingSize = 2 + 4 * 4;
+constexpr size_t kParamSize = 4;        // [Etat, Id, ValMsb, ValLsb]
+
+} // namespace
+
+const std::error_category &errorCategory()
+{
+    static ErrorCategory category;
+    return category;
+}
+
+std::error_code make_error_code(Errc e)
+{
+    return std::error_code(static_cast<int>(e), errorCategory());
+}
+
+bool decodePing(const Response &resp, PingResult &out)
+{
+    if (resp.Data.size() < kPingSize) {
+        return false;
+    }
+    out.Seq = resp.Data[kPingSeqOffset];
+    out.TRx = resp.u32(2);
+    out.TParse = resp.u32(6);
+    out.TApply = resp.u32(10);
+    out.TReply = resp.u32(14);
+    out.Rtt = resp.Rtt;
+    return true;
+}
+
+/*--------------------------------------------------------*/
+// Device
+/*--------------------------------------------------------*/
+
+Device::Device(Port &port, uint8_t addr)
+    : port_(port), addr_(addr)
+{
+    HTELEM_StreamInit(&telem_);
+}
+
+void Device::command(uint8_t cmd, std::vector<uint8_t> payload, ResponseCallback cb,
+                     EventLoop::Clock::duration timeout)
+{
+    Port::Request req;
+    uint8_t frame[HFRAME_MAX_SIZE];
+
+    if (payload.size() > CMD_PAYLOAD_MAX) {
+        throw std::invalid_argument("commande trop longue");
+    }
+    uint8_t size = HFRAME_EncodeCommand(frame, port_.options_.Multidrop, addr_, cmd,
+                                        payload.data(), (uint8_t)payload.size());
+    req.Addr = addr_;
+    req.Cmd = cmd;
+    req.Frame.assign(frame, frame + size);
+    req.Cb = std::move(cb);
+    req.Timeout = (timeout == EventLoop::Clock::duration::zero()) ? port_.options_.Timeout : timeout;
+    // La diffusion n'a pas de rponse
+    req.ExpectReply = !(port_.options_.Multidrop && (addr_ == RS232_ADDR_BROADCAST));
+    if (!payload.empty() && (cmd == CMD_PING)) {
+        req.SeqOffset = kPingSeqOffset;
+        req.Seq = payload[0];
+    } else if (!payload.empty() && (cmd == CMD_REL_DATA)) {
+        req.SeqOffset = kRelSeqOffset;
+        req.Seq = payload[0];
+    }
+    port_.submit(std::move(req));
+}
+
+std::future<Response> Device::request(uint8_t cmd, std::vector<uint8_t> payload,
+                                      EventLoop::Clock::duration timeout)
+{
+    auto promise = std::make_shared<std::promise<Response>>();
+    std::future<Response> future = promise->get_future();
+    std::weak_ptr<bool> alive = port_.alive_;
+
+    if (payload.size() > CMD_PAYLOAD_MAX) {
+        throw std::invalid_argument("commande trop longue");
+    }
+    port_.loop().post([this, alive, cmd, payload = std::move(payload), timeout, promise]() mutable {
+        if (alive.expired()) {
+            promise->set_exception(std::make_exception_ptr(std::system_error(Errc::Closed)));
+            return;
+        }
+        command(cmd, std::move(payload), [promise](std::error_code ec, const Response &resp) {
+            if (ec) {
+                promise->set_exception(std::make_exception_ptr(std::system_error(ec)));
+            } else {
+                promise->set_value(resp);
+            }
+        }, timeout);
+    });
+    return future;
+}
+
+void Device::setpoint(int8_t speed, int8_t angle)
+{
+    Port::Request req;
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size = HFRAME_EncodeSetpoint(frame, port_.options_.Multidrop, addr_, speed, angle);
+
+    req.Addr = addr_;
+    req.Frame.assign(frame, frame + size);
+    // Multipoint : la carte interroge rpond par son tat (pas la diffusion)
+    req.Poll = port_.options_.Multidrop && (addr_ != RS232_ADDR_BROADCAST);
+    req.ExpectReply = req.Poll;
+    req.Timeout = port_.options_.Timeout;
+    port_.submit(std::move(req));
+}
+
+void Device::ping(uint8_t seq, PingCallback cb)
+{
+    command(CMD_PING, { seq }, [cb = std::move(cb)](std::error_code ec, const Response &resp) {
+        PingResult result;
+        if (!ec && !decodePing(resp, result)) {
+            ec = Errc::BadResponse;
+        }
+        cb(ec, result);
+    });
+}
+
+namespace {
+
+ResponseCallback paramResponse(ParamCallback cb)
+{
+    return [cb = std::move(cb)](std::error_code ec, const Response &resp) {
+        if (ec) {
+            cb(ec, 0xFF, 0);
+        } else if (resp.Data.empty()) {
+            cb(Errc::BadResponse, 0xFF, 0);
+        } else if (resp.Data.size() < kParamSize) {
+            cb(ec, resp.status(), 0);       // CMD_ERR_xxx : seul l'tat est prsent
+        } else {
+            cb(ec, resp.status(), resp.i16(2));
+        }
+    };
+}
+
+} // namespace
+
+void Device::paramRead(uint8_t id, ParamCallback cb)
+{
+    command(CMD_PARAM_READ, { id }, paramResponse(std::move(cb)));
+}
+
+void Device::paramWrite(uint8_t id, int16_t value, ParamCallback cb)
+{
+    command(CMD_PARAM_WRITE, { id, (uint8_t)((uint16_t)value >> 8), (uint8_t)(value & 0xFF) },
+            paramResponse(std::move(cb)));
+}
+
+/*--------------------------------------------------------*/
+// Port
+/*--------------------------------------------------------*/
+
+Port::Port(EventLoop &loop, std::unique_ptr<SerialTransport> transport, PortOptions options)
+    : loop_(loop), transport_(std::move(transport)), options_(options),
+      alive_(std::make_shared<bool>(true))
+{
+    if (options_.Multidrop || (options_.Window == 0)) {
+        options_.Window = 1;
+    }
+    HFRAME_Init(&scanner_, options_.Multidrop ? 1 : 0);
+    transport_->onReceive([this](const uint8_t *data, size_t len) { onBytes(data, len); });
+    transport_->onClose([this] { failAll(Errc::Closed); });
+}
+
+Port::~Port()
+{
+    for (auto &req : inflight_) {
+        loop_.cancelTimer(req.Timer);
+    }
+    transport_->onReceive(nullptr);
+    transport_->onClose(nullptr);
+}
+
+Device &Port::device(uint8_t addr)
+{
+    if (!options_.Multidrop && !devices_.empty()) {
+        return *devices_.begin()->second;
+    }
+    auto it = devices_.find(addr);
+    if (it == devices_.end()) {
+        it = devices_.emplace(addr, std::unique_ptr<Device>(new Device(*this, addr))).first;
+    }
+    return *it->second;
+}
+
+void Port::submit(Request req)
+{
+    req.Id = nextId_++;
+    stats_.Requests++;
+    // Point  point (duplex) : une trame sans rponse part tout de suite
+    if (!req.ExpectReply && !options_.Multidrop) {
+        transmit(req);
+        return;
+    }
+    queue_.push_back(std::move(req));
+    pump();
+}
+
+bool Port::canSend(const Request &req) const
+{
+    if (options_.Multidrop) {
+        return inflight_.empty();
+    }
+    if (inflight_.size() >= options_.Window) {
+        return false;
+    }
+    // La carte ne garde qu'un CMD_PING en attente (le suivant crase le
+    // prcdent) : seuls CMD_REL_DATA et CMD_BOOT_DATA, fentrs par la
+    // carte, passent  plusieurs (rponses dans l'ordre des requtes)
+    if ((req.Cmd != CMD_REL_DATA) && (req.Cmd != CMD_BOOT_DATA)) {
+        for (const auto &other : inflight_) {
+            if ((other.Addr == req.Addr) && (other.Cmd == req.Cmd)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Port::pump()
+{
+    while (!queue_.empty() && transport_->isOpen() && canSend(queue_.front())) {
+        Request req = std::move(queue_.front());
+        queue_.pop_front();
+        transmit(req);
+    }
+}
+
+void Port::transmit(Request &req)
+{
+    transport_->send(req.Frame.data(), req.Frame.size());
+    stats_.BytesTx += req.Frame.size();
+    if (!req.ExpectReply) {
+        return;
+    }
+    uint64_t id = req.Id;
+    req.SentAt = EventLoop::Clock::now();
+    req.Timer = loop_.addTimer(req.Timeout, [this, id] { onTimeout(id); });
+    inflight_.push_back(std::move(req));
+}
+
+void Port::onBytes(const uint8_t *data, size_t len)
+{
+    S_hframe frame;
+
+    stats_.BytesRx += len;
+    for (size_t i = 0; i < len; i++) {
+        int type = HFRAME_Feed(&scanner_, data[i], &frame);
+        if (type != HFRAME_NONE) {
+            onFrame(type, frame);
+        }
+    }
+}
+
+void Port::onFrame(int type, const S_hframe &frame)
+{
+    Device *pDev = nullptr;
+
+    if (options_.Multidrop) {
+        auto it = devices_.find(frame.Addr);
+        if (it != devices_.end()) {
+            pDev = it->second.get();
+        }
+    } else if (!devices_.empty()) {
+        pDev = devices_.begin()->second.get();
+    }
+
+    if (type == HFRAME_SETPOINT) {
+        stats_.Setpoints++;
+        // Rponse  une interrogation : libre le bus
+        for (auto it = inflight_.begin(); it != inflight_.end(); ++it) {
+            if (it->Poll && (it->Addr == frame.Addr)) {
+                loop_.cancelTimer(it->Timer);
+                inflight_.erase(it);
+                stats_.Responses++;
+                pump();
+                break;
+            }
+        }
+        if ((pDev != nullptr) && pDev->setpointCb_) {
+            pDev->setpointCb_(frame.Speed, frame.Angle);
+        }
+        return;
+    }
+
+    if (frame.Cmd == CMD_TELEMETRY) {
+        if (pDev != nullptr) {
+            S_telemSample samples[GTELEM_FLUSH_SAMPLES];
+            S_telemHeader header = { 0, 0, 0 };
+            if (frame.Len >= GTELEM_HEADER_SIZE) {
+                header.Mode = frame.Data[0];
+                header.Seq = frame.Data[1];
+                header.NbSamples = frame.Data[2];
+            }
+            int n = HTELEM_StreamFrame(&pDev->telem_, frame.Data, frame.Len, samples,
+                                       GTELEM_FLUSH_SAMPLES);
+            if ((n >= 0) && pDev->telemCb_) {
+                pDev->telemCb_(header, samples, n);
+            }
+        }
+        return;
+    }
+
+    // Requtes (cho d'un bus, autre matre) ignores
+    if ((frame.Cmd & CMD_RESPONSE_FLAG) == 0) {
+        stats_.Unmatched++;
+        return;
+    }
+
+    uint8_t cmd = frame.Cmd & (uint8_t)~CMD_RESPONSE_FLAG;
+    auto it = inflight_.begin();
+    for (; it != inflight_.end(); ++it) {
+        if (!it->Poll && (!options_.Multidrop || (it->Addr == frame.Addr)) &&
+            (it->Cmd == cmd) &&
+            ((it->SeqOffset < 0) ||
+             ((it->SeqOffset < frame.Len) && (frame.Data[it->SeqOffset] == it->Seq)))) {
+            break;
+        }
+    }
+    if (it == inflight_.end()) {
+        stats_.Unmatched++;
+        return;
+    }
+
+    Request req = std::move(*it);
+    inflight_.erase(it);
+    loop_.cancelTimer(req.Timer);
+    stats_.Responses++;
+
+    Response resp;
+    resp.Addr = frame.Addr;
+    resp.Cmd = cmd;
+    resp.Data.assign(frame.Data, frame.Data + frame.Len);
+    resp.Rtt = EventLoop::Clock::now() - req.SentAt;
+    pump();
+    if (req.Cb) {
+        req.Cb(std::error_code(), resp);
+    }
+}
+
+void Port::onTimeout(uint64_t id)
+{
+    for (auto it = inflight_.begin(); it != inflight_.end(); ++it) {
+        if (it->Id == id) {
+            Request req = std::move(*it);
+            inflight_.erase(it);
+            stats_.Timeouts++;
+            pump();
+            if (req.Cb) {
+                Response resp;
+                resp.Addr = req.Addr;
+                resp.Cmd = req.Cmd;
+                req.Cb(Errc::Timeout, resp);
+            }
+            return;
+        }
+    }
+}
+
+void Port::failAll(Errc e)
+{
+    std::list<Request> failed;
+
+    for (auto &req : inflight_) {
+        loop_.cancelTimer(req.Timer);
+    }
+    failed.splice(failed.end(), inflight_);
+    for (auto &req : queue_) {
+        failed.push_back(std::move(req));
+    }
+    queue_.clear();
+    for (auto &req : failed) {
+        if (req.Cb) {
+            Response resp;
+            resp.Addr = req.Addr;
+            resp.Cmd = req.Cmd;
+            req.Cb(e, resp);
+        }
+    }
+}
+
+} // namespace tp2link
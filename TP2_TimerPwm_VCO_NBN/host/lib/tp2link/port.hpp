@@ -0,0 +1,276 @@
+#ifndef Tp2link_Port_HPP
+#define Tp2link_Port_HPP
+
+/*--------------------------------------------------------*/
+// Port.hpp
+/*--------------------------------------------------------*/
+// Description : Protocole RS232 de la carte ct hte (contrepartie de
+//               Mc32gest_RS232.c) : un Port est une liaison srie portant
+//               une carte (point  point) ou plusieurs (bus multipoint) ;
+//               un Device est une carte, adresse par son numro de noeud.
+//
+//               - Les trames sont codes et dcoupes par hostFrame (mme
+//                 table CRC16 que la carte).
+//               - Chaque commande reoit sa rponse par callback, ou par
+//                 std::future avec request() depuis un autre thread.
+//               - Une rponse est associe  la plus ancienne requte en
+//                 vol de mme adresse et de mme code ; CMD_PING et
+//                 CMD_REL_DATA sont associs par leur Seq. Une seule requte
+//                 en vol par code et par carte (la carte ne garde qu'un
+//                 ping en attente), sauf CMD_REL_DATA et CMD_BOOT_DATA,
+//                 fentrs par la carte.
+//               - Bus multipoint (demi-duplex) : une seule requte en vol
+//                 sur le Port et rien n'est mis avant la rponse, ce qui
+//                 vite les collisions avec la carte qui rpond. Une
+//                 consigne adresse est une interrogation : le bus reste
+//                 rserv jusqu' la trame d'tat de la carte.
+//
+//               Toutes les mthodes, sauf Device::request, s'appellent
+//               depuis le thread de la boucle d'vnements.
+//
+/*--------------------------------------------------------*/
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "eventLoop.hpp"
+#include "serialTransport.hpp"
+#include "hostFrame.h"
+#include "hostTelem.h"
+#include "gestParam.h"         // PARAM_ID_* de paramRead / paramWrite
+
+namespace tp2link {
+
+/*--------------------------------------------------------*/
+// Erreurs de liaison (les codes d'tat de la carte sont dans Response)
+/*--------------------------------------------------------*/
+enum class Errc {
+    Timeout = 1,            // Pas de rponse dans le dlai
+    Closed,                 // Port ferm, requte abandonne
+    BadResponse,            // Rponse trop courte pour la commande
+};
+
+const std::error_category &errorCategory();
+std::error_code make_error_code(Errc e);
+
+} // namespace tp2link
+
+namespace std {
+template <>
+struct is_error_code_enum<tp2link::Errc> : true_type {};
+} // namespace std
+
+namespace tp2link {
+
+/**
+ * @brief Trame de rponse (code sans CMD_RESPONSE_FLAG).
+ */
+struct Response {
+    uint8_t Addr = 0;
+    uint8_t Cmd = 0;
+    std::vector<uint8_t> Data;
+    EventLoop::Clock::duration Rtt{};   // mission de la requte -> rception
+
+    uint8_t status() const { return Data.empty() ? 0xFF : Data[0]; }
+    uint32_t u32(size_t offset) const
+    {
+        (void)Data.at(offset + 3);      // std::out_of_range si la rponse est trop courte
+        return HFRAME_GetU32(&Data[offset]);
+    }
+    int16_t i16(size_t offset) const
+    {
+        return (int16_t)((Data.at(offset) << 8) | Data.at(offset + 1));
+    }
+};
+
+// Core timer de la carte : SYS_CLK_FREQ / 2 (RS232_CORE_TICKS_PER_US)
+constexpr double kCoreTicksPerUs = 40.0;
+
+/**
+ * @brief Rponse dcode de CMD_PING.
+ */
+struct PingResult {
+    uint8_t Seq = 0;
+    uint32_t TRx = 0;       // Core timer (RS232_CORE_TICKS_PER_US par us)
+    uint32_t TParse = 0;
+    uint32_t TApply = 0;
+    uint32_t TReply = 0;
+    EventLoop::Clock::duration Rtt{};
+
+    // Intervalles ct carte [us], diffrences modulo 2^32 (dbordement du core timer)
+    double parseUs() const { return (uint32_t)(TParse - TRx) / kCoreTicksPerUs; }
+    double applyUs() const { return (uint32_t)(TApply - TParse) / kCoreTicksPerUs; }
+    double replyUs() const { return (uint32_t)(TReply - TApply) / kCoreTicksPerUs; }
+    double deviceUs() const { return (uint32_t)(TReply - TRx) / kCoreTicksPerUs; }
+};
+
+/**
+ * @brief Options d'un Port.
+ */
+struct PortOptions {
+    bool Multidrop = false;
+    unsigned Window = 4;                                // Requtes en vol (1 impos en multipoint)
+    EventLoop::Clock::duration Timeout = std::chrono::milliseconds(250);
+};
+
+/**
+ * @brief Compteurs d'un Port.
+ */
+struct PortStats {
+    uint64_t Requests = 0;
+    uint64_t Responses = 0;
+    uint64_t Timeouts = 0;
+    uint64_t Unmatched = 0;         // Rponses sans requte en vol
+    uint64_t Setpoints = 0;         // Trames de consigne reues
+    uint64_t BytesTx = 0;
+    uint64_t BytesRx = 0;
+};
+
+using ResponseCallback = std::function<void(std::error_code, const Response &)>;
+using PingCallback = std::function<void(std::error_code, const PingResult &)>;
+using ParamCallback = std::function<void(std::error_code, uint8_t status, int16_t value)>;
+
+class Port;
+
+/**
+ * @brief Une carte sur un Port.
+ */
+class Device {
+public:
+    uint8_t address() const { return addr_; }
+    Port &port() { return port_; }
+
+    /**
+     * @brief Envoie une commande ; cb est appel une fois (rponse ou erreur).
+     * @param timeout 0 = dlai du Port.
+     * @throws std::invalid_argument si payload dpasse CMD_PAYLOAD_MAX.
+     */
+    void command(uint8_t cmd, std::vector<uint8_t> payload, ResponseCallback cb,
+                 EventLoop::Clock::duration timeout = EventLoop::Clock::duration::zero());
+
+    /**
+     * @brief Comme command(), depuis n'importe quel thread.
+     * @details Le future lve std::system_error (Errc) si la requte choue ;
+     *          la boucle doit tourner dans un autre thread pour l'attendre.
+     */
+    std::future<Response> request(uint8_t cmd, std::vector<uint8_t> payload,
+                                  EventLoop::Clock::duration timeout = EventLoop::Clock::duration::zero());
+
+    /**
+     * @brief Consigne  distance. En multipoint, une carte adresse renvoie
+     *        son tat (onSetpoint) ; la diffusion est sans rponse.
+     */
+    void setpoint(int8_t speed, int8_t angle);
+
+    void ping(uint8_t seq, PingCallback cb);
+    void paramRead(uint8_t id, ParamCallback cb);
+    void paramWrite(uint8_t id, int16_t value, ParamCallback cb);
+
+    /**
+     * @brief Consignes locales mises par la carte (SendMessage).
+     */
+    void onSetpoint(std::function<void(int8_t speed, int8_t angle)> cb) { setpointCb_ = std::move(cb); }
+
+    /**
+     * @brief Trames de tlmtrie dcodes (format gestTelem.h).
+     */
+    void onTelemetry(std::function<void(const S_telemHeader &, const S_telemSample *, int)> cb)
+    {
+        telemCb_ = std::move(cb);
+    }
+
+    const S_telemStream &telemetryStream() const { return telem_; }
+
+private:
+    friend class Port;
+    Device(Port &port, uint8_t addr);
+
+    Port &port_;
+    uint8_t addr_;
+    std::function<void(int8_t, int8_t)> setpointCb_;
+    std::function<void(const S_telemHeader &, const S_telemSample *, int)> telemCb_;
+    S_telemStream telem_;
+};
+
+/**
+ * @brief Liaison srie : dcoupage des trames, file des requtes, dlais.
+ */
+class Port {
+public:
+    Port(EventLoop &loop, std::unique_ptr<SerialTransport> transport, PortOptions options = {});
+    ~Port();
+    Port(const Port &) = delete;
+    Port &operator=(const Port &) = delete;
+
+    /**
+     * @brief Carte d'adresse addr (cre au premier appel). En point  point,
+     *        l'adresse n'est pas mise et une seule carte existe.
+     */
+    Device &device(uint8_t addr = RS232_NODE_ADDRESS);
+
+    EventLoop &loop() { return loop_; }
+    SerialTransport &transport() { return *transport_; }
+    const PortOptions &options() const { return options_; }
+    const PortStats &stats() const { return stats_; }
+    const S_hframeScanner &scanner() const { return scanner_; }
+
+    /**
+     * @brief Requtes en vol et en attente.
+     */
+    size_t pending() const { return inflight_.size() + queue_.size(); }
+
+private:
+    friend class Device;
+
+    struct Request {
+        uint64_t Id = 0;
+        uint8_t Addr = 0;
+        uint8_t Cmd = 0;
+        int SeqOffset = -1;                 // Position du Seq dans la rponse (-1 = sans)
+        uint8_t Seq = 0;
+        bool ExpectReply = true;
+        bool Poll = false;                  // Consigne adresse : trame d'tat en rponse
+        std::vector<uint8_t> Frame;
+        ResponseCallback Cb;
+        EventLoop::Clock::duration Timeout{};
+        EventLoop::TimerId Timer = 0;
+        EventLoop::Clock::time_point SentAt{};
+    };
+
+    void submit(Request req);
+    bool canSend(const Request &req) const;
+    void pump();
+    void transmit(Request &req);
+    void onBytes(const uint8_t *data, size_t len);
+    void onFrame(int type, const S_hframe &frame);
+    void onTimeout(uint64_t id);
+    void failAll(Errc e);
+
+    EventLoop &loop_;
+    std::unique_ptr<SerialTransport> transport_;
+    PortOptions options_;
+    PortStats stats_;
+    S_hframeScanner scanner_;
+    std::map<uint8_t, std::unique_ptr<Device>> devices_;
+    std::deque<Request> queue_;
+    std::list<Request> inflight_;
+    uint64_t nextId_ = 1;
+    std::shared_ptr<bool> alive_;           // Tches postes aprs la destruction du Port
+};
+
+/**
+ * @brief Dcode une rponse CMD_PING.
+ * @return false si la rponse est trop courte.
+ */
+bool decodePing(const Response &resp, PingResult &out);
+
+} // namespace tp2link
+
+#endif // Tp2link_Port_HPP
@@ -0,0 +1,178 @@
+/*--------------------------------------------------------*/
+// SerialTransport.cpp
+/*--------------------------------------------------------*/
+//	Description :	Port srie non bloquant sur EventLoop
+//
+/*--------------------------------------------------------*/
+#include "serialTransport.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+namespace tp2link {
+
+namespace {
+
+constexpr size_t kReadSize = 4096;
+constexpr size_t kCompactSize = 65536;  // Compactage du tampon TX au-del
+
+speed_t baudConstant(unsigned baud)
+{
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: throw std::invalid_argument("debit non supporte");
+    }
+}
+
+} // namespace
+
+SerialTransport::SerialTransport(EventLoop &loop, const std::string &path, unsigned baud,
+                                 bool rtscts)
+    : loop_(loop)
+{
+    struct termios tio;
+
+    fd_ = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+    // Un pty accepte tcsetattr ; les options matrielles sont ignores
+    if (tcgetattr(fd_, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, baudConstant(baud));
+        cfsetospeed(&tio, baudConstant(baud));
+        tio.c_cflag |= CLOCAL | CREAD;
+        if (rtscts) {
+            tio.c_cflag |= CRTSCTS;
+        } else {
+            tio.c_cflag &= ~CRTSCTS;
+        }
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd_, TCSANOW, &tio);
+        tcflush(fd_, TCIOFLUSH);
+    }
+    attach();
+}
+
+SerialTransport::SerialTransport(EventLoop &loop, int fd)
+    : loop_(loop), fd_(fd)
+{
+    int flags = fcntl(fd_, F_GETFL);
+
+    if ((flags < 0) || (fcntl(fd_, F_SETFL, flags | O_NONBLOCK) != 0)) {
+        throw std::system_error(errno, std::generic_category(), "fcntl");
+    }
+    attach();
+}
+
+SerialTransport::~SerialTransport()
+{
+    if (fd_ >= 0) {
+        loop_.remove(fd_);
+        close(fd_);
+    }
+}
+
+void SerialTransport::attach()
+{
+    loop_.add(fd_, EPOLLIN, [this](uint32_t events) { handleEvents(events); });
+}
+
+void SerialTransport::closeFd()
+{
+    loop_.remove(fd_);
+    close(fd_);
+    fd_ = -1;
+    if (closeHandler_) {
+        closeHandler_();
+    }
+}
+
+void SerialTransport::send(const uint8_t *data, size_t len)
+{
+    if (fd_ < 0) {
+        return;
+    }
+    txBuf_.insert(txBuf_.end(), data, data + len);
+    flush();
+}
+
+void SerialTransport::flush()
+{
+    while (txPos_ < txBuf_.size()) {
+        ssize_t n = write(fd_, &txBuf_[txPos_], txBuf_.size() - txPos_);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                closeFd();
+                return;
+            }
+            break;
+        }
+        txPos_ += (size_t)n;
+    }
+    if (txPos_ == txBuf_.size()) {
+        txBuf_.clear();
+        txPos_ = 0;
+    } else if (txPos_ >= kCompactSize) {
+        txBuf_.erase(txBuf_.begin(), txBuf_.begin() + (std::ptrdiff_t)txPos_);
+        txPos_ = 0;
+    }
+
+    // EPOLLOUT seulement tant qu'il reste des octets
+    bool want = (txPos_ < txBuf_.size());
+    if (want != wantWrite_) {
+        wantWrite_ = want;
+        loop_.modify(fd_, want ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+    }
+}
+
+void SerialTransport::handleEvents(uint32_t events)
+{
+    uint8_t buf[kReadSize];
+
+    if (events & EPOLLOUT) {
+        flush();
+        if (fd_ < 0) {
+            return;
+        }
+    }
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        for (;;) {
+            ssize_t n = read(fd_, buf, sizeof(buf));
+            if (n > 0) {
+                if (rxHandler_) {
+                    rxHandler_(buf, (size_t)n);
+                }
+                if ((fd_ < 0) || ((size_t)n < sizeof(buf))) {
+                    break;
+                }
+            } else if ((n < 0) && (errno == EINTR)) {
+                continue;
+            } else if ((n < 0) && (errno == EAGAIN)) {
+                break;
+            } else {
+                // Fin de fichier, ou EIO : l'autre extrmit du pty est ferme
+                closeFd();
+                break;
+            }
+        }
+    }
+}
+
+} // namespace tp2link
@@ -0,0 +1,78 @@
+#ifndef Tp2link_SerialTransport_HPP
+#define Tp2link_SerialTransport_HPP
+
+/*--------------------------------------------------------*/
+// SerialTransport.hpp
+/*--------------------------------------------------------*/
+// Description : Port srie non bloquant (tty ou pty) enregistr dans
+//               une EventLoop : les octets reus sont passs au
+//               gestionnaire, les octets  mettre sont mis en tampon et
+//               crits quand le descripteur l'accepte (EPOLLOUT).
+//
+/*--------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "eventLoop.hpp"
+
+namespace tp2link {
+
+class SerialTransport {
+public:
+    using RxHandler = std::function<void(const uint8_t *data, size_t len)>;
+    using CloseHandler = std::function<void()>;
+
+    /**
+     * @brief Ouvre le port en mode brut, 8N1.
+     * @param rtscts Contrle de flux matriel (ignor par un pty).
+     * @throws std::system_error si le port ne peut pas tre ouvert.
+     */
+    SerialTransport(EventLoop &loop, const std::string &path, unsigned baud = 57600,
+                    bool rtscts = true);
+
+    /**
+     * @brief Prend un descripteur dj ouvert (pty, socket), rendu non bloquant.
+     */
+    SerialTransport(EventLoop &loop, int fd);
+
+    ~SerialTransport();
+    SerialTransport(const SerialTransport &) = delete;
+    SerialTransport &operator=(const SerialTransport &) = delete;
+
+    void onReceive(RxHandler handler) { rxHandler_ = std::move(handler); }
+    void onClose(CloseHandler handler) { closeHandler_ = std::move(handler); }
+
+    /**
+     * @brief Met des octets en mission (criture immdiate si possible).
+     */
+    void send(const uint8_t *data, size_t len);
+
+    /**
+     * @brief Octets pas encore accepts par le descripteur.
+     */
+    size_t txBacklog() const { return txBuf_.size() - txPos_; }
+
+    bool isOpen() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+
+private:
+    void attach();
+    void handleEvents(uint32_t events);
+    void flush();
+    void closeFd();
+
+    EventLoop &loop_;
+    int fd_;
+    std::vector<uint8_t> txBuf_;
+    size_t txPos_ = 0;
+    bool wantWrite_ = false;
+    RxHandler rxHandler_;
+    CloseHandler closeHandler_;
+};
+
+} // namespace tp2link
+
+#endif // Tp2link_SerialTransport_HPP
@@ -0,0 +1,23 @@
+#ifndef Tp2link_HPP
+#define Tp2link_HPP
+
+/*--------------------------------------------------------*/
+// Tp2link.hpp
+/*--------------------------------------------------------*/
+// Description : Bibliothque client C++ de la carte TP2 (liaison RS232).
+//
+//               tp2link::EventLoop loop;
+//               tp2link::Port port(loop, std::make_unique<tp2link::SerialTransport>(loop, "/dev/ttyUSB0"));
+//               port.device().ping(1, [](std::error_code ec, const tp2link::PingResult &r) { ... });
+//               loop.run();
+//
+//               Plusieurs Port (une carte par port srie) ou un Port
+//               multipoint (plusieurs cartes par bus) partagent la mme
+//               boucle : un seul thread pilote toutes les cartes.
+//
+/*--------------------------------------------------------*/
+#include "eventLoop.hpp"
+#include "serialTransport.hpp"
+#include "port.hpp"
+
+#endif // Tp2link_HPP
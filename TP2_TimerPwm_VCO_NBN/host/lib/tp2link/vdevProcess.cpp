@@ -0,0 +1,77 @@
+/*--------------------------------------------------------*/
+// VdevProcess.cpp
+/*--------------------------------------------------------*/
+//	Description :	Carte virtuelle dans un processus fils
+//
+/*--------------------------------------------------------*/
+#include "vdevProcess.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+namespace tp2link {
+
+VdevProcess::VdevProcess(const std::string &bin, const std::vector<std::string> &args)
+{
+    int pipeFd[2];
+
+    if (pipe(pipeFd) != 0) {
+        throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+    pid_ = fork();
+    if (pid_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "fork");
+    }
+    if (pid_ == 0) {
+        std::vector<char *> argv;
+        argv.push_back(const_cast<char *>(bin.c_str()));
+        for (const auto &arg : args) {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        // Arrt de la carte si le processus pre se termine sans stop()
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        dup2(pipeFd[1], STDOUT_FILENO);
+        close(pipeFd[0]);
+        close(pipeFd[1]);
+        execv(bin.c_str(), argv.data());
+        _exit(127);
+    }
+    close(pipeFd[1]);
+
+    // Premire ligne de stdout : chemin de l'esclave du pty
+    char c;
+    while (read(pipeFd[0], &c, 1) == 1) {
+        if (c == '\n') {
+            break;
+        }
+        path_ += c;
+    }
+    close(pipeFd[0]);
+    if (path_.empty()) {
+        stop();
+        throw std::runtime_error(bin + " : pas de pty");
+    }
+}
+
+VdevProcess::~VdevProcess()
+{
+    stop();
+}
+
+void VdevProcess::stop()
+{
+    if (pid_ > 0) {
+        kill(pid_, SIGTERM);
+        waitpid(pid_, nullptr, 0);
+        pid_ = -1;
+    }
+}
+
+} // namespace tp2link
@@ -0,0 +1,44 @@
+#ifndef Tp2link_VdevProcess_HPP
+#define Tp2link_VdevProcess_HPP
+
+/*--------------------------------------------------------*/
+// VdevProcess.hpp
+/*--------------------------------------------------------*/
+// Description : Lance une carte virtuelle (tp2_vdev) dans un processus
+//               fils et lit le chemin de son pty ; le fils est arrt
+//               (SIGTERM, flash sauvegarde)  la destruction.
+//
+/*--------------------------------------------------------*/
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace tp2link {
+
+class VdevProcess {
+public:
+    /**
+     * @param bin  Excutable tp2_vdev ou tp2_vdev_md.
+     * @param args Options (--flash, --nodes...).
+     * @throws std::runtime_error si le fils ne publie pas de pty.
+     */
+    VdevProcess(const std::string &bin, const std::vector<std::string> &args = {});
+    ~VdevProcess();
+    VdevProcess(const VdevProcess &) = delete;
+    VdevProcess &operator=(const VdevProcess &) = delete;
+
+    const std::string &path() const { return path_; }
+
+    /**
+     * @brief Arrte le fils et attend sa fin.
+     */
+    void stop();
+
+private:
+    pid_t pid_ = -1;
+    std::string path_;
+};
+
+} // namespace tp2link
+
+#endif // Tp2link_VdevProcess_HPP
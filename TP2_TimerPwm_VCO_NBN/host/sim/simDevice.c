@@ -0,0 +1,422 @@
+/*--------------------------------------------------------*/
+// SimDevice.c
+/*--------------------------------------------------------*/
+//	Description :	Ordonnanceur de l'appareil simul : vnements
+//			        matriels, interruptions par priorit, boucle
+//			        principale (main.c / system_interrupt.c)
+//
+/*--------------------------------------------------------*/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app.h"
+#include "gestFrame.h"
+#include "gestNvm.h"
+#include "simPriv.h"
+
+// Routines d'interruption du firmware (__ISR vide sur l'hte)
+void UART1_InterruptHandler(void);
+void GADC_InterruptHandler(void);
+
+// Sens du pont en H (bsp.h)
+#define SIM_AIN1_MASK       (1u << AIN1_HBRIDGE_BIT)
+#define SIM_AIN2_MASK       (1u << AIN2_HBRIDGE_BIT)
+
+/*--------------------------------------------------------*/
+// Vecteurs d'interruption (system_interrupt.c)
+/*--------------------------------------------------------*/
+
+static void SIM_IsrTimer1(void)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_1);
+    App_Timer1Callback();
+    BSP_LEDToggle(BSP_LED_0);
+}
+
+static void SIM_IsrTimer2(void)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_2);
+    App_Timer2Callback();
+}
+
+static void SIM_IsrTimer3(void)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_3);
+}
+
+static void SIM_IsrTimer4(void)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_4);
+    App_Timer4Callback();
+}
+
+static void SIM_IsrTimer5(void)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_TIMER_5);
+}
+
+static void (* const simIsr[INT_VECTOR_NB])(void) = {
+    [INT_VECTOR_T1] = SIM_IsrTimer1,
+    [INT_VECTOR_T2] = SIM_IsrTimer2,
+    [INT_VECTOR_T3] = SIM_IsrTimer3,
+    [INT_VECTOR_T4] = SIM_IsrTimer4,
+    [INT_VECTOR_T5] = SIM_IsrTimer5,
+    [INT_VECTOR_UART1] = UART1_InterruptHandler,
+    [INT_VECTOR_AD1] = GADC_InterruptHandler,
+};
+
+/**
+ * @brief Source leve et autorise.
+ */
+static uint8_t SIM_SourcePending(INT_SOURCE source)
+{
+    return simState.IntFlag[source] && simState.IntEnable[source];
+}
+
+/**
+ * @brief Au moins une source du vecteur demande l'interruption.
+ */
+static uint8_t SIM_VectorPending(INT_VECTOR vector)
+{
+    switch (vector)
+    {
+        case INT_VECTOR_UART1:
+            return SIM_SourcePending(INT_SOURCE_USART_1_ERROR) ||
+                   SIM_SourcePending(INT_SOURCE_USART_1_RECEIVE) ||
+                   SIM_SourcePending(INT_SOURCE_USART_1_TRANSMIT);
+        case INT_VECTOR_AD1:
+            return SIM_SourcePending(INT_SOURCE_ADC_1);
+        default:
+            return SIM_SourcePending((INT_SOURCE)(INT_SOURCE_TIMER_1 + vector));
+    }
+}
+
+/**
+ * @brief Excute les interruptions en attente, la plus prioritaire d'abord.
+ *
+ * @details Les interruptions ne s'imbriquent pas : elles sont servies entre
+ *          deux itrations de la boucle principale, une  la fois.
+ */
+static void SIM_Dispatch(void)
+{
+    uint32_t sent;
+    uint8_t txPending;
+    uint8_t best;
+    uint8_t prio;
+    uint8_t n;
+    uint8_t v;
+
+    for (n = 0; (n < SIM_ISR_LOOP_MAX) && simState.IntGlobal; n++)
+    {
+        SIM_UartLevels();
+        best = INT_VECTOR_NB;
+        prio = INT_DISABLE_INTERRUPT;
+        for (v = 0; v < INT_VECTOR_NB; v++) {
+            if ((simState.VectorPriority[v] > prio) && SIM_VectorPending((INT_VECTOR)v)) {
+                best = v;
+                prio = simState.VectorPriority[v];
+            }
+        }
+        if (best == INT_VECTOR_NB) {
+            break;
+        }
+
+        txPending = simState.IntFlag[INT_SOURCE_USART_1_TRANSMIT];
+        sent = simState.TxSent;
+        simIsr[best]();
+        simState.Stats.Interrupts++;
+
+        // ISR TX sans effet (CTS actif) : drapeau retenu un temps octet
+        if ((best == INT_VECTOR_UART1) && txPending && (sent == simState.TxSent) &&
+            simState.IntEnable[INT_SOURCE_USART_1_TRANSMIT]) {
+            simState.TxStallNs = simState.Now + SIM_UART_BYTE_NS;
+        }
+    }
+}
+
+/*--------------------------------------------------------*/
+// Ordonnanceur
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Plus proche chance (vnements matriels et boucle principale).
+ */
+static uint64_t SIM_NextDue(void)
+{
+    uint64_t due = simState.MainDueNs;
+    uint8_t i;
+
+    for (i = 0; i < TMR_NUMBER_OF_MODULES; i++) {
+        if (simState.Tmr[i].Armed && (simState.Tmr[i].DueNs < due)) {
+            due = simState.Tmr[i].DueNs;
+        }
+    }
+    if (simState.AdcDueNs < due) {
+        due = simState.AdcDueNs;
+    }
+    if (simState.LineDueNs < due) {
+        due = simState.LineDueNs;
+    }
+    if (simState.TxDueNs < due) {
+        due = simState.TxDueNs;
+    }
+    if ((simState.TxStallNs > simState.Now) && (simState.TxStallNs < due)) {
+        due = simState.TxStallNs;
+    }
+    return due;
+}
+
+/**
+ * @brief Traite tous les vnements chus.
+ *
+ * @details Aprs un blocage du CPU, plusieurs octets peuvent tre chus :
+ *          ils arrivent dans l'ordre sans qu'aucune interruption ne les
+ *          retire du FIFO matriel (dbordement possible, comme sur la cible).
+ */
+static void SIM_ProcessEvents(void)
+{
+    uint8_t found;
+    uint8_t i;
+
+    do {
+        found = 0;
+        for (i = 0; i < TMR_NUMBER_OF_MODULES; i++) {
+            if (simState.Tmr[i].Armed && (simState.Tmr[i].DueNs <= simState.Now)) {
+                SIM_TimerEvent((TMR_MODULE_ID)i);
+                found = 1;
+            }
+        }
+        if (simState.AdcDueNs <= simState.Now) {
+            SIM_AdcEvent();
+            found = 1;
+        }
+        if (simState.TxDueNs <= simState.Now) {
+            SIM_UartTxEvent();
+            found = 1;
+        }
+        if (simState.LineDueNs <= simState.Now) {
+            SIM_UartLineEvent();
+            SIM_UartLineUpdate();
+            found = 1;
+        }
+        if (found) {
+            simState.Stats.Events++;
+        }
+    } while (found);
+}
+
+/**
+ * @brief Un pas : vnements chus, interruptions, boucle principale.
+ */
+static void SIM_Step(void)
+{
+    SIM_ProcessEvents();
+    SIM_Dispatch();
+
+    APP_Tasks();
+    simState.Stats.MainLoops++;
+    simState.MainDueNs = simState.Now + SIM_MAIN_LOOP_NS;
+
+    // Effets des critures de registres de l'ISR ou de la boucle principale
+    SIM_TimerArm();
+    SIM_AdcUpdate();
+    SIM_UartLineUpdate();
+}
+
+/**
+ * @brief Remet le matriel  zro, charge la flash et excute le dmarrage.
+ *
+ * @details A appeler une seule fois par processus : l'tat statique du
+ *          firmware n'est pas rinitialis.
+ */
+int SIM_Init(const S_simConfig *pConfig)
+{
+    FILE *pFile;
+    size_t nb;
+
+    if (simState.Flash == NULL) {
+        simState.Flash = malloc(GNVM_FLASH_SIZE);
+        if (simState.Flash == NULL) {
+            return -1;
+        }
+    }
+    SIM_HalReset();
+    if (pConfig != NULL) {
+        simState.Config = *pConfig;
+    }
+#if RS232_MULTIDROP
+    simState.Config.RtsHonored = 0;     // RTS sert de DE sur le bus
+#endif
+    simState.Rand = simState.Config.Seed;
+
+    memset(simState.Flash, 0xFF, GNVM_FLASH_SIZE);
+    if (simState.Config.FlashFile != NULL) {
+        pFile = fopen(simState.Config.FlashFile, "rb");
+        if (pFile != NULL) {
+            nb = fread(simState.Flash, 1, GNVM_FLASH_SIZE, pFile);
+            fclose(pFile);
+            if ((nb != GNVM_FLASH_SIZE) && (nb != 0)) {
+                return -1;
+            }
+        } else if (errno != ENOENT) {
+            return -1;
+        }
+    }
+
+    // main() : SYS_Initialize puis premire itration (APP_STATE_INIT)
+    APP_Initialize();
+    SIM_Step();
+    return 0;
+}
+
+int SIM_FlashSave(void)
+{
+    FILE *pFile;
+    size_t nb;
+
+    if (simState.Config.FlashFile == NULL) {
+        return 0;
+    }
+    pFile = fopen(simState.Config.FlashFile, "wb");
+    if (pFile == NULL) {
+        return -1;
+    }
+    nb = fwrite(simState.Flash, 1, GNVM_FLASH_SIZE, pFile);
+    if ((fclose(pFile) != 0) || (nb != GNVM_FLASH_SIZE)) {
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t SIM_Now(void)
+{
+    return simState.Now;
+}
+
+void SIM_RunUntil(uint64_t untilNs)
+{
+    uint64_t due;
+
+    for (;;)
+    {
+        due = SIM_NextDue();
+        if (due > untilNs) {
+            break;
+        }
+        if (due > simState.Now) {
+            simState.Now = due;
+        }
+        SIM_Step();
+    }
+    if (simState.Now < untilNs) {
+        simState.Now = untilNs;
+    }
+}
+
+void SIM_RunFor(uint64_t durationNs)
+{
+    SIM_RunUntil(simState.Now + durationNs);
+}
+
+uint64_t SIM_TicksToNs(uint32_t ticks)
+{
+    return (uint64_t)ticks * SIM_CORE_TICK_NS;
+}
+
+/*--------------------------------------------------------*/
+// Ligne srie
+/*--------------------------------------------------------*/
+
+void SIM_UartPushByte(uint8_t byte, uint8_t errors)
+{
+    uint32_t pos;
+
+    if ((simState.LineHead - simState.LineTail) >= SIM_LINE_SIZE) {
+        simState.Stats.LineDrops++;
+        return;
+    }
+    pos = simState.LineHead++ % SIM_LINE_SIZE;
+    simState.LineData[pos] = byte;
+    simState.LineErrors[pos] = errors;
+    SIM_UartLineUpdate();
+}
+
+void SIM_UartWrite(const uint8_t *pData, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        SIM_UartPushByte(pData[i], 0);
+    }
+}
+
+size_t SIM_UartPending(void)
+{
+    return simState.LineHead - simState.LineTail;
+}
+
+size_t SIM_UartRead(uint8_t *pData, size_t maxLen)
+{
+    size_t n = 0;
+
+    while ((n < maxLen) && (simState.OutTail != simState.OutHead)) {
+        pData[n++] = simState.Out[simState.OutTail++ % SIM_OUT_SIZE];
+    }
+    return n;
+}
+
+void SIM_SetCts(uint8_t level)
+{
+    SIM_Pins.Cts = level ? 1 : 0;
+}
+
+uint8_t SIM_GetRts(void)
+{
+    return SIM_Pins.Rts;
+}
+
+/*--------------------------------------------------------*/
+// Entres / sorties
+/*--------------------------------------------------------*/
+
+void SIM_SetAdc(uint8_t chan, uint16_t value, uint16_t noise)
+{
+    if (chan < SIM_ADC_NB_CHANNELS) {
+        simState.AdcValue[chan] = value;
+        simState.AdcNoise[chan] = noise;
+    }
+}
+
+uint16_t SIM_GetOcPulse(uint8_t oc)
+{
+    if ((oc < 1) || (oc > OC_NUMBER_OF_MODULES)) {
+        return 0;
+    }
+    return simState.OcPulse[OC_ID_1 + oc - 1];
+}
+
+int8_t SIM_GetHBridge(void)
+{
+    uint32_t ain1 = simState.Port[AIN1_HBRIDGE_PORT] & SIM_AIN1_MASK;
+    uint32_t ain2 = simState.Port[AIN2_HBRIDGE_PORT] & SIM_AIN2_MASK;
+
+    if (!simState.HBridgeOn || (ain1 && ain2) || (!ain1 && !ain2)) {
+        return 0;
+    }
+    return ain2 ? 1 : -1;
+}
+
+const char *SIM_GetLcdLine(uint8_t line)
+{
+    if ((line < 1) || (line > SIM_LCD_LINES)) {
+        return "";
+    }
+    return simState.Lcd[line - 1];
+}
+
+void SIM_GetStats(S_simStats *pStats)
+{
+    *pStats = simState.Stats;
+}
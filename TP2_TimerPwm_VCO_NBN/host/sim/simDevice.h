@@ -0,0 +1,189 @@
+#ifndef SimDevice_H
+#define SimDevice_H
+
+/*--------------------------------------------------------*/
+// SimDevice.h
+/*--------------------------------------------------------*/
+// Description : Simulateur de la carte (PIC32MX795F512L) pour excuter le
+//               firmware sur l'hte : app.c et tous les modules gestXxx
+//               sont compils tels quels contre les en-ttes de host/hal.
+//
+//               Le temps est virtuel (ns). L'ordonnanceur droule les
+//               vnements matriels (timers, fin de conversion ADC,
+//               octets UART), excute les interruptions par ordre de
+//               priorit puis une itration de la boucle principale
+//               (APP_Tasks), comme main() sur la cible.
+//
+//               Le firmware ayant un tat statique, un seul appareil
+//               simul existe par processus (fork() pour en avoir plusieurs).
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+#define SIM_NS_PER_US           1000ull
+#define SIM_NS_PER_MS           1000000ull
+#define SIM_NS_PER_S            1000000000ull
+#define SIM_CORE_TICK_NS        25          // Core timer  SYS_CLK / 2 = 40 MHz
+#define SIM_UART_BYTE_NS        173611      // 10 bits  57600 bauds
+
+#define SIM_UART_HW_FIFO        4           // FIFO matriels RX et TX de l'UART1
+#define SIM_NVM_WORD_NS         (20 * SIM_NS_PER_US)  // Programmation d'un mot (CPU bloqu)
+#define SIM_NVM_ERASE_NS        (20 * SIM_NS_PER_MS)  // Effacement d'une page (CPU bloqu)
+#define SIM_MAIN_LOOP_NS        (20 * SIM_NS_PER_US)  // Itration de la boucle principale au repos
+
+#define SIM_ADC_NB_CHANNELS     16
+#define SIM_LCD_LINES           4
+#define SIM_LCD_COLUMNS         20
+
+// Erreurs associes  un octet reu (SIM_UartPushByte)
+#define SIM_UART_ERR_FRAMING    0x01
+#define SIM_UART_ERR_PARITY     0x02
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Options de l'appareil simul.
+ */
+typedef struct {
+    const char *FlashFile;  // Image de la flash programme (NULL = efface, non persistante)
+    uint8_t RtsHonored;     // 1 = l'metteur de la ligne attend RTS = 0 avant chaque octet
+    uint32_t Seed;          // Graine du bruit ADC
+} S_simConfig;
+
+/**
+ * @brief Compteurs de l'appareil simul (ct matriel).
+ */
+typedef struct {
+    uint64_t Events;        // vnements matriels traits
+    uint64_t Interrupts;    // Routines d'interruption excutes
+    uint64_t MainLoops;     // Itrations de la boucle principale
+    uint32_t RxBytes;       // Octets arrivs sur RX
+    uint32_t RxOverruns;    // Octets perdus, FIFO matriel RX plein
+    uint32_t RxLost;        // Octets arrivs UART non initialise ou rcepteur coup (DE)
+    uint32_t LineDrops;     // Octets refuss par SIM_UartWrite, ligne sature
+    uint32_t TxBytes;       // Octets sortis sur TX
+    uint32_t TxDeLow;       // Octets mis metteur RS485 non valid (multipoint)
+    uint32_t NvmErases;     // Pages effaces
+    uint32_t NvmWrites;     // Mots programms
+} S_simStats;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Remet le matriel  zro, charge la flash et excute le dmarrage
+ *        (APP_Initialize puis la premire itration : tat APP_STATE_INIT).
+ * @param pConfig Options (NULL = valeurs par dfaut).
+ * @return 0 si OK, -1 si le fichier flash est illisible.
+ */
+int SIM_Init(const S_simConfig *pConfig);
+
+/**
+ * @brief crit l'image flash dans le fichier de S_simConfig.FlashFile.
+ * @return 0 si OK ou sans fichier, -1 en cas d'erreur d'criture.
+ */
+int SIM_FlashSave(void);
+
+/**
+ * @brief Temps virtuel coul depuis SIM_Init [ns].
+ */
+uint64_t SIM_Now(void);
+
+/**
+ * @brief Excute l'appareil jusqu' l'instant virtuel donn.
+ * @param untilNs Instant de fin [ns].
+ */
+void SIM_RunUntil(uint64_t untilNs);
+
+/**
+ * @brief Excute l'appareil pendant une dure virtuelle.
+ * @param durationNs Dure [ns].
+ */
+void SIM_RunFor(uint64_t durationNs);
+
+/**
+ * @brief Convertit un nombre de ticks du core timer en ns.
+ */
+uint64_t SIM_TicksToNs(uint32_t ticks);
+
+/**
+ * @brief Dpose des octets sur la ligne RX (arrive au dbit de la liaison,
+ *         la suite des octets dj en attente).
+ */
+void SIM_UartWrite(const uint8_t *pData, size_t len);
+
+/**
+ * @brief Dpose un octet sur la ligne RX avec des erreurs de rception.
+ * @param byte   Octet.
+ * @param errors SIM_UART_ERR_FRAMING | SIM_UART_ERR_PARITY.
+ */
+void SIM_UartPushByte(uint8_t byte, uint8_t errors);
+
+/**
+ * @brief Octets de la ligne RX pas encore arrivs  l'UART.
+ */
+size_t SIM_UartPending(void);
+
+/**
+ * @brief Lit les octets sortis sur TX depuis le dernier appel.
+ * @param pData  Destination.
+ * @param maxLen Taille de pData.
+ * @return Nombre d'octets copis.
+ */
+size_t SIM_UartRead(uint8_t *pData, size_t maxLen);
+
+/**
+ * @brief Niveau de l'entre CTS (1 = mission interdite).
+ */
+void SIM_SetCts(uint8_t level);
+
+/**
+ * @brief Niveau de la sortie RTS (1 = rception bloque ; DE en multipoint).
+ */
+uint8_t SIM_GetRts(void);
+
+/**
+ * @brief Tension d'une entre analogique.
+ * @param chan  Canal AN0..AN15.
+ * @param value Valeur 10 bits.
+ * @param noise Amplitude du bruit uniforme ajout  chaque conversion [LSB].
+ */
+void SIM_SetAdc(uint8_t chan, uint16_t value, uint16_t noise);
+
+/**
+ * @brief Dernire largeur d'impulsion crite dans un Output Compare.
+ * @param oc Numro du module (2 = moteur, 3 = servo).
+ */
+uint16_t SIM_GetOcPulse(uint8_t oc);
+
+/**
+ * @brief Sens du pont en H : +1 (AIN2), -1 (AIN1), 0 (arrt).
+ */
+int8_t SIM_GetHBridge(void);
+
+/**
+ * @brief Ligne de l'afficheur (1  SIM_LCD_LINES), termine par 0.
+ */
+const char *SIM_GetLcdLine(uint8_t line);
+
+/**
+ * @brief Copie des compteurs du simulateur.
+ */
+void SIM_GetStats(S_simStats *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SimDevice_H
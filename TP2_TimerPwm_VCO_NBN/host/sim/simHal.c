@@ -0,0 +1,898 @@
+/*--------------------------------------------------------*/
+// SimHal.c
+/*--------------------------------------------------------*/
+//	Description :	Priphriques simuls : registres de xc.h, PLIB et
+//			        pilotes Harmony, BSP, afficheur et contrleur flash
+//
+//			        Les timers, l'ADC et l'UART ne font qu'armer des
+//			        chances ; simDevice.c les droule dans l'ordre
+//			        du temps virtuel.
+//
+/*--------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xc.h>
+#include "system_definitions.h"
+#include "Mc32DriverLcd.h"
+#include "gestFrame.h"          // RS232_MULTIDROP
+#include "gestNvm.h"            // Organisation de la flash
+#include "simPriv.h"
+
+// Bits de NVMCON
+#define SIM_NVM_WR          0x8000
+#define SIM_NVM_WREN        0x4000
+#define SIM_NVM_WRERR       0x2000
+#define SIM_NVM_OP_MASK     0x000F
+#define SIM_NVM_OP_WORD     0x1
+#define SIM_NVM_OP_ERASE    0x4
+#define SIM_NVM_KEY2        0x556699AA
+
+// Bits de AD1CON1/AD1CON2 modifis par le matriel (exclus de la configuration)
+#define SIM_AD1CON1_HW_MASK 0x0007  // DONE, SAMP, ASAM
+#define SIM_AD1CON2_HW_MASK 0x0080  // BUFS
+
+#define SIM_ADC_MAX         1023
+#define SIM_ADC_CONV_TAD    12      // TAD de conversion (10 bits + 2)
+
+/*--------------------------------------------------------*/
+// Registres (xc.h, bsp.h)
+/*--------------------------------------------------------*/
+volatile U_simAd1Con1 SIM_Ad1Con1;
+volatile U_simAd1Con2 SIM_Ad1Con2;
+volatile U_simAd1Con3 SIM_Ad1Con3;
+volatile uint32_t SIM_Ad1Chs;
+volatile uint32_t SIM_Ad1Cssl;
+volatile uint32_t SIM_Ad1Pcfg;
+volatile uint32_t SIM_Adc1Buf[SIM_ADC1BUF_WORDS];
+volatile uint32_t SIM_NvmKey;
+volatile uint32_t SIM_NvmAddr;
+volatile uint32_t SIM_NvmData;
+S_simPins SIM_Pins;
+
+S_simState simState;
+
+static const uint16_t simPrescale[] = { 1, 2, 4, 8, 16, 32, 64, 256 };
+
+/**
+ * @brief Remet les registres et l'tat du matriel  zro (reset).
+ *
+ * @details Les timers reprennent la configuration de DRV_TMRx_Initialize
+ *          (system_init.c) ; l'image flash est conserve.
+ */
+void SIM_HalReset(void)
+{
+    uint8_t *pFlash = simState.Flash;
+    uint8_t i;
+
+    memset(&simState, 0, sizeof(simState));
+    simState.Flash = pFlash;
+    simState.IntGlobal = 1;
+
+    SIM_Ad1Con1.w = 0;
+    SIM_Ad1Con2.w = 0;
+    SIM_Ad1Con3.w = 0;
+    SIM_Ad1Chs = 0;
+    SIM_Ad1Cssl = 0;
+    SIM_Ad1Pcfg = 0;
+    memset((void *)SIM_Adc1Buf, 0, sizeof(SIM_Adc1Buf));
+    SIM_NvmKey = 0;
+    SIM_NvmAddr = 0;
+    SIM_NvmData = 0;
+    memset(&SIM_Pins, 0, sizeof(SIM_Pins));
+
+    for (i = 0; i < TMR_NUMBER_OF_MODULES; i++) {
+        simState.Tmr[i].DueNs = SIM_NEVER;
+    }
+    simState.Tmr[TMR_ID_1].Prescale = TMR_PRESCALE_VALUE_256;
+    simState.Tmr[TMR_ID_1].Period = 6249;
+    simState.Tmr[TMR_ID_2].Prescale = TMR_PRESCALE_VALUE_16;
+    simState.Tmr[TMR_ID_2].Period = 124;
+    simState.Tmr[TMR_ID_3].Prescale = TMR_PRESCALE_VALUE_64;
+    simState.Tmr[TMR_ID_3].Period = 8749;
+    simState.VectorPriority[INT_VECTOR_T1] = INT_PRIORITY_LEVEL4;
+    simState.VectorPriority[INT_VECTOR_UART1] = INT_PRIORITY_LEVEL5;
+
+    simState.AdcDueNs = SIM_NEVER;
+    simState.LineDueNs = SIM_NEVER;
+    simState.TxDueNs = SIM_NEVER;
+    simState.TxMode = USART_TRANSMIT_FIFO_EMPTY;
+
+    for (i = 0; i < SIM_LCD_LINES; i++) {
+        memset(simState.Lcd[i], ' ', SIM_LCD_COLUMNS);
+    }
+    simState.LcdX = 1;
+    simState.LcdY = 1;
+}
+
+/*--------------------------------------------------------*/
+// Contrleur d'interruptions
+/*--------------------------------------------------------*/
+
+bool PLIB_INT_SourceFlagGet(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    return simState.IntFlag[source] != 0;
+}
+
+void PLIB_INT_SourceFlagSet(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    simState.IntFlag[source] = 1;
+}
+
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    simState.IntFlag[source] = 0;
+}
+
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    simState.IntEnable[source] = 1;
+}
+
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    simState.IntEnable[source] = 0;
+}
+
+bool PLIB_INT_SourceIsEnabled(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    return simState.IntEnable[source] != 0;
+}
+
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority)
+{
+    (void)index;
+    simState.VectorPriority[vector] = (uint8_t)priority;
+}
+
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector,
+                                   INT_SUBPRIORITY_LEVEL subPriority)
+{
+    (void)index;
+    (void)vector;
+    (void)subPriority;
+}
+
+/*--------------------------------------------------------*/
+// Timers
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Priode d'un timer [ns].
+ */
+uint64_t SIM_TimerPeriodNs(const S_simTimer *pTmr)
+{
+    return ((uint64_t)(pTmr->Period + 1) * simPrescale[pTmr->Prescale] * SIM_PBCLK_PS) / 1000;
+}
+
+/**
+ * @brief Fin de priode : lve le drapeau et arme la priode suivante.
+ *
+ * @details Les priodes coules pendant un blocage du CPU (programmation
+ *          flash) ne lvent le drapeau qu'une fois, comme sur la cible.
+ */
+void SIM_TimerEvent(TMR_MODULE_ID id)
+{
+    S_simTimer *pTmr = &simState.Tmr[id];
+    uint64_t period = SIM_TimerPeriodNs(pTmr);
+
+    simState.IntFlag[INT_SOURCE_TIMER_1 + id] = 1;
+    while (pTmr->DueNs <= simState.Now) {
+        pTmr->DueNs += period;
+    }
+}
+
+/**
+ * @brief Arme les timers dont l'interruption peut tre servie.
+ *
+ * @details Un timer sans interruption (Timer 3, Timer 2 en mode ADC libre)
+ *          ne gnre pas d'vnements ;  l'autorisation de sa source, la
+ *          prochaine chance est recale sur sa phase, sans drapeau.
+ */
+void SIM_TimerArm(void)
+{
+    S_simTimer *pTmr;
+    uint64_t period;
+    uint8_t armed;
+    uint8_t i;
+
+    for (i = 0; i < TMR_NUMBER_OF_MODULES; i++)
+    {
+        pTmr = &simState.Tmr[i];
+        armed = pTmr->On && simState.IntEnable[INT_SOURCE_TIMER_1 + i] &&
+                (simState.VectorPriority[INT_VECTOR_T1 + i] != INT_DISABLE_INTERRUPT);
+        if (armed && !pTmr->Armed) {
+            period = SIM_TimerPeriodNs(pTmr);
+            pTmr->DueNs = pTmr->StartNs + ((((simState.Now - pTmr->StartNs) / period) + 1) * period);
+        }
+        pTmr->Armed = armed;
+    }
+}
+
+void PLIB_TMR_Start(TMR_MODULE_ID index)
+{
+    S_simTimer *pTmr = &simState.Tmr[index];
+
+    if (!pTmr->On) {
+        pTmr->On = 1;
+        pTmr->StartNs = simState.Now;
+        pTmr->DueNs = simState.Now + SIM_TimerPeriodNs(pTmr);
+    }
+}
+
+void PLIB_TMR_Stop(TMR_MODULE_ID index)
+{
+    simState.Tmr[index].On = 0;
+    simState.Tmr[index].DueNs = SIM_NEVER;
+}
+
+void PLIB_TMR_ClockSourceSelect(TMR_MODULE_ID index, TMR_CLOCK_SOURCE source)
+{
+    (void)index;
+    (void)source;
+}
+
+void PLIB_TMR_PrescaleSelect(TMR_MODULE_ID index, TMR_PRESCALE prescale)
+{
+    simState.Tmr[index].Prescale = (uint8_t)prescale;
+}
+
+void PLIB_TMR_Mode16BitEnable(TMR_MODULE_ID index)
+{
+    (void)index;
+}
+
+void PLIB_TMR_Counter16BitClear(TMR_MODULE_ID index)
+{
+    S_simTimer *pTmr = &simState.Tmr[index];
+
+    pTmr->StartNs = simState.Now;
+    if (pTmr->On) {
+        pTmr->DueNs = simState.Now + SIM_TimerPeriodNs(pTmr);
+    }
+}
+
+void PLIB_TMR_Period16BitSet(TMR_MODULE_ID index, uint16_t period)
+{
+    simState.Tmr[index].Period = period;
+}
+
+uint16_t PLIB_TMR_Counter16BitGet(TMR_MODULE_ID index)
+{
+    const S_simTimer *pTmr = &simState.Tmr[index];
+    uint64_t ticks;
+
+    if (!pTmr->On) {
+        return 0;
+    }
+    ticks = ((simState.Now - pTmr->StartNs) * 1000) / ((uint64_t)simPrescale[pTmr->Prescale] * SIM_PBCLK_PS);
+    return (uint16_t)(ticks % ((uint32_t)pTmr->Period + 1));
+}
+
+/**
+ * @brief Dmarrage d'un timer Harmony : drapeau effac, source autorise.
+ */
+static bool SIM_DrvTmrStart(TMR_MODULE_ID id)
+{
+    PLIB_INT_SourceFlagClear(INT_ID_0, (INT_SOURCE)(INT_SOURCE_TIMER_1 + id));
+    PLIB_INT_SourceEnable(INT_ID_0, (INT_SOURCE)(INT_SOURCE_TIMER_1 + id));
+    PLIB_TMR_Start(id);
+    return true;
+}
+
+bool DRV_TMR0_Start(void)
+{
+    return SIM_DrvTmrStart(TMR_ID_1);
+}
+
+bool DRV_TMR1_Start(void)
+{
+    return SIM_DrvTmrStart(TMR_ID_2);
+}
+
+bool DRV_TMR2_Start(void)
+{
+    return SIM_DrvTmrStart(TMR_ID_3);
+}
+
+/*--------------------------------------------------------*/
+// ADC10
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Dure d'une squence de SMPI + 1 conversions [ns].
+ */
+static uint64_t SIM_AdcSequenceNs(void)
+{
+    uint64_t tadPs = 2 * ((uint64_t)SIM_Ad1Con3.bits.ADCS + 1) * SIM_PBCLK_PS;
+    uint64_t convPs = ((uint64_t)SIM_Ad1Con3.bits.SAMC + SIM_ADC_CONV_TAD) * tadPs;
+
+    return (((uint64_t)SIM_Ad1Con2.bits.SMPI + 1) * convPs) / 1000;
+}
+
+/**
+ * @brief Conversion d'une entre : valeur rgle plus bruit uniforme.
+ */
+static uint16_t SIM_AdcConvert(uint8_t chan)
+{
+    int32_t value = simState.AdcValue[chan];
+    uint16_t noise = simState.AdcNoise[chan];
+
+    if (noise != 0) {
+        simState.Rand = (simState.Rand * 1103515245u) + 12345u;
+        value += (int32_t)((simState.Rand >> 8) % ((2u * noise) + 1)) - noise;
+    }
+    if (value < 0) {
+        value = 0;
+    } else if (value > SIM_ADC_MAX) {
+        value = SIM_ADC_MAX;
+    }
+    return (uint16_t)value;
+}
+
+/**
+ * @brief Arme ou annule la squence de conversion selon AD1CON1..3.
+ *
+ * @details Appele aprs chaque pas de l'ordonnanceur : le lancement par
+ *          ASAM (mode synchronis) et les reconfigurations sont vus ds
+ *          la fin de l'interruption ou de l'itration qui les a crits.
+ */
+void SIM_AdcUpdate(void)
+{
+    uint32_t config[3];
+
+    if (!SIM_Ad1Con1.bits.ON) {
+        simState.AdcDueNs = SIM_NEVER;
+        return;
+    }
+    config[0] = SIM_Ad1Con1.w & ~SIM_AD1CON1_HW_MASK;
+    config[1] = SIM_Ad1Con2.w & ~SIM_AD1CON2_HW_MASK;
+    config[2] = SIM_Ad1Con3.w;
+    if ((simState.AdcDueNs != SIM_NEVER) && (memcmp(config, simState.AdcConfig, sizeof(config)) == 0)) {
+        return; // Squence en cours, configuration inchange
+    }
+    if (!SIM_Ad1Con1.bits.ASAM) {
+        simState.AdcDueNs = SIM_NEVER;
+        return;
+    }
+    memcpy(simState.AdcConfig, config, sizeof(config));
+    simState.AdcDueNs = simState.Now + SIM_AdcSequenceNs();
+}
+
+/**
+ * @brief Fin de squence : rsultats dans ADC1BUFx, drapeau AD1IF.
+ *
+ * @details Balayage des entres de AD1CSSL (CSCNA) ou de CH0SA. Avec BUFM,
+ *          la moiti en cours de remplissage est indique par BUFS, qui
+ *          bascule  chaque interruption. CLRASAM arrte l'acquisition.
+ */
+void SIM_AdcEvent(void)
+{
+    uint8_t scan[SIM_ADC_NB_CHANNELS];
+    uint8_t nbScan = 0;
+    uint8_t nbConv = (uint8_t)(SIM_Ad1Con2.bits.SMPI + 1);
+    uint8_t base = 0;
+    uint8_t ch;
+    uint8_t k;
+
+    if (SIM_Ad1Con2.bits.CSCNA) {
+        for (ch = 0; ch < SIM_ADC_NB_CHANNELS; ch++) {
+            if (SIM_Ad1Cssl & (1u << ch)) {
+                scan[nbScan++] = ch;
+            }
+        }
+    }
+    if (nbScan == 0) {
+        scan[nbScan++] = (uint8_t)((SIM_Ad1Chs >> 16) & 0x0F);
+    }
+    if (SIM_Ad1Con2.bits.BUFM && SIM_Ad1Con2.bits.BUFS) {
+        base = SIM_ADC_BUF_WORDS / 2;
+    }
+    for (k = 0; k < nbConv; k++) {
+        SIM_Adc1Buf[((base + k) % SIM_ADC_BUF_WORDS) * 4] = SIM_AdcConvert(scan[k % nbScan]);
+    }
+    if (SIM_Ad1Con2.bits.BUFM) {
+        SIM_Ad1Con2.bits.BUFS = !SIM_Ad1Con2.bits.BUFS;
+    }
+    SIM_Ad1Con1.bits.DONE = 1;
+    simState.IntFlag[INT_SOURCE_ADC_1] = 1;
+
+    if (SIM_Ad1Con1.bits.CLRASAM) {
+        SIM_Ad1Con1.bits.ASAM = 0;
+        simState.AdcDueNs = SIM_NEVER;
+    } else {
+        simState.AdcDueNs += SIM_AdcSequenceNs();
+        if (simState.AdcDueNs <= simState.Now) {
+            simState.AdcDueNs = simState.Now + SIM_AdcSequenceNs();
+        }
+    }
+}
+
+/*--------------------------------------------------------*/
+// UART1
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Charge le prochain octet du FIFO TX dans le registre  dcalage.
+ * @param startNs Dbut de l'mission.
+ */
+static void SIM_UartTxLoad(uint64_t startNs)
+{
+    simState.TxShift = simState.TxFifo[simState.TxHead];
+    simState.TxHead = (simState.TxHead + 1) % SIM_UART_HW_FIFO;
+    simState.TxCount--;
+    simState.TxShiftBusy = 1;
+    simState.TxDueNs = startNs + SIM_UART_BYTE_NS;
+}
+
+/**
+ * @brief Condition d'interruption TX selon UTXISEL.
+ */
+static uint8_t SIM_UartTxCondition(void)
+{
+    switch (simState.TxMode)
+    {
+        case USART_TRANSMIT_FIFO_NOT_FULL:
+            return simState.TxCount < SIM_UART_HW_FIFO;
+        case USART_TRANSMIT_FIFO_IDLE:
+            return (simState.TxCount == 0) && !simState.TxShiftBusy;
+        default:
+            return simState.TxCount == 0;
+    }
+}
+
+/**
+ * @brief Fin d'mission d'un octet : sortie sur la ligne, octet suivant.
+ *
+ * @details En multipoint, un octet mis alors que DE (RTS) est bas n'atteint
+ *          pas le bus ; il est compt dans TxDeLow.
+ */
+void SIM_UartTxEvent(void)
+{
+    uint64_t endNs = simState.TxDueNs;
+
+    simState.Stats.TxBytes++;
+#if RS232_MULTIDROP
+    if (SIM_Pins.Rts == 0) {
+        simState.Stats.TxDeLow++;
+    } else
+#endif
+    if ((simState.OutHead - simState.OutTail) < SIM_OUT_SIZE) {
+        simState.Out[simState.OutHead++ % SIM_OUT_SIZE] = simState.TxShift;
+    }
+    simState.TxShiftBusy = 0;
+    simState.TxDueNs = SIM_NEVER;
+    if (simState.TxCount > 0) {
+        SIM_UartTxLoad(endNs);
+    }
+}
+
+/**
+ * @brief Arme l'arrive du prochain octet de la ligne RX.
+ *
+ * @details L'metteur distant teste RTS avant chaque octet (si
+ *          RtsHonored) ; un octet commenc est toujours transmis.
+ */
+void SIM_UartLineUpdate(void)
+{
+    uint64_t start;
+
+    if ((simState.LineDueNs != SIM_NEVER) || (simState.LineHead == simState.LineTail)) {
+        return;
+    }
+    if (simState.Config.RtsHonored && SIM_Pins.Rts) {
+        return;
+    }
+    start = (simState.LineFreeNs > simState.Now) ? simState.LineFreeNs : simState.Now;
+    simState.LineDueNs = start + SIM_UART_BYTE_NS;
+}
+
+/**
+ * @brief Arrive d'un octet : dpt dans le FIFO matriel RX.
+ *
+ * @details FIFO plein => OERR, l'octet est perdu ; la rception reste
+ *          bloque jusqu' l'effacement de OERR (comme sur le PIC32).
+ */
+void SIM_UartLineEvent(void)
+{
+    uint32_t pos = simState.LineTail++ % SIM_LINE_SIZE;
+    S_simRxByte *pSlot;
+
+    simState.LineFreeNs = simState.LineDueNs;
+    simState.LineDueNs = SIM_NEVER;
+    simState.Stats.RxBytes++;
+
+#if RS232_MULTIDROP
+    if (!simState.UartOn || SIM_Pins.Rts) {     // /RE reli  DE : pas d'cho
+#else
+    if (!simState.UartOn) {
+#endif
+        simState.Stats.RxLost++;
+        return;
+    }
+    if (simState.RxOverrun || (simState.RxCount == SIM_UART_HW_FIFO)) {
+        simState.RxOverrun = 1;
+        simState.Stats.RxOverruns++;
+        return;
+    }
+    pSlot = &simState.RxFifo[(simState.RxHead + simState.RxCount) % SIM_UART_HW_FIFO];
+    pSlot->Data = simState.LineData[pos];
+    pSlot->Errors = simState.LineErrors[pos];
+    simState.RxCount++;
+}
+
+/**
+ * @brief Drapeaux d'interruption UART tenus par le niveau des conditions.
+ *
+ * @details Sur le PIC32, UxRXIF, UxEIF et UxTXIF sont relevs tant que la
+ *          condition persiste. Une ISR TX qui n'a rien pu dposer (CTS
+ *          actif) retient UxTXIF pendant un temps octet (TxStallNs) : la
+ *          boucle d'interruptions de la cible devient une scrutation.
+ */
+void SIM_UartLevels(void)
+{
+    if (!simState.UartOn) {
+        return;
+    }
+    if (simState.RxCount > 0) {
+        simState.IntFlag[INT_SOURCE_USART_1_RECEIVE] = 1;
+    }
+    if (simState.RxOverrun ||
+        ((simState.RxCount > 0) && (simState.RxFifo[simState.RxHead].Errors != 0))) {
+        simState.IntFlag[INT_SOURCE_USART_1_ERROR] = 1;
+    }
+    if (SIM_UartTxCondition() && (simState.Now >= simState.TxStallNs)) {
+        simState.IntFlag[INT_SOURCE_USART_1_TRANSMIT] = 1;
+    }
+}
+
+USART_ERROR PLIB_USART_ErrorsGet(USART_MODULE_ID index)
+{
+    uint32_t errors = USART_ERROR_NONE;
+    uint8_t head;
+
+    (void)index;
+    if (simState.RxOverrun) {
+        errors |= USART_ERROR_RECEIVER_OVERRUN;
+    }
+    if (simState.RxCount > 0) {
+        head = simState.RxFifo[simState.RxHead].Errors;
+        if (head & SIM_UART_ERR_FRAMING) {
+            errors |= USART_ERROR_FRAMING;
+        }
+        if (head & SIM_UART_ERR_PARITY) {
+            errors |= USART_ERROR_PARITY;
+        }
+    }
+    return (USART_ERROR)errors;
+}
+
+void PLIB_USART_ReceiverOverrunErrorClear(USART_MODULE_ID index)
+{
+    (void)index;
+    simState.RxOverrun = 0;
+    simState.RxCount = 0;   // L'effacement de OERR vide le FIFO matriel
+}
+
+bool PLIB_USART_ReceiverDataIsAvailable(USART_MODULE_ID index)
+{
+    (void)index;
+    return simState.RxCount > 0;
+}
+
+uint8_t PLIB_USART_ReceiverByteReceive(USART_MODULE_ID index)
+{
+    uint8_t data;
+
+    (void)index;
+    if (simState.RxCount == 0) {
+        return 0;
+    }
+    data = simState.RxFifo[simState.RxHead].Data;
+    simState.RxHead = (simState.RxHead + 1) % SIM_UART_HW_FIFO;
+    simState.RxCount--;
+    return data;
+}
+
+bool PLIB_USART_TransmitterBufferIsFull(USART_MODULE_ID index)
+{
+    (void)index;
+    return simState.TxCount == SIM_UART_HW_FIFO;
+}
+
+void PLIB_USART_TransmitterByteSend(USART_MODULE_ID index, uint8_t data)
+{
+    (void)index;
+    if (simState.TxCount == SIM_UART_HW_FIFO) {
+        return;
+    }
+    simState.TxFifo[(simState.TxHead + simState.TxCount) % SIM_UART_HW_FIFO] = data;
+    simState.TxCount++;
+    simState.TxSent++;
+    if (!simState.TxShiftBusy) {
+        SIM_UartTxLoad(simState.Now);
+    }
+}
+
+bool PLIB_USART_TransmitterIsEmpty(USART_MODULE_ID index)
+{
+    (void)index;
+    return (simState.TxCount == 0) && !simState.TxShiftBusy;
+}
+
+void PLIB_USART_TransmitterInterruptModeSelect(USART_MODULE_ID index,
+                                               USART_TRANSMIT_INTR_MODE fifoLevel)
+{
+    (void)index;
+    simState.TxMode = (uint8_t)fifoLevel;
+}
+
+/**
+ * @brief Configuration de drv_usart_static.c : 57600 8N1, interruption TX
+ *        sur FIFO vide, sources RX et erreur autorises.
+ */
+SYS_MODULE_OBJ DRV_USART0_Initialize(void)
+{
+    simState.UartOn = 1;
+    simState.TxMode = USART_TRANSMIT_FIFO_EMPTY;
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_1_TRANSMIT);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+    PLIB_INT_SourceFlagClear(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_ERROR);
+    PLIB_INT_SourceEnable(INT_ID_0, INT_SOURCE_USART_1_RECEIVE);
+    return 0;
+}
+
+/*--------------------------------------------------------*/
+// Ports, Output Compare, BSP
+/*--------------------------------------------------------*/
+
+void PLIB_PORTS_PinSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    simState.Port[channel] |= (1u << bitPos);
+}
+
+void PLIB_PORTS_PinClear(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    simState.Port[channel] &= ~(1u << bitPos);
+}
+
+PORTS_DATA_TYPE PLIB_PORTS_Read(PORTS_MODULE_ID index, PORTS_CHANNEL channel)
+{
+    (void)index;
+    return simState.Port[channel];
+}
+
+void PLIB_PORTS_Write(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_DATA_TYPE value)
+{
+    (void)index;
+    simState.Port[channel] = value;
+}
+
+void PLIB_OC_PulseWidth16BitSet(OC_MODULE_ID index, uint16_t pulseWidth)
+{
+    simState.OcPulse[index] = pulseWidth;
+}
+
+void DRV_OC0_Start(void)
+{
+}
+
+void DRV_OC1_Start(void)
+{
+}
+
+void BSP_LEDOn(BSP_LED led)
+{
+    simState.Led[led] = 1;
+}
+
+void BSP_LEDOff(BSP_LED led)
+{
+    simState.Led[led] = 0;
+}
+
+void BSP_LEDToggle(BSP_LED led)
+{
+    simState.Led[led] = !simState.Led[led];
+}
+
+void BSP_EnableHbrige(void)
+{
+    simState.HBridgeOn = 1;
+}
+
+/*--------------------------------------------------------*/
+// Afficheur
+/*--------------------------------------------------------*/
+
+void lcd_init(void)
+{
+    uint8_t i;
+
+    for (i = 1; i <= SIM_LCD_LINES; i++) {
+        lcd_ClearLine(i);
+    }
+    lcd_gotoxy(1, 1);
+}
+
+void lcd_bl_on(void)
+{
+}
+
+void lcd_bl_off(void)
+{
+}
+
+void lcd_gotoxy(uint8_t x, uint8_t y)
+{
+    simState.LcdX = x;
+    simState.LcdY = y;
+}
+
+void lcd_ClearLine(uint8_t noLine)
+{
+    if ((noLine >= 1) && (noLine <= SIM_LCD_LINES)) {
+        memset(simState.Lcd[noLine - 1], ' ', SIM_LCD_COLUMNS);
+    }
+}
+
+void printf_lcd(const char *format, ...)
+{
+    char text[SIM_LCD_COLUMNS + 1];
+    va_list args;
+    uint8_t i;
+
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if ((simState.LcdY < 1) || (simState.LcdY > SIM_LCD_LINES)) {
+        return;
+    }
+    for (i = 0; (text[i] != 0) && (simState.LcdX >= 1) && (simState.LcdX <= SIM_LCD_COLUMNS); i++) {
+        simState.Lcd[simState.LcdY - 1][simState.LcdX - 1] = text[i];
+        simState.LcdX++;
+    }
+}
+
+/*--------------------------------------------------------*/
+// Contrleur flash
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Excute l'opration NVMOP lance par WR.
+ *
+ * @details Le CPU est bloqu pendant l'opration (excution depuis la
+ *          flash) : le temps virtuel avance de la dure de l'opration,
+ *          les interruptions chues sont servies ensuite.
+ */
+static void SIM_NvmExecute(void)
+{
+    uint32_t addr = SIM_NvmAddr;
+    uint32_t offset = addr - GNVM_FLASH_BASE;
+    uint32_t word;
+    uint8_t ok = 0;
+
+    if ((simState.NvmCon & SIM_NVM_WREN) && (SIM_NvmKey == SIM_NVM_KEY2) &&
+        (addr >= GNVM_FLASH_BASE) && (offset < GNVM_FLASH_SIZE))
+    {
+        switch (simState.NvmCon & SIM_NVM_OP_MASK)
+        {
+            case SIM_NVM_OP_WORD:
+            {
+                if ((offset % GNVM_WORD_SIZE) == 0) {
+                    // Programmation : seuls des bits  1 passent  0
+                    memcpy(&word, &simState.Flash[offset], sizeof(word));
+                    word &= SIM_NvmData;
+                    memcpy(&simState.Flash[offset], &word, sizeof(word));
+                    simState.Now += SIM_NVM_WORD_NS;
+                    simState.Stats.NvmWrites++;
+                    ok = 1;
+                }
+                break;
+            }
+            case SIM_NVM_OP_ERASE:
+            {
+                memset(&simState.Flash[offset & ~(GNVM_PAGE_SIZE - 1)], 0xFF, GNVM_PAGE_SIZE);
+                simState.Now += SIM_NVM_ERASE_NS;
+                simState.Stats.NvmErases++;
+                ok = 1;
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+    if (!ok) {
+        simState.NvmCon |= SIM_NVM_WRERR;
+    }
+    simState.NvmCon &= ~SIM_NVM_WR;
+    SIM_NvmKey = 0;
+}
+
+/**
+ * @brief Applique les critures NVMCONSET/NVMCONCLR en attente.
+ *
+ * @details Les registres SET/CLR sont crits au travers d'un pointeur : leur
+ *          effet est appliqu au prochain accs NVM, avant lecture de NVMCON.
+ */
+static void SIM_NvmApply(void)
+{
+    if (simState.NvmConSet != 0) {
+        simState.NvmCon |= simState.NvmConSet;
+        simState.NvmConSet = 0;
+    }
+    if (simState.NvmConClr != 0) {
+        simState.NvmCon &= ~simState.NvmConClr;
+        simState.NvmConClr = 0;
+    }
+    if (simState.NvmCon & SIM_NVM_WR) {
+        SIM_NvmExecute();
+    }
+}
+
+volatile uint32_t *SIM_NvmConReg(void)
+{
+    SIM_NvmApply();
+    return &simState.NvmCon;
+}
+
+volatile uint32_t *SIM_NvmConSetReg(void)
+{
+    SIM_NvmApply();
+    return &simState.NvmConSet;
+}
+
+volatile uint32_t *SIM_NvmConClrReg(void)
+{
+    SIM_NvmApply();
+    return &simState.NvmConClr;
+}
+
+uintptr_t SIM_FlashVa(uint32_t physAddr)
+{
+    if ((physAddr < GNVM_FLASH_BASE) || ((physAddr - GNVM_FLASH_BASE) >= GNVM_FLASH_SIZE)) {
+        fprintf(stderr, "sim: adresse flash hors limites 0x%08X\n", (unsigned)physAddr);
+        abort();
+    }
+    return (uintptr_t)&simState.Flash[physAddr - GNVM_FLASH_BASE];
+}
+
+/*--------------------------------------------------------*/
+// Coeur MIPS
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Lecture du core timer : chaque lecture avance d'un tick.
+ */
+uint32_t SIM_CoreTimerRead(void)
+{
+    simState.Now += SIM_CORE_TICK_NS;
+    return (uint32_t)(simState.Now / SIM_CORE_TICK_NS);
+}
+
+unsigned int SIM_DisableInterrupts(void)
+{
+    unsigned int status = simState.IntGlobal ? 1 : 0;
+
+    simState.IntGlobal = 0;
+    return status;
+}
+
+void SIM_EnableInterrupts(void)
+{
+    simState.IntGlobal = 1;
+}
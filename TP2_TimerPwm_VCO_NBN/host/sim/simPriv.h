@@ -0,0 +1,137 @@
+#ifndef SimPriv_H
+#define SimPriv_H
+
+/*--------------------------------------------------------*/
+// SimPriv.h
+/*--------------------------------------------------------*/
+// Description : tat du matriel simul, partag entre l'ordonnanceur
+//               (simDevice.c) et les priphriques (simHal.c).
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "system_definitions.h"
+#include "simDevice.h"
+
+/*--------------------------------------------------------*/
+// Dfinitions des constantes
+/*--------------------------------------------------------*/
+#define SIM_NEVER           UINT64_MAX
+#define SIM_PBCLK_PS        12500       // Priode de PBCLK (80 MHz) [ps]
+#define SIM_LINE_SIZE       65536       // Octets en attente sur la ligne RX (puissance de 2)
+#define SIM_OUT_SIZE        65536       // Octets mis non lus par SIM_UartRead (puissance de 2)
+#define SIM_ADC_BUF_WORDS   16          // ADC1BUF0..F
+#define SIM_ISR_LOOP_MAX    64          // Interruptions par pas (drapeau jamais effac => abandon)
+
+/*--------------------------------------------------------*/
+// Types
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Timer 16 bits (Timer 1  5).
+ */
+typedef struct {
+    uint8_t On;
+    uint8_t Armed;          // 1 = interruption possible (source autorise, priorit > 0)
+    uint8_t Prescale;       // TMR_PRESCALE
+    uint16_t Period;        // PRx
+    uint64_t StartNs;       // Instant o TMRx valait 0
+    uint64_t DueNs;         // Prochaine fin de priode (SIM_NEVER si arrt)
+} S_simTimer;
+
+/**
+ * @brief Octet du FIFO matriel RX avec ses erreurs.
+ */
+typedef struct {
+    uint8_t Data;
+    uint8_t Errors;         // SIM_UART_ERR_xxx
+} S_simRxByte;
+
+/**
+ * @brief tat complet du matriel simul.
+ */
+typedef struct {
+    S_simConfig Config;
+    uint64_t Now;                           // Temps virtuel [ns]
+    uint32_t Rand;                          // Gnrateur du bruit ADC
+
+    // Contrleur d'interruptions
+    uint8_t IntFlag[INT_SOURCE_NB];
+    uint8_t IntEnable[INT_SOURCE_NB];
+    uint8_t VectorPriority[INT_VECTOR_NB];
+    uint8_t IntGlobal;                      // 0 entre __builtin_disable et enable_interrupts
+
+    // Timers
+    S_simTimer Tmr[TMR_NUMBER_OF_MODULES];
+
+    // ADC10
+    uint16_t AdcValue[SIM_ADC_NB_CHANNELS];
+    uint16_t AdcNoise[SIM_ADC_NB_CHANNELS];
+    uint64_t AdcDueNs;                      // Fin de la squence en cours
+    uint32_t AdcConfig[3];                  // AD1CON1..3 au lancement de la squence
+
+    // UART1 : ligne RX (metteur distant)
+    uint8_t UartOn;
+    uint8_t LineData[SIM_LINE_SIZE];
+    uint8_t LineErrors[SIM_LINE_SIZE];
+    uint32_t LineHead;
+    uint32_t LineTail;
+    uint64_t LineDueNs;                     // Arrive de l'octet en cours
+    uint64_t LineFreeNs;                    // Fin du dernier octet (dbut possible du suivant)
+
+    // UART1 : rception
+    S_simRxByte RxFifo[SIM_UART_HW_FIFO];
+    uint8_t RxHead;
+    uint8_t RxCount;
+    uint8_t RxOverrun;                      // OERR
+
+    // UART1 : mission
+    uint8_t TxFifo[SIM_UART_HW_FIFO];
+    uint8_t TxHead;
+    uint8_t TxCount;
+    uint8_t TxShift;                        // Octet dans le registre  dcalage
+    uint8_t TxShiftBusy;
+    uint8_t TxMode;                         // USART_TRANSMIT_INTR_MODE
+    uint64_t TxDueNs;                       // Fin de l'octet en cours d'mission
+    uint64_t TxStallNs;                     // Interruption TX retenue jusqu' cet instant
+    uint32_t TxSent;                        // Octets dposs (dtection d'une ISR sans effet)
+    uint8_t Out[SIM_OUT_SIZE];
+    uint32_t OutHead;
+    uint32_t OutTail;
+
+    // E/S
+    uint16_t OcPulse[OC_NUMBER_OF_MODULES];
+    uint32_t Port[PORT_CHANNEL_NB];
+    uint8_t Led[BSP_LED_NB];
+    uint8_t HBridgeOn;
+    char Lcd[SIM_LCD_LINES][SIM_LCD_COLUMNS + 1];
+    uint8_t LcdX;
+    uint8_t LcdY;
+
+    // Contrleur flash
+    uint8_t *Flash;
+    uint32_t NvmCon;
+    uint32_t NvmConSet;
+    uint32_t NvmConClr;
+
+    uint64_t MainDueNs;                     // Prochaine itration de la boucle principale au repos
+    S_simStats Stats;
+} S_simState;
+
+extern S_simState simState;
+
+/*--------------------------------------------------------*/
+// Prototypes des fonctions (simHal.c)
+/*--------------------------------------------------------*/
+void SIM_HalReset(void);
+uint64_t SIM_TimerPeriodNs(const S_simTimer *pTmr);
+void SIM_TimerEvent(TMR_MODULE_ID id);
+void SIM_TimerArm(void);
+void SIM_AdcUpdate(void);
+void SIM_AdcEvent(void);
+void SIM_UartLineUpdate(void);
+void SIM_UartLineEvent(void);
+void SIM_UartTxEvent(void);
+void SIM_UartLevels(void);
+
+#endif // SimPriv_H
@@ -0,0 +1,37 @@
+#ifndef Check_H
+#define Check_H
+
+/*--------------------------------------------------------*/
+// Check.h
+/*--------------------------------------------------------*/
+// Description : Assertions minimales des tests hte (CTest) : un chec est
+//               affich et compt, le test continue ; code de sortie = checs
+//
+/*--------------------------------------------------------*/
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: echec : %s\n", __FILE__, __LINE__, #cond); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        long long checkA = (long long)(a); \
+        long long checkB = (long long)(b); \
+        if (checkA != checkB) { \
+            fprintf(stderr, "%s:%d: echec : %s == %s (%lld != %lld)\n", \
+                    __FILE__, __LINE__, #a, #b, checkA, checkB); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_RESULT() \
+    (printf("%s\n", (checkFailures == 0) ? "OK" : "ECHEC"), (checkFailures != 0))
+
+#endif // Check_H
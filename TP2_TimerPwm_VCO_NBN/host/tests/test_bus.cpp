@@ -0,0 +1,118 @@
+/*--------------------------------------------------------*/
+// Test_bus.cpp
+/*--------------------------------------------------------*/
+//	Description :	Bus RS485 simul : plusieurs cartes tp2_vdev_md
+//			        sur un pty, interroges  tour de rle par
+//			        tp2link. Vrifie l'absence de collision (aucune
+//			        trame perdue ou corrompue) et mesure le dbit
+//			        d'interrogation.
+//
+//	Usage :		test_bus CHEMIN/tp2_vdev_md
+//
+/*--------------------------------------------------------*/
+#include <cstdio>
+#include <vector>
+
+#include "tp2link.hpp"
+#include "vdevProcess.hpp"
+#include "check.h"
+
+using namespace tp2link;
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kNodes = 3;
+constexpr int kRounds = 20;         // Interrogations par carte
+
+struct Node {
+    int States = 0;                 // Trames d'tat reues
+    int Replies = 0;
+};
+
+/**
+ * @brief Attend l'entre en service de la carte (dmarrage de 3 s).
+ */
+bool waitReady(EventLoop &loop, Device &dev)
+{
+    bool done = false;
+    bool ready = false;
+
+    dev.command(CMD_PING, { 0 }, [&](std::error_code ec, const Response &) {
+        ready = !ec;
+        done = true;
+    }, 6s);
+    loop.runUntil([&] { return done; }, 10s);
+    return ready;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: test_bus CHEMIN/tp2_vdev_md\n");
+        return 2;
+    }
+
+    EventLoop loop;
+    VdevProcess vdev(argv[1], { "--nodes", std::to_string(kNodes) });
+    PortOptions options;
+    options.Multidrop = true;
+    Port port(loop, std::make_unique<SerialTransport>(loop, vdev.path(), 57600, false), options);
+    std::vector<Node> nodes(kNodes + 1);
+
+    for (uint8_t addr = 1; addr <= kNodes; addr++) {
+        port.device(addr).onSetpoint([&nodes, addr](int8_t, int8_t) { nodes[addr].States++; });
+        CHECK(waitReady(loop, port.device(addr)));
+    }
+    CHECK_EQ(port.stats().Timeouts, 0);
+
+    // Remise  zro par diffusion (sans rponse), puis interrogations  tour de rle
+    port.device(RS232_ADDR_BROADCAST).command(CMD_STATS_RESET, {}, nullptr);
+    int done = 0;
+    auto start = EventLoop::Clock::now();
+    for (int round = 0; round < kRounds; round++) {
+        for (uint8_t addr = 1; addr <= kNodes; addr++) {
+            port.device(addr).setpoint((int8_t)round, 0);
+            port.device(addr).paramRead(PARAM_ID_NODE_ADDRESS,
+                                        [&, addr](std::error_code ec, uint8_t status, int16_t value) {
+                CHECK(!ec);
+                CHECK_EQ(status, PARAM_OK);
+                CHECK_EQ(value, addr);
+                nodes[addr].Replies++;
+                done++;
+            });
+        }
+    }
+    CHECK(loop.runUntil([&] { return (done == kNodes * kRounds) && (port.pending() == 0); }, 30s));
+    double elapsed = duration<double>(EventLoop::Clock::now() - start).count();
+
+    for (uint8_t addr = 1; addr <= kNodes; addr++) {
+        CHECK_EQ(nodes[addr].States, kRounds);
+        CHECK_EQ(nodes[addr].Replies, kRounds);
+
+        // Ct carte : aucune trame corrompue, les trames des autres noeuds filtres
+        bool got = false;
+        port.device(addr).command(CMD_GET_LINK_STATS, {}, [&](std::error_code ec, const Response &r) {
+            CHECK(!ec);
+            if (!ec) {
+                CHECK_EQ(r.u32(1 + 4 * 1), 0);      // FramesBadCrc
+                CHECK(r.u32(1 + 4 * 10) > 0);       // AddrFiltered
+            }
+            got = true;
+        });
+        CHECK(loop.runUntil([&] { return got; }, 2s));
+    }
+
+    // Ct hte : aucune perte, aucun octet hors trame ni CRC invalide
+    CHECK_EQ(port.stats().Timeouts, 0);
+    CHECK_EQ(port.stats().Unmatched, 0);
+    CHECK_EQ(port.scanner().BadCrc, 0);
+    CHECK_EQ(port.scanner().Skipped, 0);
+
+    std::printf("bus : %d cartes, %d transactions en %.2f s : %.1f transactions/s\n", kNodes,
+                2 * kNodes * kRounds, elapsed, 2 * kNodes * kRounds / elapsed);
+    return CHECK_RESULT();
+}
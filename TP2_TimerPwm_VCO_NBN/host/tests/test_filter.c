@@ -0,0 +1,190 @@
+/*--------------------------------------------------------*/
+// Test_filter.c
+/*--------------------------------------------------------*/
+//	Description :	Tests hte des filtres ADC (gestFilter) : gain statique,
+//			        rponse indicielle et rjection du bruit, compars  la
+//			        moyenne glissante
+//
+/*--------------------------------------------------------*/
+#include <math.h>
+#include <stdint.h>
+
+#include "gestFilter.h"
+#include "check.h"
+
+#define SCAN_HZ         2500    // Cadence d'acquisition (GADC_SCAN_HZ)
+#define CYCLE_HZ        50      // Cycle de service : une moyenne par cycle
+#define SCAN_PER_CYCLE  (SCAN_HZ / CYCLE_HZ)
+#define TONE_AMP        200.0   // Amplitude des perturbations [pas ADC]
+#define RUN_CYCLES      2000
+#define SETTLE_CYCLES   500     // Transitoire ignor dans les mesures d'ondulation
+
+/**
+ * @brief Configure un banc d'un canal sans table de sortie.
+ */
+static void FilterSetup(S_filterBank *pB, E_filterType type, uint8_t param, uint16_t initial)
+{
+    S_filterChanCfg cfg;
+
+    cfg.Type = type;
+    cfg.Param = param;
+    cfg.pMap = 0;
+    GFILT_BankInit(pB, 1);
+    GFILT_BankConfig(pB, 0, &cfg, initial);
+}
+
+/**
+ * @brief Ondulation rsiduelle (crte, en pas ADC) d'une sinusode autour de 512.
+ *
+ * @param chain 1 = sinusode chantillonne  SCAN_HZ puis moyenne par cycle
+ *              (chane gestAdc -> GADC_GetMean -> filtre), 0 = chantillonne
+ *              directement  la cadence du filtre (CYCLE_HZ).
+ */
+static double Ripple(E_filterType type, uint8_t param, double freq, int chain)
+{
+    S_filterBank bank;
+    uint16_t in;
+    int32_t out;
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+    long n = 0;
+    long sum;
+    int cycle;
+    int i;
+
+    FilterSetup(&bank, type, param, 512);
+    for (cycle = 0; cycle < RUN_CYCLES; cycle++)
+    {
+        if (chain) {
+            sum = 0;
+            for (i = 0; i < SCAN_PER_CYCLE; i++, n++) {
+                sum += lround(512.0 + (TONE_AMP * sin((2.0 * M_PI * freq * n / SCAN_HZ) + 0.7)));
+            }
+            in = (uint16_t)(sum / SCAN_PER_CYCLE);
+        } else {
+            in = (uint16_t)lround(512.0 + (TONE_AMP * sin((2.0 * M_PI * freq * cycle / CYCLE_HZ) + 0.7)));
+        }
+        GFILT_BankProcess(&bank, &in, &out);
+        if (cycle >= SETTLE_CYCLES) {
+            min = (out < min) ? out : min;
+            max = (out > max) ? out : max;
+        }
+    }
+    return (max - min) / 2.0;
+}
+
+/**
+ * @brief Gain statique : une entre constante est restitue exactement.
+ */
+static void TestDcGain(void)
+{
+    static const uint16_t levels[] = { 0, 1, 511, 512, 1023, 4095, 8191 };
+    S_filterBank bank;
+    uint16_t in;
+    int32_t out = 0;
+    unsigned l;
+    int type;
+    int n;
+
+    for (type = 0; type < GFILT_TYPE_NB; type++) {
+        for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+        {
+            // Dpart de l'autre extrmit : le gain est vrifi aprs transitoire
+            FilterSetup(&bank, (E_filterType)type, (type == GFILT_TYPE_EMA) ? GFILT_EMA_SHIFT : 10,
+                        (levels[l] > 4095) ? 0 : 8191);
+            in = levels[l];
+            for (n = 0; n < 400; n++) {
+                GFILT_BankProcess(&bank, &in, &out);
+            }
+            CHECK_EQ(out, levels[l]);
+        }
+    }
+}
+
+/**
+ * @brief Rponse indicielle 0 -> 1000 du biquad (Butterworth : dpassement 4.3 %).
+ */
+static void TestStep(void)
+{
+    S_filterBank bank;
+    uint16_t in = 1000;
+    int32_t out = 0;
+    int32_t peak = 0;
+    int settled = 0;
+    int n;
+
+    FilterSetup(&bank, GFILT_TYPE_BIQUAD, 0, 0);
+    for (n = 0; n < 200; n++)
+    {
+        GFILT_BankProcess(&bank, &in, &out);
+        peak = (out > peak) ? out : peak;
+        if ((out < 999) || (out > 1001)) {
+            settled = n + 1;
+        }
+        CHECK(out >= 0);
+    }
+    CHECK_EQ(out, 1000);
+    CHECK(peak <= 1050);          // Dpassement <= 5 %
+    CHECK(peak >= 1030);          // ... mais bien celui d'un second ordre Q = 0.707
+    CHECK(settled <= 35);         // +/- 1 pas en 0.7 s (fc = 2.5 Hz)
+
+    // EMA k = 3 : sans dpassement, +/- 1 pas en moins d'une seconde
+    FilterSetup(&bank, GFILT_TYPE_EMA, 3, 0);
+    settled = 0;
+    for (n = 0; n < 200; n++)
+    {
+        GFILT_BankProcess(&bank, &in, &out);
+        CHECK(out <= 1000);
+        if (out < 999) {
+            settled = n + 1;
+        }
+    }
+    CHECK(settled <= CYCLE_HZ);
+}
+
+/**
+ * @brief Rjection du secteur (50 Hz) et de la frquence de Nyquist de
+ *        l'acquisition (1250 Hz) par la chane complte, puis des frquences
+ *        des lobes secondaires de la moyenne glissante  la cadence du filtre.
+ */
+static void TestAttenuation(void)
+{
+    static const double chainFreqs[] = { 50.0, 50.5, 1250.0, 1237.0 };
+    static const double cycleFreqs[] = { 7.5, 12.5, 20.0 };
+    double box;
+    double biq;
+    unsigned i;
+
+    // Chane complte : la moyenne par cycle limine les multiples de 50 Hz,
+    // le filtre ne doit pas dgrader ce rsultat
+    for (i = 0; i < sizeof(chainFreqs) / sizeof(chainFreqs[0]); i++)
+    {
+        box = Ripple(GFILT_TYPE_BOXCAR, 10, chainFreqs[i], 1);
+        biq = Ripple(GFILT_TYPE_BIQUAD, 0, chainFreqs[i], 1);
+        printf("chaine %7.1f Hz : boxcar %.2f, biquad %.2f pas (entree %.0f)\n",
+               chainFreqs[i], box, biq, TONE_AMP);
+        CHECK(biq <= 2.0);        // > 40 dB
+        CHECK(biq <= box + 0.5);  // Au moins aussi bon que la moyenne glissante ( l'arrondi prs)
+    }
+
+    // Cadence du filtre : lobes secondaires de la moyenne glissante sur 10 cycles
+    for (i = 0; i < sizeof(cycleFreqs) / sizeof(cycleFreqs[0]); i++)
+    {
+        box = Ripple(GFILT_TYPE_BOXCAR, 10, cycleFreqs[i], 0);
+        biq = Ripple(GFILT_TYPE_BIQUAD, 0, cycleFreqs[i], 0);
+        printf("cycle  %7.1f Hz : boxcar %.2f, biquad %.2f pas (entree %.0f)\n",
+               cycleFreqs[i], box, biq, TONE_AMP);
+        CHECK(biq <= (TONE_AMP / 10.0));    // >= 20 dB ds 3 fc
+        if (box > 1.0) {
+            CHECK(biq < (box / 2.0));       // Lobes secondaires : biquad >= 6 dB meilleur
+        }
+    }
+}
+
+int main(void)
+{
+    TestDcGain();
+    TestStep();
+    TestAttenuation();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,299 @@
+/*--------------------------------------------------------*/
+// Test_link.cpp
+/*--------------------------------------------------------*/
+//	Description :	Tests de la bibliothque tp2link sur un pty : un
+//			        rpondeur sur le matre joue la carte (rponses en
+//			        cho), le client est sur l'esclave
+//
+/*--------------------------------------------------------*/
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tp2link.hpp"
+#include "check.h"
+
+using namespace tp2link;
+using namespace std::chrono_literals;
+
+namespace {
+
+/**
+ * @brief Carte factice sur le matre du pty.
+ *
+ * @details Rpond [0, donnes de la requte...]  chaque commande, aprs
+ *          un dlai ; PING reoit [0, Seq, 16 octets]. Les commandes
+ *          listes dans Drop restent sans rponse. En multipoint, une
+ *          consigne adresse reoit la trame d'tat en cho.
+ */
+class Responder {
+public:
+    Responder(EventLoop &loop, int master, bool multidrop)
+        : loop_(loop), transport_(loop, master), multidrop_(multidrop)
+    {
+        HFRAME_Init(&scanner_, multidrop ? 1 : 0);
+        transport_.onReceive([this](const uint8_t *data, size_t len) {
+            S_hframe frame;
+            for (size_t i = 0; i < len; i++) {
+                int type = HFRAME_Feed(&scanner_, data[i], &frame);
+                if (type == HFRAME_COMMAND) {
+                    onCommand(frame);
+                } else if ((type == HFRAME_SETPOINT) && multidrop_ &&
+                           (frame.Addr != RS232_ADDR_BROADCAST)) {
+                    onPoll(frame);
+                }
+            }
+        });
+    }
+
+    uint8_t Drop = 0;               // Code de commande ignor (0 = aucun)
+    int Received = 0;
+    int Overlaps = 0;               // Requtes reues pendant une rponse en attente
+    int MaxPending = 0;
+
+private:
+    void onReceived()
+    {
+        Received++;
+        if (pending_ > 0) {
+            Overlaps++;
+        }
+    }
+
+    void startReply()
+    {
+        pending_++;
+        if (pending_ > MaxPending) {
+            MaxPending = pending_;
+        }
+    }
+
+    void onPoll(const S_hframe &frame)
+    {
+        onReceived();
+        startReply();
+        loop_.addTimer(1ms, [this, frame] {
+            uint8_t out[HFRAME_MAX_SIZE];
+            uint8_t size = HFRAME_EncodeSetpoint(out, 1, frame.Addr, frame.Speed, frame.Angle);
+            pending_--;
+            transport_.send(out, size);
+        });
+    }
+
+    void onCommand(const S_hframe &frame)
+    {
+        onReceived();
+        if (frame.Cmd == Drop) {
+            return;
+        }
+        startReply();
+        loop_.addTimer(1ms, [this, frame] {
+            uint8_t data[CMD_PAYLOAD_MAX] = { 0 };
+            uint8_t out[HFRAME_MAX_SIZE];
+            uint8_t len = (uint8_t)(frame.Len + 1);
+            if (frame.Cmd == CMD_PING) {
+                len = 18;
+                data[1] = frame.Data[0];
+            } else {
+                std::memcpy(&data[1], frame.Data, frame.Len);
+            }
+            uint8_t size = HFRAME_EncodeCommand(out, multidrop_, frame.Addr,
+                                                frame.Cmd | CMD_RESPONSE_FLAG, data, len);
+            pending_--;
+            transport_.send(out, size);
+        });
+    }
+
+    EventLoop &loop_;
+    SerialTransport transport_;
+    bool multidrop_;
+    S_hframeScanner scanner_;
+    int pending_ = 0;
+};
+
+/**
+ * @brief Paire pty : matre (rpondeur) et chemin de l'esclave (client).
+ */
+int openPty(std::string &slave)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+        return -1;
+    }
+    slave = ptsname(master);
+    return master;
+}
+
+void testCallbacks()
+{
+    EventLoop loop;
+    std::string slave;
+    int master = openPty(slave);
+    CHECK(master >= 0);
+    Port port(loop, std::make_unique<SerialTransport>(loop, slave, 57600, false));
+    Responder responder(loop, master, false);
+    Device &dev = port.device();
+
+    // Rponse par callback, donnes en cho
+    bool done = false;
+    dev.command(CMD_PARAM_READ, { 7 }, [&](std::error_code ec, const Response &resp) {
+        CHECK(!ec);
+        CHECK_EQ(resp.Cmd, CMD_PARAM_READ);
+        CHECK_EQ(resp.Data.size(), 2);
+        CHECK_EQ(resp.Data[1], 7);
+        done = true;
+    });
+    CHECK(loop.runUntil([&] { return done; }, 1s));
+
+    // Pings : un seul en vol (la carte n'en garde qu'un), tous associs par Seq
+    int ok = 0;
+    for (int i = 0; i < 20; i++) {
+        dev.ping((uint8_t)i, [&, i](std::error_code ec, const PingResult &r) {
+            CHECK(!ec);
+            CHECK_EQ(r.Seq, i);
+            ok++;
+        });
+    }
+    CHECK(loop.runUntil([&] { return ok == 20; }, 2s));
+    CHECK_EQ(responder.MaxPending, 1);
+
+    // Fentre : codes distincts en vol ensemble, au plus Window
+    const uint8_t mix[] = { CMD_PING, CMD_GET_LINK_STATS, CMD_GET_FLOW_STATS,
+                            CMD_PLAYOUT_STATUS, CMD_GET_SYNC_STATS, CMD_DIAG };
+    ok = 0;
+    for (int round = 0; round < 5; round++) {
+        for (uint8_t cmd : mix) {
+            dev.command(cmd, { (uint8_t)round }, [&](std::error_code ec, const Response &) {
+                CHECK(!ec);
+                ok++;
+            });
+        }
+    }
+    CHECK(loop.runUntil([&] { return ok == 30; }, 2s));
+    CHECK(responder.MaxPending <= (int)port.options().Window);
+    CHECK(responder.MaxPending > 1);
+
+    // Une seule requte en vol par code : les deux lectures se suivent
+    int reads = 0;
+    dev.paramRead(1, [&](std::error_code ec, uint8_t status, int16_t) {
+        CHECK(!ec);
+        CHECK_EQ(status, 0);
+        reads++;
+    });
+    dev.paramRead(2, [&](std::error_code ec, uint8_t, int16_t) {
+        CHECK(!ec);
+        reads++;
+    });
+    CHECK(loop.runUntil([&] { return reads == 2; }, 1s));
+
+    // Dlai dpass
+    responder.Drop = CMD_DIAG;
+    std::error_code err;
+    dev.command(CMD_DIAG, {}, [&](std::error_code ec, const Response &) { err = ec; }, 50ms);
+    CHECK(loop.runUntil([&] { return bool(err); }, 1s));
+    CHECK(err == Errc::Timeout);
+    CHECK_EQ(port.stats().Timeouts, 1);
+
+    // Consigne : part sans attendre, aucune rponse
+    dev.setpoint(10, -20);
+    loop.runUntil([] { return false; }, 20ms);
+    CHECK_EQ(port.pending(), 0);
+    CHECK_EQ(port.scanner().BadCrc, 0);
+}
+
+void testFuture()
+{
+    EventLoop loop;
+    std::string slave;
+    int master = openPty(slave);
+    Port port(loop, std::make_unique<SerialTransport>(loop, slave, 57600, false));
+    Responder responder(loop, master, false);
+    responder.Drop = CMD_STATS_RESET;
+    std::thread thread([&] { loop.run(); });
+
+    std::future<Response> f = port.device().request(CMD_GET_LINK_STATS, {});
+    CHECK(f.wait_for(1s) == std::future_status::ready);
+    CHECK_EQ(f.get().Cmd, CMD_GET_LINK_STATS);
+
+    std::future<Response> lost = port.device().request(CMD_STATS_RESET, {}, 30ms);
+    try {
+        lost.get();
+        CHECK(0);
+    } catch (const std::system_error &e) {
+        CHECK(e.code() == Errc::Timeout);
+    }
+
+    loop.stop();
+    thread.join();
+}
+
+void testMultidrop()
+{
+    EventLoop loop;
+    std::string slave;
+    int master = openPty(slave);
+    PortOptions options;
+    options.Multidrop = true;
+    Port port(loop, std::make_unique<SerialTransport>(loop, slave, 57600, false), options);
+    Responder responder(loop, master, true);
+    int ok = 0;
+    int states = 0;
+
+    // Trois cartes, requtes et interrogations mles : une seule en vol  la fois
+    for (uint8_t addr = 1; addr <= 3; addr++) {
+        port.device(addr).onSetpoint([&, addr](int8_t speed, int8_t) {
+            CHECK_EQ(speed, addr);
+            states++;
+        });
+    }
+    for (int i = 0; i < 30; i++) {
+        uint8_t addr = (uint8_t)(1 + i % 3);
+        port.device(addr).command(CMD_PARAM_READ, { addr }, [&, addr](std::error_code ec,
+                                                                        const Response &resp) {
+            CHECK(!ec);
+            CHECK_EQ(resp.Addr, addr);
+            CHECK_EQ(resp.Data.at(1), addr);
+            ok++;
+        });
+        port.device(addr).setpoint((int8_t)addr, 1);
+    }
+    CHECK(loop.runUntil([&] { return (ok == 30) && (states == 30); }, 2s));
+    CHECK_EQ(responder.Received, 60);
+    CHECK_EQ(responder.Overlaps, 0);
+    CHECK_EQ(responder.MaxPending, 1);
+
+    // Diffusion : pas de rponse attendue
+    port.device(RS232_ADDR_BROADCAST).command(CMD_STATS_RESET, {}, nullptr);
+    port.device(RS232_ADDR_BROADCAST).setpoint(0, 0);
+    CHECK_EQ(port.pending(), 0);
+    CHECK_EQ(port.stats().Timeouts, 0);
+}
+
+void testClosed()
+{
+    EventLoop loop;
+    std::string slave;
+    int master = openPty(slave);
+    Port port(loop, std::make_unique<SerialTransport>(loop, slave, 57600, false));
+    std::error_code err;
+
+    port.device().command(CMD_PING, { 1 }, [&](std::error_code ec, const Response &) { err = ec; });
+    close(master);
+    CHECK(loop.runUntil([&] { return bool(err); }, 1s));
+    CHECK(err == Errc::Closed);
+}
+
+} // namespace
+
+int main()
+{
+    testCallbacks();
+    testFuture();
+    testMultidrop();
+    testClosed();
+    return CHECK_RESULT();
+}
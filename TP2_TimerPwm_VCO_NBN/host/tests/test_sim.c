@@ -0,0 +1,189 @@
+/*--------------------------------------------------------*/
+// Test_sim.c
+/*--------------------------------------------------------*/
+//	Description :	Test de bout en bout du firmware sur l'appareil
+//			        simul : dmarrage, consignes locales mises,
+//			        passage en mode remote, commandes PARAM_READ,
+//			        PARAM_WRITE et PING
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+#include "simDevice.h"
+#include "hostFrame.h"
+#include "gestParam.h"
+#include "gestPWM.h"
+#include "check.h"
+
+#define SETPOINT_PERIOD     (20 * SIM_NS_PER_MS)  // Priode d'envoi des consignes (cycle du Timer 1)
+#define COMM_TIMEOUT_NS     (300 * SIM_NS_PER_MS) // > COMM_TIMEOUT_ITERATION cycles sans consigne
+
+// Ligne 1 de l'afficheur, complte (SIM_LCD_COLUMNS colonnes)
+#define LCD_TITLE_LOCAL     "Local Settings      "
+#define LCD_TITLE_REMOTE    "Remote Settings     "
+
+static S_hframeScanner scanner;
+
+/**
+ * @brief Lit les trames mises par la carte jusqu' une trame du type voulu.
+ * @param type    HFRAME_SETPOINT ou HFRAME_COMMAND.
+ * @param cmd     Code attendu (HFRAME_COMMAND), les autres trames sont ignores.
+ * @param timeout Dure virtuelle maximale [ns].
+ * @return 1 si la trame est reue.
+ */
+static int WaitFrame(int type, uint8_t cmd, uint64_t timeout, S_hframe *pFrame)
+{
+    uint64_t end = SIM_Now() + timeout;
+    uint8_t buf[64];
+    size_t n;
+    size_t i;
+    int got;
+
+    while (SIM_Now() < end) {
+        SIM_RunFor(SIM_NS_PER_MS);
+        n = SIM_UartRead(buf, sizeof(buf));
+        for (i = 0; i < n; i++) {
+            got = HFRAME_Feed(&scanner, buf[i], pFrame);
+            if ((got == type) && ((type == HFRAME_SETPOINT) || (pFrame->Cmd == cmd))) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void SendSetpoint(int8_t speed, int8_t angle)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size = HFRAME_EncodeSetpoint(frame, 0, 0, speed, angle);
+
+    SIM_UartWrite(frame, size);
+}
+
+static void SendCommand(uint8_t cmd, const uint8_t *pPayload, uint8_t len)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size = HFRAME_EncodeCommand(frame, 0, 0, cmd, pPayload, len);
+
+    SIM_UartWrite(frame, size);
+}
+
+static void TestBootLocal(void)
+{
+    S_hframe frame;
+    S_simStats stats;
+
+    // Vitesse presque maximale, angle au milieu
+    SIM_SetAdc(0, 1015, 2);
+    SIM_SetAdc(1, 512, 2);
+
+    // Pas de trame pendant les 3 s d'introduction
+    SIM_RunFor(2900 * SIM_NS_PER_MS);
+    CHECK(strncmp(SIM_GetLcdLine(1), "Local Setting", 13) == 0);
+    CHECK(!WaitFrame(HFRAME_SETPOINT, 0, 50 * SIM_NS_PER_MS, &frame));
+
+    // Puis des consignes locales
+    CHECK(WaitFrame(HFRAME_SETPOINT, 0, 500 * SIM_NS_PER_MS, &frame));
+    CHECK((frame.Speed >= 94) && (frame.Speed <= 99));
+    CHECK((frame.Angle >= -3) && (frame.Angle <= 3));
+    CHECK(strcmp(SIM_GetLcdLine(1), LCD_TITLE_LOCAL) == 0);
+    CHECK_EQ(SIM_GetHBridge(), 1);
+
+    SIM_GetStats(&stats);
+    CHECK(stats.Interrupts > 0);
+    CHECK_EQ(stats.RxOverruns, 0);
+}
+
+static void TestRemote(void)
+{
+    uint16_t oc3;
+    int i;
+
+    for (i = 0; i < 20; i++) {
+        SendSetpoint(50, 0);
+        SIM_RunFor(SETPOINT_PERIOD);
+    }
+    CHECK(strcmp(SIM_GetLcdLine(1), LCD_TITLE_REMOTE) == 0);
+    CHECK_EQ(SIM_GetOcPulse(2), (50u * PWM_OC2_RECIP) >> 16);
+    CHECK_EQ(SIM_GetHBridge(), 1);
+    // Angle 0 => milieu de la plage OC3
+    oc3 = SIM_GetOcPulse(3);
+    CHECK((oc3 >= ((PWM_OC3_MIN + PWM_OC3_MAX) / 2) - 1) && (oc3 <= ((PWM_OC3_MIN + PWM_OC3_MAX) / 2) + 1));
+
+    for (i = 0; i < 20; i++) {
+        SendSetpoint(-30, 45);
+        SIM_RunFor(SETPOINT_PERIOD);
+    }
+    CHECK_EQ(SIM_GetHBridge(), -1);
+    CHECK_EQ(SIM_GetOcPulse(2), (30u * PWM_OC2_RECIP) >> 16);
+}
+
+/**
+ * @brief Retour en local sans consigne : le titre rcrit sur "Remote Settings"
+ *        ne doit pas laisser de caractre de l'ancien titre.
+ */
+static void TestBackToLocal(void)
+{
+    SIM_RunFor(COMM_TIMEOUT_NS);
+    CHECK(strcmp(SIM_GetLcdLine(1), LCD_TITLE_LOCAL) == 0);
+}
+
+static void TestCommands(void)
+{
+    S_hframe frame;
+    uint8_t payload[3];
+    uint32_t t[4];
+    int i;
+
+    payload[0] = PARAM_ID_NODE_ADDRESS;
+    SendCommand(CMD_PARAM_READ, payload, 1);
+    CHECK(WaitFrame(HFRAME_COMMAND, CMD_PARAM_READ | CMD_RESPONSE_FLAG, 200 * SIM_NS_PER_MS, &frame));
+    CHECK_EQ(frame.Len, 4);
+    CHECK_EQ(frame.Data[0], PARAM_OK);
+    CHECK_EQ(frame.Data[1], PARAM_ID_NODE_ADDRESS);
+    CHECK_EQ((frame.Data[2] << 8) | frame.Data[3], RS232_NODE_ADDRESS);
+
+    // Mdiane : 4 points refus, la valeur reste inchange ; 3 points accept
+    payload[0] = PARAM_ID_ADC_MEDIAN;
+    payload[1] = 0;
+    payload[2] = 4;
+    SendCommand(CMD_PARAM_WRITE, payload, 3);
+    CHECK(WaitFrame(HFRAME_COMMAND, CMD_PARAM_WRITE | CMD_RESPONSE_FLAG, 200 * SIM_NS_PER_MS, &frame));
+    CHECK_EQ(frame.Data[0], PARAM_ERR_RANGE);
+    CHECK_EQ((frame.Data[2] << 8) | frame.Data[3], 0);
+    payload[2] = 3;
+    SendCommand(CMD_PARAM_WRITE, payload, 3);
+    CHECK(WaitFrame(HFRAME_COMMAND, CMD_PARAM_WRITE | CMD_RESPONSE_FLAG, 200 * SIM_NS_PER_MS, &frame));
+    CHECK_EQ(frame.Data[0], PARAM_OK);
+    CHECK_EQ((frame.Data[2] << 8) | frame.Data[3], 3);
+
+    payload[0] = 0x5A;
+    SendCommand(CMD_PING, payload, 1);
+    CHECK(WaitFrame(HFRAME_COMMAND, CMD_PING | CMD_RESPONSE_FLAG, 200 * SIM_NS_PER_MS, &frame));
+    CHECK_EQ(frame.Len, 2 + 4 * 4);
+    CHECK_EQ(frame.Data[1], 0x5A);
+    for (i = 0; i < 4; i++) {
+        t[i] = HFRAME_GetU32(&frame.Data[2 + 4 * i]);
+    }
+    // tRx <= tParse <= tApply <= tReply,  l'chelle de la trame (< 20 ms)
+    CHECK((int32_t)(t[1] - t[0]) >= 0);
+    CHECK((int32_t)(t[2] - t[1]) >= 0);
+    CHECK((int32_t)(t[3] - t[2]) >= 0);
+    CHECK(SIM_TicksToNs(t[3] - t[0]) < (40 * SIM_NS_PER_MS));
+
+    CHECK_EQ(scanner.BadCrc, 0);
+}
+
+int main(void)
+{
+    const S_simConfig config = { NULL, 1, 1 };
+
+    HFRAME_Init(&scanner, 0);
+    CHECK_EQ(SIM_Init(&config), 0);
+    TestBootLocal();
+    TestRemote();
+    TestBackToLocal();
+    TestCommands();
+    return CHECK_RESULT();
+}
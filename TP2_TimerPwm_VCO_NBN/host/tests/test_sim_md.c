@@ -0,0 +1,225 @@
+/*--------------------------------------------------------*/
+// Test_sim_md.c
+/*--------------------------------------------------------*/
+//	Description :	Test du firmware multipoint (RS485) sur l'appareil
+//			        simul : filtrage d'adresse, diffusion sans
+//			        rponse, interrogation servie mme lorsque le
+//			        FIFO TX est presque plein, DE relch en fin
+//			        d'mission, tlmtrie refuse, comptage du bruit
+//			        et des trames trangres
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+#include "simDevice.h"
+#include "hostFrame.h"
+#include "gestParam.h"
+#include "gestTelem.h"
+#include "check.h"
+
+#define OTHER_NODE          (RS232_NODE_ADDRESS + 1)
+#define LINK_STATS_READS    2           // Rponses de 51 octets
+#define PARAM_READS         3           // Rponses de 10 octets : FIFO TX presque plein
+#define BURST_PHASES        20          // Dcalages de 1 ms sur un cycle de Timer 1
+#define NOISE_BYTES         16          // Octets hors trame (aucun code de dbut)
+#define STATS_DISCARDED     (1 + 4 * 2) // Position de BytesDiscarded dans la rponse
+#define STATS_ADDR_FILTERED (1 + 4 * 10) // Position de AddrFiltered dans la rponse
+
+static S_hframeScanner scanner;
+
+/**
+ * @brief Trames mises par la carte pendant une dure.
+ */
+typedef struct {
+    int States;             // Trames d'tat (rponse  une interrogation)
+    int Replies;            // Rponses de commande
+    S_hframe LastReply;     // Dernire rponse de commande
+} S_mdRx;
+
+static void Collect(uint64_t duration, S_mdRx *pRx)
+{
+    uint64_t end = SIM_Now() + duration;
+    S_hframe frame;
+    uint8_t buf[64];
+    size_t n;
+    size_t i;
+    int type;
+
+    memset(pRx, 0, sizeof(*pRx));
+    while (SIM_Now() < end) {
+        SIM_RunFor(SIM_NS_PER_MS);
+        n = SIM_UartRead(buf, sizeof(buf));
+        for (i = 0; i < n; i++) {
+            type = HFRAME_Feed(&scanner, buf[i], &frame);
+            CHECK((type == HFRAME_NONE) || (frame.Addr == RS232_NODE_ADDRESS));
+            if (type == HFRAME_SETPOINT) {
+                pRx->States++;
+            } else if (type == HFRAME_COMMAND) {
+                pRx->Replies++;
+                pRx->LastReply = frame;
+            }
+        }
+    }
+}
+
+static void SendSetpoint(uint8_t addr, int8_t speed, int8_t angle)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size = HFRAME_EncodeSetpoint(frame, 1, addr, speed, angle);
+
+    SIM_UartWrite(frame, size);
+}
+
+static void SendCommand(uint8_t addr, uint8_t cmd, const uint8_t *pPayload, uint8_t len)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size = HFRAME_EncodeCommand(frame, 1, addr, cmd, pPayload, len);
+
+    SIM_UartWrite(frame, size);
+}
+
+static void TestAddressing(void)
+{
+    S_mdRx rx;
+    uint8_t id = PARAM_ID_NODE_ADDRESS;
+
+    // Pas d'tat mis sans interrogation
+    Collect(100 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.States, 0);
+
+    // Trames d'un autre noeud et diffusion : pas de rponse
+    SendSetpoint(OTHER_NODE, 20, 0);
+    SendCommand(OTHER_NODE, CMD_PARAM_READ, &id, 1);
+    SendSetpoint(RS232_ADDR_BROADCAST, 20, 0);
+    Collect(100 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.States, 0);
+    CHECK_EQ(rx.Replies, 0);
+
+    // Interrogation : une trame d'tat (consignes locales de la carte)
+    SendSetpoint(RS232_NODE_ADDRESS, 30, 0);
+    Collect(100 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.States, 1);
+}
+
+/**
+ * @brief La tlmtrie mettrait sur le bus sans interrogation : le mode
+ *        reste  l'arrt, l'criture est refuse.
+ */
+static void TestTelemRefused(void)
+{
+    S_mdRx rx;
+    const uint8_t write[3] = { PARAM_ID_TELEM_MODE, 0, GTELEM_MODE_RAW };
+
+    SendCommand(RS232_NODE_ADDRESS, CMD_PARAM_WRITE, write, sizeof(write));
+    Collect(100 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.Replies, 1);
+    CHECK_EQ(rx.LastReply.Data[0], PARAM_ERR_RANGE);
+    CHECK_EQ(rx.LastReply.Data[3], GTELEM_MODE_OFF);
+
+    // Aucune trame de tlmtrie non sollicite
+    Collect(500 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.Replies, 0);
+    CHECK_EQ(rx.States, 0);
+}
+
+static void ReadLinkStats(uint32_t *pDiscarded, uint32_t *pAddrFiltered)
+{
+    S_mdRx rx;
+
+    SendCommand(RS232_NODE_ADDRESS, CMD_GET_LINK_STATS, NULL, 0);
+    Collect(100 * SIM_NS_PER_MS, &rx);
+    CHECK_EQ(rx.Replies, 1);
+    *pDiscarded = HFRAME_GetU32(&rx.LastReply.Data[STATS_DISCARDED]);
+    *pAddrFiltered = HFRAME_GetU32(&rx.LastReply.Data[STATS_ADDR_FILTERED]);
+}
+
+/**
+ * @brief Le bruit hors trame est compt comme octets rejets, seules les
+ *        trames des autres noeuds comptent dans AddrFiltered.
+ */
+static void TestNoiseCount(void)
+{
+    uint8_t noise[NOISE_BYTES];
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t size;
+    uint32_t discarded[2];
+    uint32_t filtered[2];
+
+    ReadLinkStats(&discarded[0], &filtered[0]);
+    memset(noise, 0x55, sizeof(noise));
+    SIM_UartWrite(noise, sizeof(noise));
+    size = HFRAME_EncodeSetpoint(frame, 1, OTHER_NODE, 10, 0);
+    SIM_UartWrite(frame, size);
+    SIM_RunFor(20 * SIM_NS_PER_MS);
+    ReadLinkStats(&discarded[1], &filtered[1]);
+    CHECK_EQ(discarded[1] - discarded[0], NOISE_BYTES);
+    CHECK_EQ(filtered[1] - filtered[0], size);
+}
+
+/**
+ * @brief Interrogation en fin de rafale de commandes  longues rponses.
+ *
+ * @details Lorsque toute la rafale est dcode dans le mme cycle, les
+ *          rponses remplissent le FIFO TX avant SendMessage : la trame
+ *          d'tat doit tre diffre, pas perdue. La rafale est dcale
+ *          de 1 ms  chaque essai pour couvrir la phase du Timer 1 ; si
+ *          la carte commence  rpondre pendant la rafale, la fin de
+ *          celle-ci est perdue (demi-duplex) et l'essai n'est pas compt.
+ */
+static void TestPollTxFull(void)
+{
+    S_mdRx rx;
+    S_simStats stats;
+    uint32_t lost;
+    uint8_t id = PARAM_ID_NODE_ADDRESS;
+    int fullCycles = 0;
+    int phase;
+    int i;
+
+    for (phase = 0; phase < BURST_PHASES; phase++) {
+        SIM_RunFor((uint64_t)phase * SIM_NS_PER_MS);
+        SIM_GetStats(&stats);
+        lost = stats.RxLost;
+        for (i = 0; i < LINK_STATS_READS; i++) {
+            SendCommand(RS232_NODE_ADDRESS, CMD_GET_LINK_STATS, NULL, 0);
+        }
+        for (i = 0; i < PARAM_READS; i++) {
+            SendCommand(RS232_NODE_ADDRESS, CMD_PARAM_READ, &id, 1);
+        }
+        SendSetpoint(RS232_NODE_ADDRESS, (int8_t)phase, 0);
+        Collect(200 * SIM_NS_PER_MS, &rx);
+        // Bus libr aprs la dernire trame
+        CHECK_EQ(SIM_GetRts(), 0);
+
+        SIM_GetStats(&stats);
+        if (stats.RxLost != lost) {
+            continue;
+        }
+        CHECK_EQ(rx.States, 1);
+        // Rponse de commande perdue => le FIFO TX tait plein dans ce cycle
+        if (rx.Replies < (LINK_STATS_READS + PARAM_READS)) {
+            fullCycles++;
+        }
+    }
+    CHECK(fullCycles > 0);
+
+    SIM_GetStats(&stats);
+    CHECK_EQ(stats.TxDeLow, 0);
+    CHECK_EQ(scanner.BadCrc, 0);
+}
+
+int main(void)
+{
+    const S_simConfig config = { NULL, 1, 1 };
+
+    HFRAME_Init(&scanner, 1);
+    CHECK_EQ(SIM_Init(&config), 0);
+    // Fin de l'introduction (3 s)
+    SIM_RunFor(3100 * SIM_NS_PER_MS);
+    TestAddressing();
+    TestTelemRefused();
+    TestNoiseCount();
+    TestPollTxFull();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,421 @@
+/*--------------------------------------------------------*/
+// Test_telem.c
+/*--------------------------------------------------------*/
+//	Description :	Tests hte de la tlmtrie (gestTelem) : aller-retour
+//			        codeur carte / dcodeur hte dans les trois modes,
+//			        taux de compression, trames perdues
+//
+//	SendCommand, GPARAM_Get et GPWM_GetRawAdc sont remplacs par des
+//	bouchons : les trames mises sont mmorises au lieu du FIFO TX.
+//
+/*--------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+#include "gestTelem.h"
+#include "gestParam.h"
+#include "Mc32gest_RS232.h"
+#include "hostTelem.h"
+#include "check.h"
+
+#define MAX_FRAMES      400
+#define MAX_SAMPLES     (MAX_FRAMES * GTELEM_FLUSH_SAMPLES)
+
+/*--------------------------------------------------------*/
+// Bouchons
+/*--------------------------------------------------------*/
+
+typedef struct {
+    uint8_t Cmd;
+    uint8_t Len;
+    uint8_t Data[CMD_PAYLOAD_MAX];
+    uint8_t Dropped;                    // 1 = refuse (FIFO TX plein), jamais mise
+} S_frame;
+
+static S_frame frames[MAX_FRAMES];
+static int nbFrames = 0;
+static int txFull = 0;                  // 1 = SendCommand refuse la prochaine trame
+static int16_t telemMode = GTELEM_MODE_OFF;
+static uint16_t rawAdc[2];
+
+uint8_t SendCommand(uint8_t cmd, const uint8_t *pPayload, uint8_t len)
+{
+    CHECK(len <= CMD_PAYLOAD_MAX);
+    if ((nbFrames >= MAX_FRAMES) || (len > CMD_PAYLOAD_MAX)) {
+        return 1;
+    }
+    // Trame refuse garde pour connatre ses chantillons, mais jamais dcode
+    frames[nbFrames].Cmd = cmd;
+    frames[nbFrames].Len = len;
+    memcpy(frames[nbFrames].Data, pPayload, len);
+    frames[nbFrames].Dropped = (uint8_t)txFull;
+    nbFrames++;
+    if (txFull) {
+        txFull = 0;
+        return 1;
+    }
+    return 0;
+}
+
+int16_t GPARAM_Get(E_paramId id)
+{
+    return (id == PARAM_ID_TELEM_MODE) ? telemMode : 0;
+}
+
+uint16_t GPWM_GetRawAdc(uint8_t chan)
+{
+    return rawAdc[chan];
+}
+
+/*--------------------------------------------------------*/
+// Signaux de test
+/*--------------------------------------------------------*/
+
+static S_telemSample sent[MAX_SAMPLES];
+static S_telemSample received[MAX_SAMPLES];
+
+/**
+ * @brief chantillon n d'un signal de test.
+ *
+ * @param kind 0 = potentiomtres lents avec paliers (cas typique),
+ *             1 = valeurs extrmes et sauts maximaux (pire cas du varint),
+ *             2 = constant (meilleur cas du RLE).
+ */
+static void Signal(int kind, int n, S_telemSample *pS)
+{
+    static const int16_t extremes[] = { 0, -1, 32767, -32768, 1, -32767, 0x3FFF, -0x4000, 0x2000, 127 };
+
+    if (kind == 0) {
+        pS->Value[0] = (int16_t)(((n / 40) % 2) ? 99 - ((n % 40) * 5) : -99 + (n / 3) % 20);
+        pS->Value[1] = (int16_t)((n / 10) % 181 - 90);
+        pS->Value[2] = (int16_t)(512 + ((n / 7) % 5) - 2);
+        pS->Value[3] = (int16_t)((n < 100) ? 1023 : (n * 3) % 1024);
+    } else if (kind == 1) {
+        pS->Value[0] = extremes[n % 10];
+        pS->Value[1] = extremes[(n + 3) % 10];
+        pS->Value[2] = extremes[(n * 7) % 10];
+        pS->Value[3] = (int16_t)(uint16_t)(n * 40503u);
+    } else {
+        pS->Value[0] = 25;
+        pS->Value[1] = -45;
+        pS->Value[2] = 700;
+        pS->Value[3] = 300;
+    }
+}
+
+/**
+ * @brief Prsente un chantillon au codeur de la carte.
+ */
+static void Feed(const S_telemSample *pS)
+{
+    S_pwmSettings settings;
+
+    memset(&settings, 0, sizeof(settings));
+    settings.SpeedSetting = (int8_t)pS->Value[0];
+    settings.AngleSetting = (int8_t)pS->Value[1];
+    rawAdc[0] = (uint16_t)pS->Value[2];
+    rawAdc[1] = (uint16_t)pS->Value[3];
+    GTELEM_Sample(&settings);
+}
+
+/**
+ * @brief Code count chantillons dans un mode, puis arrte la tlmtrie
+ *        (la dernire trame incomplte est mise).
+ *
+ * @return Nombre d'octets de donnes mis.
+ */
+static int Encode(int16_t mode, int kind, int count)
+{
+    int bytes = 0;
+    int n;
+    int f;
+
+    nbFrames = 0;
+    telemMode = mode;
+    for (n = 0; n < count; n++) {
+        Signal(kind, n, &sent[n]);
+        // Les consignes sont des int8_t : seules les valeurs codes sont compares
+        sent[n].Value[0] = (int8_t)sent[n].Value[0];
+        sent[n].Value[1] = (int8_t)sent[n].Value[1];
+        Feed(&sent[n]);
+    }
+    telemMode = GTELEM_MODE_OFF;
+    Feed(&sent[0]);
+
+    for (f = 0; f < nbFrames; f++) {
+        CHECK_EQ(frames[f].Cmd, CMD_TELEMETRY);
+        CHECK(frames[f].Data[2] <= GTELEM_FLUSH_SAMPLES);
+        bytes += frames[f].Len;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Dcode les trames mises, en sautant ventuellement l'une d'elles.
+ *
+ * @param pStream Flux de dcodage.
+ * @param skip    Indice de la trame perdue sur la ligne (-1 = aucune).
+ * @return Nombre d'chantillons dcods (rangs  leur indice d'origine).
+ */
+static int Decode(S_telemStream *pStream, int skip)
+{
+    S_telemSample out[GTELEM_FLUSH_SAMPLES];
+    int offset = 0;
+    int total = 0;
+    int nb;
+    int f;
+
+    for (f = 0; f < nbFrames; f++)
+    {
+        if ((f == skip) || frames[f].Dropped) {
+            offset += frames[f].Data[2];
+            continue;
+        }
+        nb = HTELEM_StreamFrame(pStream, frames[f].Data, frames[f].Len, out, GTELEM_FLUSH_SAMPLES);
+        CHECK_EQ(nb, frames[f].Data[2]);
+        if (nb > 0) {
+            memcpy(&received[offset], out, nb * sizeof(S_telemSample));
+            offset += nb;
+            total += nb;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Compare les chantillons dcods aux chantillons mis.
+ *
+ * @param from, to Plage d'indices [from, to[  comparer.
+ * @return Nombre d'chantillons diffrents.
+ */
+static int Compare(int from, int to)
+{
+    int errors = 0;
+    int n;
+
+    for (n = from; n < to; n++) {
+        if (memcmp(&sent[n], &received[n], sizeof(S_telemSample)) != 0) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/*--------------------------------------------------------*/
+// Tests
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Aller-retour sans perte dans les trois modes et les trois signaux.
+ */
+static void TestRoundTrip(void)
+{
+    static const int16_t modes[] = { GTELEM_MODE_RAW, GTELEM_MODE_DELTA, GTELEM_MODE_RLE };
+    S_telemStream stream;
+    int bytes[3][3];
+    int count = 1000;
+    int kind;
+    int m;
+
+    for (kind = 0; kind < 3; kind++) {
+        for (m = 0; m < 3; m++)
+        {
+            bytes[kind][m] = Encode(modes[m], kind, count);
+            HTELEM_StreamInit(&stream);
+            CHECK_EQ(Decode(&stream, -1), count);
+            CHECK_EQ(Compare(0, count), 0);
+            CHECK_EQ(stream.FramesLost, 0);
+            CHECK_EQ(stream.FramesBad, 0);
+            printf("signal %d, mode %d : %d octets (%.2f par echantillon)\n",
+                   kind, modes[m], bytes[kind][m], (double)bytes[kind][m] / count);
+        }
+    }
+
+    // Brut : 5 chantillons de 8 octets par trame de 48 octets
+    CHECK_EQ(bytes[0][0], (count / 5) * (GTELEM_HEADER_SIZE + (5 * 2 * GTELEM_NB_CHANNELS)));
+    // Signal typique : le delta divise le dbit par ~2 ; sans rptition, le
+    // marqueur et la rserve RLE cotent moins de 30 %
+    CHECK(bytes[0][1] * 10 < bytes[0][0] * 6);
+    CHECK(bytes[0][2] * 10 < bytes[0][1] * 13);
+    // Signal constant : une trame de 25 chantillons tient en 15 octets en RLE
+    CHECK(bytes[2][2] * 10 < bytes[2][1]);
+    CHECK(bytes[2][2] <= (count / GTELEM_FLUSH_SAMPLES) * 15);
+    // Pire cas (sauts maximaux, varints de 3 octets) : au plus 12 octets par chantillon
+    CHECK(bytes[1][1] <= (count * GTELEM_NB_CHANNELS * 3) + (count * GTELEM_HEADER_SIZE / 3));
+}
+
+/**
+ * @brief Trame perdue sur la ligne : dtecte par Seq, les suivantes sont
+ *        dcodes correctement (trames autonomes).
+ */
+static void TestLostFrame(void)
+{
+    static const int16_t modes[] = { GTELEM_MODE_RAW, GTELEM_MODE_DELTA, GTELEM_MODE_RLE };
+    S_telemStream stream;
+    int lostFrom;
+    int lostTo;
+    int f;
+    int m;
+
+    for (m = 0; m < 3; m++)
+    {
+        Encode(modes[m], 0, 500);
+        CHECK(nbFrames > 6);
+        HTELEM_StreamInit(&stream);
+        memset(received, 0, sizeof(received));
+        Decode(&stream, 5);
+
+        lostFrom = 0;
+        for (f = 0; f < 5; f++) {
+            lostFrom += frames[f].Data[2];
+        }
+        lostTo = lostFrom + frames[5].Data[2];
+        CHECK_EQ(stream.FramesLost, 1);
+        CHECK_EQ(stream.Frames, nbFrames - 1);
+        CHECK_EQ(Compare(0, lostFrom), 0);
+        CHECK_EQ(Compare(lostTo, 500), 0);
+    }
+}
+
+/**
+ * @brief Trame refuse par le FIFO TX : compte par la carte, Seq avanc
+ *        (la perte est visible ct hte), aucun chantillon dcal.
+ */
+static void TestTxDrop(void)
+{
+    S_telemStream stream;
+    uint32_t dropped = GTELEM_GetDroppedCount();
+    int lostFrom = 0;
+    int lostTo;
+    int f;
+    int n;
+
+    nbFrames = 0;
+    telemMode = GTELEM_MODE_DELTA;
+    for (n = 0; n < 200; n++)
+    {
+        Signal(0, n, &sent[n]);
+        sent[n].Value[0] = (int8_t)sent[n].Value[0];
+        sent[n].Value[1] = (int8_t)sent[n].Value[1];
+        // La premire trame mise  partir de l'chantillon 60 est refuse
+        if (n == 60) {
+            txFull = 1;
+        }
+        Feed(&sent[n]);
+    }
+    txFull = 0;
+    telemMode = GTELEM_MODE_OFF;
+    Feed(&sent[0]);
+
+    CHECK_EQ(GTELEM_GetDroppedCount() - dropped, 1);
+    for (f = 0; (f < nbFrames) && !frames[f].Dropped; f++) {
+        lostFrom += frames[f].Data[2];
+    }
+    CHECK(f < nbFrames);
+    lostTo = lostFrom + frames[f].Data[2];
+
+    HTELEM_StreamInit(&stream);
+    memset(received, 0, sizeof(received));
+    CHECK_EQ(Decode(&stream, -1), 200 - (lostTo - lostFrom));
+    CHECK_EQ(stream.FramesLost, 1);
+    CHECK_EQ(Compare(0, lostFrom), 0);
+    CHECK_EQ(Compare(lostTo, 200), 0);
+}
+
+/**
+ * @brief Seq sur 8 bits : le passage de 255  0 n'est pas une perte.
+ */
+static void TestSeqWrap(void)
+{
+    S_telemStream stream;
+
+    Encode(GTELEM_MODE_RLE, 2, 300 * GTELEM_FLUSH_SAMPLES);
+    CHECK_EQ(nbFrames, 300);
+    HTELEM_StreamInit(&stream);
+    CHECK_EQ(Decode(&stream, -1), 300 * GTELEM_FLUSH_SAMPLES);
+    CHECK_EQ(stream.FramesLost, 0);
+}
+
+/**
+ * @brief Changement de mode : la trame en cours est mise dans l'ancien mode.
+ */
+static void TestModeSwitch(void)
+{
+    S_telemStream stream;
+    S_telemHeader header;
+    S_telemSample out[GTELEM_FLUSH_SAMPLES];
+    int raw = 0;
+    int rle = 0;
+    int nb;
+    int f;
+    int n;
+
+    nbFrames = 0;
+    for (n = 0; n < 30; n++)
+    {
+        telemMode = (n < 10) ? GTELEM_MODE_RAW : GTELEM_MODE_RLE;
+        Signal(0, n, &sent[n]);
+        sent[n].Value[0] = (int8_t)sent[n].Value[0];
+        sent[n].Value[1] = (int8_t)sent[n].Value[1];
+        Feed(&sent[n]);
+    }
+    telemMode = GTELEM_MODE_OFF;
+    Feed(&sent[0]);
+
+    // Trames brutes (10 chantillons) puis RLE (20 chantillons), sans mlange
+    for (f = 0; f < nbFrames; f++)
+    {
+        nb = HTELEM_DecodeFrame(frames[f].Data, frames[f].Len, &header, out, GTELEM_FLUSH_SAMPLES);
+        CHECK(nb > 0);
+        if (header.Mode == GTELEM_MODE_RAW) {
+            CHECK_EQ(rle, 0);
+            raw += nb;
+        } else {
+            CHECK_EQ(header.Mode, GTELEM_MODE_RLE);
+            rle += nb;
+        }
+    }
+    CHECK_EQ(raw, 10);
+    CHECK_EQ(rle, 20);
+    HTELEM_StreamInit(&stream);
+    CHECK_EQ(Decode(&stream, -1), 30);
+    CHECK_EQ(Compare(0, 30), 0);
+}
+
+/**
+ * @brief Trames incohrentes rejetes par le dcodeur sans dbordement.
+ */
+static void TestMalformed(void)
+{
+    S_telemSample out[GTELEM_FLUSH_SAMPLES];
+    uint8_t frame[CMD_PAYLOAD_MAX];
+    int len;
+
+    Encode(GTELEM_MODE_RLE, 2, GTELEM_FLUSH_SAMPLES);
+    CHECK_EQ(nbFrames, 1);
+    memcpy(frame, frames[0].Data, frames[0].Len);
+    len = frames[0].Len;
+
+    CHECK_EQ(HTELEM_DecodeFrame(frame, 2, NULL, out, GTELEM_FLUSH_SAMPLES), HTELEM_ERR_HEADER);
+    CHECK_EQ(HTELEM_DecodeFrame(frame, (uint8_t)(len - 1), NULL, out, GTELEM_FLUSH_SAMPLES), HTELEM_ERR_TRUNC);
+    CHECK_EQ(HTELEM_DecodeFrame(frame, (uint8_t)len, NULL, out, 10), HTELEM_ERR_SPACE);
+    frame[len] = 0;
+    CHECK_EQ(HTELEM_DecodeFrame(frame, (uint8_t)(len + 1), NULL, out, GTELEM_FLUSH_SAMPLES), HTELEM_ERR_EXTRA);
+    frame[0] = GTELEM_MODE_OFF;
+    CHECK_EQ(HTELEM_DecodeFrame(frame, (uint8_t)len, NULL, out, GTELEM_FLUSH_SAMPLES), HTELEM_ERR_MODE);
+    // Rptition en tte de trame (aucun chantillon de rfrence)
+    frame[0] = GTELEM_MODE_RLE;
+    frame[3] = 5;
+    CHECK_EQ(HTELEM_DecodeFrame(frame, (uint8_t)len, NULL, out, GTELEM_FLUSH_SAMPLES), HTELEM_ERR_TRUNC);
+}
+
+int main(void)
+{
+    TestRoundTrip();
+    TestLostFrame();
+    TestTxDrop();
+    TestSeqWrap();
+    TestModeSwitch();
+    TestMalformed();
+    return CHECK_RESULT();
+}
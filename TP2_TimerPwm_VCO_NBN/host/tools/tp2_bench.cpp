@@ -0,0 +1,323 @@
+/*--------------------------------------------------------*/
+// Tp2_bench.cpp
+/*--------------------------------------------------------*/
+//	Description :	Banc de dbit et de latence de la liaison avec
+//			        tp2link : des requtes sont maintenues en vol sur
+//			        chaque carte depuis un seul thread. La carte ne
+//			        garde qu'un CMD_PING en attente et tp2link une seule
+//			        requte par code : la fentre est remplie en
+//			        alternant des commandes de lecture distinctes.
+//
+//	Cibles :
+//	  --loopback           carte factice en cho sur un pty (cot de la
+//	                       bibliothque et du pty seuls, sans dbit srie)
+//	  --port CHEMIN        port srie ou pty existant (rptable)
+//	  --vdev BIN           lance --devices N cartes tp2_vdev, un pty chacune
+//	  --vdev BIN --multidrop --nodes N
+//	                       lance tp2_vdev_md : N cartes sur un bus
+//
+//	Options : --count N (requtes par carte), --window W (au plus le
+//	          nombre de commandes de kMix), --timeout MS,
+//	          --warmup MS (attente du dmarrage des cartes), --rtscts
+//
+/*--------------------------------------------------------*/
+#include <getopt.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tp2link.hpp"
+#include "histogram.hpp"
+#include "vdevProcess.hpp"
+
+using namespace tp2link;
+using namespace std::chrono;
+
+namespace {
+
+struct Options {
+    bool Loopback = false;
+    std::vector<std::string> Ports;
+    std::string Vdev;
+    int Devices = 1;
+    bool Multidrop = false;
+    int Nodes = 1;
+    int Count = 500;
+    unsigned Window = 4;
+    int TimeoutMs = 250;
+    int WarmupMs = 6000;
+    bool RtsCts = false;
+};
+
+// Commandes de lecture alternes dans la fentre (rponse sans effet de bord)
+const uint8_t kMix[] = { CMD_PING, CMD_GET_LINK_STATS, CMD_GET_FLOW_STATS,
+                         CMD_PLAYOUT_STATUS, CMD_GET_SYNC_STATS, CMD_PARAM_READ };
+constexpr unsigned kMixSize = sizeof(kMix) / sizeof(kMix[0]);
+
+/**
+ * @brief Carte factice : rpond  chaque trame de commande sans dlai.
+ */
+class EchoDevice {
+public:
+    EchoDevice(EventLoop &loop, int master)
+        : transport_(loop, master)
+    {
+        HFRAME_Init(&scanner_, 0);
+        transport_.onReceive([this](const uint8_t *data, size_t len) {
+            S_hframe frame;
+            uint8_t reply[CMD_PAYLOAD_MAX] = { 0 };
+            uint8_t out[HFRAME_MAX_SIZE];
+            for (size_t i = 0; i < len; i++) {
+                if (HFRAME_Feed(&scanner_, data[i], &frame) == HFRAME_COMMAND) {
+                    reply[1] = frame.Data[0];
+                    uint8_t size = HFRAME_EncodeCommand(out, 0, 0, frame.Cmd | CMD_RESPONSE_FLAG,
+                                                        reply, 18);
+                    transport_.send(out, size);
+                }
+            }
+        });
+    }
+
+private:
+    SerialTransport transport_;
+    S_hframeScanner scanner_;
+};
+
+/**
+ * @brief Requtes en vol sur une carte.
+ */
+struct Driver {
+    Device *Dev = nullptr;
+    std::string Name;
+    int Sent = 0;
+    int Ok = 0;
+    int Failed = 0;
+    unsigned InFlight = 0;
+    unsigned Next = 0;      // Prochaine commande de kMix
+    Histogram Rtt;          // [us]
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "usage: tp2_bench [--loopback | --port CHEMIN... | --vdev BIN [--devices N]\n"
+                 "                 [--multidrop --nodes N]] [--count N] [--window W]\n"
+                 "                 [--timeout MS] [--warmup MS] [--rtscts]\n");
+}
+
+bool parse(int argc, char **argv, Options &opt)
+{
+    static const struct option longOpts[] = {
+        { "loopback", no_argument, nullptr, 'l' },
+        { "port", required_argument, nullptr, 'p' },
+        { "vdev", required_argument, nullptr, 'v' },
+        { "devices", required_argument, nullptr, 'd' },
+        { "multidrop", no_argument, nullptr, 'm' },
+        { "nodes", required_argument, nullptr, 'n' },
+        { "count", required_argument, nullptr, 'c' },
+        { "window", required_argument, nullptr, 'w' },
+        { "timeout", required_argument, nullptr, 't' },
+        { "warmup", required_argument, nullptr, 'u' },
+        { "rtscts", no_argument, nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", longOpts, nullptr)) != -1) {
+        switch (c) {
+            case 'l': opt.Loopback = true; break;
+            case 'p': opt.Ports.push_back(optarg); break;
+            case 'v': opt.Vdev = optarg; break;
+            case 'd': opt.Devices = std::atoi(optarg); break;
+            case 'm': opt.Multidrop = true; break;
+            case 'n': opt.Nodes = std::atoi(optarg); break;
+            case 'c': opt.Count = std::atoi(optarg); break;
+            case 'w': opt.Window = (unsigned)std::atoi(optarg); break;
+            case 't': opt.TimeoutMs = std::atoi(optarg); break;
+            case 'u': opt.WarmupMs = std::atoi(optarg); break;
+            case 'r': opt.RtsCts = true; break;
+            default: return false;
+        }
+    }
+    if (!opt.Loopback && opt.Ports.empty() && opt.Vdev.empty()) {
+        opt.Loopback = true;
+    }
+    opt.Window = std::min(opt.Window, kMixSize);
+    return (opt.Count > 0) && (opt.Window > 0) && (opt.Devices > 0) && (opt.Nodes > 0);
+}
+
+/**
+ * @brief Attend que chaque carte rponde (dmarrage de 3 s de la carte).
+ *
+ * @details Un ping reu pendant le dmarrage n'a sa rponse qu' l'entre en
+ *          service : le dlai couvre toute l'attente, un nouvel essai
+ *          entrerait en collision avec cette rponse tardive sur un bus.
+ */
+bool warmup(EventLoop &loop, std::vector<Driver> &drivers, int warmupMs)
+{
+    auto end = EventLoop::Clock::now() + milliseconds(warmupMs);
+
+    for (auto &d : drivers) {
+        bool ready = false;
+        while (!ready && (EventLoop::Clock::now() < end)) {
+            bool done = false;
+            auto left = duration_cast<milliseconds>(end - EventLoop::Clock::now());
+            d.Dev->command(CMD_PING, { 0 }, [&](std::error_code ec, const Response &) {
+                ready = !ec;
+                done = true;
+            }, std::max(left, milliseconds(1)));
+            loop.runUntil([&] { return done; }, seconds(3600));
+        }
+        if (!ready) {
+            std::fprintf(stderr, "tp2_bench: %s ne repond pas\n", d.Name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Complte la fentre de la carte.
+ */
+void refill(Driver &d, const Options &opt)
+{
+    unsigned window = opt.Multidrop ? 1 : opt.Window;
+
+    while ((d.InFlight < window) && (d.Sent < opt.Count)) {
+        uint8_t cmd = kMix[d.Next];
+        std::vector<uint8_t> payload;
+        if (cmd == CMD_PING) {
+            payload.push_back((uint8_t)(1 + d.Sent % 255));    // 0 rserv au dmarrage
+        } else if (cmd == CMD_PARAM_READ) {
+            payload.push_back(PARAM_ID_NODE_ADDRESS);
+        }
+        d.Next = (d.Next + 1) % window;
+        d.Sent++;
+        d.InFlight++;
+        d.Dev->command(cmd, std::move(payload), [&d, &opt](std::error_code ec, const Response &r) {
+            d.InFlight--;
+            if (ec || (r.status() != 0)) {
+                d.Failed++;
+            } else {
+                d.Ok++;
+                d.Rtt.add(duration<double, std::micro>(r.Rtt).count());
+            }
+            refill(d, opt);
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+
+    if (!parse(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    EventLoop loop;
+    std::vector<std::unique_ptr<VdevProcess>> vdevs;
+    std::vector<std::unique_ptr<EchoDevice>> echoes;
+    std::vector<std::unique_ptr<Port>> ports;
+    std::vector<Driver> drivers;
+    PortOptions portOpt;
+    portOpt.Multidrop = opt.Multidrop;
+    portOpt.Window = opt.Window;
+    portOpt.Timeout = milliseconds(opt.TimeoutMs);
+
+    try {
+        std::vector<std::string> paths = opt.Ports;
+        if (opt.Loopback) {
+            int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+            if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+                std::perror("tp2_bench: posix_openpt");
+                return 1;
+            }
+            paths.push_back(ptsname(master));
+            echoes.push_back(std::make_unique<EchoDevice>(loop, master));
+            opt.WarmupMs = 1000;
+        } else if (!opt.Vdev.empty() && opt.Multidrop) {
+            vdevs.push_back(std::make_unique<VdevProcess>(
+                opt.Vdev, std::vector<std::string>{ "--nodes", std::to_string(opt.Nodes) }));
+            paths.push_back(vdevs.back()->path());
+        } else if (!opt.Vdev.empty()) {
+            for (int i = 0; i < opt.Devices; i++) {
+                vdevs.push_back(std::make_unique<VdevProcess>(opt.Vdev));
+                paths.push_back(vdevs.back()->path());
+            }
+        }
+
+        for (const auto &path : paths) {
+            ports.push_back(std::make_unique<Port>(
+                loop, std::make_unique<SerialTransport>(loop, path, 57600, opt.RtsCts), portOpt));
+            int nodes = opt.Multidrop ? opt.Nodes : 1;
+            for (int n = 1; n <= nodes; n++) {
+                Driver d;
+                d.Dev = &ports.back()->device((uint8_t)n);
+                d.Name = path + (opt.Multidrop ? "#" + std::to_string(n) : "");
+                drivers.push_back(std::move(d));
+            }
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "tp2_bench: %s\n", e.what());
+        return 1;
+    }
+
+    if (!warmup(loop, drivers, opt.WarmupMs)) {
+        return 1;
+    }
+
+    std::printf("tp2_bench : %zu carte(s), %zu port(s), fenetre %u, %d requetes par carte\n",
+                drivers.size(), ports.size(), opt.Multidrop ? 1 : opt.Window, opt.Count);
+    uint64_t txStart = 0;
+    uint64_t rxStart = 0;
+    for (const auto &p : ports) {
+        txStart += p->stats().BytesTx;
+        rxStart += p->stats().BytesRx;
+    }
+
+    auto start = EventLoop::Clock::now();
+    for (auto &d : drivers) {
+        refill(d, opt);
+    }
+    loop.runUntil([&] {
+        for (const auto &d : drivers) {
+            if ((d.Ok + d.Failed) < opt.Count) {
+                return false;
+            }
+        }
+        return true;
+    }, seconds(3600));
+    double elapsed = duration<double>(EventLoop::Clock::now() - start).count();
+
+    Histogram all;
+    int ok = 0;
+    int failed = 0;
+    for (auto &d : drivers) {
+        std::printf("%s : %d ok, %d echecs, %.1f req/s\n  RTT %s\n", d.Name.c_str(), d.Ok, d.Failed,
+                    d.Ok / elapsed, d.Rtt.summary("us").c_str());
+        all.merge(d.Rtt);
+        ok += d.Ok;
+        failed += d.Failed;
+    }
+    uint64_t tx = 0;
+    uint64_t rx = 0;
+    for (const auto &p : ports) {
+        tx += p->stats().BytesTx;
+        rx += p->stats().BytesRx;
+    }
+    std::printf("total : %d reponses, %d echecs en %.3f s : %.1f req/s, tx %.0f o/s, rx %.0f o/s\n",
+                ok, failed, elapsed, ok / elapsed, (double)(tx - txStart) / elapsed,
+                (double)(rx - rxStart) / elapsed);
+    all.print(stdout, "RTT", "us");
+    return (ok == 0) ? 1 : 0;
+}
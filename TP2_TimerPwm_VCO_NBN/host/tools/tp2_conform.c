@@ -0,0 +1,516 @@
+/*--------------------------------------------------------*/
+// Tp2_conform.c
+/*--------------------------------------------------------*/
+//	Description :	Conformit et dbit de la liaison RS232
+//			        (Mc32gest_RS232.c) sur l'appareil simul, en
+//			        temps virtuel : base de comparaison pour toute
+//			        optimisation du transport.
+//
+//	Campagnes :
+//	  dbit      CMD_PARAM_READ  cadence croissante, ligne propre
+//	  bruit      taux d'erreur binaire inject sur la ligne RX
+//	             (bits de donnes inverss, bit de start/stop => erreur de trame)
+//	  CTS        CTS bascul par l'hte (crneaux blocage / libre)
+//	  latence    consigne reue -> largeur OC2 modifie
+//
+//	Mesures : dbit utile (transactions abouties et octets de trames
+//	par seconde), perte de trames (requtes sans rponse), temps de
+//	ralignement (CMD_GET_SYNC_STATS), latence des consignes.
+//
+//	Vrifications (code de sortie 1 en cas d'chec) : aucune perte sous
+//	la capacit de la ligne ni sans bruit, aucune rponse corrompue ou
+//	errone, CTS respect  SIM_UART_HW_FIFO octets prs, latence
+//	des consignes infrieure  un cycle de Timer 1.
+//
+//	Usage : tp2_conform [--duration MS] [--seed N]
+//
+/*--------------------------------------------------------*/
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "system_config.h"
+#include "simDevice.h"
+#include "hostFrame.h"
+#include "gestFrame.h"
+#include "gestParam.h"
+#include "Mc32gest_RS232.h"
+
+#define CONF_STEP_NS        (10 * SIM_NS_PER_US)    // Rsolution des mesures
+#define CONF_TIMER1_NS      (20 * SIM_NS_PER_MS)    // Cycle de APP_Tasks
+#define CONF_DRAIN_NS       (200 * SIM_NS_PER_MS)   // Attente des dernires rponses
+#define CONF_CMD_TIMEOUT_NS (500 * SIM_NS_PER_MS)
+#define CONF_LINE_BPS       (SIM_NS_PER_S / SIM_UART_BYTE_NS) // Octets par seconde sur la ligne
+#define CONF_PARAM_ID       PARAM_ID_SEND_DIVIDER   // Paramtre lu par le trafic
+#define CONF_REQ_SIZE       CMD_MESS_SIZE(1)        // CMD_PARAM_READ [Id]
+#define CONF_RESP_SIZE      CMD_MESS_SIZE(4)        // [Etat, Id, ValMsb, ValLsb]
+#define CONF_NOISE_RATE     200                     // Transactions / s des campagnes bruit et CTS
+#define CONF_LATENCY_COUNT  100                     // Consignes de la campagne latence
+#define CONF_SAFE_RATE      400                     // Cadence sous la capacit de la ligne (sans perte)
+#define CONF_OC_MOTOR       2
+
+/**
+ * @brief Trafic de requtes CMD_PARAM_READ et rponses reues.
+ */
+typedef struct {
+    uint32_t Sent;              // Requtes mises
+    uint32_t Replies;           // Rponses correctes
+    uint32_t BadReplies;        // Rponses d'tat ou d'identifiant inattendu
+    uint64_t StartNs;
+    uint64_t LastReplyNs;
+} S_confTraffic;
+
+/**
+ * @brief Crneaux de CTS (blocage puis libre, en ms ; 0 = jamais bloqu).
+ */
+typedef struct {
+    uint32_t HoldMs;
+    uint32_t FreeMs;
+} S_confCts;
+
+static S_hframeScanner scanner;
+static S_confTraffic *pTraffic = NULL;     // Trafic en cours de mesure
+static S_hframe lastReply;                  // Dernire rponse hors trafic
+static uint8_t lastReplyValid = 0;
+static const S_confCts *pCts = NULL;        // Crneaux CTS en cours
+static uint64_t ctsStartNs;
+static uint8_t ctsLevel = 0;                // Niveau de CTS impos  la carte
+static uint32_t ctsBytes;                   // Octets reus depuis l'activation de CTS
+static uint32_t ctsBytesMax;
+static uint32_t noiseState = 1;             // Gnrateur du bruit (xorshift32)
+static int failures = 0;
+
+#define CONF_EXPECT(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            printf("  echec : "); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+/*--------------------------------------------------------*/
+// Ligne et appareil
+/*--------------------------------------------------------*/
+
+static double CONF_Random(void)
+{
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return (double)noiseState / 4294967296.0;
+}
+
+/**
+ * @brief Dpose une trame sur la ligne RX avec un taux d'erreur binaire.
+ *
+ * @details 10 bits par octet : une erreur sur un bit de donnes l'inverse,
+ *          une erreur sur le bit de start ou de stop lve une erreur de trame.
+ */
+static void CONF_PushNoisy(const uint8_t *pFrame, uint8_t size, double ber)
+{
+    uint8_t byte;
+    uint8_t errors;
+    uint8_t i;
+    uint8_t bit;
+
+    for (i = 0; i < size; i++) {
+        byte = pFrame[i];
+        errors = 0;
+        if (ber > 0.0) {
+            for (bit = 0; bit < 10; bit++) {
+                if (CONF_Random() < ber) {
+                    if ((bit >= 1) && (bit <= 8)) {
+                        byte ^= (uint8_t)(1u << (bit - 1));
+                    } else {
+                        errors |= SIM_UART_ERR_FRAMING;
+                    }
+                }
+            }
+        }
+        SIM_UartPushByte(byte, errors);
+    }
+}
+
+/**
+ * @brief Lit les octets mis par la carte et classe les trames.
+ */
+static void CONF_Poll(void)
+{
+    uint8_t buf[64];
+    S_hframe frame;
+    size_t n;
+    size_t i;
+
+    while ((n = SIM_UartRead(buf, sizeof(buf))) > 0) {
+        // Octets mis pendant le pas prcdent, au niveau de CTS d'alors
+        if (ctsLevel) {
+            ctsBytes += (uint32_t)n;
+            if (ctsBytes > ctsBytesMax) {
+                ctsBytesMax = ctsBytes;
+            }
+        }
+        for (i = 0; i < n; i++) {
+            if (HFRAME_Feed(&scanner, buf[i], &frame) != HFRAME_COMMAND) {
+                continue;
+            }
+            if ((frame.Cmd == (CMD_PARAM_READ | CMD_RESPONSE_FLAG)) && (pTraffic != NULL)) {
+                if ((frame.Len == 4) && (frame.Data[0] == PARAM_OK) &&
+                    (frame.Data[1] == CONF_PARAM_ID)) {
+                    pTraffic->Replies++;
+                    pTraffic->LastReplyNs = SIM_Now();
+                } else {
+                    pTraffic->BadReplies++;
+                }
+            } else {
+                lastReply = frame;
+                lastReplyValid = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Met  jour CTS selon les crneaux en cours.
+ */
+static void CONF_UpdateCts(void)
+{
+    uint64_t period;
+    uint8_t hold;
+
+    if ((pCts == NULL) || (pCts->HoldMs == 0)) {
+        hold = 0;
+    } else {
+        period = (uint64_t)(pCts->HoldMs + pCts->FreeMs) * SIM_NS_PER_MS;
+        hold = ((SIM_Now() - ctsStartNs) % period) < ((uint64_t)pCts->HoldMs * SIM_NS_PER_MS);
+    }
+    if (hold && !ctsLevel) {
+        ctsBytes = 0;
+    }
+    ctsLevel = hold;
+    SIM_SetCts(hold);
+}
+
+/**
+ * @brief Excute l'appareil jusqu' un instant en lisant ses missions.
+ */
+static void CONF_RunUntil(uint64_t untilNs)
+{
+    uint64_t next;
+
+    while (SIM_Now() < untilNs) {
+        next = SIM_Now() + CONF_STEP_NS;
+        SIM_RunUntil((next < untilNs) ? next : untilNs);
+        CONF_Poll();
+        CONF_UpdateCts();
+    }
+}
+
+/**
+ * @brief Commande hors trafic sur ligne propre, attente de la rponse.
+ * @return Nombre d'octets de rponse, -1 sans rponse.
+ */
+static int CONF_Command(uint8_t cmd, const uint8_t *pPayload, uint8_t len, S_hframe *pReply)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint64_t end = SIM_Now() + CONF_CMD_TIMEOUT_NS;
+
+    lastReplyValid = 0;
+    SIM_UartWrite(frame, HFRAME_EncodeCommand(frame, 0, RS232_NODE_ADDRESS, cmd, pPayload, len));
+    while (SIM_Now() < end) {
+        CONF_RunUntil(SIM_Now() + SIM_NS_PER_MS);
+        if (lastReplyValid && (lastReply.Cmd == (cmd | CMD_RESPONSE_FLAG))) {
+            *pReply = lastReply;
+            return lastReply.Len;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Compteur 32 bits d'une rponse de statistiques (0 si absente).
+ */
+static uint32_t CONF_Stat(uint8_t cmd, uint8_t offset)
+{
+    S_hframe reply;
+
+    if (CONF_Command(cmd, NULL, 0, &reply) < (offset + 4)) {
+        CONF_EXPECT(0, "pas de reponse a la commande 0x%02X", cmd);
+        return 0;
+    }
+    return HFRAME_GetU32(&reply.Data[offset]);
+}
+
+static void CONF_ResetStats(void)
+{
+    S_hframe reply;
+
+    CONF_EXPECT(CONF_Command(CMD_STATS_RESET, NULL, 0, &reply) >= 1, "CMD_STATS_RESET sans reponse");
+    scanner.BadCrc = 0;
+    scanner.Skipped = 0;
+}
+
+/*--------------------------------------------------------*/
+// Trafic
+/*--------------------------------------------------------*/
+
+/**
+ * @brief Requtes CMD_PARAM_READ  cadence fixe, puis attente des rponses.
+ */
+static void CONF_RunTraffic(S_confTraffic *pT, uint32_t rate, uint64_t durationNs, double ber)
+{
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t id = CONF_PARAM_ID;
+    uint8_t size = HFRAME_EncodeCommand(frame, 0, RS232_NODE_ADDRESS, CMD_PARAM_READ, &id, 1);
+    uint64_t periodNs = SIM_NS_PER_S / rate;
+    uint64_t sendNs;
+
+    memset(pT, 0, sizeof(*pT));
+    pT->StartNs = SIM_Now();
+    pTraffic = pT;
+    for (sendNs = pT->StartNs; sendNs < (pT->StartNs + durationNs); sendNs += periodNs) {
+        CONF_RunUntil(sendNs);
+        CONF_PushNoisy(frame, size, ber);
+        pT->Sent++;
+    }
+    // Ligne vide (contrle de flux), puis dernires rponses
+    while (SIM_UartPending() > 0) {
+        CONF_RunUntil(SIM_Now() + SIM_NS_PER_MS);
+    }
+    CONF_RunUntil(SIM_Now() + CONF_DRAIN_NS);
+    pTraffic = NULL;
+    pCts = NULL;
+    CONF_UpdateCts();
+}
+
+/**
+ * @brief Dure de la mesure : du premier envoi  la dernire rponse.
+ */
+static double CONF_Elapsed(const S_confTraffic *pT, uint64_t durationNs)
+{
+    uint64_t end = (pT->LastReplyNs > pT->StartNs) ? pT->LastReplyNs : (pT->StartNs + durationNs);
+
+    return (double)(end - pT->StartNs) / (double)SIM_NS_PER_S;
+}
+
+static double CONF_LossPercent(const S_confTraffic *pT)
+{
+    return (pT->Sent == 0) ? 0.0 : 100.0 * (double)(pT->Sent - pT->Replies) / (double)pT->Sent;
+}
+
+/*--------------------------------------------------------*/
+// Campagnes
+/*--------------------------------------------------------*/
+
+static void CONF_RateSweep(uint64_t durationNs)
+{
+    static const uint32_t rates[] = { 50, 100, 200, 400, 600, 800, 1200 };
+    S_confTraffic t;
+    double elapsed;
+    double goodput;
+    uint32_t rts;
+    uint8_t i;
+
+    printf("\nDebit (ligne propre, %.1f s par point, %u o/s par sens ; TX carte : reponses)\n",
+           (double)durationNs / SIM_NS_PER_S, (unsigned)CONF_LINE_BPS);
+    printf("  offert/s  utiles/s   octets/s  TX carte %%  perte %%   RTS\n");
+    for (i = 0; i < (sizeof(rates) / sizeof(rates[0])); i++) {
+        CONF_ResetStats();
+        CONF_RunTraffic(&t, rates[i], durationNs, 0.0);
+        rts = CONF_Stat(CMD_GET_FLOW_STATS, 1);
+        elapsed = CONF_Elapsed(&t, durationNs);
+        goodput = (double)t.Replies / elapsed;
+        printf("  %8u  %8.1f  %9.0f  %10.1f  %7.2f  %4u\n", (unsigned)rates[i], goodput,
+               goodput * (CONF_REQ_SIZE + CONF_RESP_SIZE),
+               100.0 * goodput * CONF_RESP_SIZE / CONF_LINE_BPS, CONF_LossPercent(&t),
+               (unsigned)rts);
+        CONF_EXPECT(t.BadReplies == 0, "%u reponses erronees", (unsigned)t.BadReplies);
+        CONF_EXPECT(scanner.BadCrc == 0, "%u reponses au CRC faux", (unsigned)scanner.BadCrc);
+        if (rates[i] <= CONF_SAFE_RATE) {
+            CONF_EXPECT(t.Replies == t.Sent, "%u requetes sans reponse a %u/s",
+                        (unsigned)(t.Sent - t.Replies), (unsigned)rates[i]);
+        }
+    }
+}
+
+static void CONF_BitErrors(uint64_t durationNs)
+{
+    static const double bers[] = { 0.0, 1e-5, 1e-4, 1e-3, 3e-3, 1e-2 };
+    S_confTraffic t;
+    uint32_t badCrc;
+    uint32_t resyncs;
+    uint32_t realignTotal;
+    uint32_t realignMax;
+    uint8_t i;
+
+    printf("\nBruit (%u transactions/s, %.1f s par point)\n", CONF_NOISE_RATE,
+           (double)durationNs / SIM_NS_PER_S);
+    printf("  TEB       utiles/s  perte %%  CRC faux  resync.  realign. moy/max [us]\n");
+    for (i = 0; i < (sizeof(bers) / sizeof(bers[0])); i++) {
+        CONF_ResetStats();
+        CONF_RunTraffic(&t, CONF_NOISE_RATE, durationNs, bers[i]);
+        badCrc = CONF_Stat(CMD_GET_LINK_STATS, 1 + 4 * 1);
+        resyncs = CONF_Stat(CMD_GET_SYNC_STATS, 1);
+        realignTotal = CONF_Stat(CMD_GET_SYNC_STATS, 5);
+        realignMax = CONF_Stat(CMD_GET_SYNC_STATS, 9);
+        printf("  %-8.0e  %8.1f  %7.2f  %8u  %7u  %8.0f / %.0f\n", bers[i],
+               (double)t.Replies / CONF_Elapsed(&t, durationNs), CONF_LossPercent(&t),
+               (unsigned)badCrc, (unsigned)resyncs,
+               (resyncs == 0) ? 0.0 : (double)realignTotal / resyncs / RS232_CORE_TICKS_PER_US,
+               (double)realignMax / RS232_CORE_TICKS_PER_US);
+        CONF_EXPECT(t.BadReplies == 0, "%u reponses erronees", (unsigned)t.BadReplies);
+        CONF_EXPECT(scanner.BadCrc == 0, "%u reponses au CRC faux", (unsigned)scanner.BadCrc);
+        if (bers[i] == 0.0) {
+            CONF_EXPECT(t.Replies == t.Sent, "%u pertes sans bruit", (unsigned)(t.Sent - t.Replies));
+            CONF_EXPECT(resyncs == 0, "%u resynchronisations sans bruit", (unsigned)resyncs);
+        }
+    }
+}
+
+static void CONF_CtsToggle(uint64_t durationNs)
+{
+    static const S_confCts patterns[] = { { 0, 0 }, { 5, 15 }, { 20, 20 }, { 100, 100 }, { 300, 300 } };
+    S_confTraffic t;
+    uint32_t holds;
+    uint32_t heldTicks;
+    uint8_t i;
+
+    printf("\nCTS (%u transactions/s, %.1f s par point)\n", CONF_NOISE_RATE,
+           (double)durationNs / SIM_NS_PER_S);
+    printf("  bloque/libre [ms]  utiles/s  perte %%  blocages  bloque [ms]  octets apres CTS\n");
+    for (i = 0; i < (sizeof(patterns) / sizeof(patterns[0])); i++) {
+        CONF_ResetStats();
+        pCts = &patterns[i];
+        ctsStartNs = SIM_Now();
+        ctsBytes = 0;
+        ctsBytesMax = 0;
+        CONF_RunTraffic(&t, CONF_NOISE_RATE, durationNs, 0.0);
+        holds = CONF_Stat(CMD_GET_FLOW_STATS, 13);
+        heldTicks = CONF_Stat(CMD_GET_FLOW_STATS, 17);
+        printf("  %6u / %-6u     %8.1f  %7.2f  %8u  %11.1f  %16u\n", (unsigned)patterns[i].HoldMs,
+               (unsigned)patterns[i].FreeMs, (double)t.Replies / CONF_Elapsed(&t, durationNs),
+               CONF_LossPercent(&t), (unsigned)holds,
+               (double)heldTicks / RS232_CORE_TICKS_PER_US / 1000.0, (unsigned)ctsBytesMax);
+        CONF_EXPECT(t.BadReplies == 0, "%u reponses erronees", (unsigned)t.BadReplies);
+        CONF_EXPECT(scanner.BadCrc == 0, "%u reponses au CRC faux", (unsigned)scanner.BadCrc);
+        CONF_EXPECT(ctsBytesMax <= (SIM_UART_HW_FIFO + 1), "%u octets emis CTS actif",
+                    (unsigned)ctsBytesMax);
+        if (patterns[i].HoldMs == 0) {
+            CONF_EXPECT(t.Replies == t.Sent, "%u pertes sans CTS", (unsigned)(t.Sent - t.Replies));
+        }
+    }
+}
+
+static int CONF_CompareU64(const void *pA, const void *pB)
+{
+    uint64_t a = *(const uint64_t *)pA;
+    uint64_t b = *(const uint64_t *)pB;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Latence des consignes : arrive du dernier octet -> largeur OC2 modifie.
+ *
+ * @details Les consignes alternent entre deux vitesses et arrivent  une
+ *          phase alatoire du Timer 1.
+ */
+static void CONF_SetpointLatency(void)
+{
+    uint64_t latency[CONF_LATENCY_COUNT];
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint64_t arrivedNs;
+    uint64_t end;
+    uint64_t sum = 0;
+    uint16_t pulse;
+    int missed = 0;
+    int n = 0;
+    int i;
+
+    for (i = 0; i < CONF_LATENCY_COUNT; i++) {
+        CONF_RunUntil(SIM_Now() + CONF_TIMER1_NS + (uint64_t)(CONF_Random() * CONF_TIMER1_NS));
+        pulse = SIM_GetOcPulse(CONF_OC_MOTOR);
+        SIM_UartWrite(frame, HFRAME_EncodeSetpoint(frame, 0, RS232_NODE_ADDRESS,
+                                                   (i & 1) ? 60 : 20, 0));
+        while (SIM_UartPending() > 0) {
+            CONF_RunUntil(SIM_Now() + CONF_STEP_NS);
+        }
+        arrivedNs = SIM_Now();
+        end = arrivedNs + CONF_CMD_TIMEOUT_NS;
+        while ((SIM_GetOcPulse(CONF_OC_MOTOR) == pulse) && (SIM_Now() < end)) {
+            CONF_RunUntil(SIM_Now() + CONF_STEP_NS);
+        }
+        if (SIM_GetOcPulse(CONF_OC_MOTOR) == pulse) {
+            missed++;
+            continue;
+        }
+        latency[n] = SIM_Now() - arrivedNs;
+        sum += latency[n];
+        n++;
+    }
+
+    printf("\nLatence des consignes (%d consignes, reception -> OC%u)\n", CONF_LATENCY_COUNT,
+           CONF_OC_MOTOR);
+    CONF_EXPECT(missed == 0, "%d consignes non appliquees", missed);
+    if (n == 0) {
+        return;
+    }
+    qsort(latency, (size_t)n, sizeof(latency[0]), CONF_CompareU64);
+    printf("  min %.0f  moy %.0f  p50 %.0f  p99 %.0f  max %.0f us\n",
+           (double)latency[0] / SIM_NS_PER_US, (double)sum / n / SIM_NS_PER_US,
+           (double)latency[n / 2] / SIM_NS_PER_US, (double)latency[(n * 99) / 100] / SIM_NS_PER_US,
+           (double)latency[n - 1] / SIM_NS_PER_US);
+    // Consigne prise en compte au plus tard au cycle de Timer 1 suivant
+    CONF_EXPECT(latency[n - 1] <= (CONF_TIMER1_NS + CONF_STEP_NS), "latence max. %.0f us",
+                (double)latency[n - 1] / SIM_NS_PER_US);
+}
+
+static void CONF_Usage(void)
+{
+    fprintf(stderr, "usage: tp2_conform [--duration MS] [--seed N]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option longOpts[] = {
+        { "duration", required_argument, NULL, 'd' },
+        { "seed", required_argument, NULL, 's' },
+        { NULL, 0, NULL, 0 }
+    };
+    const S_simConfig config = { NULL, 1, 1 };
+    uint64_t durationNs = 2 * SIM_NS_PER_S;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", longOpts, NULL)) != -1) {
+        switch (c) {
+            case 'd': durationNs = (uint64_t)atoi(optarg) * SIM_NS_PER_MS; break;
+            case 's': noiseState = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: CONF_Usage(); return 2;
+        }
+    }
+    if ((durationNs == 0) || (noiseState == 0)) {
+        CONF_Usage();
+        return 2;
+    }
+
+    HFRAME_Init(&scanner, 0);
+    if (SIM_Init(&config) != 0) {
+        fprintf(stderr, "tp2_conform: initialisation du simulateur impossible\n");
+        return 1;
+    }
+    // Fin de l'introduction (3 s)
+    CONF_RunUntil(3100 * SIM_NS_PER_MS);
+
+    printf("tp2_conform : liaison RS232 a %u bauds, requete %u o, reponse %u o\n",
+           RS232_BAUDRATE, CONF_REQ_SIZE, CONF_RESP_SIZE);
+    CONF_RateSweep(durationNs);
+    CONF_BitErrors(durationNs);
+    CONF_CtsToggle(durationNs);
+    CONF_SetpointLatency();
+
+    printf("\n%s\n", (failures == 0) ? "OK" : "ECHEC");
+    return (failures == 0) ? 0 : 1;
+}
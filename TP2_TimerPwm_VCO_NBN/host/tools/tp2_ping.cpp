@@ -0,0 +1,250 @@
+/*--------------------------------------------------------*/
+// Tp2_ping.cpp
+/*--------------------------------------------------------*/
+//	Description :	Sonde de latence de la liaison : CMD_PING rpts,
+//			        distributions du temps aller-retour et de sa
+//			        dcomposition  partir des instants de la carte
+//			        (core timer, RS232_CORE_TICKS_PER_US par us) :
+//			          rx -> parse   rception de la trame, dcodage
+//			          parse -> apply  attente de GPWM_ExecPWM
+//			          apply -> reply  mise en FIFO de la rponse
+//			          hote + ligne  aller-retour moins l'intervalle
+//			                        rx -> reply de la carte
+//
+//	Cibles :
+//	  --port CHEMIN        port srie ou pty existant
+//	  --vdev BIN           lance une carte tp2_vdev sur un pty
+//	  --vdev BIN --multidrop --nodes N
+//	                       lance tp2_vdev_md : N cartes sur un bus
+//
+//	Options : --count N, --interval MS (pause entre pings), --timeout MS,
+//	          --warmup MS, --baud B, --rtscts, --multidrop, --addr A,
+//	          --setpoint VITESSE:ANGLE (consigne envoye avant chaque ping :
+//	          parse -> apply mesure alors sa prise en compte), --verbose
+//
+/*--------------------------------------------------------*/
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "tp2link.hpp"
+#include "histogram.hpp"
+#include "vdevProcess.hpp"
+
+using namespace tp2link;
+using namespace std::chrono;
+
+namespace {
+
+constexpr double kBitsPerByte = 10.0;      // 8N1
+
+struct Options {
+    std::string Port;
+    std::string Vdev;
+    bool Multidrop = false;
+    int Nodes = 1;
+    uint8_t Addr = RS232_NODE_ADDRESS;
+    int Count = 100;
+    int IntervalMs = 0;
+    int TimeoutMs = 500;
+    int WarmupMs = 6000;
+    unsigned Baud = 57600;
+    bool RtsCts = false;
+    bool Setpoint = false;
+    int8_t Speed = 0;
+    int8_t Angle = 0;
+    bool Verbose = false;
+};
+
+/**
+ * @brief Distributions releves [us].
+ */
+struct Stats {
+    Histogram Rtt;
+    Histogram Parse;
+    Histogram Apply;
+    Histogram Reply;
+    Histogram Device;
+    Histogram Host;
+    int Ok = 0;
+    int Failed = 0;
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "usage: tp2_ping (--port CHEMIN | --vdev BIN [--nodes N]) [--multidrop] [--addr A]\n"
+                 "                [--count N] [--interval MS] [--timeout MS] [--warmup MS]\n"
+                 "                [--baud B] [--rtscts] [--setpoint VITESSE:ANGLE] [--verbose]\n");
+}
+
+bool parse(int argc, char **argv, Options &opt)
+{
+    static const struct option longOpts[] = {
+        { "port", required_argument, nullptr, 'p' },
+        { "vdev", required_argument, nullptr, 'v' },
+        { "multidrop", no_argument, nullptr, 'm' },
+        { "nodes", required_argument, nullptr, 'n' },
+        { "addr", required_argument, nullptr, 'a' },
+        { "count", required_argument, nullptr, 'c' },
+        { "interval", required_argument, nullptr, 'i' },
+        { "timeout", required_argument, nullptr, 't' },
+        { "warmup", required_argument, nullptr, 'u' },
+        { "baud", required_argument, nullptr, 'b' },
+        { "rtscts", no_argument, nullptr, 'r' },
+        { "setpoint", required_argument, nullptr, 's' },
+        { "verbose", no_argument, nullptr, 'V' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int speed;
+    int angle;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", longOpts, nullptr)) != -1) {
+        switch (c) {
+            case 'p': opt.Port = optarg; break;
+            case 'v': opt.Vdev = optarg; break;
+            case 'm': opt.Multidrop = true; break;
+            case 'n': opt.Nodes = std::atoi(optarg); break;
+            case 'a': opt.Addr = (uint8_t)std::atoi(optarg); break;
+            case 'c': opt.Count = std::atoi(optarg); break;
+            case 'i': opt.IntervalMs = std::atoi(optarg); break;
+            case 't': opt.TimeoutMs = std::atoi(optarg); break;
+            case 'u': opt.WarmupMs = std::atoi(optarg); break;
+            case 'b': opt.Baud = (unsigned)std::atoi(optarg); break;
+            case 'r': opt.RtsCts = true; break;
+            case 's':
+                if (std::sscanf(optarg, "%d:%d", &speed, &angle) != 2) {
+                    return false;
+                }
+                opt.Setpoint = true;
+                opt.Speed = (int8_t)speed;
+                opt.Angle = (int8_t)angle;
+                break;
+            case 'V': opt.Verbose = true; break;
+            default: return false;
+        }
+    }
+    return (opt.Port.empty() != opt.Vdev.empty()) && (opt.Count > 0) && (opt.Nodes > 0) &&
+           (opt.Baud > 0);
+}
+
+/**
+ * @brief Attend l'entre en service de la carte (dmarrage de 3 s).
+ *
+ * @details Un ping reu pendant le dmarrage n'a sa rponse qu' l'entre
+ *          en service : un seul ping, avec un dlai couvrant toute l'attente.
+ */
+bool warmup(EventLoop &loop, Device &dev, int warmupMs)
+{
+    bool done = false;
+    bool ready = false;
+
+    dev.command(CMD_PING, { 0 }, [&](std::error_code ec, const Response &) {
+        ready = !ec;
+        done = true;
+    }, milliseconds(warmupMs));
+    loop.runUntil([&] { return done; }, milliseconds(warmupMs) + seconds(1));
+    return ready;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+
+    if (!parse(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    EventLoop loop;
+    std::unique_ptr<VdevProcess> vdev;
+    std::unique_ptr<Port> port;
+    PortOptions portOpt;
+    portOpt.Multidrop = opt.Multidrop;
+    portOpt.Timeout = milliseconds(opt.TimeoutMs);
+
+    try {
+        std::string path = opt.Port;
+        if (!opt.Vdev.empty()) {
+            std::vector<std::string> args;
+            if (opt.Multidrop) {
+                args = { "--nodes", std::to_string(opt.Nodes) };
+            }
+            vdev = std::make_unique<VdevProcess>(opt.Vdev, args);
+            path = vdev->path();
+        }
+        port = std::make_unique<Port>(
+            loop, std::make_unique<SerialTransport>(loop, path, opt.Baud, opt.RtsCts), portOpt);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "tp2_ping: %s\n", e.what());
+        return 1;
+    }
+
+    Device &dev = port->device(opt.Addr);
+    if (!warmup(loop, dev, opt.WarmupMs)) {
+        std::fprintf(stderr, "tp2_ping: la carte ne repond pas\n");
+        return 1;
+    }
+
+    // Dure thorique des deux trames sur la ligne
+    uint8_t frame[HFRAME_MAX_SIZE];
+    uint8_t reply[2 + 4 * 4] = {};
+    uint8_t seq = 0;
+    size_t bytes = HFRAME_EncodeCommand(frame, opt.Multidrop, opt.Addr, CMD_PING, &seq, 1) +
+                   HFRAME_EncodeCommand(frame, opt.Multidrop, opt.Addr,
+                                        CMD_PING | CMD_RESPONSE_FLAG, reply, sizeof(reply));
+    double lineUs = (double)bytes * kBitsPerByte * 1e6 / opt.Baud;
+
+    std::printf("tp2_ping : %d pings, noeud %u%s\n", opt.Count, opt.Addr,
+                opt.Setpoint ? ", consigne avant chaque ping" : "");
+    Stats stats;
+    for (int i = 0; i < opt.Count; i++) {
+        bool done = false;
+        seq = (uint8_t)(1 + i % 255);      // 0 rserv au dmarrage
+        if (opt.Setpoint) {
+            dev.setpoint(opt.Speed, opt.Angle);
+        }
+        dev.ping(seq, [&](std::error_code ec, const PingResult &r) {
+            done = true;
+            if (ec) {
+                stats.Failed++;
+                if (opt.Verbose) {
+                    std::printf("seq %3u : %s\n", seq, ec.message().c_str());
+                }
+                return;
+            }
+            double rttUs = duration<double, std::micro>(r.Rtt).count();
+            stats.Ok++;
+            stats.Rtt.add(rttUs);
+            stats.Parse.add(r.parseUs());
+            stats.Apply.add(r.applyUs());
+            stats.Reply.add(r.replyUs());
+            stats.Device.add(r.deviceUs());
+            stats.Host.add(rttUs - r.deviceUs());
+            if (opt.Verbose) {
+                std::printf("seq %3u : rtt %8.1f us, rx->parse %8.1f, parse->apply %8.1f, "
+                            "apply->reply %6.1f\n",
+                            r.Seq, rttUs, r.parseUs(), r.applyUs(), r.replyUs());
+            }
+        });
+        loop.runUntil([&] { return done; }, milliseconds(opt.TimeoutMs) + seconds(1));
+        if (opt.IntervalMs > 0) {
+            loop.runUntil([] { return false; }, milliseconds(opt.IntervalMs));
+        }
+    }
+
+    std::printf("%d reponses, %d pertes ; trames ping + reponse sur la ligne : %.1f us a %u bauds\n",
+                stats.Ok, stats.Failed, lineUs, opt.Baud);
+    stats.Rtt.print(stdout, "aller-retour", "us");
+    stats.Parse.print(stdout, "rx -> parse", "us");
+    stats.Apply.print(stdout, "parse -> apply", "us");
+    stats.Reply.print(stdout, "apply -> reply", "us");
+    stats.Device.print(stdout, "carte (rx -> reply)", "us");
+    stats.Host.print(stdout, "hote + ligne", "us");
+    return (stats.Ok == 0) ? 1 : 0;
+}
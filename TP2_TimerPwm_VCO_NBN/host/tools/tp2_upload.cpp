@@ -0,0 +1,435 @@
+/*--------------------------------------------------------*/
+// Tp2_upload.cpp
+/*--------------------------------------------------------*/
+//	Description :	Tlchargement d'une image firmware dans la zone de
+//			        transit de la carte (protocole : gestBoot.h) :
+//			        CMD_BOOT_START (effacement), blocs CMD_BOOT_DATA
+//			        fentrs, CMD_BOOT_END (CRC de l'image relue en
+//			        flash). Affiche la dure de chaque phase et le
+//			        dbit obtenu.
+//
+//	Fentre : jusqu' --window blocs en vol ; un bloc refus (hors
+//	squence, fentre pleine) ou sans rponse fait reprendre l'envoi au
+//	numro "Prochain" retourn par la carte (go-back-N).
+//
+//	Usage : tp2_upload (IMAGE | --random N) (--port CHEMIN | --vdev BIN
+//	        [--flash FICHIER [--verify-flash]]) [--window W] [--timeout MS]
+//	        [--warmup MS] [--baud B] [--rtscts] [--multidrop --addr A]
+//
+//	--verify-flash : aprs le transfert, arrte tp2_vdev (flash sauvegarde)
+//	et compare la zone de transit et le descripteur du fichier  l'image.
+//
+/*--------------------------------------------------------*/
+#include <getopt.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tp2link.hpp"
+#include "vdevProcess.hpp"
+#include "gestBoot.h"
+
+using namespace tp2link;
+using namespace std::chrono;
+
+namespace {
+
+constexpr double kBitsPerByte = 10.0;                  // 8N1
+constexpr auto kEraseTimePerPage = milliseconds(40);   // Effacement (~20 ms) + marge
+constexpr auto kBusyRetry = milliseconds(20);          // Un cycle de Timer 1
+constexpr int kMaxStalls = 10;                         // Reprises sans progression avant abandon
+
+struct Options {
+    std::string Image;
+    size_t RandomSize = 0;
+    std::string Port;
+    std::string Vdev;
+    std::string Flash;
+    bool VerifyFlash = false;
+    bool Multidrop = false;
+    uint8_t Addr = RS232_NODE_ADDRESS;
+    unsigned Window = GBOOT_WINDOW;
+    int TimeoutMs = 500;
+    int WarmupMs = 6000;
+    unsigned Baud = 57600;
+    bool RtsCts = false;
+};
+
+/**
+ * @brief tat du transfert des blocs.
+ */
+struct Transfer {
+    Transfer(EventLoop &loop, Device &dev, const std::vector<uint8_t> &image, unsigned blockSize,
+             unsigned window, milliseconds timeout)
+        : Loop(loop), Dev(dev), Image(image), BlockSize(blockSize), Window(window),
+          Timeout(timeout), Blocks((uint16_t)((image.size() + blockSize - 1) / blockSize))
+    {
+    }
+
+    EventLoop &Loop;
+    Device &Dev;
+    const std::vector<uint8_t> &Image;
+    unsigned BlockSize;
+    unsigned Window;
+    milliseconds Timeout;
+    uint16_t Blocks;
+
+    uint16_t Acked = 0;         // Prochain bloc attendu par la carte
+    uint16_t SendNext = 0;      // Prochain bloc  mettre
+    uint16_t Highest = 0;       // Premier bloc jamais mis
+    unsigned InFlight = 0;
+    unsigned Epoch = 0;         // Incrment  chaque reprise
+    bool Paused = false;
+    int Sent = 0;
+    int Resent = 0;
+    int Rewinds = 0;
+    int Stalls = 0;             // Reprises depuis le dernier bloc acquitt
+    std::string Error;
+
+    bool done() const { return (!Error.empty()) || ((Acked >= Blocks) && (InFlight == 0)); }
+
+    /**
+     * @brief Reprend l'envoi au bloc from (rponses des envois antrieurs ignores).
+     */
+    void rewind(uint16_t from, milliseconds delay = milliseconds(0))
+    {
+        Epoch++;
+        Rewinds++;
+        if (++Stalls > kMaxStalls) {
+            Error = "pas de progression apres " + std::to_string(kMaxStalls) + " reprises";
+            return;
+        }
+        SendNext = std::max(from, Acked);
+        if (delay.count() > 0) {
+            Paused = true;
+            Loop.addTimer(delay, [this] {
+                Paused = false;
+                pump();
+            });
+        }
+    }
+
+    void pump()
+    {
+        SendNext = std::max(SendNext, Acked);
+        while (Error.empty() && !Paused && (InFlight < Window) && (SendNext < Blocks)) {
+            uint16_t block = SendNext++;
+            size_t offset = (size_t)block * BlockSize;
+            size_t len = std::min((size_t)BlockSize, Image.size() - offset);
+            std::vector<uint8_t> payload = { (uint8_t)(block >> 8), (uint8_t)block };
+
+            payload.insert(payload.end(), Image.begin() + (long)offset,
+                           Image.begin() + (long)(offset + len));
+            if (block < Highest) {
+                Resent++;
+            } else {
+                Highest = (uint16_t)(block + 1);
+            }
+            Sent++;
+            InFlight++;
+            unsigned epoch = Epoch;
+            Dev.command(CMD_BOOT_DATA, std::move(payload),
+                        [this, epoch](std::error_code ec, const Response &r) {
+                InFlight--;
+                onResponse(epoch, ec, r);
+                pump();
+            }, Timeout);
+        }
+    }
+
+    void onResponse(unsigned epoch, std::error_code ec, const Response &r)
+    {
+        if (ec == Errc::Closed) {
+            Error = ec.message();
+            return;
+        }
+        if (ec || (r.Data.size() < 4)) {
+            // Rponse perdue : reprise au dernier bloc acquitt
+            if (epoch == Epoch) {
+                rewind(Acked);
+            }
+            return;
+        }
+        uint16_t next = (uint16_t)((r.Data[1] << 8) | r.Data[2]);
+        if (next > Acked) {
+            Acked = next;
+            Stalls = 0;
+        }
+        switch (r.status()) {
+            case GBOOT_OK:
+                break;
+            case GBOOT_ERR_SEQUENCE:
+                if (epoch == Epoch) {
+                    rewind(next);
+                }
+                break;
+            case GBOOT_ERR_BUSY:
+                // Programmation en retard : pause d'un cycle avant la reprise
+                if (epoch == Epoch) {
+                    rewind(next, kBusyRetry);
+                }
+                break;
+            default:
+                char text[40];
+                std::snprintf(text, sizeof(text), "bloc refuse, etat 0x%02X", r.status());
+                Error = text;
+                break;
+        }
+    }
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "usage: tp2_upload (IMAGE | --random N) (--port CHEMIN | --vdev BIN\n"
+                 "                  [--flash FICHIER [--verify-flash]]) [--window W]\n"
+                 "                  [--timeout MS] [--warmup MS] [--baud B] [--rtscts]\n"
+                 "                  [--multidrop --addr A]\n");
+}
+
+bool parse(int argc, char **argv, Options &opt)
+{
+    static const struct option longOpts[] = {
+        { "random", required_argument, nullptr, 'R' },
+        { "port", required_argument, nullptr, 'p' },
+        { "vdev", required_argument, nullptr, 'v' },
+        { "flash", required_argument, nullptr, 'f' },
+        { "verify-flash", no_argument, nullptr, 'F' },
+        { "multidrop", no_argument, nullptr, 'm' },
+        { "addr", required_argument, nullptr, 'a' },
+        { "window", required_argument, nullptr, 'w' },
+        { "timeout", required_argument, nullptr, 't' },
+        { "warmup", required_argument, nullptr, 'u' },
+        { "baud", required_argument, nullptr, 'b' },
+        { "rtscts", no_argument, nullptr, 'r' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", longOpts, nullptr)) != -1) {
+        switch (c) {
+            case 'R': opt.RandomSize = (size_t)std::atol(optarg); break;
+            case 'p': opt.Port = optarg; break;
+            case 'v': opt.Vdev = optarg; break;
+            case 'f': opt.Flash = optarg; break;
+            case 'F': opt.VerifyFlash = true; break;
+            case 'm': opt.Multidrop = true; break;
+            case 'a': opt.Addr = (uint8_t)std::atoi(optarg); break;
+            case 'w': opt.Window = (unsigned)std::atoi(optarg); break;
+            case 't': opt.TimeoutMs = std::atoi(optarg); break;
+            case 'u': opt.WarmupMs = std::atoi(optarg); break;
+            case 'b': opt.Baud = (unsigned)std::atoi(optarg); break;
+            case 'r': opt.RtsCts = true; break;
+            default: return false;
+        }
+    }
+    if (optind < argc) {
+        opt.Image = argv[optind];
+    }
+    if (opt.VerifyFlash && (opt.Vdev.empty() || opt.Flash.empty())) {
+        return false;
+    }
+    return (opt.Image.empty() != (opt.RandomSize == 0)) && (opt.Port.empty() != opt.Vdev.empty()) &&
+           (opt.Window > 0) && (opt.Baud > 0);
+}
+
+/**
+ * @brief Image lue ou tire au hasard, complte  un multiple du mot flash
+ *        par des octets effacs (0xFF).
+ */
+bool loadImage(const Options &opt, std::vector<uint8_t> &image)
+{
+    if (opt.RandomSize > 0) {
+        std::mt19937 gen(1);
+        image.resize(opt.RandomSize);
+        for (auto &b : image) {
+            b = (uint8_t)gen();
+        }
+    } else {
+        std::ifstream in(opt.Image, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    while ((image.size() % GNVM_WORD_SIZE) != 0) {
+        image.push_back(0xFF);
+    }
+    return !image.empty() && (image.size() <= GBOOT_STAGING_SIZE);
+}
+
+/**
+ * @brief Commande unique, attendue de faon synchrone.
+ */
+bool call(EventLoop &loop, Device &dev, uint8_t cmd, std::vector<uint8_t> payload,
+          milliseconds timeout, Response &resp)
+{
+    bool done = false;
+    std::error_code err;
+
+    dev.command(cmd, std::move(payload), [&](std::error_code ec, const Response &r) {
+        err = ec;
+        resp = r;
+        done = true;
+    }, timeout);
+    loop.runUntil([&] { return done; }, timeout + seconds(1));
+    if (err) {
+        std::fprintf(stderr, "tp2_upload: commande 0x%02X : %s\n", cmd, err.message().c_str());
+    }
+    return done && !err;
+}
+
+/**
+ * @brief Compare la zone de transit et le descripteur du fichier flash  l'image.
+ */
+bool verifyFlash(const std::string &path, const std::vector<uint8_t> &image, uint16_t crc)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> flash((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const size_t staging = GBOOT_STAGING_ADDR - GNVM_FLASH_BASE;
+    const size_t descr = GBOOT_DESCR_ADDR - GNVM_FLASH_BASE;
+
+    if (flash.size() != GNVM_FLASH_SIZE) {
+        std::fprintf(stderr, "tp2_upload: %s : taille %zu\n", path.c_str(), flash.size());
+        return false;
+    }
+    if (!std::equal(image.begin(), image.end(), flash.begin() + (long)staging)) {
+        std::fprintf(stderr, "tp2_upload: zone de transit differente de l'image\n");
+        return false;
+    }
+    // Descripteur : [Magic, Taille, Crc], mots petit-boutistes
+    auto word = [&](size_t off) {
+        return (uint32_t)flash[off] | ((uint32_t)flash[off + 1] << 8) |
+               ((uint32_t)flash[off + 2] << 16) | ((uint32_t)flash[off + 3] << 24);
+    };
+    if ((word(descr) != GBOOT_DESCR_MAGIC) || (word(descr + 4) != image.size()) ||
+        (word(descr + 8) != crc)) {
+        std::fprintf(stderr, "tp2_upload: descripteur invalide\n");
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<uint8_t> image;
+
+    if (!parse(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+    if (!loadImage(opt, image)) {
+        std::fprintf(stderr, "tp2_upload: image illisible, vide ou trop grande (max %u octets)\n",
+                     (unsigned)GBOOT_STAGING_SIZE);
+        return 1;
+    }
+    uint16_t crc = HFRAME_Crc(image.data(), image.size());
+
+    EventLoop loop;
+    std::unique_ptr<VdevProcess> vdev;
+    std::unique_ptr<Port> port;
+    PortOptions portOpt;
+    portOpt.Multidrop = opt.Multidrop;
+    portOpt.Window = opt.Window;
+    portOpt.Timeout = milliseconds(opt.TimeoutMs);
+
+    try {
+        std::string path = opt.Port;
+        if (!opt.Vdev.empty()) {
+            std::vector<std::string> args;
+            if (!opt.Flash.empty()) {
+                args = { "--flash", opt.Flash };
+            }
+            vdev = std::make_unique<VdevProcess>(opt.Vdev, args);
+            path = vdev->path();
+        }
+        port = std::make_unique<Port>(
+            loop, std::make_unique<SerialTransport>(loop, path, opt.Baud, opt.RtsCts), portOpt);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "tp2_upload: %s\n", e.what());
+        return 1;
+    }
+    Device &dev = port->device(opt.Addr);
+    Response resp;
+
+    // Attente de l'entre en service (rponse au ping diffre jusque-l)
+    if (!call(loop, dev, CMD_PING, { 0 }, milliseconds(opt.WarmupMs), resp)) {
+        return 1;
+    }
+
+    // 1. Ouverture : effacement des pages de l'image et du descripteur
+    size_t pages = (image.size() + GNVM_PAGE_SIZE - 1) / GNVM_PAGE_SIZE + 1;
+    uint32_t size = (uint32_t)image.size();
+    auto t0 = EventLoop::Clock::now();
+    if (!call(loop, dev, CMD_BOOT_START,
+              { (uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size,
+                (uint8_t)(crc >> 8), (uint8_t)crc },
+              milliseconds(opt.TimeoutMs) + kEraseTimePerPage * (long)pages, resp)) {
+        return 1;
+    }
+    if ((resp.status() != GBOOT_OK) || (resp.Data.size() < 3) || (resp.Data[2] == 0)) {
+        std::fprintf(stderr, "tp2_upload: ouverture refusee, etat 0x%02X\n", resp.status());
+        return 1;
+    }
+    unsigned window = std::min<unsigned>(opt.Window, resp.Data[1]);
+    unsigned blockSize = resp.Data[2];
+
+    // 2. Blocs fentrs
+    auto t1 = EventLoop::Clock::now();
+    Transfer transfer(loop, dev, image, blockSize, window, milliseconds(opt.TimeoutMs));
+    transfer.pump();
+    loop.runUntil([&] { return transfer.done(); }, hours(1));
+    if (!transfer.Error.empty()) {
+        std::fprintf(stderr, "tp2_upload: %s\n", transfer.Error.c_str());
+        return 1;
+    }
+
+    // 3. Fin : fin de programmation, CRC de l'image relue en flash
+    auto t2 = EventLoop::Clock::now();
+    if (!call(loop, dev, CMD_BOOT_END, {}, milliseconds(opt.TimeoutMs) + seconds(1), resp)) {
+        return 1;
+    }
+    auto t3 = EventLoop::Clock::now();
+    uint16_t deviceCrc = (resp.Data.size() >= 3) ? (uint16_t)((resp.Data[1] << 8) | resp.Data[2]) : 0;
+
+    double erase = duration<double>(t1 - t0).count();
+    double data = duration<double>(t2 - t1).count();
+    double end = duration<double>(t3 - t2).count();
+    double total = duration<double>(t3 - t0).count();
+    double lineRate = opt.Baud / kBitsPerByte;
+    std::printf("tp2_upload : %zu octets, %u blocs de %u, fenetre %u, CRC 0x%04X\n", image.size(),
+                transfer.Blocks, blockSize, window, crc);
+    std::printf("  effacement %.3f s, blocs %.3f s, fin %.3f s, total %.3f s\n", erase, data, end,
+                total);
+    std::printf("  debit blocs %.0f o/s (%.0f %% de la ligne a %u bauds), global %.0f o/s\n",
+                image.size() / data, 100.0 * image.size() / data / lineRate, opt.Baud,
+                image.size() / total);
+    std::printf("  %d blocs emis, %d reemis, %d reprises, %llu delais depasses\n", transfer.Sent,
+                transfer.Resent, transfer.Rewinds, (unsigned long long)port->stats().Timeouts);
+
+    if ((resp.status() != GBOOT_OK) || (deviceCrc != crc)) {
+        std::fprintf(stderr, "tp2_upload: image refusee, etat 0x%02X, CRC relu 0x%04X\n",
+                     resp.status(), deviceCrc);
+        return 1;
+    }
+    std::printf("  image verifiee par la carte (CRC relu 0x%04X)\n", deviceCrc);
+
+    if (opt.VerifyFlash) {
+        port.reset();
+        vdev->stop();
+        if (!verifyFlash(opt.Flash, image, crc)) {
+            return 1;
+        }
+        std::printf("  fichier flash %s conforme\n", opt.Flash.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,459 @@
+/*--------------------------------------------------------*/
+// Tp2_vdev.c
+/*--------------------------------------------------------*/
+//	Description :	Carte virtuelle servie sur un pseudo-terminal : le
+//			        firmware tourne sur l'appareil simul, cadenc sur
+//			        l'horloge murale, et la liaison RS232 est le pty.
+//
+//	Usage : tp2_vdev [--flash FICHIER] [--link CHEMIN] [--rate R]
+//	                 [--adc0 V] [--adc1 V] [--nodes N]
+//
+//	Le chemin de l'esclave (/dev/pts/N) est affich sur stdout ; les
+//	outils hte l'ouvrent comme un port srie. --nodes (variante
+//	multipoint tp2_vdev_md) lance N cartes d'adresses 1..N dans des
+//	processus fils, relies au mme pty comme sur un bus RS485.
+//
+//	Boucle d'vnements : epoll sur le pty (ou le socket du bus),
+//	un timerfd de VDEV_TICK_MS et un signalfd (SIGINT, SIGTERM).
+//
+/*--------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+#include "simDevice.h"
+#include "gestParam.h"
+#include "gestFrame.h"
+
+#define VDEV_TICK_MS        1           // Pas de cadencement sur l'horloge murale
+#define VDEV_RX_BACKLOG     4096        // Octets en attente sur la ligne avant de ne plus lire le pty
+#define VDEV_IO_SIZE        4096
+#define VDEV_MAX_NODES      16
+#define VDEV_MAX_EVENTS     (VDEV_MAX_NODES + 3)
+
+/**
+ * @brief Options de la ligne de commande.
+ */
+typedef struct {
+    const char *FlashFile;
+    const char *Link;
+    double Rate;                // Temps virtuel / temps rel
+    int Adc[2];
+    int Nodes;
+} S_vdevOptions;
+
+/**
+ * @brief Octets mis par la carte pas encore accepts par le descripteur.
+ */
+typedef struct {
+    uint8_t Data[VDEV_IO_SIZE];
+    size_t Len;
+} S_vdevPending;
+
+static uint64_t VDEV_WallNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * SIM_NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+static int VDEV_SetNonBlock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    return (flags < 0) ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int VDEV_EpollAdd(int epfd, int fd, uint32_t events)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+/**
+ * @brief Descripteur des signaux d'arrt (bloqus, lus dans la boucle).
+ */
+static int VDEV_SignalFd(void)
+{
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+static int VDEV_TimerFd(void)
+{
+    struct itimerspec its;
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_nsec = VDEV_TICK_MS * SIM_NS_PER_MS;
+    its.it_value = its.it_interval;
+    if (timerfd_settime(fd, 0, &its, NULL) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Ouvre le pty : matre non bloquant, esclave en mode brut gard
+ *        ouvert (le matre ne voit pas de raccrochage entre deux clients).
+ * @return Descripteur du matre, -1 en cas d'erreur.
+ */
+static int VDEV_OpenPty(const char *link, int *pSlave)
+{
+    struct termios tio;
+    const char *name;
+    int master;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+        perror("tp2_vdev: posix_openpt");
+        return -1;
+    }
+    name = ptsname(master);
+    *pSlave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if ((*pSlave < 0) || (tcgetattr(*pSlave, &tio) != 0)) {
+        perror("tp2_vdev: pty esclave");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B57600);
+    cfsetospeed(&tio, B57600);
+    tcsetattr(*pSlave, TCSANOW, &tio);
+    VDEV_SetNonBlock(master);
+
+    if (link != NULL) {
+        unlink(link);
+        if (symlink(name, link) != 0) {
+            perror("tp2_vdev: lien");
+            return -1;
+        }
+    }
+    printf("%s\n", name);
+    fflush(stdout);
+    return master;
+}
+
+/**
+ * @brief Vide le tampon de sortie dans le descripteur.
+ * @return 0, ou -1 si le descripteur est ferm.
+ */
+static int VDEV_Flush(int fd, S_vdevPending *pOut)
+{
+    ssize_t n;
+
+    while (pOut->Len > 0) {
+        n = write(fd, pOut->Data, pOut->Len);
+        if (n < 0) {
+            return ((errno == EAGAIN) || (errno == EIO)) ? 0 : -1;
+        }
+        pOut->Len -= (size_t)n;
+        memmove(pOut->Data, &pOut->Data[n], pOut->Len);
+    }
+    return 0;
+}
+
+/**
+ * @brief Excute une carte simule relie au descripteur fd jusqu' un signal.
+ *
+ * @details A chaque tick, le temps virtuel rattrape l'horloge murale
+ *          (multiplie par rate). Les octets lus sur fd sont dposs sur la
+ *          ligne RX ; les octets mis sont crits sur fd. Si fd n'accepte
+ *          plus rien, CTS passe  1 jusqu' ce que le tampon soit vid.
+ */
+static int VDEV_Serve(int fd, double rate)
+{
+    struct epoll_event events[VDEV_MAX_EVENTS];
+    S_vdevPending out;
+    uint8_t buf[VDEV_IO_SIZE];
+    uint64_t wallStart;
+    uint64_t simStart;
+    uint64_t expirations;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int tfd = VDEV_TimerFd();
+    int sfd = VDEV_SignalFd();
+    int running = 1;
+    ssize_t n;
+    int nb;
+    int i;
+
+    if ((epfd < 0) || (tfd < 0) || (sfd < 0)) {
+        perror("tp2_vdev: epoll");
+        return -1;
+    }
+    VDEV_EpollAdd(epfd, tfd, EPOLLIN);
+    VDEV_EpollAdd(epfd, sfd, EPOLLIN);
+    VDEV_EpollAdd(epfd, fd, EPOLLIN);
+    out.Len = 0;
+    wallStart = VDEV_WallNs();
+    simStart = SIM_Now();
+
+    while (running)
+    {
+        nb = epoll_wait(epfd, events, VDEV_MAX_EVENTS, -1);
+        if (nb < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("tp2_vdev: epoll_wait");
+            break;
+        }
+        for (i = 0; i < nb; i++) {
+            if (events[i].data.fd == sfd) {
+                running = 0;
+            } else if (events[i].data.fd == tfd) {
+                if (read(tfd, &expirations, sizeof(expirations)) < 0) {
+                    continue;
+                }
+                SIM_RunUntil(simStart + (uint64_t)((double)(VDEV_WallNs() - wallStart) * rate));
+                while (out.Len < sizeof(out.Data)) {
+                    size_t got = SIM_UartRead(&out.Data[out.Len], sizeof(out.Data) - out.Len);
+                    if (got == 0) {
+                        break;
+                    }
+                    out.Len += got;
+                }
+                if (VDEV_Flush(fd, &out) != 0) {
+                    running = 0;
+                }
+                SIM_SetCts(out.Len > 0);
+            } else if (SIM_UartPending() < VDEV_RX_BACKLOG) {
+                n = read(fd, buf, sizeof(buf));
+                if (n > 0) {
+                    SIM_UartWrite(buf, (size_t)n);
+                } else if ((n == 0) || ((errno != EAGAIN) && (errno != EIO))) {
+                    running = 0;        // Bus ferm par le processus pre
+                }
+            }
+        }
+        // Ligne sature : le pty reste lisible, pas d'attente active
+        if (SIM_UartPending() >= VDEV_RX_BACKLOG) {
+            struct epoll_event ev = { .events = 0, .data.fd = fd };
+            epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+        } else {
+            struct epoll_event ev = { .events = EPOLLIN, .data.fd = fd };
+            epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+    close(tfd);
+    close(sfd);
+    close(epfd);
+    return 0;
+}
+
+/**
+ * @brief Dmarre la carte simule (adresse de noeud en multipoint).
+ */
+static int VDEV_Start(const S_vdevOptions *pOpt, uint8_t addr)
+{
+    char flashName[512];
+    S_simConfig config;
+
+    memset(&config, 0, sizeof(config));
+    config.RtsHonored = 1;
+    config.Seed = addr;
+    if (pOpt->FlashFile != NULL) {
+        if (pOpt->Nodes > 1) {
+            snprintf(flashName, sizeof(flashName), "%s.%u", pOpt->FlashFile, addr);
+        } else {
+            snprintf(flashName, sizeof(flashName), "%s", pOpt->FlashFile);
+        }
+        config.FlashFile = flashName;
+    }
+    if (SIM_Init(&config) != 0) {
+        fprintf(stderr, "tp2_vdev: image flash illisible\n");
+        return -1;
+    }
+    SIM_SetAdc(0, (uint16_t)pOpt->Adc[0], 1);
+    SIM_SetAdc(1, (uint16_t)pOpt->Adc[1], 1);
+#if RS232_MULTIDROP
+    GPARAM_Set(PARAM_ID_NODE_ADDRESS, addr);
+#endif
+    return 0;
+}
+
+static void VDEV_Stop(void)
+{
+    S_simStats stats;
+
+    SIM_GetStats(&stats);
+    if (SIM_FlashSave() != 0) {
+        perror("tp2_vdev: sauvegarde flash");
+    }
+    fprintf(stderr, "tp2_vdev: %.3f s, rx %u (overrun %u, perdus %u), tx %u, boucles %llu\n",
+            (double)SIM_Now() / SIM_NS_PER_S, stats.RxBytes, stats.RxOverruns, stats.RxLost,
+            stats.TxBytes, (unsigned long long)stats.MainLoops);
+}
+
+/**
+ * @brief Bus multipoint : relaie le pty vers tous les fils et les missions
+ *        de chaque fil vers le pty et les autres fils (demi-duplex partag).
+ */
+static int VDEV_Bus(int master, const int *pSocks, int nodes)
+{
+    struct epoll_event events[VDEV_MAX_EVENTS];
+    uint8_t buf[VDEV_IO_SIZE];
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int sfd = VDEV_SignalFd();
+    int running = 1;
+    ssize_t n;
+    int nb;
+    int i;
+    int k;
+
+    VDEV_EpollAdd(epfd, sfd, EPOLLIN);
+    VDEV_EpollAdd(epfd, master, EPOLLIN);
+    for (k = 0; k < nodes; k++) {
+        VDEV_EpollAdd(epfd, pSocks[k], EPOLLIN);
+    }
+    while (running)
+    {
+        nb = epoll_wait(epfd, events, VDEV_MAX_EVENTS, -1);
+        for (i = 0; i < nb; i++) {
+            int src = events[i].data.fd;
+
+            if (src == sfd) {
+                running = 0;
+                continue;
+            }
+            n = read(src, buf, sizeof(buf));
+            if (n <= 0) {
+                // Fin d'un fil : le bus s'arrte ; pas de client sur le pty : EIO
+                if ((src != master) && ((n == 0) || (errno != EAGAIN))) {
+                    running = 0;
+                }
+                continue;
+            }
+            // critures bloquantes sur les sockets : le bus ne perd rien
+            if (src != master) {
+                (void)!write(master, buf, (size_t)n);
+            }
+            for (k = 0; k < nodes; k++) {
+                if (pSocks[k] != src) {
+                    (void)!write(pSocks[k], buf, (size_t)n);
+                }
+            }
+        }
+    }
+    close(sfd);
+    close(epfd);
+    return 0;
+}
+
+static void VDEV_Usage(void)
+{
+    fprintf(stderr, "usage: tp2_vdev [--flash FICHIER] [--link CHEMIN] [--rate R]\n"
+                    "                [--adc0 V] [--adc1 V]%s\n",
+            RS232_MULTIDROP ? " [--nodes N]" : "");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option longOpts[] = {
+        { "flash", required_argument, NULL, 'f' },
+        { "link", required_argument, NULL, 'l' },
+        { "rate", required_argument, NULL, 'r' },
+        { "adc0", required_argument, NULL, '0' },
+        { "adc1", required_argument, NULL, '1' },
+        { "nodes", required_argument, NULL, 'n' },
+        { NULL, 0, NULL, 0 }
+    };
+    S_vdevOptions opt = { NULL, NULL, 1.0, { 512, 512 }, 1 };
+    int socks[VDEV_MAX_NODES];
+    pid_t pids[VDEV_MAX_NODES];
+    int master;
+    int slave;
+    int pair[2];
+    int c;
+    int k;
+
+    while ((c = getopt_long(argc, argv, "", longOpts, NULL)) != -1) {
+        switch (c) {
+            case 'f': opt.FlashFile = optarg; break;
+            case 'l': opt.Link = optarg; break;
+            case 'r': opt.Rate = atof(optarg); break;
+            case '0': opt.Adc[0] = atoi(optarg); break;
+            case '1': opt.Adc[1] = atoi(optarg); break;
+            case 'n': opt.Nodes = atoi(optarg); break;
+            default: VDEV_Usage(); return 2;
+        }
+    }
+    if ((opt.Rate <= 0.0) || (opt.Nodes < 1) || (opt.Nodes > VDEV_MAX_NODES) ||
+        (!RS232_MULTIDROP && (opt.Nodes > 1))) {
+        VDEV_Usage();
+        return 2;
+    }
+
+    master = VDEV_OpenPty(opt.Link, &slave);
+    if (master < 0) {
+        return 1;
+    }
+
+    if (opt.Nodes == 1) {
+        if (VDEV_Start(&opt, RS232_NODE_ADDRESS) != 0) {
+            return 1;
+        }
+        VDEV_Serve(master, opt.Rate);
+        VDEV_Stop();
+    } else {
+        // Un processus par carte : l'tat du firmware est statique
+        for (k = 0; k < opt.Nodes; k++) {
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) {
+                perror("tp2_vdev: socketpair");
+                return 1;
+            }
+            pids[k] = fork();
+            if (pids[k] == 0) {
+                close(pair[0]);
+                VDEV_SetNonBlock(pair[1]);
+                if (VDEV_Start(&opt, (uint8_t)(k + 1)) != 0) {
+                    _exit(1);
+                }
+                VDEV_Serve(pair[1], opt.Rate);
+                VDEV_Stop();
+                _exit(0);
+            }
+            close(pair[1]);
+            socks[k] = pair[0];
+        }
+        VDEV_Bus(master, socks, opt.Nodes);
+        for (k = 0; k < opt.Nodes; k++) {
+            kill(pids[k], SIGTERM);
+            waitpid(pids[k], NULL, 0);
+        }
+    }
+
+    if (opt.Link != NULL) {
+        unlink(opt.Link);
+    }
+    close(slave);
+    close(master);
+    return 0;
+}